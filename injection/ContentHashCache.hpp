@@ -0,0 +1,66 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef GRAPHICS_LAYER_CONTENT_HASH_CACHE_HPP
+#define GRAPHICS_LAYER_CONTENT_HASH_CACHE_HPP
+
+///////////////////////////////////
+// STD C++
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+///////////////////////////////////
+
+namespace GraphicsLayer
+{
+    // Bounded map from content hash to value with first-in-first-out
+    // eviction. Eviction only depends on the sequence of inserted hashes,
+    // so two caches fed the same sequence hold the same keys. The injected
+    // side relies on this to know which hashes the parser still remembers.
+    template<typename T>
+    class ContentHashCache
+    {
+        public:
+            explicit ContentHashCache(size_t capacity);
+
+            T* get(uint64_t hash);
+            bool insert(uint64_t hash, const T& value);
+            void clear();
+            size_t getSize() const;
+            size_t getCapacity() const;
+
+        private:
+            std::unordered_map<uint64_t, T> mEntries;
+            std::vector<uint64_t> mInsertionOrder;
+            size_t mOldest = 0;
+            size_t mCapacity;
+    };
+
+    #include "injection/ContentHashCache.inl"
+}
+
+#endif // GRAPHICS_LAYER_CONTENT_HASH_CACHE_HPP
@@ -0,0 +1,90 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+
+template<typename T>
+ContentHashCache<T>::ContentHashCache(size_t capacity)
+: mCapacity(capacity)
+{
+    mEntries.reserve(mCapacity);
+    mInsertionOrder.reserve(mCapacity);
+}
+
+template<typename T>
+T* ContentHashCache<T>::get(uint64_t hash)
+{
+    auto it = mEntries.find(hash);
+    if(it == mEntries.end())
+        return nullptr;
+
+    return &it->second;
+}
+
+// Returns false, and only updates the value, if the hash is already cached.
+template<typename T>
+bool ContentHashCache<T>::insert(uint64_t hash, const T& value)
+{
+    auto it = mEntries.find(hash);
+    if(it != mEntries.end())
+    {
+        it->second = value;
+        return false;
+    }
+
+    if(mInsertionOrder.size() < mCapacity)
+    {
+        mInsertionOrder.push_back(hash);
+    }
+    else
+    {
+        mEntries.erase(mInsertionOrder[mOldest]);
+        mInsertionOrder[mOldest] = hash;
+        mOldest = (mOldest + 1) % mCapacity;
+    }
+
+    mEntries.emplace(hash, value);
+    return true;
+}
+
+template<typename T>
+void ContentHashCache<T>::clear()
+{
+    mEntries.clear();
+    mInsertionOrder.clear();
+    mOldest = 0;
+}
+
+template<typename T>
+size_t ContentHashCache<T>::getSize() const
+{
+    return mEntries.size();
+}
+
+template<typename T>
+size_t ContentHashCache<T>::getCapacity() const
+{
+    return mCapacity;
+}
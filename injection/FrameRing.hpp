@@ -0,0 +1,90 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef GRAPHICS_LAYER_FRAME_RING_HPP
+#define GRAPHICS_LAYER_FRAME_RING_HPP
+
+///////////////////////////////////
+// STD C++
+#include <atomic>
+#include <cstdint>
+///////////////////////////////////
+
+namespace GraphicsLayer
+{
+    namespace SharedMemoryProtocol
+    {
+        template<unsigned int SLOT_SIZE>
+        struct FrameSlot
+        {
+            unsigned int size;
+            char data[SLOT_SIZE];
+        };
+
+        // Single producer, single consumer ring of frame slots. Lives inside
+        // shared memory, so it is never constructed; zeroed memory is a valid
+        // empty ring. The producer only writes mHead and the consumer only
+        // writes mTail. Both are free running counters, slot index is
+        // counter % NUM_SLOTS.
+        template<unsigned int NUM_SLOTS, unsigned int SLOT_SIZE>
+        class FrameRing
+        {
+            public:
+                typedef FrameSlot<SLOT_SIZE> Slot;
+
+            public:
+                void reset();
+
+                // Producer side.
+                Slot* getWriteSlot();
+                void commitWriteSlot();
+
+                // Consumer side. Slots are released in order, but several
+                // may be read before the first one is released; index counts
+                // from the oldest unreleased slot.
+                const Slot* getReadSlot(unsigned int index = 0) const;
+                void releaseReadSlot();
+
+                unsigned int getNumFrames() const;
+                static constexpr unsigned int getNumSlots();
+                static constexpr unsigned int getSlotSize();
+
+            private:
+                static_assert(NUM_SLOTS > 0 && (NUM_SLOTS & (NUM_SLOTS - 1)) == 0, "Number of slots must be a power of two.");
+                static_assert(ATOMIC_INT_LOCK_FREE == 2, "Frame ring requires lock free atomics.");
+                static const size_t CACHE_LINE_SIZE = 64;
+
+                alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> mHead;
+                alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> mTail;
+                alignas(CACHE_LINE_SIZE) Slot mSlots[NUM_SLOTS];
+        };
+
+        #include "injection/FrameRing.inl"
+    }
+}
+
+
+#endif // GRAPHICS_LAYER_FRAME_RING_HPP
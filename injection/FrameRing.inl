@@ -0,0 +1,88 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+
+template<unsigned int NUM_SLOTS, unsigned int SLOT_SIZE>
+void FrameRing<NUM_SLOTS, SLOT_SIZE>::reset()
+{
+    mHead.store(0, std::memory_order_relaxed);
+    mTail.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+template<unsigned int NUM_SLOTS, unsigned int SLOT_SIZE>
+typename FrameRing<NUM_SLOTS, SLOT_SIZE>::Slot* FrameRing<NUM_SLOTS, SLOT_SIZE>::getWriteSlot()
+{
+    uint32_t head = mHead.load(std::memory_order_relaxed);
+    uint32_t tail = mTail.load(std::memory_order_acquire);
+    if(head - tail >= NUM_SLOTS)
+        return nullptr;
+
+    return &mSlots[head % NUM_SLOTS];
+}
+
+template<unsigned int NUM_SLOTS, unsigned int SLOT_SIZE>
+void FrameRing<NUM_SLOTS, SLOT_SIZE>::commitWriteSlot()
+{
+    uint32_t head = mHead.load(std::memory_order_relaxed);
+    mHead.store(head + 1, std::memory_order_release);
+}
+
+template<unsigned int NUM_SLOTS, unsigned int SLOT_SIZE>
+const typename FrameRing<NUM_SLOTS, SLOT_SIZE>::Slot* FrameRing<NUM_SLOTS, SLOT_SIZE>::getReadSlot(unsigned int index) const
+{
+    uint32_t tail = mTail.load(std::memory_order_relaxed);
+    uint32_t head = mHead.load(std::memory_order_acquire);
+    if(head - tail <= index)
+        return nullptr;
+
+    return &mSlots[(tail + index) % NUM_SLOTS];
+}
+
+template<unsigned int NUM_SLOTS, unsigned int SLOT_SIZE>
+void FrameRing<NUM_SLOTS, SLOT_SIZE>::releaseReadSlot()
+{
+    uint32_t tail = mTail.load(std::memory_order_relaxed);
+    mTail.store(tail + 1, std::memory_order_release);
+}
+
+template<unsigned int NUM_SLOTS, unsigned int SLOT_SIZE>
+unsigned int FrameRing<NUM_SLOTS, SLOT_SIZE>::getNumFrames() const
+{
+    return mHead.load(std::memory_order_acquire) - mTail.load(std::memory_order_acquire);
+}
+
+template<unsigned int NUM_SLOTS, unsigned int SLOT_SIZE>
+constexpr unsigned int FrameRing<NUM_SLOTS, SLOT_SIZE>::getNumSlots()
+{
+    return NUM_SLOTS;
+}
+
+template<unsigned int NUM_SLOTS, unsigned int SLOT_SIZE>
+constexpr unsigned int FrameRing<NUM_SLOTS, SLOT_SIZE>::getSlotSize()
+{
+    return SLOT_SIZE;
+}
@@ -0,0 +1,71 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef GRAPHICS_LAYER_FRAME_WRITER_HPP
+#define GRAPHICS_LAYER_FRAME_WRITER_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "injection/SharedMemoryProtocol.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <cstddef>
+///////////////////////////////////
+
+namespace GraphicsLayer
+{
+    // Bump pointer writer that encodes one frame straight into a shared
+    // memory frame slot. reserve() hands out contiguous space right after
+    // the previous reservation and keeps the frame header size up to date.
+    // It returns nullptr instead of overflowing the slot.
+    class FrameWriter
+    {
+        public:
+            void begin(SharedMemoryProtocol::SharedFrameSlot* slot);
+            void rewind();
+            void finish();
+
+            char* reserve(size_t size);
+            bool canReserve(size_t size) const;
+            bool hasSlot() const;
+
+            SharedMemoryProtocol::Frame& getFrame() const;
+            SharedMemoryProtocol::SharedFrameSlot* getSlot() const;
+            size_t getSize() const;
+            size_t getCapacity() const;
+
+            static size_t getMaxMessageSize();
+
+        private:
+            SharedMemoryProtocol::SharedFrameSlot* mSlot = nullptr;
+            char* mCursor = nullptr;
+            char* mEnd = nullptr;
+    };
+}
+
+#endif // GRAPHICS_LAYER_FRAME_WRITER_HPP
@@ -0,0 +1,154 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef GRAPHICS_LAYER_MESSAGE_CURSOR_HPP
+#define GRAPHICS_LAYER_MESSAGE_CURSOR_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "injection/SharedMemoryProtocol.hpp"
+#include "utility/utility.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <array>
+#include <utility>
+#include <type_traits>
+#include <limits>
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+///////////////////////////////////
+
+namespace GraphicsLayer
+{
+namespace SharedMemoryProtocol
+{
+    // Compile time registry of the messages. Every message type names the
+    // struct it starts with and the number of payload bytes that follow the
+    // struct. getPayloadSize returns false if the struct is invalid.
+    template<Message::MessageType type>
+    struct MessageLayout;
+
+    template<typename HeaderType>
+    struct FixedMessageLayout
+    {
+        typedef HeaderType Header;
+        static bool getPayloadSize(const Header&, size_t& size) {size = 0; return true;}
+    };
+
+    struct PixelsMessageLayout
+    {
+        typedef PixelData Header;
+        static bool getPayloadSize(const Header& m, size_t& size);
+    };
+
+    template<> struct MessageLayout<Message::MessageType::PIXEL_DATA> : PixelsMessageLayout {};
+    template<> struct MessageLayout<Message::MessageType::SCREEN_PIXELS> : PixelsMessageLayout {};
+    template<> struct MessageLayout<Message::MessageType::PIXEL_DATA_REF> : FixedMessageLayout<PixelData> {};
+    template<> struct MessageLayout<Message::MessageType::TEXTURE_DATA> : FixedMessageLayout<TextureData> {};
+    template<> struct MessageLayout<Message::MessageType::VERTEX_ATTRIB_POINTER> : FixedMessageLayout<VertexAttribPointer> {};
+    template<> struct MessageLayout<Message::MessageType::DRAW_CALL> : FixedMessageLayout<DrawCall> {};
+    template<> struct MessageLayout<Message::MessageType::TRANSFORMATION_MATRIX> : FixedMessageLayout<TransformationMatrix> {};
+    template<> struct MessageLayout<Message::MessageType::UNIFORM_4_F> : FixedMessageLayout<Uniform4f> {};
+    template<> struct MessageLayout<Message::MessageType::COPY_TEXTURE> : FixedMessageLayout<CopyTexture> {};
+
+    template<> struct MessageLayout<Message::MessageType::VERTEX_BUFFER_WRITE>
+    {
+        typedef VertexBufferWrite Header;
+        static bool getPayloadSize(const Header& m, size_t& size) {size = m.numBytes; return true;}
+    };
+
+    template<> struct MessageLayout<Message::MessageType::FILE_IO>
+    {
+        typedef FileIo Header;
+        static bool getPayloadSize(const Header& m, size_t& size) {size = m.pathSize; return true;}
+    };
+
+    // Walks the messages of one frame segment in place. Messages are
+    // dispatched through a jump table indexed by the message type byte, so
+    // unknown types cost nothing extra. Every message is checked against the
+    // end of the segment before its handler runs. Message structs are not
+    // aligned in the segment, so they are copied out before the handler sees
+    // them. Payloads are handed out where they are.
+    class MessageCursor
+    {
+        public:
+            static const size_t NUM_MESSAGE_TYPES = size_t(Message::MessageType::INVALID);
+
+            struct Counters
+            {
+                std::array<uint64_t, NUM_MESSAGE_TYPES> numMessages = {};
+                std::array<uint64_t, NUM_MESSAGE_TYPES> numBytes = {};
+
+                Counters& operator+=(const Counters& other);
+            };
+
+        public:
+            MessageCursor(const char* begin, const char* end);
+
+            // Calls handler(header, payload, payloadSize) for every message,
+            // header being the struct of the message type. Stops and returns
+            // false at the first message that is unknown, invalid or does not
+            // fit the segment. The handler is not called for that message.
+            template<typename Handler>
+            bool forEach(Handler&& handler);
+
+            bool isAtEnd() const;
+            const char* getPosition() const;
+            const Counters& getCounters() const;
+
+            static const char* getName(Message::MessageType type);
+
+        private:
+            template<typename Handler>
+            using Step = const char* (*)(Handler& handler, const char* data, const char* end, Counters& counters);
+
+            template<Message::MessageType type, typename Handler>
+            static const char* step(Handler& handler, const char* data, const char* end, Counters& counters);
+
+            template<size_t typeIndex, bool isKnown = (typeIndex < NUM_MESSAGE_TYPES)>
+            struct StepSelector;
+
+            template<typename Handler, size_t... typeIndices>
+            static const Step<Handler>* getJumpTable(std::index_sequence<typeIndices...>);
+
+        private:
+            const char* mData;
+            const char* mEnd;
+            Counters mCounters;
+    };
+
+    #include "injection/MessageCursor.inl"
+}
+}
+
+#endif // GRAPHICS_LAYER_MESSAGE_CURSOR_HPP
@@ -0,0 +1,187 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+inline bool PixelsMessageLayout::getPayloadSize(const Header& m, size_t& size)
+{
+    typedef sb::utility::PixelFormat Format;
+    size_t bytesPerPixel;
+    switch(m.format)
+    {
+        case Format::ALPHA: bytesPerPixel = sb::utility::BYTES_PER_PIXEL_ALPHA; break;
+        case Format::RGB: bytesPerPixel = sb::utility::BYTES_PER_PIXEL_RGB; break;
+        case Format::RGBA: bytesPerPixel = sb::utility::BYTES_PER_PIXEL_RGBA; break;
+        case Format::BGRA: bytesPerPixel = sb::utility::BYTES_PER_PIXEL_BGRA; break;
+        default: return false;
+    }
+
+    // Does not fit 32 bits for the largest textures.
+    const uint64_t numBytes = uint64_t(m.width) * m.height * bytesPerPixel;
+    if(numBytes > std::numeric_limits<size_t>::max())
+        return false;
+
+    size = numBytes;
+    return true;
+}
+
+///////////////////////////////////
+
+inline MessageCursor::Counters& MessageCursor::Counters::operator+=(const Counters& other)
+{
+    for(size_t i = 0; i < NUM_MESSAGE_TYPES; i++)
+    {
+        numMessages[i] += other.numMessages[i];
+        numBytes[i] += other.numBytes[i];
+    }
+
+    return *this;
+}
+
+///////////////////////////////////
+
+inline MessageCursor::MessageCursor(const char* begin, const char* end)
+: mData(begin)
+, mEnd(end)
+{
+}
+
+///////////////////////////////////
+
+inline bool MessageCursor::isAtEnd() const
+{
+    return mData >= mEnd;
+}
+
+///////////////////////////////////
+
+inline const char* MessageCursor::getPosition() const
+{
+    return mData;
+}
+
+///////////////////////////////////
+
+inline const MessageCursor::Counters& MessageCursor::getCounters() const
+{
+    return mCounters;
+}
+
+///////////////////////////////////
+
+inline const char* MessageCursor::getName(Message::MessageType type)
+{
+    typedef Message::MessageType Type;
+    switch(type)
+    {
+        case Type::PIXEL_DATA: return "PixelData";
+        case Type::TEXTURE_DATA: return "TextureData";
+        case Type::VERTEX_BUFFER_WRITE: return "VertexBufferWrite";
+        case Type::VERTEX_ATTRIB_POINTER: return "VertexAttribPointer";
+        case Type::DRAW_CALL: return "DrawCall";
+        case Type::TRANSFORMATION_MATRIX: return "TransformationMatrix";
+        case Type::UNIFORM_4_F: return "Uniform4f";
+        case Type::COPY_TEXTURE: return "CopyTexture";
+        case Type::FILE_IO: return "FileIo";
+        case Type::PIXEL_DATA_REF: return "PixelDataRef";
+        case Type::SCREEN_PIXELS: return "ScreenPixels";
+        default: return "Invalid";
+    }
+}
+
+///////////////////////////////////
+
+template<size_t typeIndex>
+struct MessageCursor::StepSelector<typeIndex, true>
+{
+    template<typename Handler>
+    static const char* step(Handler& handler, const char* data, const char* end, Counters& counters)
+    {
+        return MessageCursor::step<Message::MessageType(typeIndex)>(handler, data, end, counters);
+    }
+};
+
+template<size_t typeIndex>
+struct MessageCursor::StepSelector<typeIndex, false>
+{
+    template<typename Handler>
+    static const char* step(Handler&, const char*, const char*, Counters&)
+    {
+        return nullptr;
+    }
+};
+
+///////////////////////////////////
+
+template<typename Handler, size_t... typeIndices>
+const MessageCursor::Step<Handler>* MessageCursor::getJumpTable(std::index_sequence<typeIndices...>)
+{
+    static const Step<Handler> JUMP_TABLE[] = {&StepSelector<typeIndices>::template step<Handler>...};
+    return JUMP_TABLE;
+}
+
+///////////////////////////////////
+
+template<Message::MessageType type, typename Handler>
+const char* MessageCursor::step(Handler& handler, const char* data, const char* end, Counters& counters)
+{
+    typedef MessageLayout<type> Layout;
+    typedef typename Layout::Header Header;
+    static_assert(std::is_trivially_copyable<Header>::value, "Messages are copied out of the segment with memcpy.");
+
+    if(size_t(end - data) < sizeof(Header))
+        return nullptr;
+
+    Header header;
+    memcpy(&header, data, sizeof(Header));
+    const char* payload = data + sizeof(Header);
+    size_t payloadSize;
+    if(!Layout::getPayloadSize(header, payloadSize) || payloadSize > size_t(end - payload))
+        return nullptr;
+
+    counters.numMessages[size_t(type)]++;
+    counters.numBytes[size_t(type)] += sizeof(Header) + payloadSize;
+    handler(header, payload, payloadSize);
+    return payload + payloadSize;
+}
+
+///////////////////////////////////
+
+template<typename Handler>
+bool MessageCursor::forEach(Handler&& handler)
+{
+    typedef typename std::remove_reference<Handler>::type HandlerType;
+    static_assert(sizeof(Message::MessageType) == 1, "The jump table is indexed by one byte.");
+    const Step<HandlerType>* jumpTable = getJumpTable<HandlerType>(std::make_index_sequence<256>());
+    while(mData < mEnd)
+    {
+        const char* next = jumpTable[(unsigned char)*mData](handler, mData, mEnd, mCounters);
+        if(next == nullptr)
+            return false;
+
+        mData = next;
+    }
+
+    return true;
+}
@@ -31,6 +31,9 @@
 // Internal ShankBot headers
 #include "injection/TextureUnitHolder.hpp"
 #include "injection/SharedMemoryProtocol.hpp"
+#include "injection/FrameWriter.hpp"
+#include "injection/ContentHashCache.hpp"
+#include "utility/SharedMemory.hpp"
 ///////////////////////////////////
 
 ///////////////////////////////////
@@ -48,6 +51,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <cstring>
 ///////////////////////////////////
 
 namespace GraphicsLayer
@@ -105,8 +110,6 @@ namespace GraphicsLayer
             void setFramebuffer(GLuint framebuffer);
             void setActiveTexture(GLenum texture);
             void setFramebufferTexture(GLuint texture, GLint level);
-            void postFrame() const;
-            void waitForFrameRequest() const;
             void submitFrameData();
             void clearDataBuffer();
 
@@ -122,14 +125,24 @@ namespace GraphicsLayer
         private:
             SharedMemoryProtocol::Frame* getCurrentFrame() const;
             void createNewFrame();
+            char* reserveDataBuffer(size_t size);
             void appendToDataBuffer(const char* data, size_t size);
             template<typename T>
             void appendToDataBuffer(const T& message)
             {
                 appendToDataBuffer((char*)&message, sizeof(message));
             }
+            template<typename T>
+            void appendToDataBuffer(const T& message, const char* payload, size_t payloadSize)
+            {
+                char* dest = reserveDataBuffer(sizeof(message) + payloadSize);
+                memcpy(dest, &message, sizeof(message));
+                memcpy(dest + sizeof(message), payload, payloadSize);
+            }
 
-            void updateSharedMemory();
+            SharedMemoryProtocol::SharedFrameSlot* waitForFreeSlot() const;
+            void postFrame() const;
+            void commitFrame();
             void printSharedMemoryBufferDiagnostics();
             bool isParentAlive() const;
 
@@ -154,7 +167,6 @@ namespace GraphicsLayer
             GLuint mBoundProgram = 0;
             GLuint mBoundVertexArray = 0;
 
-            size_t mCurrentFrameIndex = 0;
             Color mCurrentBlendColor;
             GLsizei mCurrentViewportWidth = 0;
             GLsizei mCurrentViewportHeight = 0;
@@ -166,11 +178,14 @@ namespace GraphicsLayer
 
             std::map<GLuint, GLuint> mFramebufferTextureAttachment;
             TextureUnitHolder mTextureUnits;
-            std::vector<char> mDataBuffer;
+            FrameWriter mWriter;
+            bool mIsFrameContinued = false; // The slot being written continues a frame.
+            ContentHashCache<bool> mSentPixelHashes;
             std::map<GLuint, SharedMemoryProtocol::VertexBufferWrite> mVertexBuffers;
             std::map<GLuint, GLuint> mVaoToVbo;
             std::vector<GLuint> mTextureBuffers;
             unsigned char mVaoEnableData = 0;
+            std::unique_ptr<sb::utility::SharedMemory> mSharedMemory;
             SharedMemoryProtocol::SharedMemorySegment* mShm = nullptr;
 
             float mPeakDataOccupancy = 0.f;
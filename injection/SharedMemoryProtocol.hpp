@@ -38,11 +38,13 @@
 #include "utility/Matrix.hpp"
 #include "utility/Color.hpp"
 #include "utility/PixelFormat.hpp"
+#include "injection/FrameRing.hpp"
 ///////////////////////////////////
 
 ///////////////////////////////////
 // STD C++
 #include <cstdint>
+#include <atomic>
 ///////////////////////////////////
 
 namespace GraphicsLayer
@@ -63,6 +65,7 @@ namespace GraphicsLayer
                 UNIFORM_4_F,
                 COPY_TEXTURE,
                 FILE_IO,
+                PIXEL_DATA_REF, // PixelData without pixels, repeats an earlier upload with the same hash.
 
                 SCREEN_PIXELS,
                 INVALID
@@ -80,6 +83,7 @@ namespace GraphicsLayer
             unsigned short height;
             unsigned int targetTextureId;
             sb::utility::PixelFormat format;
+            uint64_t hash = 0; // 0 if the upload is not content addressed.
         };
 
         struct CopyTexture : public Message
@@ -175,10 +179,15 @@ namespace GraphicsLayer
             unsigned int size = sizeof(Frame);
             unsigned short width = 0;
             unsigned short height = 0;
+            bool hasContinuation = false; // Frame did not fit its slot and continues in the next one.
+            bool clearsPixelHashes = false; // Pixel hashes sent before this frame may not have reached the parser.
+            bool discardsContinuedFrame = false; // The frame continued into this slot was abandoned. Its earlier slots are to be dropped.
         };
 
 
         const unsigned int DATA_BUFFER_SIZE = 1 << 24;
+        const unsigned int NUM_FRAME_SLOTS = 4;
+        const unsigned int PIXEL_HASH_CACHE_SIZE = 1 << 16;
         const char* const SHARED_MEMORY_ENV_VAR_NAME = "SHANKBOT_SHARED_MEMORY_NAME";
         const unsigned int SHARED_MEMORY_NAME_LENGTH = 128;
 
@@ -188,16 +197,18 @@ namespace GraphicsLayer
             const uint32_t ScreenPixels   = 1 << 0;
         };
 
+        typedef FrameRing<NUM_FRAME_SLOTS, DATA_BUFFER_SIZE> SharedFrameRing;
+        typedef SharedFrameRing::Slot SharedFrameSlot;
+
         struct SharedMemorySegment
         {
-            char data[DATA_BUFFER_SIZE];
-            unsigned int size;
+            SharedFrameRing frames;
 
             #if defined(_WIN32)
             HWND window = NULL;
             HANDLE parentProcessHandle = NULL;
-            HANDLE semWrite = NULL;
-            HANDLE semRead = NULL;
+            HANDLE frameCommittedEvent = NULL; // Hint only, the ring is the source of truth.
+            HANDLE slotReleasedEvent = NULL; // Hint only, the ring is the source of truth.
             #else
 
             #endif
@@ -206,6 +217,7 @@ namespace GraphicsLayer
             uint32_t dataFilters = DataFilter::Standard;
 
             bool isClientAttached = false;
+            std::atomic<bool> isPixelHashResyncRequested; // Set by the parser. The monitor clears its pixel hashes and sets Frame::clearsPixelHashes on its next slot.
         };
 
         const unsigned int NUM_BYTES = sizeof(SharedMemorySegment);
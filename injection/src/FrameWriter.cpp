@@ -0,0 +1,113 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "injection/FrameWriter.hpp"
+using namespace GraphicsLayer::SharedMemoryProtocol;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <cassert>
+#include <new>
+///////////////////////////////////
+
+namespace GraphicsLayer
+{
+void FrameWriter::begin(SharedFrameSlot* slot)
+{
+    assert(slot != nullptr);
+    mSlot = slot;
+    mEnd = mSlot->data + SharedFrameRing::getSlotSize();
+    rewind();
+}
+
+void FrameWriter::rewind()
+{
+    assert(mSlot != nullptr);
+    new (mSlot->data) Frame();
+    mCursor = mSlot->data + sizeof(Frame);
+}
+
+void FrameWriter::finish()
+{
+    assert(mSlot != nullptr);
+    mSlot->size = getSize();
+    mSlot = nullptr;
+    mCursor = nullptr;
+    mEnd = nullptr;
+}
+
+char* FrameWriter::reserve(size_t size)
+{
+    if(!canReserve(size))
+        return nullptr;
+
+    char* dest = mCursor;
+    mCursor += size;
+    getFrame().size += size;
+    return dest;
+}
+
+bool FrameWriter::canReserve(size_t size) const
+{
+    return mSlot != nullptr && size <= size_t(mEnd - mCursor);
+}
+
+bool FrameWriter::hasSlot() const
+{
+    return mSlot != nullptr;
+}
+
+Frame& FrameWriter::getFrame() const
+{
+    assert(mSlot != nullptr);
+    return *(Frame*)mSlot->data;
+}
+
+SharedFrameSlot* FrameWriter::getSlot() const
+{
+    return mSlot;
+}
+
+size_t FrameWriter::getSize() const
+{
+    return mSlot == nullptr ? 0 : mCursor - mSlot->data;
+}
+
+size_t FrameWriter::getCapacity() const
+{
+    return SharedFrameRing::getSlotSize();
+}
+
+size_t FrameWriter::getMaxMessageSize()
+{
+    return SharedFrameRing::getSlotSize() - sizeof(Frame);
+}
+}
@@ -30,6 +30,7 @@
 // Internal ShankBot headers
 #include "injection/Monitor.hpp"
 #include "injection/utility.hpp"
+#include "utility/utility.hpp"
 using namespace GraphicsLayer::SharedMemoryProtocol;
 ///////////////////////////////////
 
@@ -52,56 +53,58 @@ std::map<std::string, WindowProc> Monitor::mClassNameToWndProc;
 std::map<HWND, WindowProc> Monitor::mHwndToWndProc;
 
 Monitor::Monitor()
+: mSentPixelHashes(PIXEL_HASH_CACHE_SIZE)
 {
     char szName[SHARED_MEMORY_NAME_LENGTH + 1];
     GetEnvironmentVariable(SHARED_MEMORY_ENV_VAR_NAME, szName, sizeof(szName));
     SetEnvironmentVariable(SHARED_MEMORY_ENV_VAR_NAME, NULL);
-    HANDLE hMapFile = OpenFileMapping
-    (
-        FILE_MAP_ALL_ACCESS,   // read/write access
-        FALSE,                 // do not inherit the name
-        szName      // name of mapping object
-    );
-
-    if (hMapFile == NULL)
-    {
-        throw std::runtime_error("Could not create shared memory object (" + std::to_string(GetLastError()) + ").");
-    }
-
-    mShm = (SharedMemorySegment*) MapViewOfFile
-    (
-        hMapFile, // handle to map object
-        FILE_MAP_ALL_ACCESS,  // read/write permission
-        0,
-        0,
-        NUM_BYTES
-    );
-
-    if (mShm == NULL)
-    {
-        throw std::runtime_error("Could not map shared memory (" + std::to_string(GetLastError()) + ").");
-    }
 
+    mSharedMemory.reset(new sb::utility::SharedMemory(szName, NUM_BYTES, sb::utility::SharedMemory::Mode::OPEN));
+    mShm = (SharedMemorySegment*)mSharedMemory->getData();
     mShm->isClientAttached = true;
+    createNewFrame();
 }
 
 
 Frame* Monitor::getCurrentFrame() const
 {
-    return (Frame*)((char*)mDataBuffer.data() + mCurrentFrameIndex);
+    return &mWriter.getFrame();
 }
 
 void Monitor::createNewFrame()
 {
-    Frame f;
-    mCurrentFrameIndex = mDataBuffer.size();
-    mDataBuffer.insert(mDataBuffer.end(), (char*)&f, (char*)&f + sizeof(f));
+    mWriter.begin(waitForFreeSlot());
+
+    // The parser missed uploads it holds references to, so everything is
+    // sent in full again.
+    if(mShm->isPixelHashResyncRequested.exchange(false))
+    {
+        mSentPixelHashes.clear();
+        getCurrentFrame()->clearsPixelHashes = true;
+    }
+}
+
+char* Monitor::reserveDataBuffer(size_t size)
+{
+    char* dest = mWriter.reserve(size);
+    if(dest == nullptr)
+    {
+        // Split the frame. The consumer keeps accumulating into the same
+        // frame until it sees a slot without continuation.
+        THROW_ASSERT(size <= FrameWriter::getMaxMessageSize());
+        getCurrentFrame()->hasContinuation = true;
+        commitFrame();
+        createNewFrame();
+        mIsFrameContinued = true;
+        dest = mWriter.reserve(size);
+    }
+
+    return dest;
 }
 
 void Monitor::appendToDataBuffer(const char* data, size_t size)
 {
-    getCurrentFrame()->size += size;
-    mDataBuffer.insert(mDataBuffer.end(), data, data + size);
+    memcpy(reserveDataBuffer(size), data, size);
 }
 
 void Monitor::setDepthTest(bool doEnable)
@@ -302,8 +305,7 @@ void Monitor::appendVertexBufferWriteToDataBuffer(const GLvoid* data, GLsizei si
     buffer.numBytes = size;
 
     buffer.messageType = Message::MessageType::VERTEX_BUFFER_WRITE;
-    appendToDataBuffer(buffer);
-    appendToDataBuffer((const char*)data, size);
+    appendToDataBuffer(buffer, (const char*)data, size);
 }
 
 
@@ -389,31 +391,50 @@ void Monitor::insertPixelData
     }
 
     p.messageType = Message::MessageType::PIXEL_DATA;
-    appendToDataBuffer(p);
 
-    size_t size;
     if(p.format == PixelFormat::ALPHA)
     {
-        size = width * height * 1;
+        size_t size = width * height * 1;
+        char* dest = reserveDataBuffer(sizeof(p) + size);
+        memcpy(dest, &p, sizeof(p));
+        dest += sizeof(p);
 
         size_t remainder = width % mCurrentUnpackAlignment;
         if(remainder != 0)
         {
+            // Rows are padded to the unpack alignment on the GL side, strip
+            // the padding while copying into shared memory.
             size_t paddedWidth = width + mCurrentUnpackAlignment - remainder;
-            char* unpaddedData = new char[size];
             for(size_t iSrc = 0, iDest = 0; iDest < size; iSrc += paddedWidth, iDest += width)
-                memcpy(&unpaddedData[iDest], &((const char*)data)[iSrc], width);
-            appendToDataBuffer(unpaddedData, size);
-            delete[] unpaddedData;
-            return;
+                memcpy(&dest[iDest], &((const char*)data)[iSrc], width);
+        }
+        else
+        {
+            memcpy(dest, data, size);
         }
     }
     else
     {
-        size = width * height * 4;
-    }
+        size_t size = width * height * 4;
+        if(p.targetTextureId == mTileSheetTextureId)
+        {
+            // The client keeps re-uploading the same sprites to the tile
+            // sheet. Only send pixels the parser has not seen yet.
+            uint64_t seed = (uint64_t(p.width) << 32) | (uint64_t(p.height) << 16) | uint64_t(p.format);
+            p.hash = sb::utility::hash64(data, size, seed);
+            if(p.hash == 0)
+                p.hash = 1;
+
+            if(!mSentPixelHashes.insert(p.hash, true))
+            {
+                p.messageType = Message::MessageType::PIXEL_DATA_REF;
+                appendToDataBuffer(p);
+                return;
+            }
+        }
 
-    appendToDataBuffer((char*)data, size);
+        appendToDataBuffer(p, (const char*)data, size);
+    }
 }
 
 
@@ -463,48 +484,18 @@ void Monitor::setFramebufferTexture(GLuint texture, GLint level)
 
 
 
-void Monitor::updateSharedMemory()
+void Monitor::commitFrame()
 {
-    if(mDataBuffer.size() < sizeof(Frame))
-    {
-        return;
-    }
-
-    size_t insertionSize = 0;
-    if(mDataBuffer.size() > DATA_BUFFER_SIZE)
-    {
-        while(true)
-        {
-            const Frame& f = *(Frame*)((char*)mDataBuffer.data() + insertionSize);
-            size_t newInsertionSize = insertionSize + f.size;
-            if(newInsertionSize > DATA_BUFFER_SIZE || newInsertionSize > mDataBuffer.size())
-                break;
-            insertionSize = newInsertionSize;
-        }
-        THROW_ASSERT(insertionSize <= mDataBuffer.size());
-    }
-    else
-    {
-        insertionSize = mDataBuffer.size();
-    }
-
-    memcpy(mShm->data, mDataBuffer.data(), insertionSize);
-    mShm->size = insertionSize;
-    if(insertionSize == mDataBuffer.size())
-    {
-        mDataBuffer.clear();
-    }
-    else
-    {
-        mDataBuffer.erase(mDataBuffer.begin(), mDataBuffer.begin() + insertionSize);
-    }
+    mWriter.finish();
+    mShm->frames.commitWriteSlot();
+    postFrame();
 }
 
 void Monitor::printSharedMemoryBufferDiagnostics()
 {
-    float dataOccupancy = ((float)mDataBuffer.size()) / ((float)DATA_BUFFER_SIZE) * 100.f;
+    float dataOccupancy = ((float)mWriter.getSize()) / ((float)mWriter.getCapacity()) * 100.f;
     mPeakDataOccupancy = std::max(mPeakDataOccupancy, dataOccupancy);
-    std::cout   << "Shared memory buffer occupancy: " << mDataBuffer.size() << " / " << DATA_BUFFER_SIZE
+    std::cout   << "Shared memory buffer occupancy: " << mWriter.getSize() << " / " << mWriter.getCapacity()
                 << "  (" << dataOccupancy << "%)"
                 << " peak: " << mPeakDataOccupancy << "%" <<  std::endl;
 }
@@ -523,80 +514,83 @@ bool Monitor::isParentAlive() const
 
 void Monitor::postFrame() const
 {
-    if(ReleaseSemaphore(mShm->semRead, 1, NULL) == 0)
+    if(SetEvent(mShm->frameCommittedEvent) == 0)
     {
-        std::cout << "Could not release shared memory read semaphore. Error code: " << GetLastError() << std::endl;
+        std::cout << "Could not signal frame committed event. Error code: " << GetLastError() << std::endl;
         throw std::runtime_error("");
     }
 }
 
 
-void Monitor::waitForFrameRequest() const
+SharedFrameSlot* Monitor::waitForFreeSlot() const
 {
-    switch(WaitForSingleObject(mShm->semWrite, 500))
+    while(true)
     {
-        case WAIT_ABANDONED:
-            std::cout << "WAIT_ABANDONED" << std::endl;
-            throw std::runtime_error("");
+        SharedFrameSlot* slot = mShm->frames.getWriteSlot();
+        if(slot != nullptr)
+        {
+            return slot;
+        }
 
-        case WAIT_OBJECT_0:
-            return;
+        switch(WaitForSingleObject(mShm->slotReleasedEvent, 500))
+        {
+            case WAIT_ABANDONED:
+                std::cout << "WAIT_ABANDONED" << std::endl;
+                throw std::runtime_error("");
 
-        case WAIT_TIMEOUT:
-            if(!isParentAlive())
-                ExitProcess(0);
+            case WAIT_OBJECT_0:
+                break;
 
-            waitForFrameRequest();
-            return;
+            case WAIT_TIMEOUT:
+                if(!isParentAlive())
+                    ExitProcess(0);
+                break;
 
-        case WAIT_FAILED:
-            std::cout << "WAIT_FAILED" << std::endl;
-            throw std::runtime_error("");
+            case WAIT_FAILED:
+                std::cout << "WAIT_FAILED" << std::endl;
+                throw std::runtime_error("");
 
-        default:
-            std::cout << "Unimplemented wait signal." << std::endl;
-            throw std::runtime_error("");
-            break;
+            default:
+                std::cout << "Unimplemented wait signal." << std::endl;
+                throw std::runtime_error("");
+                break;
+        }
     }
 }
 
 
 void Monitor::submitFrameData()
 {
-    THROW_ASSERT(getCurrentFrame()->size <= DATA_BUFFER_SIZE);
-
-    getCurrentFrame()->width = mCurrentViewportWidth;
-    getCurrentFrame()->height = mCurrentViewportHeight;
-
     if(mShm->dataFilters & DataFilter::ScreenPixels)
     {
         appendScreenPixelsToDataBuffer();
     }
 
-    updateSharedMemory();
+    getCurrentFrame()->width = mCurrentViewportWidth;
+    getCurrentFrame()->height = mCurrentViewportHeight;
+
+    commitFrame();
     createNewFrame();
+    mIsFrameContinued = false;
 }
 
 void Monitor::appendScreenPixelsToDataBuffer()
 {
     size_t size = mCurrentViewportWidth * mCurrentViewportHeight * 4;
-    char* pixels = new char[size];
 
     void APIENTRY (*readPixels)(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, GLvoid*);
     readPixels = (decltype(readPixels))GetProcAddress(GetModuleHandle("opengl32.dll"), "glReadPixels");
     THROW_ASSERT(readPixels != nullptr);
 
-    readPixels(0, 0, mCurrentViewportWidth, mCurrentViewportHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
-
     PixelData p;
     p.format = sb::utility::PixelFormat::RGBA;
     p.width = mCurrentViewportWidth;
     p.height = mCurrentViewportHeight;
     p.messageType = Message::MessageType::SCREEN_PIXELS;
-    appendToDataBuffer(p);
-    appendToDataBuffer(pixels, size);
 
-    delete[] pixels;
+    char* dest = reserveDataBuffer(sizeof(p) + size);
+    memcpy(dest, &p, sizeof(p));
+    readPixels(0, 0, mCurrentViewportWidth, mCurrentViewportHeight, GL_RGBA, GL_UNSIGNED_BYTE, dest + sizeof(p));
 }
 
 WindowProc Monitor::getWindowProc(HWND window)
@@ -686,7 +680,6 @@ void Monitor::createWindow(HWND window, LPCWSTR windowName)
     if(name == "Tibia")
     {
         mShm->window = window;
-        waitForFrameRequest();
     }
 }
 
@@ -769,8 +762,16 @@ void Monitor::handleWindowMessage(LPMSG msg)
 
 void Monitor::clearDataBuffer()
 {
-    mDataBuffer.clear();
-    createNewFrame();
+    mWriter.rewind();
+
+    // Slots of the frame that are already committed cannot be taken back,
+    // so the parser is told to drop them.
+    getCurrentFrame()->discardsContinuedFrame = mIsFrameContinued;
+    mIsFrameContinued = false;
+
+    // Uploads discarded by the rewind never reach the parser.
+    mSentPixelHashes.clear();
+    getCurrentFrame()->clearsPixelHashes = true;
 }
 }
 
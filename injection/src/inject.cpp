@@ -318,10 +318,7 @@ BOOL WINAPI swapBuf(HDC hdc)
 {
     static DetourHolder& detour = injection->getDetour(swapBuf);
     monitor->submitFrameData();
-    BOOL retVal = detour.callAs(swapBuf, hdc);
-    monitor->postFrame();
-    monitor->waitForFrameRequest();
-    return retVal;
+    return detour.callAs(swapBuf, hdc);
 }
 
 
@@ -28,10 +28,14 @@
 #define SB_LZMA_CONFIG_HPP
 
 
-#if defined(BUILD_SHANK_BOT_LZMA)
-    #define SHANK_BOT_LZMA_DECLSPEC __declspec(dllexport)
+#if defined(_WIN32)
+    #if defined(BUILD_SHANK_BOT_LZMA)
+        #define SHANK_BOT_LZMA_DECLSPEC __declspec(dllexport)
+    #else
+        #define SHANK_BOT_LZMA_DECLSPEC __declspec(dllimport)
+    #endif
 #else
-    #define SHANK_BOT_LZMA_DECLSPEC __declspec(dllimport)
+    #define SHANK_BOT_LZMA_DECLSPEC
 #endif
 
 #endif // SB_LZMA_CONFIG_HPP
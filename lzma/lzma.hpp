@@ -40,6 +40,8 @@
 ///////////////////////////////////
 // STD C++
 #include <cstring>
+#include <vector>
+#include <memory>
 ///////////////////////////////////
 
 namespace sb
@@ -55,6 +57,53 @@ namespace lzma
         const unsigned char* props,
         size_t propsSize
     );
+
+    // Decodes raw LZMA streams straight from the input (typically a mapped
+    // file) into a caller provided output buffer, so that neither side is
+    // copied. The decoder keeps its state and probability tables between
+    // calls in an arena of its own, so one decoder per thread can decode any
+    // number of streams without going back to the heap.
+    class SHANK_BOT_LZMA_DECLSPEC Decoder
+    {
+        public:
+            Decoder();
+            ~Decoder();
+            Decoder(const Decoder&) = delete;
+            Decoder& operator=(const Decoder&) = delete;
+
+            // Same contract as uncompress: destLen and srcLen hold the buffer
+            // sizes on input and the processed sizes on output. Returns an
+            // SZ_* result code.
+            int decode
+            (
+                unsigned char* dest,
+                size_t* destLen,
+                const unsigned char* src,
+                size_t* srcLen,
+                const unsigned char* props,
+                size_t propsSize
+            );
+
+        private:
+            struct Impl;
+            std::unique_ptr<Impl> mImpl;
+    };
+
+    struct Stream
+    {
+        const unsigned char* src = nullptr;
+        size_t srcLen = 0;
+        const unsigned char* props = nullptr;
+        size_t propsSize = 0;
+        unsigned char* dest = nullptr;
+        size_t destLen = 0;
+        int result = SZ_OK;
+    };
+
+    // Decodes independent streams concurrently, with one decoder per thread.
+    // The processed sizes and result code are written back to each stream.
+    // Uses all cores if numThreads is 0.
+    SHANK_BOT_LZMA_DECLSPEC void decodeBatch(std::vector<Stream>& streams, size_t numThreads = 0);
 }
 }
 
@@ -33,6 +33,19 @@
 ///////////////////////////////////
 // Lzma
 #include "lzma/LzmaLib.h"
+#include "lzma/LzmaDec.h"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <thread>
+#include <atomic>
+#include <algorithm>
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C
+#include <cstdlib>
 ///////////////////////////////////
 
 namespace sb
@@ -51,5 +64,141 @@ namespace lzma
     {
         return LzmaUncompress(dest, destLen, src, srcLen, props, propsSize);
     }
+
+    ///////////////////////////////////
+
+    // The decoder only allocates its probability tables, and only again when
+    // the properties of a stream need more of them. The arena keeps the
+    // largest block asked for and hands it out again instead of freeing it.
+    struct Arena
+    {
+        ISzAlloc alloc; // First member, so the callbacks can cast back.
+        void* block = nullptr;
+        size_t blockSize = 0;
+        bool isBlockUsed = false;
+
+        Arena()
+        {
+            alloc.Alloc = &Arena::allocate;
+            alloc.Free = &Arena::free;
+        }
+
+        ~Arena()
+        {
+            std::free(block);
+        }
+
+        static void* allocate(void* p, size_t size)
+        {
+            Arena& arena = *(Arena*)p;
+            if(arena.isBlockUsed)
+                return std::malloc(size);
+
+            if(size > arena.blockSize)
+            {
+                void* block = std::realloc(arena.block, size);
+                if(!block)
+                    return nullptr;
+                arena.block = block;
+                arena.blockSize = size;
+            }
+            arena.isBlockUsed = true;
+            return arena.block;
+        }
+
+        static void free(void* p, void* address)
+        {
+            Arena& arena = *(Arena*)p;
+            if(address == arena.block)
+                arena.isBlockUsed = false;
+            else
+                std::free(address);
+        }
+    };
+
+    struct Decoder::Impl
+    {
+        Arena arena;
+        CLzmaDec state;
+    };
+
+    Decoder::Decoder()
+    : mImpl(new Impl())
+    {
+        LzmaDec_Construct(&mImpl->state);
+    }
+
+    Decoder::~Decoder()
+    {
+        LzmaDec_FreeProbs(&mImpl->state, &mImpl->arena.alloc);
+    }
+
+    int Decoder::decode
+    (
+        unsigned char* dest,
+        size_t* destLen,
+        const unsigned char* src,
+        size_t* srcLen,
+        const unsigned char* props,
+        size_t propsSize
+    )
+    {
+        // Same as LzmaDecode, except that the probabilities outlive the call.
+        const SizeT RC_INIT_SIZE = 5; // As in LzmaDec.c
+        const SizeT outSize = *destLen;
+        const SizeT inSize = *srcLen;
+        *destLen = 0;
+        *srcLen = 0;
+        if(inSize < RC_INIT_SIZE)
+            return SZ_ERROR_INPUT_EOF;
+
+        CLzmaDec& state = mImpl->state;
+        SRes result = LzmaDec_AllocateProbs(&state, props, (unsigned)propsSize, &mImpl->arena.alloc);
+        if(result != SZ_OK)
+            return result;
+
+        state.dic = dest;
+        state.dicBufSize = outSize;
+        LzmaDec_Init(&state);
+
+        SizeT processed = inSize;
+        ELzmaStatus status;
+        result = LzmaDec_DecodeToDic(&state, outSize, src, &processed, LZMA_FINISH_ANY, &status);
+        *destLen = state.dicPos;
+        *srcLen = processed;
+        if(result == SZ_OK && status == LZMA_STATUS_NEEDS_MORE_INPUT)
+            result = SZ_ERROR_INPUT_EOF;
+
+        state.dic = nullptr;
+        return result;
+    }
+
+    ///////////////////////////////////
+
+    void decodeBatch(std::vector<Stream>& streams, size_t numThreads)
+    {
+        if(numThreads == 0)
+            numThreads = std::max(1u, std::thread::hardware_concurrency());
+        numThreads = std::min(numThreads, streams.size());
+
+        // Streams are handed out one at a time, since their sizes vary a lot.
+        std::atomic<size_t> nextStream(0);
+        auto run = [&streams, &nextStream]()
+        {
+            Decoder decoder;
+            for(size_t i = nextStream++; i < streams.size(); i = nextStream++)
+            {
+                Stream& s = streams[i];
+                s.result = decoder.decode(s.dest, &s.destLen, s.src, &s.srcLen, s.props, s.propsSize);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for(size_t i = 1; i < numThreads; i++)
+            threads.emplace_back(run);
+        run();
+        for(std::thread& t : threads)
+            t.join();
+    }
 }
 }
@@ -32,6 +32,8 @@
 #include "utility/Matrix.hpp"
 #include "utility/Color.hpp"
 #include "utility/Vertex.hpp"
+#include "utility/Span.hpp"
+#include "utility/StringView.hpp"
 #include "tibiaassets/Object.hpp"
 ///////////////////////////////////
 
@@ -40,15 +42,24 @@
 #include <memory>
 #include <list>
 #include <string>
+#include <vector>
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C
+#include <cstdint>
 ///////////////////////////////////
 
 namespace GraphicsLayer
 {
+    // Draws hold no memory of their own. The transforms, pairings, names
+    // and glyphs they point to live in the arena of the frame they belong
+    // to, and are valid for as long as the frame is.
     struct Draw
     {
         Vertex topLeft;
         Vertex botRight;
-        std::shared_ptr<sb::utility::Matrix<float, 4, 4>> transform;
+        const sb::utility::Matrix<float, 4, 4>* transform = nullptr;
         unsigned short drawCallId;
         bool isDepthTestEnabled = false;
         bool isDepthWriteEnabled = true;
@@ -94,10 +105,10 @@ namespace GraphicsLayer
         struct SpriteObjectPairing
         {
             size_t spriteId;
-            std::list<size_t> objects;
+            sb::utility::Span<uint32_t> objects;
         };
 
-        std::list<SpriteObjectPairing> pairings;
+        sb::utility::Span<SpriteObjectPairing> pairings;
     };
 
     struct RectDraw : public Draw
@@ -107,7 +118,7 @@ namespace GraphicsLayer
 
     struct GuiDraw : public Draw
     {
-        std::string name;
+        sb::utility::StringView name;
     };
 
     struct GlyphDraw : public Draw
@@ -117,7 +128,7 @@ namespace GraphicsLayer
 
     struct TextDraw : public Draw
     {
-        std::shared_ptr<std::vector<GlyphDraw>> glyphDraws;
+        sb::utility::Span<GlyphDraw> glyphDraws;
         Color color;
         bool isOutlined;
     };
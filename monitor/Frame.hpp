@@ -32,6 +32,7 @@
 #include "Draw.hpp"
 #include "FileIo.hpp"
 #include "monitor/RawImage.hpp"
+#include "utility/MonotonicArena.hpp"
 ///////////////////////////////////
 
 ///////////////////////////////////
@@ -70,6 +71,10 @@ namespace GraphicsLayer
         std::shared_ptr<std::vector<FileIo>> fileIo; // Unused
         std::shared_ptr<std::vector<MiniMapDraw>> miniMapDraws;
         std::shared_ptr<RawImage> screenPixels;
+
+        // Owns the memory the draws point into. Frames handed out by a
+        // FramePool share one allocation for the arena and the draw vectors.
+        std::shared_ptr<sb::utility::MonotonicArena> arena;
     };
 }
 
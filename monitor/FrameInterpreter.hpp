@@ -0,0 +1,114 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef GRAPHICS_LAYER_FRAME_INTERPRETER_HPP
+#define GRAPHICS_LAYER_FRAME_INTERPRETER_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/Frame.hpp"
+#include "monitor/GuiParser.hpp"
+#include "monitor/TextParser.hpp"
+#include "monitor/RectParser.hpp"
+#include "monitor/GuiSpriteParser.hpp"
+#include "monitor/SceneParser.hpp"
+#include "monitor/SideBarWindowAssembler.hpp"
+#include "monitor/SideBarWindowDiff.hpp"
+#include "utility/TaskGraph.hpp"
+namespace GraphicsLayer
+{
+    class TibiaContext;
+}
+namespace sb
+{
+namespace utility
+{
+    class WorkStealingPool;
+}
+}
+///////////////////////////////////
+
+namespace GraphicsLayer
+{
+    // Runs the frame parsers as a task graph, each parser as soon as what it
+    // reads is parsed:
+    //
+    //   GuiParser -> TextParser --+
+    //   RectParser ---------------+-> SideBarWindowAssembler -> SideBarWindowDiff
+    //   GuiSpriteParser ----------+
+    //   SceneParser
+    //
+    // so that interpreting a frame takes about as long as the longest path
+    // rather than all of the parsers.
+    class FrameInterpreter
+    {
+        public:
+            enum class Task : unsigned char
+            {
+                GUI,
+                TEXT,
+                RECT,
+                GUI_SPRITE,
+                SCENE,
+                SIDE_BAR,
+                SIDE_BAR_DIFF,
+
+                NUM_TASKS,
+            };
+
+        public:
+            explicit FrameInterpreter(const TibiaContext& context, sb::utility::WorkStealingPool& pool);
+
+            // Blocks until every parser is done with the frame. The frame is
+            // kept until the next one, since the results point into it.
+            void interpret(const Frame& frame);
+
+            const GuiParser::Data& getGuiData();
+            const TextParser::Data& getTextData() const;
+            const RectParser::Data& getRectData();
+            const GuiSpriteParser::Data& getGuiSpriteData();
+            const SceneParser::Data& getSceneData() const;
+            const SideBarWindowAssembler::Data& getSideBarData() const;
+            const SideBarWindowDiff::Data& getSideBarDiffData() const;
+
+            // How long the task took for the last frame.
+            double getMicroseconds(Task task) const;
+            static const char* getName(Task task);
+
+        private:
+            Frame mFrame;
+            GuiParser mGui;
+            TextParser mText;
+            RectParser mRect;
+            GuiSpriteParser mGuiSprite;
+            SceneParser mScene;
+            SideBarWindowAssembler mSideBar;
+            SideBarWindowDiff mSideBarDiff;
+            sb::utility::TaskGraph mGraph;
+    };
+}
+
+#endif // GRAPHICS_LAYER_FRAME_INTERPRETER_HPP
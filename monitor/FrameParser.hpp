@@ -31,10 +31,15 @@
 // Internal ShankBot headers
 #include "TileBufferCache.hpp"
 #include "injection/SharedMemoryProtocol.hpp"
+#include "injection/ContentHashCache.hpp"
+#include "injection/MessageCursor.hpp"
 #include "FontSample.hpp"
 #include "Frame.hpp"
+#include "FramePool.hpp"
 #include "GenericType.hpp"
 #include "CombatSquareSample.hpp"
+#include "SequenceTree.hpp"
+#include "utility/ClockCache.hpp"
 
 #include "utility/utility.hpp" // REMOVE LATER
  // REMOVE LATER
@@ -44,6 +49,13 @@ namespace GraphicsLayer
 {
     class TibiaContext;
 }
+namespace sb
+{
+namespace utility
+{
+    class ThreadPool;
+}
+}
 ///////////////////////////////////
 
 
@@ -51,6 +63,7 @@ namespace GraphicsLayer
 // STD C++
 #include <set>
 #include <memory>
+#include <map>
 ///////////////////////////////////
 
 namespace GraphicsLayer
@@ -174,18 +187,97 @@ namespace GraphicsLayer
                 T data;
             };
 
+            // Pairings of a recognized tile, stored flat. They are copied into
+            // the frame arena for every draw of the tile.
+            struct SpriteObjectPairings
+            {
+                struct Pairing
+                {
+                    uint32_t spriteId;
+                    uint32_t numObjects;
+                };
+
+                std::vector<Pairing> pairings;
+                std::vector<uint32_t> objects;
+            };
+
             typedef TileData<std::list<std::string>, Tile::Type::GRAPHICS_RESOURCE_NAMES> GraphicsResourceNamesData;
-            typedef TileData<std::list<SpriteDraw::SpriteObjectPairing>, Tile::Type::SPRITE_OBJECT_PAIRINGS> SpriteObjectPairingsData;
+            typedef TileData<SpriteObjectPairings, Tile::Type::SPRITE_OBJECT_PAIRINGS> SpriteObjectPairingsData;
             typedef TileData<TileNumber, Tile::Type::TILE_NUMBER> TileNumberData;
             typedef TileData<unsigned char, Tile::Type::GLYPH> GlyphData;
             typedef TileData<CombatSquareSample::CombatSquare::Type, Tile::Type::COMBAT_SQUARE> CombatSquareData;
 
+            // Identifies the pixels of a tile upload. The hash is the one sent
+            // by the injected side, if there is one. The rest guards against
+            // two uploads sharing a hash.
+            struct TileContent
+            {
+                uint64_t hash = 0;
+                size_t size = 0;
+                uint64_t head = 0; // First bytes of the pixels.
+                uint64_t tail = 0; // Last bytes of the pixels.
+
+                bool operator==(const TileContent& other) const;
+            };
+
+            struct RecognizedTile
+            {
+                TileContent content;
+                Tile tile;
+            };
+
+            struct TileQuery
+            {
+                SharedMemoryProtocol::PixelData data;
+                const unsigned char* pixels = nullptr;
+                std::vector<size_t> opaquePixels;
+                std::vector<size_t> transparency;
+                bool isBlank = false;
+                TileContent content;
+                size_t recognizedTileIndex = 0;
+            };
+
         public:
             explicit FrameParser(const TibiaContext& context);
-            std::list<Frame> parse(const SharedMemoryProtocol::SharedMemorySegment* segment);
+            ~FrameParser();
+
+            // Segments that are truncated or hold unknown or invalid messages
+            // are skipped without parsing any of their messages.
+            std::list<Frame> parse(const char* data, size_t size);
+
+            const SharedMemoryProtocol::MessageCursor::Counters& getMessageCounters() const;
+            size_t getNumRejectedSegments() const;
+
+            // True once whenever the pixel hashes of the injected side may name
+            // uploads this parser never saw, i.e. after a rejected segment or a
+            // reference to an unknown hash. The injected side is then to clear
+            // its hashes, which it answers with a frame that sets
+            // clearsPixelHashes. Until that frame arrives, no further request
+            // is made.
+            bool takePixelHashResyncRequest();
+
+            // Tile buffer uploads looked up by their content, before any
+            // sequence tree lookup.
+            size_t getNumRecognitionCacheHits() const;
+            size_t getNumRecognitionCacheMisses() const;
 
         private:
+            struct MessageHandler;
+            struct TileQueryCollector;
+
             void updateTileBuffer(const SharedMemoryProtocol::PixelData& data, const unsigned char* pixels);
+            Tile recognizeTile(const SharedMemoryProtocol::PixelData& data, const unsigned char* pixels) const;
+            bool recognizeTiles(const char* data, const char* end);
+            void rejectSegment();
+            Tile getRecognizedTile(const SharedMemoryProtocol::PixelData& data, const unsigned char* pixels);
+            static TileContent getTileContent(const SharedMemoryProtocol::PixelData& data, const unsigned char* pixels);
+            const Tile* findRecognizedTile(const TileContent& content);
+            void convertToTreeSprites(TileQuery& query) const;
+            static SequenceTree::BatchQuery createTreeQuery(const TileQuery& query);
+            Tile createTile(const TileQuery& query, const unsigned int* matchingIds, size_t numMatchingIds, bool isColorFound) const;
+            void setTile(const SharedMemoryProtocol::PixelData& data, const Tile& tile);
+            sb::utility::Span<SpriteDraw::SpriteObjectPairing> copyToFrame(const SpriteObjectPairings& pairings);
+            sb::utility::StringView copyToFrame(const std::string& str);
             void updateMiniMapPixels(const SharedMemoryProtocol::PixelData& pixelData, const unsigned char* pixels);
 
             unsigned char getChar(unsigned textureId, unsigned short x, unsigned short y, unsigned short width, unsigned short height);
@@ -197,6 +289,7 @@ namespace GraphicsLayer
             void copyGlyphs(const SharedMemoryProtocol::DrawCall& drawCall);
 
             void parsePixelData(const SharedMemoryProtocol::PixelData& pixelData, const unsigned char* pixels);
+            void parsePixelDataRef(const SharedMemoryProtocol::PixelData& ref);
             void parseGlyphPixelData(const SharedMemoryProtocol::PixelData& pixelData, const unsigned char* pixels);
             void parseCopyTexture(const SharedMemoryProtocol::CopyTexture& copy);
             void parseTextureData(const SharedMemoryProtocol::TextureData& textureData);
@@ -222,6 +315,23 @@ namespace GraphicsLayer
 
             const TibiaContext& mContext;
             TileBufferCache<Tile> mTileCache;
+            ContentHashCache<Tile> mPixelHashCache;
+
+            // Unlike mPixelHashCache, which mirrors the injected side, this
+            // one evicts on its own terms. Uploads without a pixel hash, as
+            // in older recordings, are hashed here the same way.
+            static const size_t RECOGNITION_CACHE_SIZE = 1 << 14;
+            sb::utility::ClockCache<RecognizedTile> mRecognitionCache;
+            size_t mNumRecognitionCollisions = 0;
+
+            // Tile buffer uploads of the current frame, recognized in one batch
+            // before the frame is parsed. Consumed in message order.
+            std::unique_ptr<sb::utility::ThreadPool> mThreadPool;
+            std::vector<TileQuery> mTileQueries;
+            size_t mNumTileQueries = 0;
+            SequenceTree::BatchResults mTreeResults;
+            std::vector<std::pair<const unsigned char*, Tile>> mRecognizedTiles;
+            size_t mNextRecognizedTile = 0;
 
             std::map<unsigned short, VertexBuffer> mVertexBuffers;
             std::map<unsigned int, Texture> mTextures;
@@ -233,7 +343,15 @@ namespace GraphicsLayer
             unsigned int mShadedViewBufferId = 0;
             std::set<unsigned int> mGlyphBufferIds;
 
+            SharedMemoryProtocol::MessageCursor::Counters mMessageCounters;
+            size_t mNumRejectedSegments = 0;
+            bool mIsPixelHashResyncNeeded = false;
+            bool mIsPixelHashResyncRequested = false;
+
+            FramePool mFramePool;
             Frame mCurrentFrame;
+            bool mIsFrameContinued = false;
+            std::vector<GlyphDraw> mGlyphDraws;
 
             size_t mDrawCallId;
     };
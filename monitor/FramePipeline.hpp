@@ -0,0 +1,201 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef GRAPHICS_LAYER_FRAME_PIPELINE_HPP
+#define GRAPHICS_LAYER_FRAME_PIPELINE_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/FrameParser.hpp"
+#include "utility/SpscQueue.hpp"
+namespace GraphicsLayer
+{
+    class TibiaContext;
+}
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <exception>
+///////////////////////////////////
+
+namespace GraphicsLayer
+{
+    // Runs frame parsing as three stages on threads of their own, connected
+    // by bounded queues:
+    //  1. Acquisition waits for the next segment of the source, e.g. a
+    //     shared memory slot, and passes it on without copying it.
+    //  2. FrameParser turns segments into frames, in place. It sees every
+    //     segment, in order, and hands each back to the source once parsed.
+    //  3. Interpreters consume the frames. Each one runs on a thread of its
+    //     own and sees every frame, in order, so they run concurrently with
+    //     each other.
+    // A full queue blocks the stage feeding it, so the throughput is the one
+    // of the slowest stage rather than the sum of them.
+    class FramePipeline
+    {
+        public:
+            typedef std::chrono::steady_clock Clock;
+
+            // Frames are shared between the interpreters and never modified
+            // once parsed.
+            struct StampedFrame
+            {
+                Frame frame;
+                size_t sequence = 0;
+                Clock::time_point acquireTime;
+                Clock::time_point parseTime;
+            };
+            typedef std::shared_ptr<const StampedFrame> SharedFrame;
+
+            // Points data at the next segment. The segment has to stay valid
+            // until it is released. Returning false ends the pipeline once
+            // everything before it is interpreted. Should not block for long
+            // after isStopping() turns true.
+            typedef std::function<bool(const char*& data, size_t& size)> SegmentSource;
+            // Called on the parsing thread once the oldest segment that is
+            // not yet released is parsed. Segments are released in the order
+            // they were acquired. Ones left in the queue when the pipeline
+            // stops are never released.
+            typedef std::function<void()> SegmentRelease;
+            typedef std::function<void(const SharedFrame& frame)> Interpreter;
+            // Asks the source to resend the pixels the parser lost track of.
+            // See FrameParser::takePixelHashResyncRequest.
+            typedef std::function<void()> PixelHashResync;
+
+            struct StageStats
+            {
+                std::string name;
+                size_t numItems = 0;
+                double busyMicroseconds = 0.0;
+                double maxMicroseconds = 0.0;
+            };
+
+        public:
+            // At most queueCapacity + 2 segments are held at a time: the
+            // queued ones, the one being parsed and the one being pushed.
+            explicit FramePipeline(const TibiaContext& context, SegmentSource source, SegmentRelease release, size_t queueCapacity = 4);
+            ~FramePipeline();
+            FramePipeline(const FramePipeline&) = delete;
+            FramePipeline& operator=(const FramePipeline&) = delete;
+
+            // Must be called before start().
+            void addInterpreter(std::string name, Interpreter interpreter);
+            // Must be called before start(). Called on the parsing thread.
+            void setPixelHashResync(PixelHashResync resync);
+
+            void start();
+
+            // Closes the queues. Every stage stops after its current item.
+            void stop();
+            bool isStopping() const;
+
+            // Waits for every stage to finish, either because the source ran
+            // out of segments or because of stop(). Rethrows the first
+            // exception thrown by any stage, which also stops the pipeline.
+            void join();
+
+            // Acquisition, parsing, every interpreter and lastly the latency
+            // from acquiring a segment until its frame is interpreted by all.
+            std::vector<StageStats> getStageStats() const;
+            size_t getNumInterpretedFrames() const;
+
+            // Only to be read after join().
+            const FrameParser& getFrameParser() const;
+
+        private:
+            struct Segment
+            {
+                const char* data = nullptr;
+                size_t size = 0;
+                Clock::time_point acquireTime;
+            };
+
+            struct TrackedFrame : StampedFrame
+            {
+                mutable std::atomic<size_t> numPendingInterpreters;
+            };
+
+            struct Timing
+            {
+                explicit Timing(std::string name);
+                void record(Clock::time_point start, Clock::time_point end);
+                StageStats get() const;
+
+                mutable std::mutex mutex;
+                StageStats stats;
+            };
+
+            struct InterpreterStage
+            {
+                explicit InterpreterStage(std::string name, Interpreter interpreter, size_t queueCapacity);
+
+                Interpreter interpreter;
+                sb::utility::SpscQueue<SharedFrame> frames;
+                Timing timing;
+                std::thread thread;
+            };
+
+        private:
+            void acquire();
+            void parse();
+            void interpret(InterpreterStage& stage);
+            void joinThreads();
+            void runStage(const std::function<void()>& function);
+            void fail(std::exception_ptr error);
+
+        private:
+            SegmentSource mSource;
+            SegmentRelease mRelease;
+            PixelHashResync mPixelHashResync;
+            FrameParser mFrameParser;
+            const size_t mQueueCapacity;
+
+            sb::utility::SpscQueue<Segment> mSegments;
+            std::vector<std::unique_ptr<InterpreterStage>> mInterpreters;
+            std::thread mAcquisitionThread;
+            std::thread mParsingThread;
+            Timing mAcquisitionTiming;
+            Timing mParsingTiming;
+            Timing mLatencyTiming;
+            std::atomic<size_t> mNumInterpretedFrames;
+
+            std::atomic<bool> mIsStopping;
+            bool mIsStarted = false;
+            std::mutex mErrorMutex;
+            std::exception_ptr mError;
+    };
+}
+
+#endif // GRAPHICS_LAYER_FRAME_PIPELINE_HPP
@@ -0,0 +1,93 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef GRAPHICS_LAYER_FRAME_POOL_HPP
+#define GRAPHICS_LAYER_FRAME_POOL_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/Frame.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <memory>
+#include <mutex>
+///////////////////////////////////
+
+namespace GraphicsLayer
+{
+    // Hands out empty frames whose draw vectors and arena are recycled once
+    // the last copy of the frame is released, so that a steady stream of
+    // frames stops allocating after the first few. Frames may be released
+    // on any thread and may outlive the pool.
+    class FramePool
+    {
+        public:
+            // At most maxNumFree released frames are kept for reuse.
+            explicit FramePool(size_t maxNumFree = 8);
+
+            Frame acquire();
+
+            size_t getNumCreated() const;
+            size_t getNumFree() const;
+
+        private:
+            struct Storage
+            {
+                sb::utility::MonotonicArena arena;
+                std::vector<SpriteDraw> spriteDraws;
+                std::vector<GuiDraw> guiDraws;
+                std::vector<SpriteDraw> guiSpriteDraws;
+                std::vector<TextDraw> textDraws;
+                std::vector<RectDraw> rectDraws;
+                std::vector<FileIo> fileIo;
+                std::vector<MiniMapDraw> miniMapDraws;
+
+                void clear();
+            };
+
+            struct State
+            {
+                mutable std::mutex mutex;
+                std::vector<std::unique_ptr<Storage>> free;
+                size_t maxNumFree = 0;
+                size_t numCreated = 0;
+            };
+
+            struct Recycler
+            {
+                std::shared_ptr<State> state;
+                void operator()(Storage* storage) const;
+            };
+
+        private:
+            std::shared_ptr<State> mState;
+    };
+}
+
+#endif // GRAPHICS_LAYER_FRAME_POOL_HPP
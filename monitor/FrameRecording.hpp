@@ -0,0 +1,94 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef GRAPHICS_LAYER_FRAME_RECORDING_HPP
+#define GRAPHICS_LAYER_FRAME_RECORDING_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/MappedFile.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <string>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <cstdint>
+///////////////////////////////////
+
+namespace GraphicsLayer
+{
+    // A recording holds the raw contents of every shared memory frame slot
+    // the monitor read, in order, so that FrameParser can be fed the exact
+    // same message stream offline. FrameParser keeps texture and buffer
+    // state between slots, so a useful recording starts at the first slot
+    // of a client session.
+    namespace FrameRecording
+    {
+        static const char MAGIC[8] = {'S', 'B', 'F', 'R', 'M', 'R', 'E', 'C'};
+        static const uint32_t VERSION = 1;
+
+        struct Chunk
+        {
+            uint64_t time; // Microseconds since the recording started.
+            const char* data;
+            size_t size;
+        };
+
+        class Writer
+        {
+            public:
+                explicit Writer(const std::string& filePath);
+
+                void write(const char* data, size_t size);
+                size_t getNumChunks() const;
+
+            private:
+                std::ofstream mFile;
+                std::chrono::steady_clock::time_point mStart;
+                size_t mNumChunks = 0;
+        };
+
+        // Maps the whole recording. Chunk data points into the mapping and
+        // is aligned like a frame slot.
+        class Reader
+        {
+            public:
+                explicit Reader(const std::string& filePath);
+
+                const std::vector<Chunk>& getChunks() const;
+
+            private:
+                sb::utility::MappedFile mFile;
+                std::vector<Chunk> mChunks;
+        };
+    }
+}
+
+
+#endif // GRAPHICS_LAYER_FRAME_RECORDING_HPP
@@ -0,0 +1,88 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef GRAPHICS_LAYER_GLYPH_INDEX_HPP
+#define GRAPHICS_LAYER_GLYPH_INDEX_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/FontSample.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+///////////////////////////////////
+
+namespace GraphicsLayer
+{
+    // Lookup structure over the glyph samples, built once when the glyphs
+    // are loaded. Pixel identical glyphs are found through a hash table.
+    // Otherwise the glyphs are bucketed by size and sorted by pixel sum, so
+    // that the candidates for a fuzzy comparison are found without scanning
+    // every glyph.
+    class GlyphIndex
+    {
+        public:
+            static const size_t NO_GLYPH = -1;
+            static const size_t SUM_EPSILON = 2;
+
+        public:
+            explicit GlyphIndex(const std::vector<FontSample::Glyph>& glyphs);
+
+            // Index of the first glyph with exactly these pixels, or NO_GLYPH.
+            size_t findExact(const unsigned char* pixels, unsigned short width, unsigned short height) const;
+
+            // Indices of the glyphs that a window of the given size and pixel sum
+            // should be compared against, in glyph order. That is, the glyphs
+            // whose sum is within a factor SUM_EPSILON of sum and which either
+            // fit inside the window or contain it.
+            void findCandidates(unsigned short width, unsigned short height, size_t sum, std::vector<uint32_t>& candidates) const;
+
+        private:
+            struct SizeBucket
+            {
+                unsigned short width;
+                unsigned short height;
+                std::vector<std::pair<unsigned int, uint32_t>> glyphs; // (sum, index), sorted by sum.
+            };
+
+        private:
+            static uint64_t hash(const unsigned char* pixels, unsigned short width, unsigned short height);
+
+        private:
+            const std::vector<FontSample::Glyph>& mGlyphs;
+            std::vector<SizeBucket> mBuckets;
+
+            // Hash -> indices of the first glyph of every distinct pixel content with that hash.
+            std::unordered_map<uint64_t, std::vector<uint32_t>> mExactGlyphs;
+    };
+}
+
+
+#endif // GRAPHICS_LAYER_GLYPH_INDEX_HPP
@@ -29,7 +29,8 @@
 
 ///////////////////////////////////
 // Internal ShankBot headers
-#include "FrameParser.hpp"
+#include "FramePipeline.hpp"
+#include "FrameRecording.hpp"
 namespace GraphicsLayer
 {
     class TibiaClient;
@@ -37,27 +38,63 @@ namespace GraphicsLayer
 }
 ///////////////////////////////////
 
-
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+///////////////////////////////////
 
 namespace GraphicsLayer
 {
+    // Reads the frames committed by the injected monitor. Segments are
+    // acquired and parsed on a FramePipeline in the background, so that the
+    // client never waits for the parser and getNewFrame() rarely has to.
+    // Slots are parsed in place and held until then, so the client only
+    // waits when every slot of the ring is queued for parsing.
     class GraphicsMonitorReader
     {
         public:
-            explicit GraphicsMonitorReader(const TibiaClient& client, const TibiaContext& context, const SharedMemoryProtocol::SharedMemorySegment* shm);
+            explicit GraphicsMonitorReader(const TibiaClient& client, const TibiaContext& context, SharedMemoryProtocol::SharedMemorySegment* shm);
+            ~GraphicsMonitorReader();
 
+            // Blocks until a frame acquired after this call is parsed, and
+            // returns it. Rethrows what stopped the pipeline, if it stopped.
             Frame getNewFrame();
             const TibiaClient& getClient() const;
 
+            // Writes every slot read from here on to a frame recording.
+            void startRecording(const std::string& filePath);
+
+            std::vector<FramePipeline::StageStats> getStageStats() const;
+
         private:
-            void waitForFrame() const;
-            void postFrameRequest() const;
+            bool acquireSegment(const char*& data, size_t& size);
+            void releaseSegment();
+            const SharedMemoryProtocol::SharedFrameSlot* waitForSlot();
+            const SharedMemoryProtocol::SharedFrameSlot* holdNextSlot();
+            void pollClient() const;
+            void postSlotRelease() const;
 
         private:
             const TibiaClient& mClient;
-            const SharedMemoryProtocol::SharedMemorySegment* const mShm;
-            FrameParser mFrameParser;
-            Frame mLatestFrame;
+            SharedMemoryProtocol::SharedMemorySegment* const mShm;
+
+            // Slots acquired but not yet parsed. Acquisition reads the slot
+            // after them while parsing releases the first one.
+            std::mutex mHeldSlotsMutex;
+            unsigned int mNumHeldSlots = 0;
+
+            std::mutex mRecordingMutex;
+            std::unique_ptr<FrameRecording::Writer> mRecording;
+
+            mutable std::mutex mLatestFrameMutex;
+            std::condition_variable mLatestFrameChanged;
+            FramePipeline::SharedFrame mLatestFrame;
+
+            // Last, so that its threads stop before the members they use go.
+            FramePipeline mPipeline;
     };
 }
 
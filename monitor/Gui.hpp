@@ -41,6 +41,7 @@ namespace GraphicsLayer
 // STD C++
 #include <map>
 #include <set>
+#include <functional>
 ///////////////////////////////////
 
 namespace GraphicsLayer
@@ -42,6 +42,8 @@ namespace GraphicsLayer
 // STD C++
 #include <map>
 #include <set>
+#include <array>
+#include <functional>
 ///////////////////////////////////
 
 namespace GraphicsLayer
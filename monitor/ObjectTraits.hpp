@@ -0,0 +1,103 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef GRAPHICS_LAYER_OBJECT_TRAITS_HPP
+#define GRAPHICS_LAYER_OBJECT_TRAITS_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "tibiaassets/Object.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <cstdint>
+///////////////////////////////////
+
+namespace GraphicsLayer
+{
+    // The handful of object fields that the frame parsers read for every
+    // sprite draw, packed into eight bytes per object and indexed like
+    // TibiaContext::getObjects(). Reading them from Object touches a large
+    // struct per object, which misses the cache on every draw.
+    class ObjectTraits
+    {
+        public:
+            class Traits
+            {
+                public:
+                    explicit Traits(const sb::tibiaassets::Object& o);
+
+                    sb::tibiaassets::Object::Type getType() const {return mType;}
+                    sb::tibiaassets::Object::BodyRestriction getBodyRestriction() const {return mBodyRestriction;}
+                    unsigned short getWalkSpeed() const {return mWalkSpeed;}
+                    unsigned char getTopOrder() const {return mTopOrder;}
+                    unsigned char getOffsetX() const {return mOffsetX;}
+                    unsigned char getOffsetY() const {return mOffsetY;}
+
+                    bool isGround() const {return mFlags & GROUND;}
+                    bool isBlocking() const {return mFlags & BLOCKING;}
+                    bool isMovable() const {return mFlags & MOVABLE;}
+                    bool isContainer() const {return mFlags & CONTAINER;}
+                    bool isPickupable() const {return mFlags & PICKUPABLE;}
+                    bool hasMounts() const {return mFlags & HAS_MOUNTS;}
+
+                private:
+                    enum Flag : uint8_t
+                    {
+                        GROUND = 1 << 0,
+                        BLOCKING = 1 << 1,
+                        MOVABLE = 1 << 2,
+                        CONTAINER = 1 << 3,
+                        PICKUPABLE = 1 << 4,
+                        HAS_MOUNTS = 1 << 5,
+                    };
+
+                private:
+                    uint8_t mFlags = 0;
+                    sb::tibiaassets::Object::Type mType;
+                    unsigned short mWalkSpeed;
+                    unsigned char mTopOrder;
+                    unsigned char mOffsetX;
+                    unsigned char mOffsetY;
+                    sb::tibiaassets::Object::BodyRestriction mBodyRestriction;
+            };
+            static_assert(sizeof(Traits) == 8, "Traits should stay eight bytes.");
+
+        public:
+            explicit ObjectTraits(const std::vector<sb::tibiaassets::Object>& objects);
+
+            const Traits& operator[](size_t objectId) const {return mTraits[objectId];}
+            size_t size() const;
+
+        private:
+            std::vector<Traits> mTraits;
+    };
+}
+
+
+#endif // GRAPHICS_LAYER_OBJECT_TRAITS_HPP
@@ -83,8 +83,10 @@ namespace GraphicsLayer
 
         public:
             void addOutfit(const sb::tibiaassets::Object& outfit);
-            std::vector<std::shared_ptr<Sprite>> processSprite(unsigned int id, size_t width, size_t height, const unsigned char* pixels);
+            std::vector<std::shared_ptr<Sprite>> processSprite(unsigned int id, size_t width, size_t height, const unsigned char* pixels, size_t stride);
             bool isEmpty() const;
+            // Ids of the sprites processSprite still has to be called with.
+            std::vector<unsigned int> getNeededSprites() const;
 
         private:
             std::vector<SnapshotMerger::OutfitSnapshot> getOutfitSnapshots(const sb::tibiaassets::Object& outfit) const;
@@ -51,6 +51,7 @@ namespace tibiaassets
 // STD C++
 #include <list>
 #include <functional>
+#include <array>
 ///////////////////////////////////
 
 namespace GraphicsLayer
@@ -40,6 +40,7 @@
 
 namespace GraphicsLayer
 {
+    class TibiaContext;
     class SceneDiff
     {
         public:
@@ -49,11 +50,12 @@ namespace GraphicsLayer
             };
 
         public:
-            SceneDiff();
+            explicit SceneDiff(const TibiaContext& context);
             void parse(const Frame& frame, const SceneParser::Data& scene);
             const Data& getData() const;
 
         private:
+            const TibiaContext& mContext;
             Data mData;
             SceneParser::Data mPrevScene;
             Frame mPrevFrame;
@@ -52,6 +52,7 @@ namespace tibiaassets
 // STD C++
 #include <list>
 #include <functional>
+#include <array>
 ///////////////////////////////////
 
 namespace GraphicsLayer
@@ -63,13 +64,16 @@ namespace GraphicsLayer
             struct Object
             {
                 size_t drawOrder;
-                std::vector<const sb::tibiaassets::Object*> disputes;
+                // Ids of the objects the draw may be, indexing both
+                // TibiaContext::getObjects and TibiaContext::getObjectTraits.
+                std::vector<uint32_t> disputes;
             };
 
             struct NonGridObject : public Object
             {
                 IRect localBounds;
                 IRect screenBounds;
+                std::vector<const sb::tibiaassets::Object*> objects;
             };
 
             struct Tile
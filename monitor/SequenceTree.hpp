@@ -27,42 +27,116 @@
 #ifndef GRAPHICS_LAYER_SEQUENCE_TREE_HPP
 #define GRAPHICS_LAYER_SEQUENCE_TREE_HPP
 
+///////////////////////////////////
+// Internal ShankBot headers
+namespace sb
+{
+namespace utility
+{
+    class MappedFile;
+    class ThreadPool;
+}
+}
+///////////////////////////////////
+
 ///////////////////////////////////
 // STD C++
 #include <vector>
 #include <memory>
 #include <unordered_map>
 #include <list>
+#include <functional>
+#include <cstdint>
+#include <string>
+#include <fstream>
 ///////////////////////////////////
 
 namespace GraphicsLayer
 {
+    // The tree is stored as one flat, relocatable image which is also the
+    // file format, so a tree file can be memory mapped and searched in place.
+    //
+    //  Header
+    //  uint32_t levels[numNodes]
+    //  uint32_t childOffsets[numNodes + 1]     Children of node n are in [childOffsets[n], childOffsets[n + 1]).
+    //  size_t   childKeys[numEdges]            Sorted per node.
+    //  uint32_t childNodes[numEdges]
+    //  uint32_t elementOffsets[numNodes + 1]   Elements of node n are in [elementOffsets[n], elementOffsets[n + 1]).
+    //  uint32_t elementIds[numElements]       Sorted per node.
+    //  int32_t  elementNumValuesIgnored[numElements]
+    //
+    // Every array starts at an 8 byte aligned offset. Node 0 is the root.
     class SequenceTree
     {
         public:
-            struct Element
+            struct Header
             {
-                explicit Element(const std::vector<size_t>* sequence, unsigned int id) : sequence(sequence), id(id){};
+                char magic[8];
+                uint32_t version;
+                uint32_t keySize;
+                uint32_t numNodes;
+                uint32_t numEdges;
+                uint32_t numElements;
+                uint32_t reserved;
+            };
 
-                const std::vector<size_t>* sequence;
-                const unsigned int id;
-                int numValuesIgnored;
+            static const char MAGIC[8];
+            static const uint32_t VERSION = 1;
+
+            struct BatchQuery
+            {
+                const size_t* primary;
+                size_t primarySize;
+                const size_t* secondary;
+                size_t secondarySize;
             };
 
-            struct Node;
-            typedef std::unique_ptr<Node> NodePtr;
-            struct Node
+            // Flat output of findBatch. Kept by the caller between batches
+            // so that its storage is reused.
+            struct BatchResults
             {
-                explicit Node(unsigned int level) : level(level){};
+                // The ids of query i are ids[offsets[i], offsets[i + 1]).
+                std::vector<uint32_t> offsets;
+                std::vector<unsigned int> ids;
+                std::vector<char> isPrimaryFound;
 
-                std::unordered_map<size_t, NodePtr> children;
-                std::list<Element> elements;
-                unsigned int level;
+                // Per range scratch space.
+                std::vector<std::vector<unsigned int>> rangeIds;
+            };
+
+            // Collects sequences for a tree without keeping them in memory.
+            // Added sequences are appended to a spill file, which is mapped
+            // once the tree is built, and removed when the builder goes away.
+            class Builder
+            {
+                public:
+                    explicit Builder(std::string spillFilePath);
+                    ~Builder();
+                    Builder(const Builder&) = delete;
+                    Builder& operator=(const Builder&) = delete;
+
+                    // Returns the index of the sequence. Empty sequences are
+                    // counted, but not inserted into the tree.
+                    size_t add(const std::vector<size_t>& sequence, unsigned int id);
+                    void getSequence(size_t index, std::vector<size_t>& sequence);
+                    size_t getNumSequences() const;
+
+                    // See the SequenceTree constructor for numThreads.
+                    std::unique_ptr<SequenceTree> build(size_t numThreads = 0);
+
+                private:
+                    std::string mSpillFilePath;
+                    std::fstream mSpillFile;
+                    std::vector<uint64_t> mOffsets; // In size_t values.
+                    std::vector<unsigned int> mIds;
             };
 
         public:
-            explicit SequenceTree(const std::vector<std::vector<size_t>>& sequences, const std::vector<unsigned int>& ids);
+            // Subtrees below the first PARTITION_DEPTH branches are built on
+            // numThreads threads. Zero means one per hardware thread.
+            explicit SequenceTree(const std::vector<std::vector<size_t>>& sequences, const std::vector<unsigned int>& ids, size_t numThreads = 0);
             explicit SequenceTree(std::string filePath);
+            ~SequenceTree();
 
 
             bool find(const std::vector<size_t>& sequence, std::list<unsigned int>& ids) const;
@@ -70,25 +144,119 @@ namespace GraphicsLayer
             void writeToBinaryFile(std::string filePath) const;
             std::list<size_t> trace(unsigned int id) const;
 
+            // For every query, finds the ids matching the primary sequence in
+            // primaryTree that also match the secondary sequence in
+            // secondaryTree. The ids of each query are sorted and unique.
+            // Queries are split across pool if given.
+            static void findBatch
+            (
+                const SequenceTree& primaryTree,
+                const SequenceTree& secondaryTree,
+                const BatchQuery* queries,
+                size_t numQueries,
+                BatchResults& results,
+                sb::utility::ThreadPool* pool = nullptr
+            );
 
+            static bool isLegacyFile(const std::string& filePath);
+            static void convertLegacyFile(const std::string& srcPath, const std::string& destPath);
 
         private:
-            size_t getSize(const NodePtr& node) const;
-            void insert(NodePtr& node, Element element);
-            void writeToBinaryFile(const NodePtr& node, std::ostream& file) const;
-            void trace(const NodePtr& node, unsigned int id, bool& isFound, std::list<size_t>& breadcrumbs) const;
+            struct SequenceView
+            {
+                const size_t* data;
+                size_t size;
+            };
+
+            // Pointer tree only used while building the flat image.
+            struct Element
+            {
+                explicit Element(unsigned int id, int numValuesIgnored) : id(id), numValuesIgnored(numValuesIgnored){};
+
+                unsigned int id;
+                int numValuesIgnored;
+            };
+
+            struct Node;
+            typedef std::unique_ptr<Node> NodePtr;
+            struct Node
+            {
+                explicit Node(unsigned int level) : level(level){};
 
-            void forEachNode(NodePtr& node, std::function<void(NodePtr& node)> function);
+                std::unordered_map<size_t, NodePtr> children;
+                std::vector<Element> elements;
+                unsigned int level;
+            };
+
+            struct Layout
+            {
+                size_t levels;
+                size_t childOffsets;
+                size_t childKeys;
+                size_t childNodes;
+                size_t elementOffsets;
+                size_t elementIds;
+                size_t elementNumValuesIgnored;
+                size_t size;
+            };
+
+            struct PendingNode
+            {
+                NodePtr* node;
+                uint32_t* begin;
+                uint32_t* end;
+                size_t level;
+            };
+
+            static const size_t PARTITION_DEPTH = 2;
+
+        private:
+            SequenceTree() = default;
 
-            void removeEmptyNodes();
+            void build(const std::vector<SequenceView>& sequences, const std::vector<unsigned int>& ids, size_t numThreads);
+            static NodePtr buildNode
+            (
+                const std::vector<SequenceView>& sequences,
+                const std::vector<unsigned int>& ids,
+                uint32_t* begin,
+                uint32_t* end,
+                size_t level,
+                size_t depth,
+                std::vector<PendingNode>* pendingNodes
+            );
+            static void loadLegacyFile(NodePtr& node, std::istream& file);
+            static Layout computeLayout(const Header& header);
 
+            uint32_t findNode(const size_t* sequence, size_t size) const;
+            static void findRange
+            (
+                const SequenceTree& primaryTree,
+                const SequenceTree& secondaryTree,
+                const BatchQuery* queries,
+                size_t begin,
+                size_t end,
+                BatchResults& results,
+                std::vector<unsigned int>& ids
+            );
 
-            void loadFromBinaryFile(std::string filePath);
-            void loadFromBinaryFile(NodePtr& node, std::istream& file);
+            void flatten(const NodePtr& root);
+            void setImage(const char* data, size_t size);
+            void validateImage() const;
 
         private:
-            NodePtr mRoot;
+            std::unique_ptr<sb::utility::MappedFile> mFile;
+            std::vector<uint64_t> mBuffer; // Owns the image unless it is mapped. uint64_t for alignment.
 
+            const char* mData = nullptr;
+            size_t mDataSize = 0;
+            const Header* mHeader = nullptr;
+            const uint32_t* mLevels = nullptr;
+            const uint32_t* mChildOffsets = nullptr;
+            const size_t* mChildKeys = nullptr;
+            const uint32_t* mChildNodes = nullptr;
+            const uint32_t* mElementOffsets = nullptr;
+            const uint32_t* mElementIds = nullptr;
+            const int32_t* mElementNumValuesIgnored = nullptr;
     };
 }
 
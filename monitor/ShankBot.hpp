@@ -32,6 +32,7 @@
 // Internal ShankBot headers
 #include "TibiaClient.hpp"
 #include "TibiaContext.hpp"
+#include "StartupProfile.hpp"
 ///////////////////////////////////
 
 ///////////////////////////////////
@@ -45,14 +46,18 @@ namespace GraphicsLayer
     class ShankBot
     {
         public:
-            explicit ShankBot(std::string clientDir, std::string versionControlDir);
+            explicit ShankBot(std::string clientDir, std::string versionControlDir, std::string recordingPath = "");
 
             void run();
 
         private:
             void initializeData(std::string clientDir, std::string versionControlDir);
+            void writeStartupReport() const;
 
         private:
+            // Declared first, since the context times its loading in it.
+            StartupProfile mStartupProfile;
+            std::string mStartupReportPath;
             std::unique_ptr<TibiaClient> mTibiaClient;
             std::unique_ptr<TibiaContext> mTibiaContext;
     };
@@ -31,6 +31,7 @@
 ///////////////////////////////////
 // STD C++
 #include <vector>
+#include <cstddef>
 ///////////////////////////////////
 
 namespace GraphicsLayer
@@ -38,6 +39,7 @@ namespace GraphicsLayer
     struct Sprite
     {
         Sprite(unsigned int id, unsigned short width, unsigned short height, const unsigned char* pixels);
+        Sprite(unsigned int id, unsigned short width, unsigned short height, const unsigned char* pixels, size_t stride);
         Sprite(unsigned int id, unsigned short width, unsigned short height, const std::vector<unsigned char>& pixels);
 
         const unsigned int id;
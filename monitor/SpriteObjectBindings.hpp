@@ -31,37 +31,72 @@
 ///////////////////////////////////
 // Internal ShankBot headers
 #include "tibiaassets/AppearancesReader.hpp"
+#include "utility/Span.hpp"
+#include "utility/MappedFile.hpp"
 ///////////////////////////////////
 
 ///////////////////////////////////
 // STD C++
 #include <memory>
-#include <list>
 #include <vector>
-#include <map>
-#include <set>
+#include <string>
+#include <cstdint>
 ///////////////////////////////////
 
 namespace GraphicsLayer
 {
+    // Sprite id to object id lookup in compressed sparse row form. The
+    // object ids bound to sprite s are objectIds[offsets[s]] up to
+    // objectIds[offsets[s + 1]], sorted and unique. The binary file holds
+    // the two arrays as they are in memory, so it is mapped rather than
+    // parsed.
     class SpriteObjectBindings
     {
+        public:
+            static const char MAGIC[8];
+            static const uint32_t VERSION = 1;
+
         public:
             explicit SpriteObjectBindings(const std::vector<sb::tibiaassets::Object>& objects);
             explicit SpriteObjectBindings(std::string binPath);
 
-            std::list<size_t> getObjects(size_t spriteId) const;
+            // Empty if no object uses the sprite. Valid for the lifetime of
+            // the bindings.
+            sb::utility::Span<uint32_t> getObjects(size_t spriteId) const;
 
             void writeToBinaryFile(std::string path) const;
 
+            // Files written before the bindings were stored as arrays.
+            static bool isLegacyFile(const std::string& path);
+            static void convertLegacyFile(const std::string& srcPath, const std::string& destPath);
+
+        private:
+            struct Header
+            {
+                char magic[8];
+                uint32_t version;
+                uint32_t numSprites;
+                uint32_t numObjectIds;
+                uint32_t reserved;
+            };
+
         private:
             void readFromBinaryFile(std::string binPath);
+            void readLegacyFile(std::string binPath);
 
             void parseObjects(const std::vector<sb::tibiaassets::Object>& objects);
-            void createBindings(const sb::tibiaassets::Object& o, size_t globalId);
+            void createBindings(std::vector<std::pair<uint32_t, uint32_t>>& bindings, const sb::tibiaassets::Object& o, size_t globalId) const;
+            void createRows(std::vector<std::pair<uint32_t, uint32_t>>& bindings);
 
         private:
-            std::map<size_t, std::set<size_t>> mBindings;
+            std::vector<uint32_t> mOffsets;
+            std::vector<uint32_t> mObjectIds;
+            std::unique_ptr<sb::utility::MappedFile> mFile;
+
+            // Point either into the vectors or into the mapped file.
+            const uint32_t* mOffsetsData = nullptr;
+            const uint32_t* mObjectIdsData = nullptr;
+            size_t mNumSprites = 0;
     };
 }
 
@@ -0,0 +1,129 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef GRAPHICS_LAYER_SPRITE_SEQUENCE_CACHE_HPP
+#define GRAPHICS_LAYER_SPRITE_SEQUENCE_CACHE_HPP
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <string>
+#include <set>
+#include <fstream>
+#include <functional>
+#include <cstdint>
+///////////////////////////////////
+
+namespace GraphicsLayer
+{
+    // Tree sprite sequences stored on disk under the content hash of the
+    // input they were made from, e.g. one sprite sheet. Sequence trees are
+    // assembled from the cached sequences, so that after a client update
+    // only the inputs that changed have to be decoded again.
+    //
+    //  Header
+    //  For every entry:
+    //      uint32_t id
+    //      uint32_t colorSize
+    //      uint32_t transparencySize
+    //      uint32_t reserved
+    //      size_t   color[colorSize]
+    //      size_t   transparency[transparencySize]
+    class SpriteSequenceCache
+    {
+        public:
+            static const char MAGIC[8];
+            static const uint32_t VERSION = 1;
+
+            struct Entry
+            {
+                unsigned int id;
+                const size_t* color;
+                size_t colorSize;
+                const size_t* transparency;
+                size_t transparencySize;
+            };
+
+            // Writes the entries of one key. The entries only become visible
+            // once finish is called, so an interrupted write is redone.
+            class Writer
+            {
+                public:
+                    Writer(const SpriteSequenceCache& cache, uint64_t key);
+                    ~Writer();
+                    Writer(const Writer&) = delete;
+                    Writer& operator=(const Writer&) = delete;
+
+                    void add(unsigned int id, const std::vector<size_t>& color, const std::vector<size_t>& transparency);
+                    void finish();
+
+                private:
+                    std::string mPath;
+                    std::string mTempPath;
+                    std::ofstream mFile;
+                    uint32_t mNumEntries = 0;
+                    bool mIsFinished = false;
+            };
+
+        public:
+            explicit SpriteSequenceCache(std::string directory);
+
+            bool contains(uint64_t key) const;
+            // Calls func for the entries of key, in the order they were added.
+            void forEach(uint64_t key, const std::function<void(const Entry& entry)>& func) const;
+            // Removes the entries of every key not in keys.
+            void retainOnly(const std::set<uint64_t>& keys) const;
+
+        private:
+            struct Header
+            {
+                char magic[8];
+                uint32_t version;
+                uint32_t sizeOfValue;
+                uint32_t numEntries;
+                uint32_t reserved;
+            };
+
+            struct EntryHeader
+            {
+                uint32_t id;
+                uint32_t colorSize;
+                uint32_t transparencySize;
+                uint32_t reserved;
+            };
+
+        private:
+            std::string getPath(uint64_t key) const;
+            static bool parseKey(const std::string& fileName, uint64_t& key);
+
+        private:
+            static const std::string EXTENSION;
+            std::string mDirectory;
+    };
+}
+
+
+#endif // GRAPHICS_LAYER_SPRITE_SEQUENCE_CACHE_HPP
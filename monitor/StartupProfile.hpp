@@ -0,0 +1,97 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef GRAPHICS_LAYER_STARTUP_PROFILE_HPP
+#define GRAPHICS_LAYER_STARTUP_PROFILE_HPP
+
+///////////////////////////////////
+// STD C++
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <thread>
+///////////////////////////////////
+
+namespace GraphicsLayer
+{
+    // Times the steps of starting up, on whichever thread they run, so that
+    // steps loaded in the background can be seen next to the ones they
+    // overlap.
+    class StartupProfile
+    {
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+        public:
+            struct Step
+            {
+                std::string name;
+                std::string thread;
+                double startMs; // Since the profile was created.
+                double durationMs;
+            };
+
+            // Times the scope it lives in as one step.
+            class ScopedStep
+            {
+                public:
+                    ScopedStep(StartupProfile& profile, std::string name);
+                    ~ScopedStep();
+                    ScopedStep(const ScopedStep&) = delete;
+                    ScopedStep& operator=(const ScopedStep&) = delete;
+
+                private:
+                    StartupProfile& mProfile;
+                    const std::string mName;
+                    const Clock::time_point mStart;
+            };
+
+        public:
+            StartupProfile();
+
+            template<typename Func>
+            auto measure(const std::string& name, Func func) -> decltype(func());
+            // Records a point in time, e.g. the first parsed frame.
+            void mark(const std::string& name);
+
+            std::vector<Step> getSteps() const;
+            void writeReport(const std::string& path) const;
+
+        private:
+            void add(const std::string& name, Clock::time_point start, Clock::time_point end);
+
+        private:
+            const Clock::time_point mStart;
+            const std::thread::id mMainThread;
+            mutable std::mutex mMutex;
+            std::vector<Step> mSteps;
+    };
+}
+
+#include "monitor/StartupProfile.inl"
+
+#endif // GRAPHICS_LAYER_STARTUP_PROFILE_HPP
@@ -39,6 +39,8 @@
 #include "messaging/Message.hpp"
 #include "MiniMap.hpp"
 #include "messaging/ConnectionManager.hpp"
+#include "utility/WorkStealingPool.hpp"
+#include "utility/TaskGraph.hpp"
 
 namespace GraphicsLayer
 {
@@ -47,6 +49,13 @@ namespace SharedMemoryProtocol
     struct SharedMemorySegment;
 }
 }
+namespace sb
+{
+namespace utility
+{
+    class SharedMemory;
+}
+}
 ///////////////////////////////////
 
 ///////////////////////////////////
@@ -66,7 +75,7 @@ namespace GraphicsLayer
     class TibiaClient
     {
         public:
-            explicit TibiaClient(std::string clientDirectory, const TibiaContext& context);
+            explicit TibiaClient(std::string clientDirectory, const TibiaContext& context, std::string recordingPath = "");
             ~TibiaClient();
 
             void update();
@@ -82,11 +91,11 @@ namespace GraphicsLayer
 
             void initializeInput();
             void prepareSharedMemory(std::string& sharedMemoryName);
-            void mapSharedMemory();
             char** prepareEnvironment() const;
             void deleteEnvironment(char** environment) const;
             void launchClient(char** environment, std::string clientDirectory, std::string sharedMemoryName);
             void waitForWindow() const;
+            void interpretFrame(const Frame& frame);
             std::shared_ptr<sb::messaging::Message> handleLoginRequest(const char* data, size_t size);
             std::shared_ptr<sb::messaging::Message> handleGoRequest(const char* data, size_t size);
             std::shared_ptr<sb::messaging::Message> handleFrameRequest(const char* data, size_t size);
@@ -95,7 +104,7 @@ namespace GraphicsLayer
 
         private:
             const TibiaContext& mContext;
-            HANDLE mShmHandle = NULL;
+            std::unique_ptr<sb::utility::SharedMemory> mSharedMemory;
             SharedMemoryProtocol::SharedMemorySegment* mShm = nullptr;
             FrameParser mFrameParser;
             Display* mXDisplay;
@@ -104,6 +113,9 @@ namespace GraphicsLayer
             Gui mGui;
             HANDLE mClientProcessHandle = NULL;
             OutfitResolver mOutfitResolver;
+            sb::utility::WorkStealingPool mInterpreterPool;
+            sb::utility::TaskGraph mInterpreterGraph;
+            const Frame* mInterpretedFrame = nullptr;
             std::unique_ptr<GraphicsMonitorReader> mGraphicsMonitorReader;
             std::unique_ptr<MiniMap> mMiniMap;
             sb::messaging::ConnectionManager mConnectionManager;
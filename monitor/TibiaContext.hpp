@@ -34,11 +34,18 @@
 #include "SpriteInfo.hpp"
 #include "SpriteObjectBindings.hpp"
 #include "FontSample.hpp"
+#include "GlyphIndex.hpp"
+#include "ObjectTraits.hpp"
+#include "StartupProfile.hpp"
 ///////////////////////////////////
 
 ///////////////////////////////////
 // STD C++
 #include <memory>
+#include <functional>
+#include <future>
+#include <atomic>
+#include <thread>
 ///////////////////////////////////
 
 namespace GraphicsLayer
@@ -49,6 +56,43 @@ namespace GraphicsLayer
             template<typename T>
             using UPtr = std::unique_ptr<T>;
 
+            template<typename T>
+            using Loader = std::function<UPtr<T>()>;
+
+            // A member that is filled in once, possibly from another thread.
+            // Getting it blocks until then, and rethrows if loading it failed.
+            // Getting a member that was set to nullptr throws.
+            template<typename T>
+            class Handle
+            {
+                public:
+                    Handle();
+
+                    void set(UPtr<T> value);
+                    void setError(std::exception_ptr error);
+                    bool isReady() const;
+                    bool isSettled() const;
+                    const T& get() const;
+
+                private:
+                    UPtr<T> mValue;
+                    std::atomic<bool> mIsReady;
+                    std::promise<void> mPromise;
+                    std::shared_future<void> mReady;
+            };
+
+        public:
+            struct Loaders
+            {
+                Loader<std::vector<sb::tibiaassets::Object>> objects;
+                Loader<SpriteObjectBindings> spriteObjectBindings;
+                Loader<SequenceTree> spriteColorTree;
+                Loader<SequenceTree> spriteTransparencyTree;
+                Loader<SpriteInfo> spriteInfo;
+                Loader<std::vector<std::string>> graphicsResourceNames;
+                Loader<std::vector<FontSample::Glyph>> glyphs;
+            };
+
         public:
             explicit TibiaContext
             (
@@ -60,23 +104,44 @@ namespace GraphicsLayer
                 UPtr<std::vector<std::string>>& graphicsResourceNames,
                 UPtr<std::vector<FontSample::Glyph>>& glyphs
             );
+            // Loads the members on a background thread, in the order frame
+            // parsing needs them. Each getter only waits for its own member.
+            // The steps are timed in profile, if given.
+            explicit TibiaContext(Loaders loaders, StartupProfile* profile = nullptr);
+            ~TibiaContext();
 
             const std::vector<sb::tibiaassets::Object>& getObjects() const;
+            const ObjectTraits& getObjectTraits() const;
             const SpriteObjectBindings& getSpriteObjectBindings() const;
             const SequenceTree& getSpriteColorTree() const;
             const SequenceTree& getSpriteTransparencyTree() const;
             const SpriteInfo& getSpriteInfo() const;
             const std::vector<std::string>& getGraphicsResourceNames() const;
             const std::vector<FontSample::Glyph>& getGlyphs() const;
+            const GlyphIndex& getGlyphIndex() const;
+
+            // Whether every member has been loaded. Does not block.
+            bool isLoaded() const;
+            // Whether loading is over, successfully or not. Does not block.
+            bool isLoadFinished() const;
+            // Rethrows the first error, if loading failed.
+            void waitUntilLoaded() const;
+
+        private:
+            void load(Loaders& loaders, StartupProfile* profile);
 
         private:
-            UPtr<std::vector<sb::tibiaassets::Object>> mObjects;
-            UPtr<SpriteObjectBindings> mSpriteObjectBindings;
-            UPtr<SequenceTree> mSpriteColorTree;
-            UPtr<SequenceTree> mSpriteTransparencyTree;
-            UPtr<SpriteInfo> mSpriteInfo;
-            UPtr<std::vector<std::string>> mGraphicsResourceNames;
-            UPtr<std::vector<FontSample::Glyph>> mGlyphs;
+            Handle<std::vector<sb::tibiaassets::Object>> mObjects;
+            Handle<ObjectTraits> mObjectTraits;
+            Handle<SpriteObjectBindings> mSpriteObjectBindings;
+            Handle<SequenceTree> mSpriteColorTree;
+            Handle<SequenceTree> mSpriteTransparencyTree;
+            Handle<SpriteInfo> mSpriteInfo;
+            Handle<std::vector<std::string>> mGraphicsResourceNames;
+            Handle<std::vector<FontSample::Glyph>> mGlyphs;
+            Handle<GlyphIndex> mGlyphIndex;
+            Handle<bool> mIsLoaded;
+            std::thread mLoader;
     };
 }
 
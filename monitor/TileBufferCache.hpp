@@ -29,20 +29,24 @@
 
 ///////////////////////////////////
 // STD C++
-#include <map>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
 #include <list>
 #include <functional>
 ///////////////////////////////////
 
 namespace GraphicsLayer
 {
+    // Elements are bucketed into square cells of CELL_SIZE pixels, so that
+    // exact lookups are a cell access and area queries only touch the cells
+    // overlapping the area. Traversals are still in row major order.
     template<typename ElementType>
     class TileBufferCache
     {
         public:
             typedef unsigned int TextureId;
-            typedef std::map<size_t, ElementType> ElementIndexMap;
-            typedef std::map<TextureId, ElementIndexMap> ElementMap;
+            static const size_t CELL_SIZE = 32;
 
         public:
             struct AreaElement
@@ -66,14 +70,30 @@ namespace GraphicsLayer
             void clear(unsigned int textureId);
 
         private:
+            struct Entry
+            {
+                size_t index;
+                ElementType element;
+            };
 
+            // Entries of a cell are sorted by index.
+            typedef std::vector<Entry> Cell;
+            typedef std::vector<Cell> CellRow;
+            typedef std::vector<CellRow> Grid;
+            typedef std::unordered_map<TextureId, Grid> ElementMap;
+
+        private:
             size_t coordsToIndex(size_t x, size_t y) const;
             void indexToCoords(size_t index, size_t& x, size_t& y) const;
 
-            typename ElementIndexMap::const_iterator get(const ElementIndexMap& indexMap, size_t x, size_t y) const;
-            typename ElementIndexMap::const_iterator getClosestTopLeft(const ElementIndexMap& indexMap, size_t x, size_t y) const;
+            const Grid* getGrid(unsigned int textureId) const;
+            const Cell* getCell(const Grid& grid, size_t cellX, size_t cellY) const;
+            Cell& getCell(Grid& grid, size_t cellX, size_t cellY);
 
-            void set(ElementIndexMap& indexMap, size_t x, size_t y, const ElementType& element);
+            // Visits the entries from fromIndex onwards, or backwards from it
+            // and including it, in index order. Stops once func returns false.
+            void traverse(const Grid& grid, size_t fromIndex, bool traverseForward, const std::function<bool(const Entry&)>& func) const;
+            void getRowEntries(const Grid& grid, size_t cellY, size_t minIndex, size_t maxIndex, std::vector<const Entry*>& entries) const;
 
         private:
             ElementMap mElements;
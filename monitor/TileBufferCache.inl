@@ -24,10 +24,20 @@
 ****************************************************************
 ****************************************************************/
 // {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// STD C++
+#include <algorithm>
+///////////////////////////////////
+
 namespace GraphicsLayer
 {
 ///////////////////////////////////
 
+template<typename ElementType>
+const size_t TileBufferCache<ElementType>::CELL_SIZE;
+
+///////////////////////////////////
+
 template<typename ElementType>
 TileBufferCache<ElementType>::TileBufferCache(size_t width)
 : M_WIDTH(width)
@@ -40,16 +50,25 @@ TileBufferCache<ElementType>::TileBufferCache(size_t width)
 template<typename ElementType>
 bool TileBufferCache<ElementType>::get(unsigned int textureId, size_t x, size_t y, ElementType& element) const
 {
-    auto indexMap = mElements.find(textureId);
-    if(indexMap == mElements.end())
+    const Grid* grid = getGrid(textureId);
+    if(grid == nullptr)
         return false;
 
-    auto s = get(indexMap->second, x, y);
-    if(s == indexMap->second.end())
+    const Cell* cell = getCell(*grid, x / CELL_SIZE, y / CELL_SIZE);
+    if(cell == nullptr)
         return false;
 
-    element = s->second;
-    return true;
+    const size_t INDEX = coordsToIndex(x, y);
+    for(const Entry& entry : *cell)
+    {
+        if(entry.index == INDEX)
+        {
+            element = entry.element;
+            return true;
+        }
+    }
+
+    return false;
 }
 
 ///////////////////////////////////
@@ -57,45 +76,55 @@ bool TileBufferCache<ElementType>::get(unsigned int textureId, size_t x, size_t
 template<typename ElementType>
 bool TileBufferCache<ElementType>::getClosestTopLeft(unsigned int textureId, size_t x, size_t y, AreaElement& element) const
 {
-    auto indexMap = mElements.find(textureId);
-    if(indexMap == mElements.end())
-        return false;
-
-    auto s = getClosestTopLeft(indexMap->second, x, y);
-    if(s == indexMap->second.end())
+    const Grid* grid = getGrid(textureId);
+    if(grid == nullptr || grid->empty())
         return false;
 
+    // Cells are visited moving away from (x, y), until even their closest
+    // corner is further away than the best element found. Ties go to the
+    // element furthest along in row major order.
+    const size_t INDEX = coordsToIndex(x, y);
     size_t minDiff = -1;
-    auto minElement = s;
-    s++;
-    while(s != indexMap->second.begin())
+    const Entry* closest = nullptr;
+    for(size_t cellY = std::min(y / CELL_SIZE, grid->size() - 1) + 1; cellY-- > 0;)
     {
-        s--;
+        const size_t DIFF_Y = y - std::min(y, cellY * CELL_SIZE + CELL_SIZE - 1);
+        if(closest && DIFF_Y > minDiff)
+            break;
 
-        size_t elementX;
-        size_t elementY;
-        indexToCoords(s->first, elementX, elementY);
+        const CellRow& row = (*grid)[cellY];
+        if(row.empty())
+            continue;
 
-        if(elementX <= x && elementY <= y)
+        for(size_t cellX = std::min(x / CELL_SIZE, row.size() - 1) + 1; cellX-- > 0;)
         {
-            size_t diff = x - elementX + y - elementY;
-            if(diff < minDiff)
+            const size_t DIFF_X = x - std::min(x, cellX * CELL_SIZE + CELL_SIZE - 1);
+            if(closest && DIFF_X + DIFF_Y > minDiff)
+                break;
+
+            for(const Entry& entry : row[cellX])
             {
-                minDiff = diff;
-                minElement = s;
+                size_t elementX;
+                size_t elementY;
+                indexToCoords(entry.index, elementX, elementY);
+                if(entry.index < INDEX && elementX <= x && elementY <= y)
+                {
+                    size_t diff = x - elementX + y - elementY;
+                    if(diff < minDiff || (diff == minDiff && entry.index > closest->index))
+                    {
+                        minDiff = diff;
+                        closest = &entry;
+                    }
+                }
             }
         }
     }
 
-    if(minDiff == -1)
+    if(closest == nullptr)
         return false;
 
-    size_t elementX;
-    size_t elementY;
-    indexToCoords(minElement->first, elementX, elementY);
-    element.x = elementX;
-    element.y = elementY;
-    element.element = minElement->second;
+    indexToCoords(closest->index, element.x, element.y);
+    element.element = closest->element;
     return true;
 }
 
@@ -105,40 +134,50 @@ bool TileBufferCache<ElementType>::getClosestTopLeft(unsigned int textureId, siz
 template<typename ElementType>
 bool TileBufferCache<ElementType>::getClosestBotRight(unsigned int textureId, size_t x, size_t y, AreaElement& element) const
 {
-    auto indexMap = mElements.find(textureId);
-    if(indexMap == mElements.end())
-        return false;
-
-    size_t index = coordsToIndex(x, y);
-    auto s = indexMap->second.lower_bound(index);
-    if(s == indexMap->second.end())
+    const Grid* grid = getGrid(textureId);
+    if(grid == nullptr)
         return false;
 
+    // Mirrors getClosestTopLeft. Ties go to the element first in row major
+    // order.
     size_t minDiff = -1;
-    auto minElement = s;
-    while(s != indexMap->second.end())
+    const Entry* closest = nullptr;
+    for(size_t cellY = y / CELL_SIZE; cellY < grid->size(); cellY++)
     {
-        size_t elementX;
-        size_t elementY;
-        indexToCoords(s->first, elementX, elementY);
-        if(elementX >= x && elementY >= y)
+        const size_t DIFF_Y = std::max(y, cellY * CELL_SIZE) - y;
+        if(closest && DIFF_Y > minDiff)
+            break;
+
+        const CellRow& row = (*grid)[cellY];
+        for(size_t cellX = x / CELL_SIZE; cellX < row.size(); cellX++)
         {
-            size_t diff = elementX - x + elementY - y;
-            if(diff < minDiff)
+            const size_t DIFF_X = std::max(x, cellX * CELL_SIZE) - x;
+            if(closest && DIFF_X + DIFF_Y > minDiff)
+                break;
+
+            for(const Entry& entry : row[cellX])
             {
-                minDiff = diff;
-                minElement = s;
+                size_t elementX;
+                size_t elementY;
+                indexToCoords(entry.index, elementX, elementY);
+                if(elementX >= x && elementY >= y)
+                {
+                    size_t diff = elementX - x + elementY - y;
+                    if(diff < minDiff || (diff == minDiff && entry.index < closest->index))
+                    {
+                        minDiff = diff;
+                        closest = &entry;
+                    }
+                }
             }
         }
-        s++;
     }
 
-    size_t elementX;
-    size_t elementY;
-    indexToCoords(minElement->first, elementX, elementY);
-    element.x = elementX;
-    element.y = elementY;
-    element.element = minElement->second;
+    if(closest == nullptr)
+        return false;
+
+    indexToCoords(closest->index, element.x, element.y);
+    element.element = closest->element;
     return true;
 }
 
@@ -150,36 +189,44 @@ std::list<typename TileBufferCache<ElementType>::AreaElement> TileBufferCache<El
 {
     std::list<AreaElement> elements;
 
-    auto indexMap = mElements.find(textureId);
-    if(indexMap == mElements.end())
+    const Grid* grid = getGrid(textureId);
+    if(grid == nullptr || width == 0)
         return elements;
 
-    const size_t MIN_INDEX = coordsToIndex(x, y);
-    const size_t MAX_INDEX = coordsToIndex(x + width - 1, y + width - 1);
-    const size_t MIN_X = x;
+    // The rows covered have always been derived from the width rather than
+    // the height, and the callers have been tuned against that.
     const size_t MAX_X = x + width - 1;
-    for(const auto& pair : indexMap->second)
+    const size_t MAX_Y = y + width - 1;
+    std::vector<const Entry*> entries;
+    for(size_t cellY = y / CELL_SIZE; cellY <= MAX_Y / CELL_SIZE && cellY < grid->size(); cellY++)
     {
-        const size_t& INDEX = pair.first;
-        if(INDEX >= MIN_INDEX)
+        const CellRow& row = (*grid)[cellY];
+        for(size_t cellX = x / CELL_SIZE; cellX <= MAX_X / CELL_SIZE && cellX < row.size(); cellX++)
         {
-            if(INDEX > MAX_INDEX)
-                return elements;
-
-            size_t elementX;
-            size_t elementY;
-            indexToCoords(INDEX, elementX, elementY);
-            if(elementX >= MIN_X && elementX <= MAX_X)
+            for(const Entry& entry : row[cellX])
             {
-                AreaElement areaElement;
-                areaElement.x = elementX;
-                areaElement.y = elementY;
-                areaElement.element = pair.second;
-                elements.push_back(std::move(areaElement));
+                size_t elementX;
+                size_t elementY;
+                indexToCoords(entry.index, elementX, elementY);
+                if(elementX >= x && elementX <= MAX_X && elementY >= y && elementY <= MAX_Y)
+                    entries.push_back(&entry);
             }
         }
     }
 
+    std::sort(entries.begin(), entries.end(), [](const Entry* lhs, const Entry* rhs)
+    {
+        return lhs->index < rhs->index;
+    });
+
+    for(const Entry* entry : entries)
+    {
+        AreaElement areaElement;
+        indexToCoords(entry->index, areaElement.x, areaElement.y);
+        areaElement.element = entry->element;
+        elements.push_back(std::move(areaElement));
+    }
+
     return elements;
 }
 
@@ -188,14 +235,17 @@ std::list<typename TileBufferCache<ElementType>::AreaElement> TileBufferCache<El
 template<typename ElementType>
 void TileBufferCache<ElementType>::set(unsigned int textureId, size_t x, size_t y, const ElementType& element)
 {
-    auto indexMap = mElements.find(textureId);
-    if(indexMap == mElements.end())
+    Cell& cell = getCell(mElements[textureId], x / CELL_SIZE, y / CELL_SIZE);
+    const size_t INDEX = coordsToIndex(x, y);
+    auto it = std::lower_bound(cell.begin(), cell.end(), INDEX, [](const Entry& entry, size_t index)
     {
-        auto insertion = mElements.insert(std::make_pair(textureId, ElementIndexMap()));
-        indexMap = insertion.first;
-    }
+        return entry.index < index;
+    });
 
-    set(indexMap->second, x, y, element);
+    if(it != cell.end() && it->index == INDEX)
+        it->element = element;
+    else
+        cell.insert(it, Entry{INDEX, element});
 }
 
 ///////////////////////////////////
@@ -203,11 +253,21 @@ void TileBufferCache<ElementType>::set(unsigned int textureId, size_t x, size_t
 template<typename ElementType>
 void TileBufferCache<ElementType>::remove(unsigned int textureId, size_t x, size_t y)
 {
-    auto indexMap = mElements.find(textureId);
-    if(indexMap == mElements.end())
+    auto grid = mElements.find(textureId);
+    if(grid == mElements.end())
         return;
 
-    indexMap->second.erase(coordsToIndex(x, y));
+    const size_t CELL_X = x / CELL_SIZE;
+    const size_t CELL_Y = y / CELL_SIZE;
+    if(CELL_Y >= grid->second.size() || CELL_X >= grid->second[CELL_Y].size())
+        return;
+
+    Cell& cell = grid->second[CELL_Y][CELL_X];
+    const size_t INDEX = coordsToIndex(x, y);
+    cell.erase(std::remove_if(cell.begin(), cell.end(), [INDEX](const Entry& entry)
+    {
+        return entry.index == INDEX;
+    }), cell.end());
 }
 
 ///////////////////////////////////
@@ -215,32 +275,26 @@ void TileBufferCache<ElementType>::remove(unsigned int textureId, size_t x, size
 template<typename ElementType>
 void TileBufferCache<ElementType>::removeByArea(unsigned int textureId, size_t x, size_t y, size_t width, size_t height)
 {
-    auto indexMap = mElements.find(textureId);
-    if(indexMap == mElements.end())
+    auto grid = mElements.find(textureId);
+    if(grid == mElements.end() || width == 0 || height == 0)
         return;
 
-    const size_t MIN_INDEX = coordsToIndex(x, y);
-    const size_t MAX_INDEX = coordsToIndex(x + width - 1, y + height - 1);
-    const size_t MIN_X = x;
     const size_t MAX_X = x + width - 1;
-    for(auto it = indexMap->second.begin(); it != indexMap->second.end();)
+    const size_t MAX_Y = y + height - 1;
+    for(size_t cellY = y / CELL_SIZE; cellY <= MAX_Y / CELL_SIZE && cellY < grid->second.size(); cellY++)
     {
-        const size_t& INDEX = it->first;
-        if(INDEX >= MIN_INDEX)
+        CellRow& row = grid->second[cellY];
+        for(size_t cellX = x / CELL_SIZE; cellX <= MAX_X / CELL_SIZE && cellX < row.size(); cellX++)
         {
-            if(INDEX > MAX_INDEX)
-                return;
-
-            size_t elementX;
-            size_t elementY;
-            indexToCoords(INDEX, elementX, elementY);
-            if(elementX >= MIN_X && elementX <= MAX_X)
-                it = indexMap->second.erase(it);
-            else
-                it++;
+            Cell& cell = row[cellX];
+            cell.erase(std::remove_if(cell.begin(), cell.end(), [this, x, y, MAX_X, MAX_Y](const Entry& entry)
+            {
+                size_t elementX;
+                size_t elementY;
+                indexToCoords(entry.index, elementX, elementY);
+                return elementX >= x && elementX <= MAX_X && elementY >= y && elementY <= MAX_Y;
+            }), cell.end());
         }
-        else
-            it++;
     }
 }
 
@@ -249,81 +303,80 @@ void TileBufferCache<ElementType>::removeByArea(unsigned int textureId, size_t x
 template<typename ElementType>
 void TileBufferCache<ElementType>::clear(unsigned int textureId)
 {
-    auto indexMap = mElements.find(textureId);
-    if(indexMap == mElements.end())
+    auto grid = mElements.find(textureId);
+    if(grid == mElements.end())
         return;
 
-    indexMap->second.clear();
+    grid->second.clear();
 }
 
 ///////////////////////////////////
 
 template<typename ElementType>
-typename TileBufferCache<ElementType>::ElementIndexMap::const_iterator TileBufferCache<ElementType>::get(const ElementIndexMap& indexMap, size_t x, size_t y) const
+void TileBufferCache<ElementType>::forEach(unsigned int textureId, const std::function<bool(const ElementType&, const size_t&, const size_t&)>& func, size_t x, size_t y, bool traverseForward) const
 {
-    return indexMap.find(coordsToIndex(x, y));
-}
-
-///////////////////////////////////
+    const Grid* grid = getGrid(textureId);
+    if(grid == nullptr)
+        return;
 
-template<typename ElementType>
-typename TileBufferCache<ElementType>::ElementIndexMap::const_iterator TileBufferCache<ElementType>::getClosestTopLeft(const ElementIndexMap& indexMap, size_t x, size_t y) const
-{
-    auto it = indexMap.lower_bound(coordsToIndex(x, y));
-    if(it != indexMap.begin())
+    // Start at the first element at or after (x, y), or at the last element
+    // if there is none.
+    bool isFound = false;
+    size_t startIndex = 0;
+    auto findStart = [&isFound, &startIndex](const Entry& entry)
     {
-        it--;
-        return it;
-    }
+        isFound = true;
+        startIndex = entry.index;
+        return false;
+    };
+    traverse(*grid, coordsToIndex(x, y), true, findStart);
+    if(!isFound)
+        traverse(*grid, -1, false, findStart);
+
+    if(!isFound)
+        return;
 
-    return indexMap.end();
+    traverse(*grid, startIndex, traverseForward, [this, &func](const Entry& entry)
+    {
+        size_t currX;
+        size_t currY;
+        indexToCoords(entry.index, currX, currY);
+        return func(entry.element, currX, currY);
+    });
 }
 
 ///////////////////////////////////
 
 template<typename ElementType>
-void TileBufferCache<ElementType>::forEach(unsigned int textureId, const std::function<bool(const ElementType&, const size_t&, const size_t&)>& func, size_t x, size_t y, bool traverseForward) const
+void TileBufferCache<ElementType>::traverse(const Grid& grid, size_t fromIndex, bool traverseForward, const std::function<bool(const Entry&)>& func) const
 {
-    auto indexMapIt = mElements.find(textureId);
-    if(indexMapIt == mElements.end())
-        return;
-
-    const ElementIndexMap& indexMap = indexMapIt->second;
-    if(indexMap.empty())
+    if(grid.empty())
         return;
 
-    auto it = indexMap.begin();
-    if(x != 0 || y != 0)
-    {
-        it = indexMap.lower_bound(coordsToIndex(x, y));
-        if(it == indexMap.end())
-            it--;
-    }
+    size_t fromX;
+    size_t fromY;
+    indexToCoords(fromIndex, fromX, fromY);
+    const size_t FROM_CELL_Y = fromY / CELL_SIZE;
 
+    std::vector<const Entry*> entries;
     if(traverseForward)
     {
-        while(it != indexMap.end())
+        for(size_t cellY = FROM_CELL_Y; cellY < grid.size(); cellY++)
         {
-            size_t currX;
-            size_t currY;
-            indexToCoords(it->first, currX, currY);
-            if(!func(it->second, currX, currY))
-                return;
-
-            it++;
+            getRowEntries(grid, cellY, fromIndex, -1, entries);
+            for(auto it = entries.begin(); it != entries.end(); it++)
+                if(!func(**it))
+                    return;
         }
     }
     else
-    {   it++;
-        while(it != indexMap.begin())
+    {
+        for(size_t cellY = std::min(FROM_CELL_Y, grid.size() - 1) + 1; cellY-- > 0;)
         {
-            it--;
-
-            size_t currX;
-            size_t currY;
-            indexToCoords(it->first, currX, currY);
-            if(!func(it->second, currX, currY))
-                return;
+            getRowEntries(grid, cellY, 0, fromIndex, entries);
+            for(auto it = entries.rbegin(); it != entries.rend(); it++)
+                if(!func(**it))
+                    return;
         }
     }
 }
@@ -331,9 +384,56 @@ void TileBufferCache<ElementType>::forEach(unsigned int textureId, const std::fu
 ///////////////////////////////////
 
 template<typename ElementType>
-void TileBufferCache<ElementType>::set(ElementIndexMap& indexMap, size_t x, size_t y, const ElementType& element)
+void TileBufferCache<ElementType>::getRowEntries(const Grid& grid, size_t cellY, size_t minIndex, size_t maxIndex, std::vector<const Entry*>& entries) const
 {
-    indexMap[coordsToIndex(x, y)] = element;
+    entries.clear();
+    for(const Cell& cell : grid[cellY])
+        for(const Entry& entry : cell)
+            if(entry.index >= minIndex && entry.index <= maxIndex)
+                entries.push_back(&entry);
+
+    std::sort(entries.begin(), entries.end(), [](const Entry* lhs, const Entry* rhs)
+    {
+        return lhs->index < rhs->index;
+    });
+}
+
+///////////////////////////////////
+
+template<typename ElementType>
+const typename TileBufferCache<ElementType>::Grid* TileBufferCache<ElementType>::getGrid(unsigned int textureId) const
+{
+    auto grid = mElements.find(textureId);
+    if(grid == mElements.end())
+        return nullptr;
+
+    return &grid->second;
+}
+
+///////////////////////////////////
+
+template<typename ElementType>
+const typename TileBufferCache<ElementType>::Cell* TileBufferCache<ElementType>::getCell(const Grid& grid, size_t cellX, size_t cellY) const
+{
+    if(cellY >= grid.size() || cellX >= grid[cellY].size())
+        return nullptr;
+
+    return &grid[cellY][cellX];
+}
+
+///////////////////////////////////
+
+template<typename ElementType>
+typename TileBufferCache<ElementType>::Cell& TileBufferCache<ElementType>::getCell(Grid& grid, size_t cellX, size_t cellY)
+{
+    if(cellY >= grid.size())
+        grid.resize(cellY + 1);
+
+    CellRow& row = grid[cellY];
+    if(cellX >= row.size())
+        row.resize(cellX + 1);
+
+    return row[cellX];
 }
 
 ///////////////////////////////////
@@ -30,6 +30,9 @@
 ///////////////////////////////////
 // STD C++
 #include <string>
+#include <map>
+#include <vector>
+#include <cstdint>
 ///////////////////////////////////
 
 namespace GraphicsLayer
@@ -45,11 +48,31 @@ namespace GraphicsLayer
                 std::string version;
             };
 
+            // The input keys that the artifacts of the current version were
+            // last generated from.
+            struct ManifestFile
+            {
+                void toFile(std::string path) const;
+                static ManifestFile fromFile(std::string path);
+
+                std::map<std::string, uint64_t> keys;
+            };
+
         public:
             static bool hasNewVersion(std::string clientDir, std::string versionControlDir);
             static std::string getPath(std::string versionControlDir);
+            static std::string getCachePath(std::string versionControlDir);
             static void checkout(std::string versionControlDir);
 
+            // Content hash of a file, to be used as an input key.
+            static uint64_t hashFile(const std::string& path);
+            static uint64_t combineKeys(const std::vector<uint64_t>& keys);
+            // An artifact is up to date if it was last committed with the same
+            // input key. Artifacts are kept across versions, so that only the
+            // ones whose inputs changed have to be regenerated.
+            static bool isUpToDate(std::string versionControlDir, const std::string& artifact, uint64_t inputKey);
+            static void commit(std::string versionControlDir, const std::string& artifact, uint64_t inputKey);
+
         private:
             static void prepareFiles(std::string versionControlDir);
             static void checkClientFiles(std::string clientDir);
@@ -61,6 +84,8 @@ namespace GraphicsLayer
             static const std::string OLD_PATH;
             static const std::string CURRENT_PATH;
             static const std::string CURRENT_VERSION_PATH;
+            static const std::string CURRENT_MANIFEST_PATH;
+            static const std::string CACHE_PATH;
             static const std::string CLIENT_MODULE_NAME;
             static const std::string CLIENT_MODULE_PATH;
             static const std::string TIBIA_PACKAGE_PATH;
@@ -27,7 +27,10 @@
 ///////////////////////////////////
 // Internal ShankBot headers
 #include "monitor/FontSample.hpp"
+#include "utility/utility.hpp"
+#if defined(_WIN32)
 #include "utility/FunctionDetour.hpp"
+#endif // defined
 using namespace GraphicsLayer;
 ///////////////////////////////////
 
@@ -58,7 +61,9 @@ const unsigned char FontSample::Glyph::bytesPerPixel = 1;
 namespace FontSamplePrivate
 {
     std::vector<FontSample::Glyph>* currentGlyphs = nullptr;
+    #if defined(_WIN32)
     FunctionDetour* subTexImgDetour = nullptr;
+    #endif // defined
     char currentCharacter = 0;
     float currentPointSize = 0;
     FontSample::Style currentStyle = FontSample::Style::NORMAL;
@@ -149,6 +154,10 @@ FontSample::FontSample(std::string family, float minPointSize, float maxPointSiz
 
 void FontSample::createGlyphSamples(std::string family, float minPointSize, float maxPointSize, unsigned char styleFlags)
 {
+    #if !defined(_WIN32)
+    // The glyphs are caught by detouring glTexSubImage2D of OPENGL32.DLL.
+    SB_THROW("Glyph samples can only be created on Windows.");
+    #else
     int argc = 0;
     QGuiApplication app(argc, nullptr);
     QSurfaceFormat surfaceFormat;
@@ -215,6 +224,7 @@ void FontSample::createGlyphSamples(std::string family, float minPointSize, floa
     delete subTexImgDetour;
     subTexImgDetour = nullptr;
     currentGlyphs = nullptr;
+    #endif // defined
 }
 
 void FontSample::generateGlyphs(QPainter& painter)
@@ -26,7 +26,7 @@
 // {SHANK_BOT_LICENSE_END}
 ///////////////////////////////////
 // Internal ShankBot headers
-#include "monitor/FrameFile.hpp"
+#include "monitor/FrameFile.hpp"
 #include "monitor/Frame.hpp"
 #include "utility/utility.hpp"
 #include "utility/file.hpp"
@@ -92,7 +92,7 @@ void write(const std::shared_ptr<std::vector<SpriteDraw>>& draws, std::ostream&
             unsigned short numObjects = p.objects.size();
             writeStream(numObjects, stream);
 
-            for(const size_t& o : p.objects)
+            for(uint32_t o : p.objects)
             {
                 unsigned int object = o;
                 writeStream(object, stream);
@@ -121,25 +121,21 @@ void write(const std::shared_ptr<std::vector<GuiDraw>>& draws, std::ostream& str
         writeStream(nameLength, stream);
         if(nameLength)
         {
-            writeStream(*d.name.c_str(), stream, nameLength);
+            writeStream(*d.name.data(), stream, nameLength);
         }
     }
 }
 
 
-void write(const std::shared_ptr<std::vector<GlyphDraw>>& draws, std::ostream& stream)
+void write(const Span<GlyphDraw>& draws, std::ostream& stream)
 {
-    bool hasData = draws != nullptr;
+    bool hasData = true;
     writeStream(hasData, stream);
-    if(!hasData)
-    {
-        return;
-    }
-    unsigned short numDraws = draws->size();
+    unsigned short numDraws = draws.size();
     writeStream(numDraws, stream);
     for(unsigned short i = 0; i < numDraws; i++)
     {
-        const GlyphDraw& d = (*draws)[i];
+        const GlyphDraw& d = draws[i];
         write(d, stream);
         writeStream(d.character, stream);
     }
@@ -232,7 +228,7 @@ void write(const std::shared_ptr<RawImage>& screenPixels, std::ostream& stream)
     }
 }
 
-void read(Draw& draw, std::istream& stream)
+void read(Draw& draw, MonotonicArena& arena, std::istream& stream)
 {
     readStreamSafe(draw.drawCallId, stream);
     readStreamSafe(draw.topLeft, stream);
@@ -246,8 +242,9 @@ void read(Draw& draw, std::istream& stream)
         return;
     }
 
-    draw.transform.reset(new Matrix<float, 4, 4>());
-    readStreamSafe(*draw.transform, stream);
+    Matrix<float, 4, 4>* transform = arena.create(Matrix<float, 4, 4>());
+    readStreamSafe(*transform, stream);
+    draw.transform = transform;
 
     readStreamSafe(draw.isDepthTestEnabled, stream);
     readStreamSafe(draw.isDepthWriteEnabled, stream);
@@ -255,7 +252,7 @@ void read(Draw& draw, std::istream& stream)
     readStreamSafe(draw.order, stream);
 }
 
-void read(std::shared_ptr<std::vector<SpriteDraw>>& draws, std::istream& stream)
+void read(std::shared_ptr<std::vector<SpriteDraw>>& draws, MonotonicArena& arena, std::istream& stream)
 {
     bool hasData;
     readStreamSafe(hasData, stream);
@@ -272,14 +269,14 @@ void read(std::shared_ptr<std::vector<SpriteDraw>>& draws, std::istream& stream)
     for(unsigned short i = 0; i < numDraws; i++)
     {
         SpriteDraw& d = (*draws)[i];
-        read(d, stream);
+        read(d, arena, stream);
 
         unsigned short numPairings;
         readStreamSafe(numPairings, stream);
+        SpriteDraw::SpriteObjectPairing* pairings = arena.allocate<SpriteDraw::SpriteObjectPairing>(numPairings);
         for(unsigned short j = 0; j < numPairings; j++)
         {
-            d.pairings.emplace_back();
-            SpriteDraw::SpriteObjectPairing& p = d.pairings.back();
+            SpriteDraw::SpriteObjectPairing& p = pairings[j];
 
             unsigned int spriteId;
             readStreamSafe(spriteId, stream);
@@ -288,18 +285,21 @@ void read(std::shared_ptr<std::vector<SpriteDraw>>& draws, std::istream& stream)
             unsigned short numObjects;
             readStreamSafe(numObjects, stream);
 
+            uint32_t* objects = arena.allocate<uint32_t>(numObjects);
             for(unsigned short k = 0; k < numObjects; k++)
             {
                 unsigned int object;
                 readStreamSafe(object, stream);
-                p.objects.push_back(object);
+                objects[k] = object;
             }
+            p.objects = Span<uint32_t>(objects, objects + numObjects);
         }
+        d.pairings = Span<SpriteDraw::SpriteObjectPairing>(pairings, pairings + numPairings);
     }
 }
 
 
-void read(std::shared_ptr<std::vector<GuiDraw>>& draws, std::istream& stream)
+void read(std::shared_ptr<std::vector<GuiDraw>>& draws, MonotonicArena& arena, std::istream& stream)
 {
     bool hasData;
     readStreamSafe(hasData, stream);
@@ -317,44 +317,44 @@ void read(std::shared_ptr<std::vector<GuiDraw>>& draws, std::istream& stream)
     for(unsigned short i = 0; i < numDraws; i++)
     {
         GuiDraw& d = (*draws)[i];
-        read(d, stream);
+        read(d, arena, stream);
 
         unsigned short nameLength;
         readStreamSafe(nameLength, stream);
         if(nameLength)
         {
-            d.name.resize(nameLength);
-            readStreamSafe(*d.name.c_str(), stream, nameLength);
+            char* name = arena.allocate<char>(nameLength);
+            readStreamSafe(*name, stream, nameLength);
+            d.name = StringView(name, nameLength);
         }
     }
 }
 
 
-void read(std::shared_ptr<std::vector<GlyphDraw>>& draws, std::istream& stream)
+void read(Span<GlyphDraw>& draws, MonotonicArena& arena, std::istream& stream)
 {
     bool hasData;
     readStreamSafe(hasData, stream);
     if(!hasData)
     {
-        draws = nullptr;
+        draws = Span<GlyphDraw>();
         return;
     }
 
-    draws.reset(new std::vector<GlyphDraw>());
-
     unsigned short numDraws;
     readStreamSafe(numDraws, stream);
-    draws->resize(numDraws);
+    GlyphDraw* glyphDraws = arena.allocate<GlyphDraw>(numDraws);
     for(unsigned short i = 0; i < numDraws; i++)
     {
-        GlyphDraw& d = (*draws)[i];
-        read(d, stream);
+        GlyphDraw& d = glyphDraws[i];
+        read(d, arena, stream);
         readStreamSafe(d.character, stream);
     }
+    draws = Span<GlyphDraw>(glyphDraws, glyphDraws + numDraws);
 }
 
 
-void read(std::shared_ptr<std::vector<TextDraw>>& draws, std::istream& stream)
+void read(std::shared_ptr<std::vector<TextDraw>>& draws, MonotonicArena& arena, std::istream& stream)
 {
     bool hasData;
     readStreamSafe(hasData, stream);
@@ -372,16 +372,16 @@ void read(std::shared_ptr<std::vector<TextDraw>>& draws, std::istream& stream)
     for(unsigned short i = 0; i < numDraws; i++)
     {
         TextDraw& d = (*draws)[i];
-        read(d, stream);
+        read(d, arena, stream);
 
         readStreamSafe(d.color, stream);
         readStreamSafe(d.isOutlined, stream);
-        read(d.glyphDraws, stream);
+        read(d.glyphDraws, arena, stream);
     }
 }
 
 
-void read(std::shared_ptr<std::vector<RectDraw>>& draws, std::istream& stream)
+void read(std::shared_ptr<std::vector<RectDraw>>& draws, MonotonicArena& arena, std::istream& stream)
 {
     bool hasData;
     readStreamSafe(hasData, stream);
@@ -399,13 +399,13 @@ void read(std::shared_ptr<std::vector<RectDraw>>& draws, std::istream& stream)
     for(unsigned short i = 0; i < numDraws; i++)
     {
         RectDraw& d = (*draws)[i];
-        read(d, stream);
+        read(d, arena, stream);
         readStreamSafe(d.color, stream);
     }
 }
 
 
-void read(std::shared_ptr<std::vector<MiniMapDraw>>& draws, std::istream& stream)
+void read(std::shared_ptr<std::vector<MiniMapDraw>>& draws, MonotonicArena& arena, std::istream& stream)
 {
     bool hasData;
     readStreamSafe(hasData, stream);
@@ -423,7 +423,7 @@ void read(std::shared_ptr<std::vector<MiniMapDraw>>& draws, std::istream& stream
     for(unsigned short i = 0; i < numDraws; i++)
     {
         MiniMapDraw& d = (*draws)[i];
-        read(d, stream);
+        read(d, arena, stream);
 
         d.pixels.reset(new std::vector<unsigned char>());
 
@@ -557,11 +557,13 @@ bool readBin(Frame& f, const std::string& filePath)
         readStreamSafe(f.width, file);
         readStreamSafe(f.height, file);
 
-        read(f.spriteDraws, file);
-        read(f.guiDraws, file);
-        read(f.guiSpriteDraws, file);
-        read(f.textDraws, file);
-        read(f.rectDraws, file);        read(f.miniMapDraws, file);
+        f.arena = std::make_shared<MonotonicArena>();
+        read(f.spriteDraws, *f.arena, file);
+        read(f.guiDraws, *f.arena, file);
+        read(f.guiSpriteDraws, *f.arena, file);
+        read(f.textDraws, *f.arena, file);
+        read(f.rectDraws, *f.arena, file);
+        read(f.miniMapDraws, *f.arena, file);
     }
     catch(...)
     {
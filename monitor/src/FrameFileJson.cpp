@@ -146,12 +146,9 @@ QJsonValue toJson(const TextDraw& d, const Frame& f)
     TextBuilder builder(d, f.width, f.height);
 
     QJsonArray glyphs;
-    if(d.glyphDraws != nullptr)
+    for(const GlyphDraw& g : d.glyphDraws)
     {
-        for(const GlyphDraw& g : *d.glyphDraws)
-        {
-            glyphs.push_back(toJson(g, f));
-        }
+        glyphs.push_back(toJson(g, f));
     }
 
     return QJsonObject(
@@ -216,7 +213,7 @@ QJsonValue toJson(const GuiDraw& d, const Frame& f)
     o["localX"] = round(d.topLeft.x);
     o["localY"] = round(d.topLeft.y);
 
-    o["name"] = QString::fromStdString(d.name);
+    o["name"] = QString::fromUtf8(d.name.data(), d.name.size());
     return o;
 }
 
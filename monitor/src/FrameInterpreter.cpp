@@ -0,0 +1,137 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/FrameInterpreter.hpp"
+#include "utility/WorkStealingPool.hpp"
+#include "utility/utility.hpp"
+using namespace GraphicsLayer;
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <cassert>
+///////////////////////////////////
+
+FrameInterpreter::FrameInterpreter(const TibiaContext& context, WorkStealingPool& pool)
+: mScene(context)
+, mSideBar(context)
+, mGraph(pool)
+{
+    // Added in the order of Task, so that a Task is its TaskId.
+    TaskGraph::TaskId gui = mGraph.addTask(getName(Task::GUI), [this]()
+    {
+        mGui.parse(mFrame);
+    });
+    TaskGraph::TaskId text = mGraph.addTask(getName(Task::TEXT), [this]()
+    {
+        mText.parse(mFrame, mGui.getData());
+    }, {gui});
+    TaskGraph::TaskId rect = mGraph.addTask(getName(Task::RECT), [this]()
+    {
+        mRect.parse(mFrame);
+    });
+    TaskGraph::TaskId guiSprite = mGraph.addTask(getName(Task::GUI_SPRITE), [this]()
+    {
+        mGuiSprite.parse(mFrame);
+    });
+    mGraph.addTask(getName(Task::SCENE), [this]()
+    {
+        mScene.parse(mFrame);
+    });
+    TaskGraph::TaskId sideBar = mGraph.addTask(getName(Task::SIDE_BAR), [this]()
+    {
+        mSideBar.assemble(mFrame, mGui.getData(), mText.getData(), mRect.getData(), mGuiSprite.getData());
+    }, {gui, text, rect, guiSprite});
+    mGraph.addTask(getName(Task::SIDE_BAR_DIFF), [this]()
+    {
+        mSideBarDiff.parse(mFrame, mSideBar.getData());
+    }, {sideBar});
+    assert(mGraph.getNumTasks() == size_t(Task::NUM_TASKS));
+}
+
+void FrameInterpreter::interpret(const Frame& frame)
+{
+    mFrame = frame;
+    mGraph.run();
+}
+
+const GuiParser::Data& FrameInterpreter::getGuiData()
+{
+    return mGui.getData();
+}
+
+const TextParser::Data& FrameInterpreter::getTextData() const
+{
+    return mText.getData();
+}
+
+const RectParser::Data& FrameInterpreter::getRectData()
+{
+    return mRect.getData();
+}
+
+const GuiSpriteParser::Data& FrameInterpreter::getGuiSpriteData()
+{
+    return mGuiSprite.getData();
+}
+
+const SceneParser::Data& FrameInterpreter::getSceneData() const
+{
+    return mScene.getData();
+}
+
+const SideBarWindowAssembler::Data& FrameInterpreter::getSideBarData() const
+{
+    return mSideBar.getData();
+}
+
+const SideBarWindowDiff::Data& FrameInterpreter::getSideBarDiffData() const
+{
+    return mSideBarDiff.getData();
+}
+
+double FrameInterpreter::getMicroseconds(Task task) const
+{
+    return mGraph.getMicroseconds(TaskGraph::TaskId(task));
+}
+
+const char* FrameInterpreter::getName(Task task)
+{
+    switch(task)
+    {
+        case Task::GUI: return "GuiParser";
+        case Task::TEXT: return "TextParser";
+        case Task::RECT: return "RectParser";
+        case Task::GUI_SPRITE: return "GuiSpriteParser";
+        case Task::SCENE: return "SceneParser";
+        case Task::SIDE_BAR: return "SideBarWindowAssembler";
+        case Task::SIDE_BAR_DIFF: return "SideBarWindowDiff";
+        default: SB_THROW("Unimplemented task: ", (int)task);
+    }
+}
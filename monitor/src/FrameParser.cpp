@@ -31,6 +31,7 @@
 
 #include "monitor/Constants.hpp"
 #include "monitor/TibiaContext.hpp"
+#include "utility/ThreadPool.hpp"
 using namespace GraphicsLayer;
 using namespace SharedMemoryProtocol;
 using namespace sb::utility;
@@ -46,6 +47,7 @@ using namespace sb::tibiaassets;
 ///////////////////////////////////
 // STD C++
 #include <algorithm>
+#include <unordered_map>
 #include <cassert>
 #include <iostream>
 #include <fstream>
@@ -56,6 +58,13 @@ using namespace sb::tibiaassets;
 FrameParser::FrameParser(const TibiaContext& context)
 : mContext(context)
 , mTileCache(1 << 14)
+, mPixelHashCache(SharedMemoryProtocol::PIXEL_HASH_CACHE_SIZE)
+, mRecognitionCache(RECOGNITION_CACHE_SIZE)
+, mThreadPool(new ThreadPool())
+{
+}
+
+FrameParser::~FrameParser()
 {
 }
 
@@ -471,24 +480,42 @@ FrameParser::TileNumber FrameParser::getTileNumber(const unsigned char* pixels,
 
 unsigned char FrameParser::getChar(const unsigned char* pixels, unsigned short width, unsigned short height, std::list<unsigned char>* topTen) const
 {
+    const std::vector<FontSample::Glyph>& glyphs = mContext.getGlyphs();
+    const GlyphIndex& index = mContext.getGlyphIndex();
+    if(!topTen)
+    {
+        size_t exactGlyph = index.findExact(pixels, width, height);
+        if(exactGlyph != GlyphIndex::NO_GLYPH)
+            return glyphs[exactGlyph].character;
+    }
+
     size_t sum = 0;
     for(size_t i = 0; i < width * height; i++)
         sum += pixels[i];
 
+    std::vector<uint32_t> candidates;
+    index.findCandidates(width, height, sum, candidates);
+
+    std::vector<WindowDiffTemplate> templates;
+    templates.reserve(candidates.size());
+    for(uint32_t candidate : candidates)
+    {
+        const FontSample::Glyph& glyph = glyphs[candidate];
+        templates.push_back({glyph.data.data(), glyph.width, glyph.height, glyph.sum});
+    }
+
+    // Without topTen only the best match matters, so the others may be
+    // abandoned early.
+    std::vector<size_t> candidateDiffs(candidates.size());
+    movingWindowMinDiffs(pixels, width, height, sum, templates.data(), templates.size(), candidateDiffs.data(), topTen == nullptr);
+
     size_t minDiff = -1;
     std::list<std::pair<size_t, const FontSample::Glyph*>> diffs(10, {-1, nullptr});
     const FontSample::Glyph* mostSimilarGlyph = nullptr;
-    for(const FontSample::Glyph& lhs : mContext.getGlyphs())
+    for(size_t i = 0; i < candidates.size(); i++)
     {
-        size_t diff = -1;
-        #define SUM_EPSILON 2
-        if(!(sum > lhs.sum * SUM_EPSILON || lhs.sum > sum * SUM_EPSILON))
-        {
-            if(lhs.width <= width && lhs.height <= height)
-                diff = movingWindowMinDiff(lhs.data.data(), lhs.width, lhs.height, pixels, width, height, sum);
-            else if(width <= lhs.width && height <= lhs.height)
-                diff = movingWindowMinDiff(pixels, width, height, lhs.data.data(), lhs.width, lhs.height, lhs.sum);
-        }
+        const FontSample::Glyph& lhs = glyphs[candidates[i]];
+        size_t diff = candidateDiffs[i];
 
         if(topTen)
         {
@@ -744,8 +771,8 @@ void FrameParser::parseGlyphDraw(const DrawCall& drawCall)
     }
     else
         d.color = drawCall.blendColor;
-    d.transform = std::make_shared<Matrix<float, 4, 4>>(program.transform);
-    d.glyphDraws = std::make_shared<std::vector<GlyphDraw>>();
+    d.transform = mCurrentFrame.arena->create(program.transform);
+    mGlyphDraws.clear();
     const unsigned short HALF_FRAME_WIDTH = mCurrentFrame.width / 2;
     const unsigned short HALF_FRAME_HEIGHT = mCurrentFrame.height / 2;
 
@@ -764,7 +791,7 @@ void FrameParser::parseGlyphDraw(const DrawCall& drawCall)
         const bool hasOrder = orders != nullptr;
         VertexAttribPointer::Index* indices = (VertexAttribPointer::Index*)((char*)buffer.data + drawCall.indicesOffset);
         const size_t numDraws = drawCall.numIndices / 6;
-        d.glyphDraws->reserve(d.glyphDraws->capacity() + numDraws);
+        mGlyphDraws.reserve(numDraws);
         for(size_t i = 0; i + 5 < drawCall.numIndices; i += 6)
         {
             assert(size_t(&indices[i]) < bufferEnd);
@@ -789,11 +816,12 @@ void FrameParser::parseGlyphDraw(const DrawCall& drawCall)
             g.botRight.x = botRight.x;
             g.botRight.y = botRight.y;
             g.character = getChar(drawCall.sourceTextureId, topLeft.texX, topLeft.texY, botRight.texX - topLeft.texX, botRight.texY - topLeft.texY);
-            d.glyphDraws->push_back(g);
+            mGlyphDraws.push_back(g);
         }
 
+        d.glyphDraws = mCurrentFrame.arena->copy(mGlyphDraws.data(), mGlyphDraws.size());
         d.hasOrder = hasOrder;
-        d.order = d.glyphDraws->empty() ? 0.f : d.glyphDraws->front().order;
+        d.order = d.glyphDraws.empty() ? 0.f : d.glyphDraws.front().order;
         d.drawCallId = mDrawCallId;
         d.isDepthTestEnabled = drawCall.isDepthTestEnabled;
         d.isDepthWriteEnabled = drawCall.isDepthWriteEnabled;
@@ -822,7 +850,7 @@ void FrameParser::parseRectDraw(const DrawCall& drawCall)
     assert(drawCall.enabledVaos & (1 << 2) && buffer.getOrdersOffset() != -1);
     VertexAttribPointer::Index* indices = (VertexAttribPointer::Index*)((char*)buffer.data + drawCall.indicesOffset);
     const ShaderProgram& program = mShaderPrograms[drawCall.programId];
-    std::shared_ptr<Matrix<float, 4, 4>> transform = std::make_shared<Matrix<float, 4, 4>>(program.transform);
+    const Matrix<float, 4, 4>* transform = mCurrentFrame.arena->create(program.transform);
     if(drawCall.targetTextureId == 0)
     {
         if(drawCall.type == DrawCall::PrimitiveType::TRIANGLE_STRIP)
@@ -900,7 +928,7 @@ void FrameParser::parseSpriteDraw(const DrawCall& drawCall)
     VertexAttribPointer::Index* indices = (VertexAttribPointer::Index*)((char*)buffer.data + drawCall.indicesOffset);
     const Texture& tex = mTextures[drawCall.sourceTextureId];
     const size_t numDraws = drawCall.numIndices / 6;
-    mCurrentFrame.spriteDraws->reserve(mCurrentFrame.spriteDraws->capacity() + numDraws);
+    mCurrentFrame.spriteDraws->reserve(mCurrentFrame.spriteDraws->size() + numDraws);
 
     for(size_t i = 0; i < drawCall.numIndices; i += 6)
     {
@@ -928,7 +956,7 @@ void FrameParser::parseSpriteDraw(const DrawCall& drawCall)
                 draw.order = orders[indices[i]];
                 draw.isDepthTestEnabled = drawCall.isDepthTestEnabled;
                 draw.isDepthWriteEnabled = drawCall.isDepthWriteEnabled;
-                draw.pairings = SpriteObjectPairingsData::fromTile(tile);
+                draw.pairings = copyToFrame(SpriteObjectPairingsData::fromTile(tile));
                 mCurrentFrame.spriteDraws->push_back(draw);
                 break;
             }
@@ -962,8 +990,8 @@ void FrameParser::parseGuiTileDraw(const DrawCall& drawCall)
     const unsigned short HALF_FRAME_HEIGHT = mCurrentFrame.height / 2;
     const ShaderProgram& program = mShaderPrograms[drawCall.programId];
     const size_t numDraws = drawCall.numIndices / 6;
-    mCurrentFrame.guiDraws->reserve(mCurrentFrame.guiDraws->capacity() + numDraws);
-    std::shared_ptr<Matrix<float, 4, 4>> transform = std::make_shared<Matrix<float, 4, 4>>(program.transform);
+    mCurrentFrame.guiDraws->reserve(mCurrentFrame.guiDraws->size() + numDraws);
+    const Matrix<float, 4, 4>* transform = mCurrentFrame.arena->create(program.transform);
 
     const size_t BOT_RIGHT_OFFSET = (drawCall.type == DrawCall::PrimitiveType::TRIANGLE ? 2 : 3);
     for(size_t i = 0; i < drawCall.numIndices; i += 6)
@@ -1037,7 +1065,7 @@ void FrameParser::parseGuiTileDraw(const DrawCall& drawCall)
                 draw.topLeft.y = topLeft.y;
                 draw.botRight.x = botRight.x;
                 draw.botRight.y = botRight.y;
-                draw.pairings = SpriteObjectPairingsData::fromTile(tile);
+                draw.pairings = copyToFrame(SpriteObjectPairingsData::fromTile(tile));
                 draw.transform = transform;
                 draw.isDepthTestEnabled = drawCall.isDepthTestEnabled;
                 draw.isDepthWriteEnabled = drawCall.isDepthWriteEnabled;
@@ -1055,7 +1083,7 @@ void FrameParser::parseGuiTileDraw(const DrawCall& drawCall)
                 d.topLeft.y = topLeft.y;
                 d.botRight.x = botRight.x;
                 d.botRight.y = botRight.y;
-                d.name = GraphicsResourceNamesData::fromTile(tile).front();
+                d.name = copyToFrame(GraphicsResourceNamesData::fromTile(tile).front());
                 d.transform = transform;
                 d.isDepthTestEnabled = drawCall.isDepthTestEnabled;
                 d.isDepthWriteEnabled = drawCall.isDepthWriteEnabled;
@@ -1183,7 +1211,7 @@ void FrameParser::parseMiniMapDraw(const DrawCall& drawCall)
     d.topLeft.y = topLeft.y;
     d.botRight.x = botRight.x;
     d.botRight.y = botRight.y;
-    d.transform = std::make_shared<Matrix<float, 4, 4>>(mShaderPrograms[drawCall.programId].transform);
+    d.transform = mCurrentFrame.arena->create(mShaderPrograms[drawCall.programId].transform);
 
     auto pixelsIt = mMiniMapBuffers.find(drawCall.sourceTextureId);
     assert(pixelsIt != mMiniMapBuffers.end());
@@ -1238,139 +1266,236 @@ void FrameParser::parseUniform4f(const Uniform4f& uniform)
     memcpy(program.uniform4fs[uniform.location], uniform.values, sizeof(uniform.values));
 }
 
-size_t numGlyphs = 0;
-size_t frameId = 0;
-std::list<GraphicsLayer::Frame> FrameParser::parse(const SharedMemoryProtocol::SharedMemorySegment* segment)
+// Hands every message of a segment to its parse function.
+struct FrameParser::MessageHandler
 {
-    std::list<Frame> frames;
-    const char* DATA_END = segment->data + segment->size;
-    for(const char* data = segment->data; data < DATA_END;)
-    {
-        const SharedMemoryProtocol::Frame& frame = *(SharedMemoryProtocol::Frame*)(data);
-        mCurrentFrame = Frame();
-        mCurrentFrame.guiDraws = std::make_shared<std::vector<GuiDraw>>();
-        mCurrentFrame.spriteDraws = std::make_shared<std::vector<SpriteDraw>>();
-        mCurrentFrame.textDraws = std::make_shared<std::vector<TextDraw>>();
-        mCurrentFrame.rectDraws = std::make_shared<std::vector<RectDraw>>();
-        mCurrentFrame.guiSpriteDraws = std::make_shared<std::vector<SpriteDraw>>();
-        mCurrentFrame.fileIo = std::make_shared<std::vector<FileIo>>();
-        mCurrentFrame.miniMapDraws = std::make_shared<std::vector<MiniMapDraw>>();
-        mDrawCallId = 0;
+    FrameParser& parser;
 
-        mCurrentFrame.width = frame.width;
-        mCurrentFrame.height = frame.height;
+    void operator()(const PixelData& pixelData, const char* pixels, size_t)
+    {
+        if(pixelData.messageType == Message::MessageType::PIXEL_DATA_REF)
+            parser.parsePixelDataRef(pixelData);
+        else
+            parser.parsePixelData(pixelData, (const unsigned char*)pixels);
+    }
 
-        const char* FRAME_END = data + frame.size;
-        data += sizeof(frame);
-        while(data < FRAME_END)
-        {
-            const Message& message = *(Message*)(data);
-            typedef Message::MessageType Type;
-            switch(message.messageType)
-            {
-                case Type::PIXEL_DATA:
-                case Type::SCREEN_PIXELS:
-                {
-                    const PixelData& pixelData = *(PixelData*)(data);
-                    data += sizeof(pixelData);
+    void operator()(const CopyTexture& copy, const char*, size_t)
+    {
+        parser.parseCopyTexture(copy);
+    }
 
-                    unsigned char* pixels = (unsigned char*)data;
-                    size_t pixelsSize = pixelData.width * pixelData.height * getBytesPerPixel(pixelData.format);
+    void operator()(const TextureData& textureData, const char*, size_t)
+    {
+        parser.parseTextureData(textureData);
+    }
 
-                    data += pixelsSize;
-                    parsePixelData(pixelData, pixels);
-                    break;
-                }
-                case Type::COPY_TEXTURE:
-                {
-                    const CopyTexture& copy = *(CopyTexture*)(data);
-                    data += sizeof(copy);
+    void operator()(const VertexBufferWrite& bufferWrite, const char* bufferData, size_t)
+    {
+        parser.parseVertexBufferWrite(bufferWrite, bufferData);
+    }
 
-                    parseCopyTexture(copy);
-                    break;
-                }
+    void operator()(const VertexAttribPointer& attrib, const char*, size_t)
+    {
+        parser.parseVertexAttribPointer(attrib);
+    }
 
-                case Type::TEXTURE_DATA:
-                {
-                    const TextureData& textureData = *(TextureData*)(data);
-                    data += sizeof(textureData);
+    void operator()(const DrawCall& drawCall, const char*, size_t)
+    {
+        parser.parseDrawCall(drawCall);
+    }
 
-                    parseTextureData(textureData);
-                    break;
-                }
+    void operator()(const TransformationMatrix& transform, const char*, size_t)
+    {
+        parser.parseTransformationMatrix(transform);
+    }
 
-                case Type::VERTEX_BUFFER_WRITE:
-                {
-                    const VertexBufferWrite& bufferWrite = *(VertexBufferWrite*)(data);
-                    data += sizeof(bufferWrite);
+    void operator()(const Uniform4f& uniform, const char*, size_t)
+    {
+        parser.parseUniform4f(uniform);
+    }
 
-                    const char* bufferData = data;
-                    data += bufferWrite.numBytes;
+    void operator()(const SharedMemoryProtocol::FileIo& io, const char* path, size_t)
+    {
+        parser.parseFileIo(io, path);
+    }
+};
 
-                    parseVertexBufferWrite(bufferWrite, bufferData);
-                    break;
-                }
+// Collects the tile buffer uploads for recognizeTiles. The tile buffer id
+// is tracked the same way parseTextureData does it. Uploads whose content
+// is in the recognition cache are resolved right away, and repeats within
+// the frame are queried only once.
+struct FrameParser::TileQueryCollector
+{
+    FrameParser& parser;
+    unsigned int tileBufferId;
+    std::set<uint64_t> hashes;
+    std::unordered_map<uint64_t, size_t> queriedTiles;
+    std::vector<std::pair<size_t, size_t>> repeatedTiles;
 
-                case Type::VERTEX_ATTRIB_POINTER:
-                {
-                    const VertexAttribPointer& attrib = *(VertexAttribPointer*)(data);
-                    data += sizeof(attrib);
+    void operator()(const PixelData& pixelData, const char* pixels, size_t)
+    {
+        if
+        (
+            pixelData.messageType == Message::MessageType::PIXEL_DATA &&
+            pixelData.targetTextureId == tileBufferId &&
+            pixelData.format != sb::utility::PixelFormat::ALPHA &&
+            (pixelData.hash == 0 || (parser.mPixelHashCache.get(pixelData.hash) == nullptr && hashes.insert(pixelData.hash).second))
+        )
+        {
+            const unsigned char* tilePixels = (const unsigned char*)pixels;
+            std::vector<std::pair<const unsigned char*, Tile>>& recognizedTiles = parser.mRecognizedTiles;
+            const size_t recognizedTileIndex = recognizedTiles.size();
+            const TileContent content = getTileContent(pixelData, tilePixels);
+            if(const Tile* tile = parser.findRecognizedTile(content))
+            {
+                recognizedTiles.emplace_back(tilePixels, *tile);
+                return;
+            }
 
-                    parseVertexAttribPointer(attrib);
-                    break;
-                }
+            recognizedTiles.emplace_back(tilePixels, Tile());
+            auto queried = queriedTiles.emplace(content.hash, recognizedTileIndex);
+            if(!queried.second && getTileContent(pixelData, recognizedTiles[queried.first->second].first) == content)
+            {
+                repeatedTiles.emplace_back(recognizedTileIndex, queried.first->second);
+                return;
+            }
 
-                case Type::DRAW_CALL:
-                {
-                    const DrawCall& drawCall = *(DrawCall*)(data);
-                    data += sizeof(drawCall);
+            // The queries are kept between frames so that their sprite
+            // buffers get reused.
+            if(parser.mNumTileQueries == parser.mTileQueries.size())
+                parser.mTileQueries.emplace_back();
 
-                    parseDrawCall(drawCall);
-                    break;
-                }
+            TileQuery& query = parser.mTileQueries[parser.mNumTileQueries++];
+            query.data = pixelData;
+            query.pixels = tilePixels;
+            query.content = content;
+            query.recognizedTileIndex = recognizedTileIndex;
+        }
+    }
 
-                case Type::TRANSFORMATION_MATRIX:
-                {
-                    const TransformationMatrix& transform = *(TransformationMatrix*)(data);
-                    data += sizeof(transform);
+    void operator()(const TextureData& textureData, const char*, size_t)
+    {
+        if(textureData.width == 4096 && textureData.height == 4096)
+            tileBufferId = textureData.id;
+    }
 
-                    parseTransformationMatrix(transform);
-                    break;
-                }
+    template<typename OtherMessage>
+    void operator()(const OtherMessage&, const char*, size_t)
+    {
+    }
+};
 
-                case Type::UNIFORM_4_F:
-                {
-                    const Uniform4f& uniform = *(Uniform4f*)(data);
-                    data += sizeof(uniform);
+size_t numGlyphs = 0;
+size_t frameId = 0;
+std::list<GraphicsLayer::Frame> FrameParser::parse(const char* data, size_t size)
+{
+    std::list<Frame> frames;
+    const char* DATA_END = data + size;
+    while(data < DATA_END)
+    {
+        // Without a valid segment header there is nothing to resynchronize on.
+        SharedMemoryProtocol::Frame frame;
+        if(size_t(DATA_END - data) < sizeof(frame))
+        {
+            rejectSegment();
+            break;
+        }
+        memcpy(&frame, data, sizeof(frame));
+        if(frame.size < sizeof(frame) || frame.size > size_t(DATA_END - data))
+        {
+            rejectSegment();
+            break;
+        }
 
-                    parseUniform4f(uniform);
-                    break;
-                }
+        const char* FRAME_END = data + frame.size;
+        const char* messages = data + sizeof(frame);
+        data = FRAME_END;
 
-                case Type::FILE_IO:
-                {
-                    const SharedMemoryProtocol::FileIo& io = *(SharedMemoryProtocol::FileIo*)(data);
-                    data += sizeof(io);
+        if(frame.clearsPixelHashes)
+        {
+            mPixelHashCache.clear();
+            mIsPixelHashResyncNeeded = false;
+            mIsPixelHashResyncRequested = false;
+        }
 
-                    const char* pathData = data;
-                    data += io.pathSize;
+        if(frame.discardsContinuedFrame && mIsFrameContinued)
+        {
+            mIsFrameContinued = false;
+            mCurrentFrame = Frame();
+        }
 
-                    parseFileIo(io, pathData);
-                    break;
-                }
+        if(!mIsFrameContinued)
+        {
+            mCurrentFrame = mFramePool.acquire();
+            mDrawCallId = 0;
+        }
 
-                default:
-                    SB_THROW("Unimplemented message type: ", (int)message.messageType);
-            }
+        mCurrentFrame.width = frame.width;
+        mCurrentFrame.height = frame.height;
+
+        // Validates the whole segment before any of it is parsed.
+        if(!recognizeTiles(messages, FRAME_END))
+        {
+            rejectSegment();
+            continue;
+        }
+
+        MessageCursor cursor(messages, FRAME_END);
+        const bool isValid = cursor.forEach(MessageHandler{*this});
+        assert(isValid);
+        mMessageCounters += cursor.getCounters();
+
+        mIsFrameContinued = frame.hasContinuation;
+        if(!mIsFrameContinued)
+        {
+            frames.push_back(std::move(mCurrentFrame));
+            mCurrentFrame = Frame();
         }
-        assert(data == FRAME_END);
-        frames.push_back(std::move(mCurrentFrame));
-        mCurrentFrame = Frame();
     }
 
     return frames;
 }
 
+void FrameParser::rejectSegment()
+{
+    // A frame that continues into a rejected segment is dropped as a whole.
+    // Uploads in the segment were sent with their hash all the same, so
+    // later references to them would miss.
+    mNumRejectedSegments++;
+    mIsPixelHashResyncNeeded = true;
+    mIsFrameContinued = false;
+    mCurrentFrame = Frame();
+}
+
+const MessageCursor::Counters& FrameParser::getMessageCounters() const
+{
+    return mMessageCounters;
+}
+
+size_t FrameParser::getNumRejectedSegments() const
+{
+    return mNumRejectedSegments;
+}
+
+bool FrameParser::takePixelHashResyncRequest()
+{
+    if(!mIsPixelHashResyncNeeded || mIsPixelHashResyncRequested)
+        return false;
+
+    mIsPixelHashResyncRequested = true;
+    return true;
+}
+
+size_t FrameParser::getNumRecognitionCacheHits() const
+{
+    return mRecognitionCache.getNumHits() - mNumRecognitionCollisions;
+}
+
+size_t FrameParser::getNumRecognitionCacheMisses() const
+{
+    return mRecognitionCache.getNumMisses() + mNumRecognitionCollisions;
+}
+
 void FrameParser::parseFileIo(const SharedMemoryProtocol::FileIo& io, const char* data) const
 {
     FileIo f;
@@ -1393,38 +1518,219 @@ void FrameParser::parseFileIo(const SharedMemoryProtocol::FileIo& io, const char
 }
 
 void FrameParser::updateTileBuffer(const PixelData& data, const unsigned char* pixels)
+{
+    if(data.format == sb::utility::PixelFormat::ALPHA)
+        return; // No reason to care about alpha.
+
+    if(data.hash == 0)
+    {
+        setTile(data, getRecognizedTile(data, pixels));
+        return;
+    }
+
+    // Recognition only depends on the pixels, so a tile recognized once can be
+    // reused for every later upload with the same content. The hash has to be
+    // inserted even on a hit, since the injected side mirrors this cache.
+    const Tile* cachedTile = mPixelHashCache.get(data.hash);
+    Tile tile = (cachedTile ? *cachedTile : getRecognizedTile(data, pixels));
+    mPixelHashCache.insert(data.hash, tile);
+    setTile(data, tile);
+}
+
+FrameParser::Tile FrameParser::getRecognizedTile(const PixelData& data, const unsigned char* pixels)
+{
+    if(mNextRecognizedTile < mRecognizedTiles.size() && mRecognizedTiles[mNextRecognizedTile].first == pixels)
+        return mRecognizedTiles[mNextRecognizedTile++].second;
+
+    const TileContent content = getTileContent(data, pixels);
+    if(const Tile* tile = findRecognizedTile(content))
+        return *tile;
+
+    Tile tile = recognizeTile(data, pixels);
+    mRecognitionCache.insert(content.hash, {content, tile});
+    return tile;
+}
+
+bool FrameParser::TileContent::operator==(const TileContent& other) const
+{
+    return hash == other.hash && size == other.size && head == other.head && tail == other.tail;
+}
+
+FrameParser::TileContent FrameParser::getTileContent(const PixelData& data, const unsigned char* pixels)
+{
+    TileContent content;
+    content.size = size_t(data.width) * data.height * sb::utility::getBytesPerPixel(data.format);
+    content.hash = data.hash;
+    if(content.hash == 0)
+    {
+        // Hashed the way the injected side does it, so that both kinds of
+        // upload share their cache entries.
+        const uint64_t seed = (uint64_t(data.width) << 32) | (uint64_t(data.height) << 16) | uint64_t(data.format);
+        content.hash = sb::utility::hash64(pixels, content.size, seed);
+        if(content.hash == 0)
+            content.hash = 1;
+    }
+
+    const size_t edgeSize = std::min(content.size, sizeof(content.head));
+    memcpy(&content.head, pixels, edgeSize);
+    memcpy(&content.tail, pixels + content.size - edgeSize, edgeSize);
+    return content;
+}
+
+const FrameParser::Tile* FrameParser::findRecognizedTile(const TileContent& content)
+{
+    const RecognizedTile* recognized = mRecognitionCache.get(content.hash);
+    if(recognized == nullptr)
+        return nullptr;
+
+    if(!(recognized->content == content))
+    {
+        mNumRecognitionCollisions++;
+        return nullptr;
+    }
+
+    return &recognized->tile;
+}
+
+bool FrameParser::recognizeTiles(const char* data, const char* end)
+{
+    // Finds the tile buffer uploads of the frame up front, so that they can
+    // be looked up in the sequence trees as one batch. Uploads that would be
+    // answered by the pixel hash cache are left out, and those answered by
+    // the recognition cache never become queries.
+    mRecognizedTiles.clear();
+    mNextRecognizedTile = 0;
+    mNumTileQueries = 0;
+
+    MessageCursor cursor(data, end);
+    TileQueryCollector collector{*this, mTileBufferId};
+    if(!cursor.forEach(collector))
+        return false;
+
+    if(mNumTileQueries == 0)
+        return true;
+
+    // Small batches are not worth waking the pool up for.
+    const size_t MIN_PARALLEL_QUERIES = 8;
+    ThreadPool* pool = (mNumTileQueries >= MIN_PARALLEL_QUERIES ? mThreadPool.get() : nullptr);
+    auto convert = [this](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++)
+            convertToTreeSprites(mTileQueries[i]);
+    };
+    if(pool)
+        pool->parallelFor(mNumTileQueries, 1, convert);
+    else
+        convert(0, mNumTileQueries);
+
+    std::vector<SequenceTree::BatchQuery> treeQueries;
+    treeQueries.reserve(mNumTileQueries);
+    for(size_t i = 0; i < mNumTileQueries; i++)
+        treeQueries.push_back(createTreeQuery(mTileQueries[i]));
+
+    SequenceTree::findBatch(mContext.getSpriteColorTree(), mContext.getSpriteTransparencyTree(), treeQueries.data(), treeQueries.size(), mTreeResults, pool);
+
+    for(size_t i = 0; i < mNumTileQueries; i++)
+    {
+        const TileQuery& query = mTileQueries[i];
+        Tile& tile = mRecognizedTiles[query.recognizedTileIndex].second;
+        if(query.isBlank)
+        {
+            tile = Tile(query.data.width, query.data.height, Tile::Type::BLANK);
+        }
+        else
+        {
+            const uint32_t offset = mTreeResults.offsets[i];
+            const size_t numIds = mTreeResults.offsets[i + 1] - offset;
+            tile = createTile(query, mTreeResults.ids.data() + offset, numIds, mTreeResults.isPrimaryFound[i]);
+        }
+
+        mRecognitionCache.insert(query.content.hash, {query.content, tile});
+    }
+
+    for(const std::pair<size_t, size_t>& repeated : collector.repeatedTiles)
+        mRecognizedTiles[repeated.first].second = mRecognizedTiles[repeated.second].second;
+
+    return true;
+}
+
+void FrameParser::parsePixelDataRef(const PixelData& ref)
+{
+    if(ref.targetTextureId != mTileBufferId)
+        return;
+
+    const Tile* tile = mPixelHashCache.get(ref.hash);
+    if(tile == nullptr)
+    {
+        // Only happens if the caches on both sides went out of sync. Better
+        // to forget the area than to keep reporting what was there before,
+        // until the injected side sends the pixels again.
+        mTileCache.removeByArea(ref.targetTextureId, ref.texX, ref.texY, ref.width, ref.height);
+        mIsPixelHashResyncNeeded = true;
+        return;
+    }
+
+    setTile(ref, *tile);
+}
+
+void FrameParser::setTile(const PixelData& data, const Tile& tile)
+{
+    if(tile.getType() == Tile::Type::INVALID)
+        return;
+
+    mTileCache.removeByArea(data.targetTextureId, data.texX, data.texY, data.width, data.height);
+    mTileCache.set(data.targetTextureId, data.texX, data.texY, tile);
+}
+
+sb::utility::Span<SpriteDraw::SpriteObjectPairing> FrameParser::copyToFrame(const SpriteObjectPairings& pairings)
+{
+    sb::utility::MonotonicArena& arena = *mCurrentFrame.arena;
+    sb::utility::Span<uint32_t> objects = arena.copy(pairings.objects.data(), pairings.objects.size());
+    SpriteDraw::SpriteObjectPairing* framePairings = arena.allocate<SpriteDraw::SpriteObjectPairing>(pairings.pairings.size());
+
+    const uint32_t* objectIt = objects.begin();
+    for(size_t i = 0; i < pairings.pairings.size(); i++)
+    {
+        const SpriteObjectPairings::Pairing& p = pairings.pairings[i];
+        framePairings[i].spriteId = p.spriteId;
+        framePairings[i].objects = sb::utility::Span<uint32_t>(objectIt, objectIt + p.numObjects);
+        objectIt += p.numObjects;
+    }
+    assert(objectIt == objects.end());
+
+    return sb::utility::Span<SpriteDraw::SpriteObjectPairing>(framePairings, framePairings + pairings.pairings.size());
+}
+
+sb::utility::StringView FrameParser::copyToFrame(const std::string& str)
+{
+    sb::utility::Span<char> chars = mCurrentFrame.arena->copy(str.data(), str.size());
+    return sb::utility::StringView(chars.begin(), chars.size());
+}
+
+void FrameParser::convertToTreeSprites(TileQuery& query) const
 {
     typedef sb::utility::PixelFormat Format;
-    std::vector<size_t> opaquePixels;
-    bool isBlank = false;
+    const PixelData& data = query.data;
     switch(data.format)
     {
         case Format::RGBA:
-            opaquePixels = rgbaToColorTreeSprite(pixels, data.width, data.height, &isBlank);
+            rgbaToColorTreeSprite(query.pixels, data.width, data.height, query.opaquePixels, &query.isBlank);
             break;
 
         case Format::BGRA:
-            opaquePixels = bgraToColorTreeSprite(pixels, data.width, data.height, &isBlank);
+            bgraToColorTreeSprite(query.pixels, data.width, data.height, query.opaquePixels, &query.isBlank);
             break;
 
-        case Format::ALPHA:
-            return; // No reason to care about alpha.
-
         default:
             SB_THROW("Unimplemented pixel format for color tree.");
     }
 
-
-
-    if(isBlank)
+    if(query.isBlank)
     {
-        mTileCache.removeByArea(data.targetTextureId, data.texX, data.texY, data.width, data.height);
-        Tile tile(data.width, data.height, Tile::Type::BLANK);
-        mTileCache.set(data.targetTextureId, data.texX, data.texY, tile);
+        query.transparency.clear();
         return;
     }
 
-    std::vector<size_t> transparency;
     switch(data.format)
     {
         case Format::RGBA:
@@ -1432,51 +1738,68 @@ void FrameParser::updateTileBuffer(const PixelData& data, const unsigned char* p
             // The alpha value of both formats are in the same place, which is the only
             // thing rgbaToTransparencyTreeSprite cares about. So it's OK to use it
             // for BGRA as well as RGBA.
-            transparency = rgbaToTransparencyTreeSprite(pixels, data.width, data.height);
+            rgbaToTransparencyTreeSprite(query.pixels, data.width, data.height, query.transparency);
             break;
 
-        case Format::ALPHA:
-            return; // No reason to care about alpha.
-
         default:
             SB_THROW("Unimplemented pixel format for transparency tree.");
     }
+}
 
-    std::list<size_t> ids;
-    if(mContext.getSpriteColorTree().find(opaquePixels, ids))
-    {
-        std::list<size_t> tIds;
-        mContext.getSpriteTransparencyTree().find(transparency, tIds);
+FrameParser::Tile FrameParser::recognizeTile(const PixelData& data, const unsigned char* pixels) const
+{
+    TileQuery query;
+    query.data = data;
+    query.pixels = pixels;
+    convertToTreeSprites(query);
+    if(query.isBlank)
+        return Tile(data.width, data.height, Tile::Type::BLANK);
+
+    SequenceTree::BatchQuery treeQuery = createTreeQuery(query);
+    SequenceTree::BatchResults results;
+    SequenceTree::findBatch(mContext.getSpriteColorTree(), mContext.getSpriteTransparencyTree(), &treeQuery, 1, results);
+
+    return createTile(query, results.ids.data(), results.ids.size(), results.isPrimaryFound[0]);
+}
 
-        std::list<size_t> matchingIds;
-        for(size_t id : ids)
-            if(std::find(tIds.begin(), tIds.end(), id) != tIds.end())
-                matchingIds.push_back(id);
+SequenceTree::BatchQuery FrameParser::createTreeQuery(const TileQuery& query)
+{
+    SequenceTree::BatchQuery treeQuery;
+    treeQuery.primary = query.opaquePixels.data();
+    treeQuery.primarySize = query.opaquePixels.size();
+    treeQuery.secondary = query.transparency.data();
+    treeQuery.secondarySize = query.transparency.size();
+    return treeQuery;
+}
 
-        if(matchingIds.empty())
-            return;
+FrameParser::Tile FrameParser::createTile(const TileQuery& query, const unsigned int* matchingIds, size_t numMatchingIds, bool isColorFound) const
+{
+    typedef sb::utility::PixelFormat Format;
+    const PixelData& data = query.data;
+    const unsigned char* pixels = query.pixels;
+    if(isColorFound)
+    {
+        // The matching ids are sorted and unique.
+        if(numMatchingIds == 0)
+            return Tile();
 
-        ids = matchingIds;
-        ids.sort();
-        ids.unique();
         size_t width = 0;
         size_t height = 0;
-        std::list<SpriteDraw::SpriteObjectPairing> pairings;
+        SpriteObjectPairings pairings;
         std::list<std::string> graphicsResourceNames;
         std::list<CombatSquareSample::CombatSquare::Type> combatSquares;
-        for(size_t spriteId : ids)
+        for(size_t i = 0; i < numMatchingIds; i++)
         {
+            const size_t spriteId = matchingIds[i];
             if(spriteId >= Constants::SPRITE_ID_START && spriteId <= Constants::SPRITE_ID_END)
             {
-                SpriteDraw::SpriteObjectPairing pairing;
-                pairing.spriteId = spriteId;
-                std::list<size_t> objects = mContext.getSpriteObjectBindings().getObjects(spriteId);
+                sb::utility::Span<uint32_t> objects = mContext.getSpriteObjectBindings().getObjects(spriteId);
                 if(!objects.empty())
                 {
-                    pairing.objects.swap(objects);
+                    pairings.pairings.push_back({uint32_t(spriteId), uint32_t(objects.size())});
+                    pairings.objects.insert(pairings.objects.end(), objects.begin(), objects.end());
                     width = data.width;
                     height = data.height;
-                    pairings.push_back(pairing);
                 }
             }
             else if(spriteId >= Constants::GRAPHICS_RESOURCE_ID_START && spriteId <= Constants::GRAPHICS_RESOURCE_ID_END)
@@ -1493,7 +1816,7 @@ void FrameParser::updateTileBuffer(const PixelData& data, const unsigned char* p
             }
         }
 
-        assert(!graphicsResourceNames.empty() + !pairings.empty() + !combatSquares.empty() <= 1);
+        assert(!graphicsResourceNames.empty() + !pairings.pairings.empty() + !combatSquares.empty() <= 1);
 
         Tile tile;
         if(!graphicsResourceNames.empty())
@@ -1501,7 +1824,7 @@ void FrameParser::updateTileBuffer(const PixelData& data, const unsigned char* p
             assert(graphicsResourceNames.size() == 1);
             tile = GraphicsResourceNamesData::createTile(data.width, data.height, graphicsResourceNames);
         }
-        else if(!pairings.empty())
+        else if(!pairings.pairings.empty())
         {
             tile = SpriteObjectPairingsData::createTile(data.width, data.height, pairings);
         }
@@ -1513,26 +1836,20 @@ void FrameParser::updateTileBuffer(const PixelData& data, const unsigned char* p
         else
             SB_THROW("This shouldn't happen. :-)");
 
-        mTileCache.removeByArea(data.targetTextureId, data.texX, data.texY, data.width, data.height);
-        mTileCache.set(data.targetTextureId, data.texX, data.texY, tile);
+        return tile;
     }
     else
     {
-        ids.clear();
+        std::list<unsigned int> ids;
         static size_t failCount = 0;
-        if(!mContext.getSpriteTransparencyTree().find(transparency, ids))
+        if(!mContext.getSpriteTransparencyTree().find(query.transparency, ids))
         {
             bool isRecFail = true;
 
             QImage::Format f = data.format == Format::RGBA ? QImage::Format_RGBA8888 : QImage::Format_ARGB32;
             TileNumber n = getTileNumber(pixels, data.width, data.height, data.format);
             if(n.type != TileNumber::Type::INVALID)
-            {
-                isRecFail = false;
-                Tile tile(TileNumberData::createTile(data.width, data.height, n));
-                mTileCache.removeByArea(data.targetTextureId, data.texX, data.texY, data.width, data.height);
-                mTileCache.set(data.targetTextureId, data.texX, data.texY, tile);
-            }
+                return TileNumberData::createTile(data.width, data.height, n);
 
             if(data.width != 1 && data.height != 1 && isRecFail)
             {
@@ -1544,50 +1861,47 @@ void FrameParser::updateTileBuffer(const PixelData& data, const unsigned char* p
                 std::cout << "Failed to recognize pixel data. A dump has been written to \"" << sstream.str() << "\"." << std::endl;
             }
 
-            return;
+            return Tile();
         }
 
         // If we got here, we are either dealing with something using blend frames,
         // or a false positive. This means we will ONLY allow blend framed sprites.
         size_t width;
         size_t height;
-        std::list<SpriteDraw::SpriteObjectPairing> pairings;
+        SpriteObjectPairings pairings;
         for(size_t spriteId : ids)
         {
             if(spriteId >= Constants::SPRITE_ID_START && spriteId <= Constants::SPRITE_ID_END)
             {
-                SpriteDraw::SpriteObjectPairing pairing;
-                pairing.spriteId = spriteId;
-                std::list<size_t> objects = mContext.getSpriteObjectBindings().getObjects(spriteId);
+                sb::utility::Span<uint32_t> objects = mContext.getSpriteObjectBindings().getObjects(spriteId);
                 if(!objects.empty())
                 {
-                    for(size_t object : objects)
+                    const size_t numObjectsBefore = pairings.objects.size();
+                    for(uint32_t object : objects)
                     {
                         for(const Object::SomeInfo& info : mContext.getObjects()[object].someInfos)
                             if(info.spriteInfo.numBlendFrames > 1)
                             {
-                                pairing.objects.push_back(object);
+                                pairings.objects.push_back(object);
                                 break;
                             }
                     }
 
-                    if(!pairing.objects.empty())
+                    const size_t numObjects = pairings.objects.size() - numObjectsBefore;
+                    if(numObjects != 0)
                     {
                         width = data.width;
                         height = data.height;
-                        pairings.push_back(pairing);
+                        pairings.pairings.push_back({uint32_t(spriteId), uint32_t(numObjects)});
                     }
                 }
             }
         }
 
-        if(!pairings.empty())
-        {
-            mTileCache.removeByArea(data.targetTextureId, data.texX, data.texY, data.width, data.height);
-            Tile tile(SpriteObjectPairingsData::createTile(data.width, data.height, pairings));
-            mTileCache.set(data.targetTextureId, data.texX, data.texY, tile);
-        }
-        else if(data.width != 1 && data.height != 1)
+        if(!pairings.pairings.empty())
+            return SpriteObjectPairingsData::createTile(data.width, data.height, pairings);
+
+        if(data.width != 1 && data.height != 1)
         {
             QImage::Format f = data.format == Format::RGBA ? QImage::Format_RGBA8888 : QImage::Format_ARGB32;
             QImage img(pixels, data.width, data.height, f);
@@ -1596,5 +1910,7 @@ void FrameParser::updateTileBuffer(const PixelData& data, const unsigned char* p
             img.save(QString::fromStdString(sstream.str()));
             std::cout << "Failed to recognize pixel data. A dump has been written to \"" << sstream.str() << "\"." << std::endl;
         }
+
+        return Tile();
     }
 }
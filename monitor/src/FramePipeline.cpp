@@ -0,0 +1,339 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/FramePipeline.hpp"
+using namespace GraphicsLayer;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <algorithm>
+///////////////////////////////////
+
+namespace
+{
+    double getMicroseconds(FramePipeline::Clock::time_point start, FramePipeline::Clock::time_point end)
+    {
+        return std::chrono::duration<double, std::micro>(end - start).count();
+    }
+}
+
+///////////////////////////////////
+
+FramePipeline::Timing::Timing(std::string name)
+{
+    stats.name = name;
+}
+
+void FramePipeline::Timing::record(Clock::time_point start, Clock::time_point end)
+{
+    double microseconds = getMicroseconds(start, end);
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.numItems++;
+    stats.busyMicroseconds += microseconds;
+    stats.maxMicroseconds = std::max(stats.maxMicroseconds, microseconds);
+}
+
+FramePipeline::StageStats FramePipeline::Timing::get() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+///////////////////////////////////
+
+FramePipeline::InterpreterStage::InterpreterStage(std::string name, Interpreter interpreter, size_t queueCapacity)
+: interpreter(interpreter)
+, frames(queueCapacity)
+, timing(name)
+{
+
+}
+
+///////////////////////////////////
+
+FramePipeline::FramePipeline(const TibiaContext& context, SegmentSource source, SegmentRelease release, size_t queueCapacity)
+: mSource(source)
+, mRelease(release)
+, mFrameParser(context)
+, mQueueCapacity(queueCapacity)
+, mSegments(queueCapacity)
+, mAcquisitionTiming("Acquisition")
+, mParsingTiming("FrameParser")
+, mLatencyTiming("Acquisition to interpreted")
+, mNumInterpretedFrames(0)
+, mIsStopping(false)
+{
+
+}
+
+FramePipeline::~FramePipeline()
+{
+    stop();
+    joinThreads();
+}
+
+///////////////////////////////////
+
+void FramePipeline::addInterpreter(std::string name, Interpreter interpreter)
+{
+    if(mIsStarted)
+        SB_THROW("Interpreters cannot be added to a started pipeline.");
+
+    mInterpreters.emplace_back(new InterpreterStage(name, interpreter, mQueueCapacity));
+}
+
+///////////////////////////////////
+
+void FramePipeline::setPixelHashResync(PixelHashResync resync)
+{
+    if(mIsStarted)
+        SB_THROW("The pixel hash resync cannot be set on a started pipeline.");
+
+    mPixelHashResync = resync;
+}
+
+///////////////////////////////////
+
+void FramePipeline::start()
+{
+    if(mIsStarted)
+        SB_THROW("Pipeline is already started.");
+
+    mIsStarted = true;
+    for(const std::unique_ptr<InterpreterStage>& stage : mInterpreters)
+    {
+        InterpreterStage* s = stage.get();
+        s->thread = std::thread([this, s]()
+        {
+            runStage([this, s]()
+            {
+                interpret(*s);
+            });
+        });
+    }
+    mParsingThread = std::thread([this]()
+    {
+        runStage([this]()
+        {
+            parse();
+        });
+    });
+    mAcquisitionThread = std::thread([this]()
+    {
+        runStage([this]()
+        {
+            acquire();
+        });
+    });
+}
+
+///////////////////////////////////
+
+void FramePipeline::stop()
+{
+    mIsStopping = true;
+    mSegments.close();
+    for(const std::unique_ptr<InterpreterStage>& stage : mInterpreters)
+        stage->frames.close();
+}
+
+///////////////////////////////////
+
+bool FramePipeline::isStopping() const
+{
+    return mIsStopping;
+}
+
+///////////////////////////////////
+
+void FramePipeline::join()
+{
+    joinThreads();
+    std::lock_guard<std::mutex> lock(mErrorMutex);
+    if(mError)
+        std::rethrow_exception(mError);
+}
+
+///////////////////////////////////
+
+std::vector<FramePipeline::StageStats> FramePipeline::getStageStats() const
+{
+    std::vector<StageStats> stats;
+    stats.push_back(mAcquisitionTiming.get());
+    stats.push_back(mParsingTiming.get());
+    for(const std::unique_ptr<InterpreterStage>& stage : mInterpreters)
+        stats.push_back(stage->timing.get());
+
+    stats.push_back(mLatencyTiming.get());
+    return stats;
+}
+
+///////////////////////////////////
+
+size_t FramePipeline::getNumInterpretedFrames() const
+{
+    return mNumInterpretedFrames;
+}
+
+///////////////////////////////////
+
+const FrameParser& FramePipeline::getFrameParser() const
+{
+    return mFrameParser;
+}
+
+///////////////////////////////////
+
+void FramePipeline::acquire()
+{
+    Segment segment;
+    while(!mIsStopping)
+    {
+        Clock::time_point start = Clock::now();
+        if(!mSource(segment.data, segment.size))
+            break;
+
+        segment.acquireTime = Clock::now();
+        mAcquisitionTiming.record(start, segment.acquireTime);
+        if(!mSegments.push(std::move(segment)))
+            break;
+    }
+
+    mSegments.close();
+}
+
+///////////////////////////////////
+
+void FramePipeline::parse()
+{
+    Segment segment;
+    size_t sequence = 0;
+    while(mSegments.pop(segment))
+    {
+        Clock::time_point start = Clock::now();
+        std::list<Frame> frames = mFrameParser.parse(segment.data, segment.size);
+        Clock::time_point end = Clock::now();
+        mParsingTiming.record(start, end);
+        if(mFrameParser.takePixelHashResyncRequest() && mPixelHashResync)
+            mPixelHashResync();
+
+        // The frames own their data, so the segment can go back right away.
+        mRelease();
+
+        // A frame spanning several segments is stamped with the last one.
+        Clock::time_point acquireTime = segment.acquireTime;
+        for(Frame& f : frames)
+        {
+            std::shared_ptr<TrackedFrame> frame = std::make_shared<TrackedFrame>();
+            frame->frame = std::move(f);
+            frame->sequence = sequence++;
+            frame->acquireTime = acquireTime;
+            frame->parseTime = end;
+            frame->numPendingInterpreters = mInterpreters.size();
+            if(mInterpreters.empty())
+            {
+                mLatencyTiming.record(acquireTime, end);
+                mNumInterpretedFrames++;
+            }
+
+            for(const std::unique_ptr<InterpreterStage>& stage : mInterpreters)
+            {
+                SharedFrame shared = frame;
+                stage->frames.push(std::move(shared));
+            }
+        }
+    }
+
+    for(const std::unique_ptr<InterpreterStage>& stage : mInterpreters)
+        stage->frames.close();
+}
+
+///////////////////////////////////
+
+void FramePipeline::interpret(InterpreterStage& stage)
+{
+    SharedFrame frame;
+    while(stage.frames.pop(frame))
+    {
+        Clock::time_point start = Clock::now();
+        stage.interpreter(frame);
+        Clock::time_point end = Clock::now();
+        stage.timing.record(start, end);
+
+        const TrackedFrame& tracked = static_cast<const TrackedFrame&>(*frame);
+        if(--tracked.numPendingInterpreters == 0)
+        {
+            mLatencyTiming.record(tracked.acquireTime, end);
+            mNumInterpretedFrames++;
+        }
+
+        // Released before waiting, so that the frame may go back to its pool.
+        frame.reset();
+    }
+}
+
+///////////////////////////////////
+
+void FramePipeline::joinThreads()
+{
+    for(std::thread* thread : {&mAcquisitionThread, &mParsingThread})
+        if(thread->joinable())
+            thread->join();
+
+    for(const std::unique_ptr<InterpreterStage>& stage : mInterpreters)
+        if(stage->thread.joinable())
+            stage->thread.join();
+}
+
+///////////////////////////////////
+
+void FramePipeline::runStage(const std::function<void()>& function)
+{
+    try
+    {
+        function();
+    }
+    catch(...)
+    {
+        fail(std::current_exception());
+    }
+}
+
+///////////////////////////////////
+
+void FramePipeline::fail(std::exception_ptr error)
+{
+    {
+        std::lock_guard<std::mutex> lock(mErrorMutex);
+        if(!mError)
+            mError = error;
+    }
+
+    stop();
+}
@@ -0,0 +1,103 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/FramePool.hpp"
+using namespace GraphicsLayer;
+///////////////////////////////////
+
+FramePool::FramePool(size_t maxNumFree)
+: mState(std::make_shared<State>())
+{
+    mState->maxNumFree = maxNumFree;
+}
+
+Frame FramePool::acquire()
+{
+    std::unique_ptr<Storage> storage;
+    {
+        std::lock_guard<std::mutex> lock(mState->mutex);
+        if(!mState->free.empty())
+        {
+            storage = std::move(mState->free.back());
+            mState->free.pop_back();
+        }
+        else
+            mState->numCreated++;
+    }
+
+    if(storage == nullptr)
+        storage.reset(new Storage());
+
+    // Every member aliases the one shared storage. The draw vectors are
+    // shared_ptrs so that consumers may keep a single vector alive.
+    std::shared_ptr<Storage> owner(storage.release(), Recycler{mState});
+    Frame frame;
+    frame.arena = std::shared_ptr<sb::utility::MonotonicArena>(owner, &owner->arena);
+    frame.spriteDraws = std::shared_ptr<std::vector<SpriteDraw>>(owner, &owner->spriteDraws);
+    frame.guiDraws = std::shared_ptr<std::vector<GuiDraw>>(owner, &owner->guiDraws);
+    frame.guiSpriteDraws = std::shared_ptr<std::vector<SpriteDraw>>(owner, &owner->guiSpriteDraws);
+    frame.textDraws = std::shared_ptr<std::vector<TextDraw>>(owner, &owner->textDraws);
+    frame.rectDraws = std::shared_ptr<std::vector<RectDraw>>(owner, &owner->rectDraws);
+    frame.fileIo = std::shared_ptr<std::vector<FileIo>>(owner, &owner->fileIo);
+    frame.miniMapDraws = std::shared_ptr<std::vector<MiniMapDraw>>(owner, &owner->miniMapDraws);
+    return frame;
+}
+
+size_t FramePool::getNumCreated() const
+{
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    return mState->numCreated;
+}
+
+size_t FramePool::getNumFree() const
+{
+    std::lock_guard<std::mutex> lock(mState->mutex);
+    return mState->free.size();
+}
+
+void FramePool::Storage::clear()
+{
+    spriteDraws.clear();
+    guiDraws.clear();
+    guiSpriteDraws.clear();
+    textDraws.clear();
+    rectDraws.clear();
+    fileIo.clear();
+    miniMapDraws.clear();
+    arena.reset();
+}
+
+void FramePool::Recycler::operator()(Storage* storage) const
+{
+    std::unique_ptr<Storage> recycled(storage);
+    recycled->clear();
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if(state->free.size() < state->maxNumFree)
+        state->free.push_back(std::move(recycled));
+}
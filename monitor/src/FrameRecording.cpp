@@ -0,0 +1,139 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/FrameRecording.hpp"
+#include "utility/utility.hpp"
+using namespace GraphicsLayer;
+using namespace GraphicsLayer::FrameRecording;
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <cstring>
+#include <algorithm>
+///////////////////////////////////
+
+// File layout:
+//  char     magic[8]
+//  uint32_t version
+//  uint32_t reserved
+//  Chunks, each:
+//      uint64_t size
+//      uint64_t time
+//      char     data[size], zero padded to a multiple of ALIGNMENT
+namespace
+{
+    const size_t ALIGNMENT = 8;
+
+    size_t getPadding(size_t size)
+    {
+        return (ALIGNMENT - size % ALIGNMENT) % ALIGNMENT;
+    }
+}
+
+///////////////////////////////////
+
+Writer::Writer(const std::string& filePath)
+: mFile(filePath, std::ios::binary)
+, mStart(std::chrono::steady_clock::now())
+{
+    if(!mFile.good())
+        SB_THROW("Could not open frame recording '", filePath, "' for writing.");
+
+    const uint32_t reserved = 0;
+    writeStream(*MAGIC, mFile, sizeof(MAGIC));
+    writeStream(VERSION, mFile);
+    writeStream(reserved, mFile);
+}
+
+///////////////////////////////////
+
+void Writer::write(const char* data, size_t size)
+{
+    const uint64_t chunkSize = size;
+    const uint64_t time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - mStart).count();
+    const char padding[ALIGNMENT] = {};
+    writeStream(chunkSize, mFile);
+    writeStream(time, mFile);
+    if(size > 0)
+        writeStream(*data, mFile, size);
+    writeStream(*padding, mFile, getPadding(size));
+
+    if(mFile.fail())
+        SB_THROW("Failed to write frame recording chunk ", mNumChunks, ".");
+
+    mNumChunks++;
+}
+
+///////////////////////////////////
+
+size_t Writer::getNumChunks() const
+{
+    return mNumChunks;
+}
+
+///////////////////////////////////
+
+Reader::Reader(const std::string& filePath)
+: mFile(filePath)
+{
+    const char* data = mFile.getData();
+    const char* const end = data + mFile.getSize();
+
+    char magic[sizeof(MAGIC)];
+    uint32_t version;
+    uint32_t reserved;
+    if(!readStreamSafe(*magic, data, end, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+        SB_THROW("'", filePath, "' is not a frame recording.");
+
+    if(!readStreamSafe(version, data, end) || !readStreamSafe(reserved, data, end))
+        SB_THROW("Frame recording '", filePath, "' has a truncated header.");
+
+    if(version != VERSION)
+        SB_THROW("Unsupported frame recording version ", version, " in '", filePath, "'.");
+
+    while(data != end)
+    {
+        uint64_t size;
+        uint64_t time;
+        if(!readStreamSafe(size, data, end) || !readStreamSafe(time, data, end) || size > uint64_t(end - data))
+            SB_THROW("Frame recording '", filePath, "' has a truncated chunk ", mChunks.size(), ".");
+
+        mChunks.push_back({time, data, size_t(size)});
+        data += size;
+        data += std::min<size_t>(getPadding(size), end - data);
+    }
+}
+
+///////////////////////////////////
+
+const std::vector<Chunk>& Reader::getChunks() const
+{
+    return mChunks;
+}
@@ -0,0 +1,119 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/GlyphIndex.hpp"
+#include "utility/utility.hpp"
+using namespace GraphicsLayer;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <algorithm>
+#include <map>
+///////////////////////////////////
+
+const size_t GlyphIndex::NO_GLYPH;
+const size_t GlyphIndex::SUM_EPSILON;
+
+GlyphIndex::GlyphIndex(const std::vector<FontSample::Glyph>& glyphs)
+: mGlyphs(glyphs)
+{
+    std::map<std::pair<unsigned short, unsigned short>, size_t> bucketIndices;
+    for(size_t i = 0; i < glyphs.size(); i++)
+    {
+        const FontSample::Glyph& glyph = glyphs[i];
+        auto bucketIt = bucketIndices.insert(std::make_pair(std::make_pair(glyph.width, glyph.height), mBuckets.size()));
+        if(bucketIt.second)
+        {
+            mBuckets.emplace_back();
+            mBuckets.back().width = glyph.width;
+            mBuckets.back().height = glyph.height;
+        }
+        mBuckets[bucketIt.first->second].glyphs.emplace_back(glyph.sum, i);
+
+        std::vector<uint32_t>& sameHash = mExactGlyphs[hash(glyph.data.data(), glyph.width, glyph.height)];
+        auto isSamePixels = [&glyphs, &glyph](uint32_t other)
+        {
+            return glyphs[other].width == glyph.width && glyphs[other].height == glyph.height && glyphs[other].data == glyph.data;
+        };
+        if(std::none_of(sameHash.begin(), sameHash.end(), isSamePixels))
+            sameHash.push_back(i);
+    }
+
+    for(SizeBucket& bucket : mBuckets)
+        std::sort(bucket.glyphs.begin(), bucket.glyphs.end());
+}
+
+uint64_t GlyphIndex::hash(const unsigned char* pixels, unsigned short width, unsigned short height)
+{
+    return sb::utility::hash64(pixels, width * height * FontSample::Glyph::bytesPerPixel, (uint64_t(width) << 16) | height);
+}
+
+size_t GlyphIndex::findExact(const unsigned char* pixels, unsigned short width, unsigned short height) const
+{
+    auto it = mExactGlyphs.find(hash(pixels, width, height));
+    if(it == mExactGlyphs.end())
+        return NO_GLYPH;
+
+    const size_t size = width * height * FontSample::Glyph::bytesPerPixel;
+    for(uint32_t i : it->second)
+    {
+        const FontSample::Glyph& glyph = mGlyphs[i];
+        if(glyph.width == width && glyph.height == height && memcmp(glyph.data.data(), pixels, size) == 0)
+            return i;
+    }
+
+    return NO_GLYPH;
+}
+
+void GlyphIndex::findCandidates(unsigned short width, unsigned short height, size_t sum, std::vector<uint32_t>& candidates) const
+{
+    candidates.clear();
+    for(const SizeBucket& bucket : mBuckets)
+    {
+        const bool isInside = (bucket.width <= width && bucket.height <= height);
+        const bool isContaining = (width <= bucket.width && height <= bucket.height);
+        if(!isInside && !isContaining)
+            continue;
+
+        // sum <= glyphSum * SUM_EPSILON && glyphSum <= sum * SUM_EPSILON
+        auto begin = std::partition_point(bucket.glyphs.begin(), bucket.glyphs.end(), [sum](const std::pair<unsigned int, uint32_t>& glyph)
+        {
+            return size_t(glyph.first) * SUM_EPSILON < sum;
+        });
+        auto end = std::partition_point(begin, bucket.glyphs.end(), [sum](const std::pair<unsigned int, uint32_t>& glyph)
+        {
+            return size_t(glyph.first) <= sum * SUM_EPSILON;
+        });
+
+        for(auto it = begin; it != end; it++)
+            candidates.push_back(it->second);
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+}
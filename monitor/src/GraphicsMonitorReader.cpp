@@ -37,60 +37,151 @@ using namespace GraphicsLayer;
 #include <cassert>
 ///////////////////////////////////
 
-GraphicsMonitorReader::GraphicsMonitorReader(const TibiaClient& client, const TibiaContext& context, const SharedMemoryProtocol::SharedMemorySegment* shm)
+GraphicsMonitorReader::GraphicsMonitorReader(const TibiaClient& client, const TibiaContext& context, SharedMemoryProtocol::SharedMemorySegment* shm)
 : mClient(client)
 , mShm(shm)
-, mFrameParser(context)
+, mPipeline(context, [this](const char*& data, size_t& size){return acquireSegment(data, size);}, [this](){releaseSegment();})
 {
+    mPipeline.addInterpreter("GraphicsMonitorReader", [this](const FramePipeline::SharedFrame& frame)
+    {
+        std::lock_guard<std::mutex> lock(mLatestFrameMutex);
+        mLatestFrame = frame;
+        mLatestFrameChanged.notify_all();
+    });
+    mPipeline.setPixelHashResync([this]()
+    {
+        mShm->isPixelHashResyncRequested = true;
+    });
+    mPipeline.start();
+}
 
-
+GraphicsMonitorReader::~GraphicsMonitorReader()
+{
+    mPipeline.stop();
 }
 
 
-void GraphicsMonitorReader::waitForFrame() const
+const SharedMemoryProtocol::SharedFrameSlot* GraphicsMonitorReader::holdNextSlot()
 {
-    switch(WaitForSingleObject(mShm->semRead, 500))
+    std::lock_guard<std::mutex> lock(mHeldSlotsMutex);
+    const SharedMemoryProtocol::SharedFrameSlot* slot = mShm->frames.getReadSlot(mNumHeldSlots);
+    if(slot != nullptr)
+        mNumHeldSlots++;
+
+    return slot;
+}
+
+const SharedMemoryProtocol::SharedFrameSlot* GraphicsMonitorReader::waitForSlot()
+{
+    const SharedMemoryProtocol::SharedFrameSlot* slot;
+    while((slot = holdNextSlot()) == nullptr)
     {
-        case WAIT_ABANDONED:
-            SB_THROW("Wait abandoned.");
+        if(mPipeline.isStopping())
+            return nullptr;
 
-        case WAIT_OBJECT_0:
-            return;
+        switch(WaitForSingleObject(mShm->frameCommittedEvent, 500))
+        {
+            case WAIT_ABANDONED:
+                SB_THROW("Wait abandoned.");
 
-        case WAIT_TIMEOUT:
-            if(!mClient.isAlive())
-                SB_THROW("Tibia client unexpectedly terminated.");
+            case WAIT_OBJECT_0:
+                break;
 
-            mClient.getInput().sendPaintMessage();
-            waitForFrame();
-            return;
+            case WAIT_TIMEOUT:
+                // The client is polled by getNewFrame(), on the thread that
+                // owns its input.
+                break;
 
-        case WAIT_FAILED:
-        {
-            SB_THROW("Failed wait. Error code: ", GetLastError(), "\n");
+            case WAIT_FAILED:
+            {
+                SB_THROW("Failed wait. Error code: ", GetLastError(), "\n");
+            }
+
+            default:
+                SB_THROW("Unimplemented wait signal.");
         }
+    }
+
+    return slot;
+}
+
+void GraphicsMonitorReader::pollClient() const
+{
+    if(!mClient.isAlive())
+        SB_THROW("Tibia client unexpectedly terminated.");
+
+    mClient.getInput().sendPaintMessage();
+}
 
-        default:
-            SB_THROW("Unimplemented wait signal.");
+void GraphicsMonitorReader::postSlotRelease() const
+{
+    if(SetEvent(mShm->slotReleasedEvent) == 0)
+    {
+        SB_THROW("Could not signal slot released event. Error code: ", GetLastError(), "\n");
     }
 }
 
-void GraphicsMonitorReader::postFrameRequest() const
+bool GraphicsMonitorReader::acquireSegment(const char*& data, size_t& size)
+{
+    // Parsed in place. The client writes to the other slots meanwhile.
+    const SharedMemoryProtocol::SharedFrameSlot* slot = waitForSlot();
+    if(slot == nullptr)
+        return false;
+
+    data = slot->data;
+    size = slot->size;
+
+    std::lock_guard<std::mutex> lock(mRecordingMutex);
+    if(mRecording)
+        mRecording->write(data, size);
+
+    return true;
+}
+
+void GraphicsMonitorReader::releaseSegment()
 {
-    if(ReleaseSemaphore(mShm->semWrite, 1, NULL) == 0)
     {
-        SB_THROW("Could not release shared memory write semaphore. Error code: ", GetLastError(), "\n");
+        std::lock_guard<std::mutex> lock(mHeldSlotsMutex);
+        assert(mNumHeldSlots > 0);
+        mShm->frames.releaseReadSlot();
+        mNumHeldSlots--;
     }
+
+    postSlotRelease();
 }
 
 Frame GraphicsMonitorReader::getNewFrame()
 {
-    postFrameRequest();
-    waitForFrame();
-    std::list<Frame> frames = mFrameParser.parse(mShm);
-    assert(frames.size() == 1);
-    mLatestFrame = frames.front();
-    return frames.front();
+    // The parser has to see every frame, but frames acquired before this
+    // call are stale to the caller.
+    const std::chrono::milliseconds CLIENT_POLL_INTERVAL(500);
+    const FramePipeline::Clock::time_point start = FramePipeline::Clock::now();
+    FramePipeline::Clock::time_point lastPoll = start;
+    std::unique_lock<std::mutex> lock(mLatestFrameMutex);
+    while(mLatestFrame == nullptr || mLatestFrame->acquireTime < start)
+    {
+        if(mPipeline.isStopping())
+        {
+            lock.unlock();
+            mPipeline.join();
+            SB_THROW("Frame pipeline is stopped.");
+        }
+
+        mLatestFrameChanged.wait_for(lock, std::chrono::milliseconds(100));
+
+        // A client that draws nothing commits no frames until it is asked
+        // to paint.
+        const FramePipeline::Clock::time_point now = FramePipeline::Clock::now();
+        if(now - lastPoll >= CLIENT_POLL_INTERVAL)
+        {
+            lock.unlock();
+            pollClient();
+            lock.lock();
+            lastPoll = now;
+        }
+    }
+
+    return mLatestFrame->frame;
 }
 
 const TibiaClient& GraphicsMonitorReader::getClient() const
@@ -98,3 +189,13 @@ const TibiaClient& GraphicsMonitorReader::getClient() const
     return mClient;
 }
 
+void GraphicsMonitorReader::startRecording(const std::string& filePath)
+{
+    std::lock_guard<std::mutex> lock(mRecordingMutex);
+    mRecording.reset(new FrameRecording::Writer(filePath));
+}
+
+std::vector<FramePipeline::StageStats> GraphicsMonitorReader::getStageStats() const
+{
+    return mPipeline.getStageStats();
+}
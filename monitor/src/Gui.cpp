@@ -1281,8 +1281,7 @@ void Gui::parseEquippedItems(size_t& i)
         {
             for(size_t objIndex : pairing.objects)
             {
-                const Object& o = mContext.getObjects()[objIndex];
-                if(o.itemInfo.bodyRestriction != Object::BodyRestriction::NONE)
+                if(mContext.getObjectTraits()[objIndex].getBodyRestriction() != Object::BodyRestriction::NONE)
                 {
                     equippable = objIndex;
                     break;
@@ -1295,7 +1294,7 @@ void Gui::parseEquippedItems(size_t& i)
         assert(equippable != -1);
 
         typedef Object::BodyRestriction B;
-        switch(mContext.getObjects()[equippable].itemInfo.bodyRestriction)
+        switch(mContext.getObjectTraits()[equippable].getBodyRestriction())
         {
             case B::TWO_HANDED:
             case B::WEAPON:
@@ -1319,7 +1318,7 @@ void Gui::parseEquippedItems(size_t& i)
             case B::BELT: mData.equipment[EqType::HIP] = equippable; break;
 
             default:
-                SB_THROW("Unexpected body restriction: ", (int)mContext.getObjects()[equippable].itemInfo.bodyRestriction, '\n');
+                SB_THROW("Unexpected body restriction: ", (int)mContext.getObjectTraits()[equippable].getBodyRestriction(), '\n');
         }
     }
 }
@@ -1368,7 +1367,7 @@ void Gui::parseContainerSprites(size_t& i, Container& c)
         for(const SpriteDraw::SpriteObjectPairing& pairing : draws[i].pairings)
         {
             for(size_t o : pairing.objects)
-                if(mContext.getObjects()[o].itemInfo.isContainer)
+                if(mContext.getObjectTraits()[o].isContainer())
                 {
                     isContainerFound = true;
                     break;
@@ -1400,7 +1399,7 @@ void Gui::parseContainerSprites(size_t& i, Container& c)
         std::set<size_t> pickupables;
         for(const SpriteDraw::SpriteObjectPairing& pairing : d.pairings)
             for(size_t o : pairing.objects)
-                if(mContext.getObjects()[o].itemInfo.isPickupable)
+                if(mContext.getObjectTraits()[o].isPickupable())
                 {
                     pickupables.insert(o);
                 }
@@ -0,0 +1,67 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/ObjectTraits.hpp"
+using namespace GraphicsLayer;
+using namespace sb::tibiaassets;
+///////////////////////////////////
+
+ObjectTraits::Traits::Traits(const Object& o)
+: mType(o.type)
+, mWalkSpeed(o.itemInfo.walkSpeed)
+, mTopOrder(o.itemInfo.topOrder)
+, mOffsetX(o.itemInfo.offsetX)
+, mOffsetY(o.itemInfo.offsetY)
+, mBodyRestriction(o.itemInfo.bodyRestriction)
+{
+    const Object::ItemInfo& i = o.itemInfo;
+    if(i.isGround)
+        mFlags |= GROUND;
+    if(i.isBlocking)
+        mFlags |= BLOCKING;
+    if(i.isMovable)
+        mFlags |= MOVABLE;
+    if(i.isContainer)
+        mFlags |= CONTAINER;
+    if(i.isPickupable)
+        mFlags |= PICKUPABLE;
+    if(!o.someInfos.empty() && o.someInfos.front().spriteInfo.numMounts > 1)
+        mFlags |= HAS_MOUNTS;
+}
+
+ObjectTraits::ObjectTraits(const std::vector<Object>& objects)
+{
+    mTraits.reserve(objects.size());
+    for(const Object& o : objects)
+        mTraits.emplace_back(o);
+}
+
+size_t ObjectTraits::size() const
+{
+    return mTraits.size();
+}
@@ -133,13 +133,13 @@ void OutfitAddonMerger::addOutfit(const Object& outfit)
     }
 }
 
-std::vector<std::shared_ptr<Sprite>> OutfitAddonMerger::processSprite(unsigned int id, size_t width, size_t height, const unsigned char* pixels)
+std::vector<std::shared_ptr<Sprite>> OutfitAddonMerger::processSprite(unsigned int id, size_t width, size_t height, const unsigned char* pixels, size_t stride)
 {
     auto mergersIt = mMerges.find(id);
     if(mergersIt == mMerges.end())
         return {};
 
-    std::shared_ptr<Sprite> sprite = std::make_shared<Sprite>(id, width, height, pixels);
+    std::shared_ptr<Sprite> sprite = std::make_shared<Sprite>(id, width, height, pixels, stride);
     std::vector<std::shared_ptr<Sprite>> merges;
     for(const std::shared_ptr<SnapshotMerger>& m : mergersIt->second)
     {
@@ -161,6 +161,16 @@ bool OutfitAddonMerger::isEmpty() const
     return mMerges.empty();
 }
 
+std::vector<unsigned int> OutfitAddonMerger::getNeededSprites() const
+{
+    std::vector<unsigned int> ids;
+    ids.reserve(mMerges.size());
+    for(const auto& merges : mMerges)
+        ids.push_back(merges.first);
+
+    return ids;
+}
+
 
 std::vector<OutfitAddonMerger::SnapshotMerger::OutfitSnapshot> OutfitAddonMerger::getOutfitSnapshots(const Object& outfit) const
 {
@@ -87,13 +87,13 @@ std::list<Scene::Object> OutfitResolver::getVisibleOutfits(Scene& scene) const
     {
         for(auto it = tile.objects.rbegin(); it != tile.objects.rend(); it++)
         {
-            const Object& o = mContext.getObjects()[it->object];
-            if(o.type == Object::Type::OUTFIT)
+            const ObjectTraits::Traits& o = mContext.getObjectTraits()[it->object];
+            if(o.getType() == Object::Type::OUTFIT)
             {
                 visibleOutfits.push_back(*it);
                 break;
             }
-            else if(o.itemInfo.isGround)
+            else if(o.isGround())
                 break;
         }
     });
@@ -435,7 +435,7 @@ void OutfitResolver::processPlayerCreatures(std::list<TextHpPair>& pairs, std::l
         auto storedIt = mOutfits.find(pairIt->text.string);
         if(matchingOutfitIt != visibleOutfits.end())
         {
-            bool hasMounts = mContext.getObjects()[matchingOutfitIt->object].someInfos.front().spriteInfo.numMounts > 1;
+            bool hasMounts = mContext.getObjectTraits()[matchingOutfitIt->object].hasMounts();
             if(storedIt != mOutfits.end())
             {
                 Outfit& storedOutfit = storedIt->second;
@@ -114,10 +114,10 @@ void Scene::parseCurrentFrame()
         {
             const SpriteInfo::Info& spriteInfo = mContext.getSpriteInfo().get(draw.pairings.front().spriteId);
 
-            const sb::tibiaassets::Object& firstObject = mContext.getObjects()[draw.pairings.front().objects.front()];
+            const ObjectTraits::Traits& firstObject = mContext.getObjectTraits()[draw.pairings.front().objects.front()];
 
-            short x = draw.topLeft.x + firstObject.itemInfo.offsetX;
-            short y = draw.topLeft.y + firstObject.itemInfo.offsetY;
+            short x = draw.topLeft.x + firstObject.getOffsetX();
+            short y = draw.topLeft.y + firstObject.getOffsetY();
 
             short remainderX;
             remainderX = x % Constants::TILE_PIXEL_WIDTH;
@@ -162,7 +162,7 @@ void Scene::parseCurrentFrame()
                     o.layer = tile.numLayers;
                     o.object = obj;
 
-                    tile.knownLayerObjects.push_back(o);
+                    tile.objects.push_back(o);
                 }
             }
             tile.numLayers++;
@@ -173,7 +173,7 @@ void Scene::parseCurrentFrame()
         for(size_t y = 0; y < MAX_VISIBLE_TILES_Y; y++)
         {
             Tile& tile = mData->tiles[x][y];
-            for(Object& object : tile.knownLayerObjects)
+            for(Object& object : tile.objects)
                 object.layer = (tile.numLayers - 1) - object.layer;
         }
 
@@ -194,7 +194,7 @@ std::list<Scene::Object> Scene::get(const std::function<bool(const Object& objec
 //        for(size_t y = 0; y < MAX_VISIBLE_TILES_Y; y++)
 //        {
 //            const Tile& tile = mData->tiles[x][y];
-//            for(const Object& obj : tile.knownLayerObjects)
+//            for(const Object& obj : tile.objects)
 //            {
 //                if(func(obj))
 //                    objects.push_back(obj);
@@ -212,7 +212,7 @@ void Scene::forEach(const std::function<void(const Object& object)>& func) const
         for(size_t y = 0; y < MAX_VISIBLE_TILES_Y; y++)
         {
             const Tile& tile = mData->tiles[x][y];
-            for(const Object& obj : tile.knownLayerObjects)
+            for(const Object& obj : tile.objects)
             {
                 func(obj);
             }
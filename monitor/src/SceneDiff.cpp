@@ -28,6 +28,7 @@
 // Internal ShankBot headers
 #include "monitor/SceneDiff.hpp"
 #include "monitor/Frame.hpp"
+#include "monitor/TibiaContext.hpp"
 using namespace GraphicsLayer;
 ///////////////////////////////////
 
@@ -38,7 +39,8 @@ using namespace GraphicsLayer;
 #include <cassert>
 ///////////////////////////////////
 
-SceneDiff::SceneDiff()
+SceneDiff::SceneDiff(const TibiaContext& context)
+: mContext(context)
 {
     mPrevScene.layers.resize(1);
     mPrevScene.playerLayer = 0;
@@ -46,7 +48,7 @@ SceneDiff::SceneDiff()
 
 void SceneDiff::parse(const Frame& frame, const SceneParser::Data& scene)
 {
-    auto getGround = [](const SceneParser::Tile& t)
+    auto getGround = [this](const SceneParser::Tile& t)
     {
         const sb::tibiaassets::Object* ground = nullptr;
         if(t.isObscured)
@@ -56,7 +58,7 @@ void SceneDiff::parse(const Frame& frame, const SceneParser::Data& scene)
 
         for(const SceneParser::Object& disputes : t.objects)
         {
-            const sb::tibiaassets::Object* o = disputes.disputes.front();
+            const sb::tibiaassets::Object* o = &mContext.getObjects()[disputes.disputes.front()];
             if(o->type == sb::tibiaassets::Object::Type::ITEM &&
                o->itemInfo.isGround &&
                o->itemInfo.topOrder == 0 &&
@@ -173,8 +175,9 @@ void SceneDiff::parse(const Frame& frame, const SceneParser::Data& scene)
         {
             for(const SceneParser::Object& so : t.objects)
             {
-                for(const sb::tibiaassets::Object* o : so.disputes)
+                for(uint32_t id : so.disputes)
                 {
+                    const sb::tibiaassets::Object* o = &mContext.getObjects()[id];
 //                    if(o->type == sb::tibiaassets::Object::Type::ITEM &&
 //                       o->itemInfo.defaultAction != (unsigned short)-1)
 //                    {
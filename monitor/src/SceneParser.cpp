@@ -85,23 +85,25 @@ void SceneParser::parse(const Frame& frame)
     {
         const SpriteDraw& draw = (*mCurrentDraws)[i];
         using AObject = sb::tibiaassets::Object;
-        std::vector<const AObject*> disputes;
+        std::vector<uint32_t> disputes;
         for(const auto& pairing : draw.pairings)
         {
-            for(const size_t objectId : pairing.objects)
-            {
-                disputes.push_back(&mContext.getObjects()[objectId]);
-            }
+            disputes.insert(disputes.end(), pairing.objects.begin(), pairing.objects.end());
         }
         SB_EXPECT_FALSE(disputes.empty());
-        const AObject& firstObject = *disputes.front();
+        const ObjectTraits::Traits& firstObject = mContext.getObjectTraits()[disputes.front()];
         const SpriteInfo::Info& spriteInfo = mContext.getSpriteInfo().get(draw.pairings.front().spriteId);
 
-        if(firstObject.type == AObject::Type::OUTFIT || firstObject.type == AObject::Type::PROJECTILE)
+        if(firstObject.getType() == AObject::Type::OUTFIT || firstObject.getType() == AObject::Type::PROJECTILE)
         {
             NonGridObject o;
             o.drawOrder = i;
-            o.disputes = disputes;
+            o.objects.reserve(disputes.size());
+            for(uint32_t id : disputes)
+            {
+                o.objects.push_back(&mContext.getObjects()[id]);
+            }
+            o.disputes = std::move(disputes);
             float x = (draw.topLeft.x + Constants::TILE_PIXEL_WIDTH * (spriteInfo.tileWidth - 1)) * VIEW_TEX_TO_SCREEN_RATIO_X;
             float y = (draw.topLeft.y + Constants::TILE_PIXEL_HEIGHT * (spriteInfo.tileHeight - 1)) * VIEW_TEX_TO_SCREEN_RATIO_Y;
             o.screenBounds.x = round(x) + mData->screenBounds.x;
@@ -114,7 +116,7 @@ void SceneParser::parse(const Frame& frame)
             o.localBounds.height = Constants::TILE_PIXEL_HEIGHT;
 
             Layer& layer = mData->layers.back();
-            if(firstObject.type == AObject::Type::OUTFIT)
+            if(firstObject.getType() == AObject::Type::OUTFIT)
             {
                 Draw d;
                 d.spriteId = draw.pairings.front().spriteId;
@@ -133,8 +135,8 @@ void SceneParser::parse(const Frame& frame)
         {
             short x = round(draw.topLeft.x);
             short y = round(draw.topLeft.y);
-            x += short(firstObject.itemInfo.offsetX) - mData->offsetX;
-            y += short(firstObject.itemInfo.offsetY) - mData->offsetY;
+            x += short(firstObject.getOffsetX()) - mData->offsetX;
+            y += short(firstObject.getOffsetY()) - mData->offsetY;
 
             short remainderX = x % Constants::TILE_PIXEL_WIDTH;
             short remainderY = y % Constants::TILE_PIXEL_HEIGHT;
@@ -147,7 +149,7 @@ void SceneParser::parse(const Frame& frame)
             assert(tileX >= -VISIBILITY_OFFSET_LOW && tileX < MAX_VISIBLE_TILES_X - VISIBILITY_OFFSET_LOW);
             assert(tileY >= -VISIBILITY_OFFSET_LOW && tileY < MAX_VISIBLE_TILES_Y - VISIBILITY_OFFSET_LOW);
 
-            bool isGround = firstObject.itemInfo.isGround || firstObject.itemInfo.topOrder == 1;
+            bool isGround = firstObject.isGround() || firstObject.getTopOrder() == 1;
             if(isGround)
             {
                 if(!isPrevGround && tileX + tileY < prevTileX + prevTileY)
@@ -160,13 +162,13 @@ void SceneParser::parse(const Frame& frame)
             Tile& tile = layer.gridObjects[tileX + VISIBILITY_OFFSET_LOW][tileY + VISIBILITY_OFFSET_LOW];
             Object o;
             o.drawOrder = i;
-            if(firstObject.itemInfo.isGround && firstObject.itemInfo.topOrder == 0)
+            if(firstObject.isGround() && firstObject.getTopOrder() == 0)
             {
                 tile.isObscured = false;
-                tile.speed = firstObject.itemInfo.walkSpeed;
+                tile.speed = firstObject.getWalkSpeed();
             }
 
-            if(firstObject.itemInfo.isBlocking && !firstObject.itemInfo.isMovable)
+            if(firstObject.isBlocking() && !firstObject.isMovable())
             {
                 tile.isWalkable = false;
             }
@@ -180,8 +182,8 @@ void SceneParser::parse(const Frame& frame)
             mData->draws.push_back(d);
             prevTileX = tileX;
             prevTileY = tileY;
-            o.disputes = disputes;
-            tile.objects.push_back(o);
+            o.disputes = std::move(disputes);
+            tile.objects.push_back(std::move(o));
         }
 
     }
@@ -223,10 +225,10 @@ const SpriteDraw* SceneParser::findFirstGroundTile() const
     {
         for(const auto& pairing : draw.pairings)
         {
-            for(const size_t& id : pairing.objects)
+            for(uint32_t id : pairing.objects)
             {
-                const sb::tibiaassets::Object& obj = mContext.getObjects()[id];
-                if(obj.type == sb::tibiaassets::Object::Type::ITEM && obj.itemInfo.isGround)
+                const ObjectTraits::Traits& obj = mContext.getObjectTraits()[id];
+                if(obj.getType() == sb::tibiaassets::Object::Type::ITEM && obj.isGround())
                 {
                     return &draw;
                 }
@@ -28,6 +28,8 @@
 // Internal ShankBot headers
 #include "monitor/SequenceTree.hpp"
 #include "utility/utility.hpp"
+#include "utility/MappedFile.hpp"
+#include "utility/ThreadPool.hpp"
 using namespace GraphicsLayer;
 ///////////////////////////////////
 
@@ -36,90 +38,286 @@ using namespace GraphicsLayer;
 // STD C++
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <mutex>
+#include <future>
 ///////////////////////////////////
-#include <iostream>
 
-SequenceTree::SequenceTree(const std::vector<std::vector<size_t>>& sequences, const std::vector<unsigned int>& ids)
-: mRoot(new Node(0))
+///////////////////////////////////
+// STD C
+#include <cstring>
+#include <cstdio>
+///////////////////////////////////
+
+const char SequenceTree::MAGIC[8] = {'S', 'B', 'S', 'E', 'Q', 'T', 'R', 'E'};
+const uint32_t SequenceTree::VERSION;
+const size_t SequenceTree::PARTITION_DEPTH;
+
+SequenceTree::Builder::Builder(std::string spillFilePath)
+: mSpillFilePath(spillFilePath)
+, mSpillFile(spillFilePath, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc)
+, mOffsets(1, 0)
+{
+    if(!mSpillFile.is_open())
+        SB_THROW("Could not open sequence tree spill file '", spillFilePath, "'.");
+}
+
+SequenceTree::Builder::~Builder()
+{
+    mSpillFile.close();
+    std::remove(mSpillFilePath.c_str());
+}
+
+size_t SequenceTree::Builder::add(const std::vector<size_t>& sequence, unsigned int id)
+{
+    if(!mSpillFile.is_open())
+        SB_THROW("Cannot add sequences after the tree has been built.");
+
+    mSpillFile.seekp(0, std::ios::end);
+    if(!sequence.empty())
+        sb::utility::writeStream(*sequence.data(), mSpillFile, sequence.size());
+
+    if(mSpillFile.fail())
+        SB_THROW("Failed to write to sequence tree spill file '", mSpillFilePath, "'.");
+
+    mOffsets.push_back(mOffsets.back() + sequence.size());
+    mIds.push_back(id);
+    return mIds.size() - 1;
+}
+
+void SequenceTree::Builder::getSequence(size_t index, std::vector<size_t>& sequence)
+{
+    if(index >= mIds.size())
+        SB_THROW("Sequence index out of range: ", index, ". Have ", mIds.size(), " sequences.");
+
+    if(!mSpillFile.is_open())
+        SB_THROW("Cannot read sequences after the tree has been built.");
+
+    sequence.resize(mOffsets[index + 1] - mOffsets[index]);
+    mSpillFile.seekg(mOffsets[index] * sizeof(size_t));
+    if(!sequence.empty())
+        sb::utility::readStream(*sequence.data(), mSpillFile, sequence.size());
+
+    if(mSpillFile.fail())
+        SB_THROW("Failed to read from sequence tree spill file '", mSpillFilePath, "'.");
+}
+
+size_t SequenceTree::Builder::getNumSequences() const
+{
+    return mIds.size();
+}
+
+std::unique_ptr<SequenceTree> SequenceTree::Builder::build(size_t numThreads)
+{
+    if(!mSpillFile.is_open())
+        SB_THROW("The tree has already been built.");
+
+    mSpillFile.close();
+    if(mSpillFile.fail())
+        SB_THROW("Failed to write sequence tree spill file '", mSpillFilePath, "'.");
+
+    std::unique_ptr<sb::utility::MappedFile> spill;
+    const size_t* data = nullptr;
+    if(mOffsets.back() > 0)
+    {
+        spill.reset(new sb::utility::MappedFile(mSpillFilePath));
+        data = (const size_t*)spill->getData();
+    }
+
+    std::vector<SequenceView> views;
+    views.reserve(mIds.size());
+    for(size_t i = 0; i < mIds.size(); i++)
+        views.push_back({data + mOffsets[i], size_t(mOffsets[i + 1] - mOffsets[i])});
+
+    std::unique_ptr<SequenceTree> tree(new SequenceTree());
+    tree->build(views, mIds, numThreads);
+    return tree;
+}
+
+SequenceTree::SequenceTree(const std::vector<std::vector<size_t>>& sequences, const std::vector<unsigned int>& ids, size_t numThreads)
 {
     if(sequences.size() != ids.size())
         SB_THROW("Element count does not match ID count.");
 
-    for(size_t i = 0; i < sequences.size(); i++)
+    std::vector<SequenceView> views;
+    views.reserve(sequences.size());
+    for(const std::vector<size_t>& sequence : sequences)
+        views.push_back({sequence.data(), sequence.size()});
+
+    build(views, ids, numThreads);
+}
+
+SequenceTree::SequenceTree(std::string filePath)
+{
+    if(isLegacyFile(filePath))
     {
-        if(!sequences[i].empty())
-            insert(mRoot, Element(&sequences[i], ids[i]));
+        std::ifstream file(filePath, std::ios::binary);
+        if(!file.is_open())
+            SB_THROW("Could not open sequence tree file '", filePath, "'.");
+
+        NodePtr root(new Node(0));
+        loadLegacyFile(root, file);
+        flatten(root);
+        return;
     }
 
-    removeEmptyNodes();
-//    computeIgnoredValues();
-    forEachNode(mRoot, [](NodePtr& node)
-    {
-        for(Element& element : node->elements)
-        {
-            element.numValuesIgnored = element.sequence->size() - node->level;
-//            std::cout << "values ignored " << element.id << ": " << element.numValuesIgnored << std::endl;
-        }
-    });
+    mFile.reset(new sb::utility::MappedFile(filePath));
+    setImage(mFile->getData(), mFile->getSize());
 }
 
-void SequenceTree::removeEmptyNodes()
+SequenceTree::~SequenceTree()
 {
-    forEachNode(mRoot, [](NodePtr& node)
-    {
-        for(auto& pair : node->children)
-        {
-            NodePtr& child = pair.second;
-            while(child->children.size() == 1 && child->elements.empty())
-            {
-                Node* pointerToGrandChild = child->children.begin()->second.release();
-                child.reset(pointerToGrandChild);
-            }
-        }
-    });
 }
 
-void SequenceTree::forEachNode(NodePtr& node, std::function<void(NodePtr& node)> function)
+bool SequenceTree::isLegacyFile(const std::string& filePath)
 {
-    function(node);
-    for(auto& child : node->children)
-        forEachNode(child.second, function);
+    std::ifstream file(filePath, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    if(!file.read(magic, sizeof(magic)))
+        return true;
+
+    return memcmp(magic, MAGIC, sizeof(MAGIC)) != 0;
 }
 
-SequenceTree::SequenceTree(std::string filePath)
-: mRoot(new Node(0))
+void SequenceTree::convertLegacyFile(const std::string& srcPath, const std::string& destPath)
 {
-    loadFromBinaryFile(filePath);
+    SequenceTree tree(srcPath);
+    tree.writeToBinaryFile(destPath);
 }
 
-void SequenceTree::loadFromBinaryFile(std::string filePath)
+void SequenceTree::build(const std::vector<SequenceView>& sequences, const std::vector<unsigned int>& ids, size_t numThreads)
 {
-    std::ifstream file(filePath, std::ios::binary);
+    if(sequences.size() > UINT32_MAX)
+        SB_THROW("Too many sequences for one sequence tree.");
 
-    loadFromBinaryFile(mRoot, file);
+    std::vector<uint32_t> indices;
+    indices.reserve(sequences.size());
+    for(size_t i = 0; i < sequences.size(); i++)
+        if(sequences[i].size > 0)
+            indices.push_back(i);
+
+    // The top of the tree is built right away. The subtrees below it do not
+    // share any sequences, so they are built in parallel, largest first.
+    std::vector<PendingNode> pendingNodes;
+    NodePtr root = buildNode(sequences, ids, indices.data(), indices.data() + indices.size(), 0, 0, &pendingNodes);
+    std::sort(pendingNodes.begin(), pendingNodes.end(), [](const PendingNode& lhs, const PendingNode& rhs)
+    {
+        return lhs.end - lhs.begin > rhs.end - rhs.begin;
+    });
 
-    file.close();
+    sb::utility::ThreadPool pool(numThreads);
+    std::vector<std::future<void>> futures;
+    futures.reserve(pendingNodes.size());
+    for(const PendingNode& pending : pendingNodes)
+    {
+        futures.push_back(pool.push([&sequences, &ids, pending]()
+        {
+            *pending.node = buildNode(sequences, ids, pending.begin, pending.end, pending.level, PARTITION_DEPTH, nullptr);
+        }));
+    }
+    for(std::future<void>& future : futures)
+        future.get();
+
+    flatten(root);
+}
+
+// Builds the same tree as inserting the sequences one by one in index order
+// did. A node holds the sequences that end at it. As long as more than one
+// sequence reaches a node, the others are passed on to its children, keyed
+// by their value at the node's level. A lone sequence stays at the first
+// node it reaches. Nodes that would have no sequences and only one child
+// are skipped, so the level of a node can be more than one below its
+// parent's. Subtrees only depend on their own sequences.
+SequenceTree::NodePtr SequenceTree::buildNode
+(
+    const std::vector<SequenceView>& sequences,
+    const std::vector<unsigned int>& ids,
+    uint32_t* begin,
+    uint32_t* end,
+    size_t level,
+    size_t depth,
+    std::vector<PendingNode>* pendingNodes
+)
+{
+    NodePtr node(new Node(level));
+    if(end - begin == 1)
+    {
+        node->elements.push_back(Element(ids[*begin], sequences[*begin].size - level));
+        return node;
+    }
+
+    uint32_t* branches = std::partition(begin, end, [&sequences, level](uint32_t i)
+    {
+        return sequences[i].size <= level;
+    });
+
+    // A single sequence going on stays too, if it was added before every
+    // sequence ending here.
+    if(end - branches == 1 && std::all_of(begin, branches, [branches](uint32_t i){return i > *branches;}))
+        branches = end;
+
+    for(uint32_t* it = begin; it != branches; it++)
+        node->elements.push_back(Element(ids[*it], sequences[*it].size - level));
+
+    auto getKey = [&sequences](uint32_t i, size_t level)
+    {
+        return sequences[i].data[level];
+    };
+    std::sort(branches, end, [&getKey, level](uint32_t lhs, uint32_t rhs)
+    {
+        return getKey(lhs, level) < getKey(rhs, level);
+    });
+
+    for(uint32_t* childBegin = branches; childBegin != end;)
+    {
+        const size_t key = getKey(*childBegin, level);
+        uint32_t* childEnd = childBegin + 1;
+        while(childEnd != end && getKey(*childEnd, level) == key)
+            childEnd++;
+
+        size_t childLevel = level + 1;
+        if(childEnd - childBegin > 1)
+        {
+            auto isSkipped = [&](size_t level)
+            {
+                const size_t firstKey = sequences[*childBegin].size > level ? getKey(*childBegin, level) : 0;
+                for(uint32_t* it = childBegin; it != childEnd; it++)
+                    if(sequences[*it].size <= level || getKey(*it, level) != firstKey)
+                        return false;
+
+                return true;
+            };
+
+            while(isSkipped(childLevel))
+                childLevel++;
+        }
+
+        NodePtr& child = node->children[key];
+        if(pendingNodes != nullptr && depth + 1 >= PARTITION_DEPTH)
+            pendingNodes->push_back({&child, childBegin, childEnd, childLevel});
+        else
+            child = buildNode(sequences, ids, childBegin, childEnd, childLevel, depth + 1, pendingNodes);
+
+        childBegin = childEnd;
+    }
+
+    return node;
 }
 
-void SequenceTree::loadFromBinaryFile(NodePtr& node, std::istream& file)
+void SequenceTree::loadLegacyFile(NodePtr& node, std::istream& file)
 {
     unsigned int numElements;
     file.read((char*)&numElements, sizeof(numElements));
     if(numElements > 0)
     {
-        unsigned int* elements = new unsigned int[numElements];
-        int* numValuesIgnored = new int[numElements];
-        file.read((char*)elements, sizeof(unsigned int) * numElements);
-        file.read((char*)numValuesIgnored, sizeof(int) * numElements);
+        std::vector<unsigned int> elements(numElements);
+        std::vector<int> numValuesIgnored(numElements);
+        file.read((char*)elements.data(), sizeof(unsigned int) * numElements);
+        file.read((char*)numValuesIgnored.data(), sizeof(int) * numElements);
         for(size_t i = 0; i < numElements; i++)
         {
-            node->elements.push_back(Element(nullptr, elements[i]));
-            node->elements.back().numValuesIgnored = numValuesIgnored[i];
+            node->elements.push_back(Element(elements[i], numValuesIgnored[i]));
         }
-
-
-        delete[] elements;
-        delete[] numValuesIgnored;
     }
 
     unsigned int level;
@@ -129,189 +327,388 @@ void SequenceTree::loadFromBinaryFile(NodePtr& node, std::istream& file)
     unsigned short numChildren;
     file.read((char*)&numChildren, sizeof(numChildren));
 
+    if(!file)
+        SB_THROW("Unexpected end of legacy sequence tree file.");
+
     if(numChildren > 0)
     {
-        size_t* children = new size_t[numChildren];
-        file.read((char*)children, sizeof(size_t) * numChildren);
+        std::vector<size_t> children(numChildren);
+        file.read((char*)children.data(), sizeof(size_t) * numChildren);
         for(size_t i = 0; i < numChildren; i++)
         {
             auto it = node->children.insert(std::make_pair(children[i], NodePtr(new Node(node->level + 1))));
-            loadFromBinaryFile(it.first->second, file);
+            loadLegacyFile(it.first->second, file);
         }
-
-        delete[] children;
     }
 }
 
-
-void SequenceTree::writeToBinaryFile(const NodePtr& node, std::ostream& file) const
+SequenceTree::Layout SequenceTree::computeLayout(const Header& header)
 {
-    unsigned int* elements = new unsigned int[node->elements.size()];
-    int* numValuesIgnored = new int[node->elements.size()];
-    size_t i = 0;
-    for(const Element& element : node->elements)
+    auto align = [](size_t offset)
     {
-        elements[i] = element.id;
-        numValuesIgnored[i] = element.numValuesIgnored;
-
-        i++;
-    }
-
-    unsigned int numElements = node->elements.size();
-
-
-    file.write((char*)&numElements, sizeof(numElements));
-    file.write((char*)elements, sizeof(unsigned int) * node->elements.size());
-    file.write((char*)numValuesIgnored, sizeof(int) * node->elements.size());
-    delete[] elements;
-    delete[] numValuesIgnored;
-
-    unsigned int level = node->level;
-    file.write((char*)&level, sizeof(level));
-
-    unsigned short numChildren = node->children.size();
-    file.write((char*)&numChildren, sizeof(numChildren));
-
-    size_t* children = new size_t[node->children.size()];
-    i = 0;
-    for(const auto& pair : node->children)
-        children[i++] = pair.first;
-
-    file.write((char*)children, sizeof(size_t) * node->children.size());
-    delete[] children;
-
-    for(const auto& pair : node->children)
-        writeToBinaryFile(pair.second, file);
+        return (offset + 7) & ~size_t(7);
+    };
+
+    Layout l;
+    l.levels = align(sizeof(Header));
+    l.childOffsets = align(l.levels + sizeof(uint32_t) * header.numNodes);
+    l.childKeys = align(l.childOffsets + sizeof(uint32_t) * (size_t(header.numNodes) + 1));
+    l.childNodes = align(l.childKeys + sizeof(size_t) * header.numEdges);
+    l.elementOffsets = align(l.childNodes + sizeof(uint32_t) * header.numEdges);
+    l.elementIds = align(l.elementOffsets + sizeof(uint32_t) * (size_t(header.numNodes) + 1));
+    l.elementNumValuesIgnored = align(l.elementIds + sizeof(uint32_t) * header.numElements);
+    l.size = align(l.elementNumValuesIgnored + sizeof(int32_t) * header.numElements);
+    return l;
 }
 
-
-
-void SequenceTree::insert(NodePtr& node, Element element)
+void SequenceTree::flatten(const NodePtr& root)
 {
-    if(node->level >= element.sequence->size())
+    // Breadth first, so the children of a node get consecutive indices
+    // and its edges end up next to each other.
+    std::vector<const Node*> nodes;
+    size_t numEdges = 0;
+    size_t numElements = 0;
+    nodes.push_back(root.get());
+    for(size_t i = 0; i < nodes.size(); i++)
     {
-        node->elements.push_back(element);
-        return;
+        const Node* node = nodes[i];
+        numEdges += node->children.size();
+        numElements += node->elements.size();
+
+        std::vector<std::pair<size_t, const Node*>> children;
+        for(const auto& pair : node->children)
+            children.emplace_back(pair.first, pair.second.get());
+        std::sort(children.begin(), children.end());
+        for(const auto& child : children)
+            nodes.push_back(child.second);
     }
 
-
-    if(!node->elements.empty())
+    if(nodes.size() > UINT32_MAX || numEdges > UINT32_MAX || numElements > UINT32_MAX)
+        SB_THROW("Sequence tree too large for the flat format.");
+
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.keySize = sizeof(size_t);
+    header.numNodes = nodes.size();
+    header.numEdges = numEdges;
+    header.numElements = numElements;
+    header.reserved = 0;
+    Layout l = computeLayout(header);
+
+    mBuffer.assign((l.size + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+    char* data = (char*)mBuffer.data();
+    memcpy(data, &header, sizeof(header));
+    uint32_t* levels = (uint32_t*)(data + l.levels);
+    uint32_t* childOffsets = (uint32_t*)(data + l.childOffsets);
+    size_t* childKeys = (size_t*)(data + l.childKeys);
+    uint32_t* childNodes = (uint32_t*)(data + l.childNodes);
+    uint32_t* elementOffsets = (uint32_t*)(data + l.elementOffsets);
+    uint32_t* elementIds = (uint32_t*)(data + l.elementIds);
+    int32_t* elementNumValuesIgnored = (int32_t*)(data + l.elementNumValuesIgnored);
+
+    uint32_t edge = 0;
+    uint32_t element = 0;
+    uint32_t nextChild = 1;
+    for(size_t i = 0; i < nodes.size(); i++)
     {
-        node->elements.push_back(element);
-
-        for(auto it = node->elements.begin(); it != node->elements.end();)
+        const Node* node = nodes[i];
+        levels[i] = node->level;
+
+        childOffsets[i] = edge;
+        std::vector<size_t> keys;
+        for(const auto& pair : node->children)
+            keys.push_back(pair.first);
+        std::sort(keys.begin(), keys.end());
+        for(size_t key : keys)
         {
-            if(node->level < it->sequence->size())
-            {
-                if(node->level > 16000)
-                    std::cout << "Sequence tree getting deep... Level at " << node->level << ". Did you insert identical sequences?" << std::endl;
-
-                auto child = node->children.insert(std::make_pair(it->sequence->operator[](node->level), NodePtr(new Node(node->level + 1))));
-                insert(child.first->second, *it);
+            childKeys[edge] = key;
+            childNodes[edge] = nextChild++;
+            edge++;
+        }
 
-                node->elements.erase(it++);
-            }
-            else
-                it++;
+        elementOffsets[i] = element;
+        std::vector<std::pair<unsigned int, int>> elements;
+        for(const Element& e : node->elements)
+            elements.emplace_back(e.id, e.numValuesIgnored);
+        std::sort(elements.begin(), elements.end());
+        for(const auto& e : elements)
+        {
+            elementIds[element] = e.first;
+            elementNumValuesIgnored[element] = e.second;
+            element++;
         }
     }
-    else
+    childOffsets[nodes.size()] = edge;
+    elementOffsets[nodes.size()] = element;
+
+    setImage(data, l.size);
+}
+
+void SequenceTree::setImage(const char* data, size_t size)
+{
+    if(size < sizeof(Header))
+        SB_THROW("Sequence tree image too small.");
+
+    const Header& header = *(const Header*)data;
+    if(memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+        SB_THROW("Not a sequence tree image.");
+
+    if(header.version != VERSION)
+        SB_THROW("Unsupported sequence tree version: ", header.version, ". Expected ", VERSION, ".");
+
+    if(header.keySize != sizeof(size_t))
+        SB_THROW("Sequence tree key size ", header.keySize, " does not match size_t (", sizeof(size_t), ").");
+
+    if(header.numNodes == 0)
+        SB_THROW("Sequence tree has no root.");
+
+    Layout l = computeLayout(header);
+    if(l.size != size)
+        SB_THROW("Sequence tree image size mismatch. Expected ", l.size, " bytes, got ", size, ".");
+
+    mData = data;
+    mDataSize = size;
+    mHeader = &header;
+    mLevels = (const uint32_t*)(data + l.levels);
+    mChildOffsets = (const uint32_t*)(data + l.childOffsets);
+    mChildKeys = (const size_t*)(data + l.childKeys);
+    mChildNodes = (const uint32_t*)(data + l.childNodes);
+    mElementOffsets = (const uint32_t*)(data + l.elementOffsets);
+    mElementIds = (const uint32_t*)(data + l.elementIds);
+    mElementNumValuesIgnored = (const int32_t*)(data + l.elementNumValuesIgnored);
+
+    validateImage();
+}
+
+void SequenceTree::validateImage() const
+{
+    // Images may come from files, so every index is checked once here
+    // instead of on every lookup. Children always come after their parent
+    // and one level deeper, so lookups terminate.
+    const Header& header = *mHeader;
+    if(mChildOffsets[0] != 0 || mChildOffsets[header.numNodes] != header.numEdges)
+        SB_THROW("Corrupt sequence tree image. Child offsets do not cover the edges.");
+
+    if(mElementOffsets[0] != 0 || mElementOffsets[header.numNodes] != header.numElements)
+        SB_THROW("Corrupt sequence tree image. Element offsets do not cover the elements.");
+
+    // Non-decreasing offsets from zero up to the counts stay in range.
+    for(uint32_t node = 0; node < header.numNodes; node++)
+        if(mChildOffsets[node] > mChildOffsets[node + 1] || mElementOffsets[node] > mElementOffsets[node + 1])
+            SB_THROW("Corrupt sequence tree image. Offsets of node ", node, " are decreasing.");
+
+    for(uint32_t node = 0; node < header.numNodes; node++)
     {
-        if(node->children.empty())
-        {
-            node->elements.push_back(element);
-            return;
-        }
-        else
+        for(uint32_t edge = mChildOffsets[node]; edge < mChildOffsets[node + 1]; edge++)
         {
-            auto it = node->children.insert(std::make_pair(element.sequence->operator[](node->level), NodePtr(new Node(node->level + 1))));
-            insert(it.first->second, element);
+            const uint32_t child = mChildNodes[edge];
+            if(child <= node || child >= header.numNodes)
+                SB_THROW("Corrupt sequence tree image. Edge ", edge, " points to node ", child, ".");
+
+            if(mLevels[child] <= mLevels[node])
+                SB_THROW("Corrupt sequence tree image. Node ", child, " is not deeper than its parent.");
+
+            if(edge > mChildOffsets[node] && mChildKeys[edge - 1] >= mChildKeys[edge])
+                SB_THROW("Corrupt sequence tree image. Children of node ", node, " are not sorted.");
         }
     }
 }
 
 size_t SequenceTree::getSize() const
 {
-    return getSize(mRoot);
+    return mHeader->numElements;
 }
 
-size_t SequenceTree::getSize(const NodePtr& node) const
+uint32_t SequenceTree::findNode(const size_t* sequence, size_t size) const
 {
-    size_t size = 0;
-    for(const auto& pair : node->children)
-        size += getSize(pair.second);
+    uint32_t node = 0;
+    for(size_t i = mLevels[node]; i < size; i = mLevels[node])
+    {
+        const size_t* begin = mChildKeys + mChildOffsets[node];
+        const size_t* end = mChildKeys + mChildOffsets[node + 1];
+        const size_t* it = std::lower_bound(begin, end, sequence[i]);
 
-    size += node->elements.size();
+        if(it == end || *it != sequence[i])
+        {
+            break;
+        }
 
-    return size;
+        node = mChildNodes[it - mChildKeys];
+    }
+
+    return node;
 }
 
 bool SequenceTree::find(const std::vector<size_t>& sequence, std::list<unsigned int>& ids) const
 {
-    Node* node = mRoot.get();
-    for(size_t i = node->level; i < sequence.size(); i = node->level)
-    {
-        auto it = node->children.find(sequence[i]);
+    const uint32_t node = findNode(sequence.data(), sequence.size());
 
-        if(it == node->children.end())
+    bool foundMatch = false;
+    const int numValuesIgnored = sequence.size() - mLevels[node];
+    for(uint32_t i = mElementOffsets[node]; i < mElementOffsets[node + 1]; i++)
+    {
+        if(mElementNumValuesIgnored[i] == numValuesIgnored)
         {
-            break;
+            ids.push_back(mElementIds[i]);
+            foundMatch = true;
         }
-
-        node = it->second.get();
     }
 
-    bool foundMatch = false;
-    for(const Element& element : node->elements)
+    return foundMatch;
+}
+
+void SequenceTree::findBatch
+(
+    const SequenceTree& primaryTree,
+    const SequenceTree& secondaryTree,
+    const BatchQuery* queries,
+    size_t numQueries,
+    BatchResults& results,
+    sb::utility::ThreadPool* pool
+)
+{
+    results.offsets.resize(numQueries + 1);
+    results.offsets[0] = 0;
+    results.isPrimaryFound.resize(numQueries);
+    results.ids.clear();
+
+    if(pool == nullptr)
+    {
+        findRange(primaryTree, secondaryTree, queries, 0, numQueries, results, results.ids);
+    }
+    else
     {
-        const int numValuesIgnored = sequence.size() - node->level;
+        // Each range collects its ids separately, and they are stitched
+        // together in query order afterwards.
+        const size_t GRAIN_SIZE = 16;
+        const size_t maxNumRanges = pool->getNumThreads() + 1;
+        if(results.rangeIds.size() < maxNumRanges)
+            results.rangeIds.resize(maxNumRanges);
+
+        std::vector<std::pair<size_t, size_t>> ranges(maxNumRanges, std::make_pair(0, 0));
+        std::mutex rangesMutex;
+        size_t numRanges = 0;
+        pool->parallelFor(numQueries, GRAIN_SIZE, [&](size_t begin, size_t end)
+        {
+            size_t range;
+            {
+                std::lock_guard<std::mutex> lock(rangesMutex);
+                range = numRanges++;
+                ranges[range] = std::make_pair(begin, end);
+            }
+
+            std::vector<unsigned int>& ids = results.rangeIds[range];
+            ids.clear();
+            findRange(primaryTree, secondaryTree, queries, begin, end, results, ids);
+        });
 
-        if(element.numValuesIgnored == numValuesIgnored)
+        std::vector<size_t> order(numRanges);
+        for(size_t i = 0; i < numRanges; i++)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&ranges](size_t lhs, size_t rhs)
         {
-            ids.push_back(element.id);
-            foundMatch = true;
+            return ranges[lhs].first < ranges[rhs].first;
+        });
+
+        for(size_t range : order)
+        {
+            const std::vector<unsigned int>& ids = results.rangeIds[range];
+            results.ids.insert(results.ids.end(), ids.begin(), ids.end());
         }
     }
 
-    if(!foundMatch)
-        return false;
+    // findRange leaves the number of ids of query i in offsets[i + 1].
+    for(size_t i = 0; i < numQueries; i++)
+        results.offsets[i + 1] += results.offsets[i];
+}
+
+void SequenceTree::findRange
+(
+    const SequenceTree& primaryTree,
+    const SequenceTree& secondaryTree,
+    const BatchQuery* queries,
+    size_t begin,
+    size_t end,
+    BatchResults& results,
+    std::vector<unsigned int>& ids
+)
+{
+    for(size_t q = begin; q < end; q++)
+    {
+        const BatchQuery& query = queries[q];
+        const size_t numIdsBefore = ids.size();
+
+        // Both id runs are sorted, so the intersection is a single merge pass
+        // skipping the elements that do not match the length of the query.
+        const uint32_t pNode = primaryTree.findNode(query.primary, query.primarySize);
+        const int pNumValuesIgnored = query.primarySize - primaryTree.mLevels[pNode];
+        uint32_t p = primaryTree.mElementOffsets[pNode];
+        const uint32_t pEnd = primaryTree.mElementOffsets[pNode + 1];
+
+        const uint32_t sNode = secondaryTree.findNode(query.secondary, query.secondarySize);
+        const int sNumValuesIgnored = query.secondarySize - secondaryTree.mLevels[sNode];
+        uint32_t s = secondaryTree.mElementOffsets[sNode];
+        const uint32_t sEnd = secondaryTree.mElementOffsets[sNode + 1];
+
+        bool isPrimaryFound = false;
+        while(p < pEnd)
+        {
+            if(primaryTree.mElementNumValuesIgnored[p] != pNumValuesIgnored)
+            {
+                p++;
+                continue;
+            }
+            isPrimaryFound = true;
+
+            const unsigned int id = primaryTree.mElementIds[p];
+            while(s < sEnd && (secondaryTree.mElementIds[s] < id || secondaryTree.mElementNumValuesIgnored[s] != sNumValuesIgnored))
+                s++;
+
+            if(s < sEnd && secondaryTree.mElementIds[s] == id && (ids.size() == numIdsBefore || ids.back() != id))
+                ids.push_back(id);
+
+            p++;
+        }
 
-    return true;
+        results.isPrimaryFound[q] = isPrimaryFound;
+        results.offsets[q + 1] = ids.size() - numIdsBefore;
+    }
 }
 
 
 void SequenceTree::writeToBinaryFile(std::string filePath) const
 {
     std::ofstream file(filePath, std::ios::binary);
-    writeToBinaryFile(mRoot, file);
+    file.write(mData, mDataSize);
     file.close();
 }
 
 std::list<size_t> SequenceTree::trace(unsigned int id) const
 {
     std::list<size_t> breadcrumbs;
-    bool isFound = false;
-    trace(mRoot, id, isFound, breadcrumbs);
 
-    return breadcrumbs;
-}
+    const uint32_t* elementIdsEnd = mElementIds + mHeader->numElements;
+    const uint32_t* element = std::find(mElementIds, elementIdsEnd, id);
+    if(element == elementIdsEnd)
+        return breadcrumbs;
 
-void SequenceTree::trace(const NodePtr& node, unsigned int id, bool& isFound, std::list<size_t>& breadcrumbs) const
-{
-    for(const Element& element : node->elements)
-        if(element.id == id)
-        {
-            isFound = true;
-            return;
-        }
+    const uint32_t elementIndex = element - mElementIds;
+    const uint32_t* offsetsEnd = mElementOffsets + mHeader->numNodes + 1;
+    uint32_t node = std::upper_bound(mElementOffsets, offsetsEnd, elementIndex) - mElementOffsets - 1;
 
-    for(const auto& pair : node->children)
+    const uint32_t NO_PARENT = UINT32_MAX;
+    std::vector<uint32_t> parentEdges(mHeader->numNodes, NO_PARENT);
+    for(uint32_t n = 0; n < mHeader->numNodes; n++)
+        for(uint32_t edge = mChildOffsets[n]; edge < mChildOffsets[n + 1]; edge++)
+            parentEdges[mChildNodes[edge]] = edge;
+
+    while(parentEdges[node] != NO_PARENT)
     {
-        trace(pair.second, id, isFound, breadcrumbs);
-        if(isFound)
-        {
-            breadcrumbs.push_front(pair.first);
-            return;
-        }
+        uint32_t edge = parentEdges[node];
+        breadcrumbs.push_front(mChildKeys[edge]);
+        node = std::upper_bound(mChildOffsets, mChildOffsets + mHeader->numNodes + 1, edge) - mChildOffsets - 1;
     }
+
+    return breadcrumbs;
 }
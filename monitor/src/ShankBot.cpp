@@ -30,9 +30,11 @@
 #include "monitor/VersionControl.hpp"
 #include "monitor/SequenceTree.hpp"
 #include "monitor/SpriteObjectBindings.hpp"
+#include "monitor/SpriteSequenceCache.hpp"
 #include "utility/file.hpp"
 #include "tibiaassets/CatalogContent.hpp"
 #include "tibiaassets/SpriteReader.hpp"
+#include "tibiaassets/SpriteAtlas.hpp"
 #include "tibiaassets/GraphicsResourceReader.hpp"
 #include "tibiaassets/AppearancesReader.hpp"
 #include "monitor/Constants.hpp"
@@ -51,11 +53,100 @@ using namespace sb::tibiaassets;
 #include <iostream>
 #include <memory>
 #include <cassert>
+#include <unordered_map>
+#include <chrono>
+#include <set>
+#include <algorithm>
 ///////////////////////////////////
 
 ///////////////////////////////////
 // STD C
 #include <unistd.h>
+#include <cstring>
+///////////////////////////////////
+
+namespace
+{
+    // Finds sequences identical to ones added to a tree builder before, in
+    // constant time. Only hashes are kept, the sequences are read back from
+    // the builder on a hash match.
+    class SequenceSet
+    {
+        public:
+            explicit SequenceSet(SequenceTree::Builder& sequences)
+            : mSequences(sequences)
+            {
+            }
+
+            // Returns the index of an identical sequence, or -1 if there is none.
+            size_t find(const std::vector<size_t>& sequence)
+            {
+                auto range = mIndices.equal_range(hash(sequence));
+                for(auto it = range.first; it != range.second; it++)
+                {
+                    mSequences.getSequence(it->second, mCandidate);
+                    if(mCandidate == sequence)
+                        return it->second;
+                }
+
+                return -1;
+            }
+
+            void insert(const std::vector<size_t>& sequence, size_t index)
+            {
+                mIndices.emplace(hash(sequence), index);
+            }
+
+        private:
+            static uint64_t hash(const std::vector<size_t>& sequence)
+            {
+                return sb::utility::hash64(sequence.data(), sequence.size() * sizeof(size_t));
+            }
+
+        private:
+            SequenceTree::Builder& mSequences;
+            std::unordered_multimap<uint64_t, size_t> mIndices;
+            std::vector<size_t> mCandidate;
+    };
+
+    struct SheetInput
+    {
+        const CatalogContent::SpriteSheet* sheet;
+        uint64_t key;
+    };
+
+    struct FontParameters
+    {
+        const char* family;
+        float minPointSize;
+        float maxPointSize;
+        unsigned char styleFlags;
+    };
+
+    const FontParameters FONTS[] =
+    {
+        {"Verdana", 6.f, 10.f, FontSample::Style::BOLD | FontSample::Style::NORMAL},
+        {"Verdana", 13.f, 15.f, FontSample::Style::BOLD | FontSample::Style::NORMAL},
+    };
+
+    // Part of every tree sprite key. Bump when the way sprites are turned
+    // into tree sequences changes, so that cached sequences are remade.
+    const uint64_t SPRITE_SEQUENCE_VERSION = 1;
+
+    uint64_t getFontsKey()
+    {
+        uint64_t key = 0;
+        for(const FontParameters& font : FONTS)
+        {
+            const float sizes[] = {font.minPointSize, font.maxPointSize};
+            key = sb::utility::hash64(font.family, strlen(font.family), key);
+            key = sb::utility::hash64(sizes, sizeof(sizes), key);
+            key = sb::utility::hash64(&font.styleFlags, sizeof(font.styleFlags), key);
+        }
+        return key;
+    }
+}
+
 ///////////////////////////////////
 
 void ShankBot::initializeData(std::string clientDir, std::string versionControlDir)
@@ -67,237 +158,472 @@ void ShankBot::initializeData(std::string clientDir, std::string versionControlD
     const std::string SPRITE_OBJECT_BINDINGS_PATH = STORAGE_PATH + "/sprite-object-bindings.bin";
     const std::string GLYPHS_PATH = STORAGE_PATH + "/glyphs.bin";
     const std::string SPRITE_INFO_PATH = STORAGE_PATH + "/sprite-info.bin";
+    const std::string SPRITE_ATLAS_PATH = STORAGE_PATH + "/sprite-atlas.bin";
+    const std::string SPRITE_COLOR_SPILL_PATH = STORAGE_PATH + "/tree-sprite-color.spill";
+    const std::string SPRITE_TRANSPARENCY_SPILL_PATH = STORAGE_PATH + "/tree-sprite-transparency.spill";
     const std::string CATALOG_CONTENT_PATH = clientDir + "/packages/Tibia/assets/catalog-content.json";
     const std::string GRAPHICS_RESOURCES_PATH = clientDir + "/packages/Tibia/bin/graphics_resources.rcc";
 
+    mStartupReportPath = STORAGE_PATH + "/startup-report.txt";
+
     std::cout << "Initializing..." << std::endl;
 
     std::cout << "Reading catalog content... ";
-    CatalogContent cat(CATALOG_CONTENT_PATH);
+    auto cat = mStartupProfile.measure("Read catalog content", [&CATALOG_CONTENT_PATH]()
+    {
+        return std::make_shared<CatalogContent>(CATALOG_CONTENT_PATH);
+    });
     std::cout << "Done" << std::endl;
 
-    const std::list<CatalogContent::Appearances>& appearanceses = cat.getAppearances();
+    const std::list<CatalogContent::Appearances>& appearanceses = cat->getAppearances();
     assert(appearanceses.size() == 1);
+    const std::string APPEARANCES_PATH = appearanceses.front().path;
+    auto readObjects = [APPEARANCES_PATH]()
+    {
+        AppearancesReader appearances(APPEARANCES_PATH);
+        return std::make_unique<std::vector<Object>>(appearances.getAppearances().toObjects());
+    };
 
-    std::cout << "Reading appearances... ";
-    AppearancesReader appearances(appearanceses.front().path);
-    auto objects = std::make_unique<std::vector<Object>>(appearances.getObjects());
-    std::cout << "Done" << std::endl;
-
-    std::cout << "Reading graphics resource names...";
-    auto graphicsResourceNames = std::make_unique<std::vector<std::string>>(GraphicsResourceReader::readNames(GRAPHICS_RESOURCES_PATH));
-    std::cout << "Done" << std::endl;
+    // Only read up front if the stored data has to be regenerated. The
+    // context then takes them over instead of reading them again.
+    auto objects = std::make_shared<std::unique_ptr<std::vector<Object>>>();
 
-    if(VersionControl::hasNewVersion(clientDir, versionControlDir))
+    bool hasNewVersion = mStartupProfile.measure("Check version", [&]()
+    {
+        return VersionControl::hasNewVersion(clientDir, versionControlDir);
+    });
+    if(hasNewVersion)
     {
+        StartupProfile::ScopedStep step(mStartupProfile, "Regenerate stored data");
         std::cout << "Has new version" << std::endl;
 
+        std::cout << "Reading appearances... ";
+        *objects = readObjects();
+        std::cout << "Done" << std::endl;
 
+        // Every artifact is keyed on the content of the inputs it is made
+        // from, so that a client update only regenerates what it touched.
+        std::cout << "Hashing client files... ";
+        const uint64_t APPEARANCES_KEY = VersionControl::hashFile(appearanceses.front().path);
+        const uint64_t GRAPHICS_RESOURCES_KEY = VersionControl::combineKeys({VersionControl::hashFile(GRAPHICS_RESOURCES_PATH), SPRITE_SEQUENCE_VERSION});
+        std::vector<SheetInput> sheets;
+        for(const CatalogContent::SpriteSheet& sheet : cat->getSpriteSheets())
+        {
+            const uint64_t values[] = {uint64_t(sheet.spriteSize), uint64_t(sheet.firstSpriteId), uint64_t(sheet.lastSpriteId), SPRITE_SEQUENCE_VERSION};
+            const uint64_t key = sb::utility::hash64(values, sizeof(values), VersionControl::hashFile(sheet.path + ".lzma"));
+            sheets.push_back({&sheet, key});
+        }
+        std::sort(sheets.begin(), sheets.end(), [](const SheetInput& lhs, const SheetInput& rhs)
+        {
+            return lhs.sheet->firstSpriteId < rhs.sheet->firstSpriteId;
+        });
+        std::cout << "Done" << std::endl;
 
-        std::vector<std::vector<size_t>> colorSprites;
-        std::vector<std::vector<size_t>> transparencySprites;
-        std::vector<size_t> ids;
+        if(!VersionControl::isUpToDate(versionControlDir, "sprite-object-bindings", APPEARANCES_KEY))
+        {
+            std::cout << "Creating sprite object bindings... ";
+            SpriteObjectBindings(**objects).writeToBinaryFile(SPRITE_OBJECT_BINDINGS_PATH);
+            VersionControl::commit(versionControlDir, "sprite-object-bindings", APPEARANCES_KEY);
+            std::cout << "Done" << std::endl;
+        }
+
+        std::vector<CombatSquareSample::CombatSquare> squares = CombatSquareSample::generateSamples();
+        if(squares.size() >= Constants::COMBAT_SQUARE_ID_END - Constants::COMBAT_SQUARE_ID_START)
+            THROW_RUNTIME_ERROR("There are not enough IDs allocated for combat squares.")
+
+        std::vector<uint64_t> treeInputKeys = {APPEARANCES_KEY, GRAPHICS_RESOURCES_KEY, SPRITE_SEQUENCE_VERSION};
+        for(const CombatSquareSample::CombatSquare& s : squares)
+            treeInputKeys.push_back(sb::utility::hash64(s.pixels.data(), s.pixels.size()));
+        for(const SheetInput& sheet : sheets)
+            treeInputKeys.push_back(sheet.key);
+        const uint64_t TREES_KEY = VersionControl::combineKeys(treeInputKeys);
 
-        std::cout << "Generating combat squares...";
+        // Every sheet is decoded once per catalog version, into the atlas.
+        // Everything below looks sprites up in it instead.
+        if(!SpriteAtlas::isUpToDate(SPRITE_ATLAS_PATH, *cat))
         {
-            std::vector<CombatSquareSample::CombatSquare> squares = CombatSquareSample::generateSamples();
-            if(squares.size() >= Constants::COMBAT_SQUARE_ID_END - Constants::COMBAT_SQUARE_ID_START)
-                THROW_RUNTIME_ERROR("There are not enough IDs allocated for combat squares.")
-            for(size_t i = 0; i < squares.size(); i++)
+            std::cout << "Building sprite atlas... ";
+            mStartupProfile.measure("Build sprite atlas", [&]()
             {
-                const CombatSquareSample::CombatSquare& s = squares[i];
-                colorSprites.push_back(rgbaToColorTreeSprite(s.pixels, s.width, s.height));
-                transparencySprites.push_back(rgbaToTransparencyTreeSprite(s.pixels, s.width, s.height));
-                ids.push_back(i + Constants::COMBAT_SQUARE_ID_START);
-            }
+                SpriteAtlas::build(*cat, SPRITE_ATLAS_PATH);
+            });
+            std::cout << "Done" << std::endl;
         }
-        std::cout << "Done" << std::endl;
 
-        std::cout << "Loading graphics resources... ";
-        std::unique_ptr<GraphicsResourceReader> gResourceReader = std::make_unique<GraphicsResourceReader>(GRAPHICS_RESOURCES_PATH);
-        const std::vector<GraphicsResourceReader::GraphicsResource>& gResources = gResourceReader->getGraphicsResources();
-        for(size_t i = 0; i < gResources.size(); i++)
+        if(!VersionControl::isUpToDate(versionControlDir, "sprite-trees", TREES_KEY))
         {
-            const GraphicsResourceReader::GraphicsResource& gRes = gResources[i];
-            const size_t ID = i + Constants::GRAPHICS_RESOURCE_ID_START;
-
-            std::vector<size_t> colorTreeSprite = rgbaToColorTreeSprite(gRes.pixels, gRes.width, gRes.height);
-            if(colorTreeSprite.size() > 0)
+            SpriteSequenceCache cache(VersionControl::getCachePath(versionControlDir));
+            SpriteObjectBindings bindings(**objects);
+
+            // Tree sprites only depend on the sheet they are in, so only
+            // sheets that are not in the cache yet have to be converted. Outfit
+            // merges also depend on the appearances, and are keyed on both
+            // the appearances and the sheets with outfit sprites in them.
+            auto findSheet = [&sheets](unsigned int spriteId)
             {
-                bool isDuplicate = false;
-                for(const std::vector<size_t>& spr1 : colorSprites)
+                auto it = std::upper_bound(sheets.begin(), sheets.end(), spriteId, [](unsigned int id, const SheetInput& sheet)
                 {
-                    if(spr1.size() == colorTreeSprite.size())
-                    {
-                        size_t j = 0;
-                        while(j < spr1.size())
+                    return id < (unsigned int)sheet.sheet->firstSpriteId;
+                });
+                if(it == sheets.begin() || spriteId > (unsigned int)(it - 1)->sheet->lastSpriteId)
+                    return size_t(-1);
+                return size_t(it - sheets.begin() - 1);
+            };
+
+            std::set<size_t> outfitSheets;
+            for(const Object& o : **objects)
+                if(o.type == Object::Type::OUTFIT)
+                    for(const Object::SomeInfo& info : o.someInfos)
+                        for(unsigned int spriteId : info.spriteInfo.spriteIds)
                         {
-                            if(spr1[j] != colorTreeSprite[j])
-                                break;
-
-                            j++;
+                            size_t sheet = findSheet(spriteId);
+                            if(sheet != size_t(-1))
+                                outfitSheets.insert(sheet);
                         }
 
-                        if(j == spr1.size())
+            std::vector<uint64_t> mergeInputKeys = {APPEARANCES_KEY, SPRITE_SEQUENCE_VERSION};
+            for(size_t sheet : outfitSheets)
+                mergeInputKeys.push_back(sheets[sheet].key);
+            const uint64_t MERGES_KEY = VersionControl::combineKeys(mergeInputKeys);
+            const bool areMergesStale = !cache.contains(MERGES_KEY);
+
+            std::vector<size_t> staleSheets;
+            for(size_t i = 0; i < sheets.size(); i++)
+                if(!cache.contains(sheets[i].key))
+                    staleSheets.push_back(i);
+
+            if(!staleSheets.empty() || areMergesStale)
+            {
+                std::cout << "Loading sprites (" << staleSheets.size() << " of " << sheets.size() << " sheets)... ";
+                SpriteAtlas atlas(SPRITE_ATLAS_PATH);
+                SpriteReader reader(*cat, atlas);
+                auto getSprite = [&reader](unsigned int id)
+                {
+                    SpriteReader::Sprite spr = reader.getSprite(id);
+                    if(spr.pixels && (spr.id < Constants::SPRITE_ID_START || spr.id > Constants::SPRITE_ID_END))
+                        THROW_RUNTIME_ERROR("There are not enough IDs allocated for Tibia's sprites.");
+                    return spr;
+                };
+
+                if(areMergesStale)
+                {
+                    OutfitAddonMerger merger;
+                    for(const Object& o : **objects)
+                        if(o.type == Object::Type::OUTFIT)
+                            merger.addOutfit(o);
+
+                    SpriteSequenceCache::Writer mergeWriter(cache, MERGES_KEY);
+                    const std::vector<size_t> noColor;
+                    for(unsigned int id : merger.getNeededSprites())
+                    {
+                        SpriteReader::Sprite spr = getSprite(id);
+                        if(!spr.pixels)
+                            continue;
+
+                        size_t pixelWidth = spr.tileWidth * Constants::TILE_PIXEL_WIDTH;
+                        size_t pixelHeight = spr.tileHeight * Constants::TILE_PIXEL_HEIGHT;
+                        for(const std::shared_ptr<Sprite>& m : merger.processSprite(spr.id, pixelWidth, pixelHeight, spr.pixels, spr.stride))
                         {
-                            isDuplicate = true;
-                            break;
+                            bool isBlank = false;
+                            std::vector<size_t> transparency = rgbaToTransparencyTreeSprite(m->pixels, m->width, m->height, &isBlank);
+                            if(!isBlank)
+                                mergeWriter.add(m->id, noColor, transparency);
                         }
                     }
+                    assert(merger.isEmpty());
+                    mergeWriter.finish();
                 }
 
-                if(!isDuplicate)
+                // Stale sheets without any sprites in them still get their
+                // (empty) entry, so that they are not looked at again.
+                std::vector<size_t> colorSprite;
+                std::vector<size_t> transparencySprite;
+                for(size_t i : staleSheets)
                 {
-                    colorSprites.push_back(colorTreeSprite);
-                    transparencySprites.push_back(rgbaToTransparencyTreeSprite(gRes.pixels, gRes.width, gRes.height));
-                    ids.push_back(ID);
+                    const CatalogContent::SpriteSheet& sheet = *sheets[i].sheet;
+                    SpriteSequenceCache::Writer sheetWriter(cache, sheets[i].key);
+                    for(unsigned int id = sheet.firstSpriteId; id <= (unsigned int)sheet.lastSpriteId; id++)
+                    {
+                        SpriteReader::Sprite spr = getSprite(id);
+                        if(!spr.pixels)
+                            continue;
+
+                        size_t pixelWidth = spr.tileWidth * Constants::TILE_PIXEL_WIDTH;
+                        size_t pixelHeight = spr.tileHeight * Constants::TILE_PIXEL_HEIGHT;
+                        bool isBlank = false;
+                        rgbaToColorTreeSprite(spr.pixels, pixelWidth, pixelHeight, spr.stride, colorSprite, &isBlank);
+                        if(!isBlank)
+                        {
+                            rgbaToTransparencyTreeSprite(spr.pixels, pixelWidth, pixelHeight, spr.stride, transparencySprite);
+                            sheetWriter.add(spr.id, colorSprite, transparencySprite);
+                        }
+                    }
+                    sheetWriter.finish();
                 }
+                std::cout << "Done" << std::endl;
             }
-        }
-        if(gResources.size() >= Constants::GRAPHICS_RESOURCE_ID_END - Constants::GRAPHICS_RESOURCE_ID_START)
-            THROW_RUNTIME_ERROR("There are not enough IDs allocated for Tibia's graphics resources.");
-        gResourceReader.reset();
-        std::cout << "Done" << std::endl;
-
-        std::cout << "Creating sprite object bindings... ";
-        SpriteObjectBindings bindings(*objects);
-        bindings.writeToBinaryFile(SPRITE_OBJECT_BINDINGS_PATH);
-        std::cout << "Done" << std::endl;
 
-        std::cout << "Loading sprites... ";
-        OutfitAddonMerger merger;
-        for(const Object& o : *objects)
-            if(o.type == Object::Type::OUTFIT)
-                merger.addOutfit(o);
-        std::vector<std::vector<size_t>> mergeTransparencySprites;
-        std::vector<unsigned int> mergeIds;
-        SpriteReader(cat).forEachSprite([&](const SpriteReader::Sprite& spr)
-        {
-            size_t pixelWidth = spr.tileWidth * Constants::TILE_PIXEL_WIDTH;
-            size_t pixelHeight = spr.tileHeight * Constants::TILE_PIXEL_HEIGHT;
-
-            if(spr.id < Constants::SPRITE_ID_START || spr.id > Constants::SPRITE_ID_END)
-                THROW_RUNTIME_ERROR("There are not enough IDs allocated for Tibia's sprites.");
-
-            std::vector<std::shared_ptr<Sprite>> merges = merger.processSprite(spr.id, pixelWidth, pixelHeight, spr.pixels);
-            for(const std::shared_ptr<Sprite>& m : merges)
+            if(!cache.contains(GRAPHICS_RESOURCES_KEY))
             {
-                bool isBlank = false;
-                std::vector<size_t> transparency = rgbaToTransparencyTreeSprite(m->pixels, m->width, m->height, &isBlank);
-                if(!isBlank)
+                std::cout << "Loading graphics resources... ";
+                std::unique_ptr<GraphicsResourceReader> gResourceReader = std::make_unique<GraphicsResourceReader>(GRAPHICS_RESOURCES_PATH);
+                const std::vector<GraphicsResourceReader::GraphicsResource>& gResources = gResourceReader->getGraphicsResources();
+                if(gResources.size() >= Constants::GRAPHICS_RESOURCE_ID_END - Constants::GRAPHICS_RESOURCE_ID_START)
+                    THROW_RUNTIME_ERROR("There are not enough IDs allocated for Tibia's graphics resources.");
+
+                SpriteSequenceCache::Writer writer(cache, GRAPHICS_RESOURCES_KEY);
+                for(size_t i = 0; i < gResources.size(); i++)
                 {
-                    mergeTransparencySprites.push_back(transparency);
-                    mergeIds.push_back(m->id);
+                    const GraphicsResourceReader::GraphicsResource& gRes = gResources[i];
+                    std::vector<size_t> colorTreeSprite = rgbaToColorTreeSprite(gRes.pixels, gRes.width, gRes.height);
+                    if(colorTreeSprite.size() > 0)
+                        writer.add(i + Constants::GRAPHICS_RESOURCE_ID_START, colorTreeSprite, rgbaToTransparencyTreeSprite(gRes.pixels, gRes.width, gRes.height));
                 }
+                writer.finish();
+                std::cout << "Done" << std::endl;
             }
 
-            std::list<size_t> boundObjects = bindings.getObjects(spr.id);
-            bool isMergeOnly = false;
-            for(size_t objIndex : boundObjects)
+            // The trees are flat images that can not be patched in place.
+            // Instead, their sequences are assembled from the cache, in the
+            // same order as a full rebuild would add them.
+            std::cout << "Assembling tree sprites... ";
+            auto colorSprites = std::make_unique<SequenceTree::Builder>(SPRITE_COLOR_SPILL_PATH);
+            auto transparencySprites = std::make_unique<SequenceTree::Builder>(SPRITE_TRANSPARENCY_SPILL_PATH);
+            SequenceSet uniqueColorSprites(*colorSprites);
+            std::vector<size_t> colorSprite;
+            std::vector<size_t> transparencySprite;
+
+            for(size_t i = 0; i < squares.size(); i++)
             {
-                const Object& o = (*objects)[objIndex];
-                const Object::SpriteInfo& info = o.someInfos.front().spriteInfo;
-                if(o.type == Object::Type::OUTFIT && (info.numAddons > 1 || info.numMounts > 1 || info.numBlendFrames > 1))
-                    isMergeOnly = true;
-                else
-                {
-                    isMergeOnly = false;
-                    break;
-                }
+                const CombatSquareSample::CombatSquare& s = squares[i];
+                const unsigned int ID = i + Constants::COMBAT_SQUARE_ID_START;
+                colorSprite = rgbaToColorTreeSprite(s.pixels, s.width, s.height);
+                uniqueColorSprites.insert(colorSprite, colorSprites->add(colorSprite, ID));
+                transparencySprites->add(rgbaToTransparencyTreeSprite(s.pixels, s.width, s.height), ID);
             }
-            if(!isMergeOnly)
+
+            cache.forEach(GRAPHICS_RESOURCES_KEY, [&](const SpriteSequenceCache::Entry& e)
             {
-                bool isBlank = false;
-                std::vector<size_t> colorSprite = rgbaToColorTreeSprite(spr.pixels, pixelWidth, pixelHeight, &isBlank);
-                if(!isBlank)
+                colorSprite.assign(e.color, e.color + e.colorSize);
+                if(uniqueColorSprites.find(colorSprite) == size_t(-1))
                 {
-                    colorSprites.push_back(colorSprite);
-                    transparencySprites.push_back(rgbaToTransparencyTreeSprite(spr.pixels, pixelWidth, pixelHeight));
-                    ids.push_back(spr.id);
+                    uniqueColorSprites.insert(colorSprite, colorSprites->add(colorSprite, e.id));
+                    transparencySprites->add(std::vector<size_t>(e.transparency, e.transparency + e.transparencySize), e.id);
                 }
-            }
+            });
 
+            size_t numDuplicateSprites = 0;
+            for(const SheetInput& sheet : sheets)
+            {
+                cache.forEach(sheet.key, [&](const SpriteSequenceCache::Entry& e)
+                {
+                    bool isMergeOnly = false;
+                    for(size_t objIndex : bindings.getObjects(e.id))
+                    {
+                        const Object& o = (**objects)[objIndex];
+                        const Object::SpriteInfo& info = o.someInfos.front().spriteInfo;
+                        if(o.type == Object::Type::OUTFIT && (info.numAddons > 1 || info.numMounts > 1 || info.numBlendFrames > 1))
+                            isMergeOnly = true;
+                        else
+                        {
+                            isMergeOnly = false;
+                            break;
+                        }
+                    }
+                    if(isMergeOnly)
+                        return;
 
-            return true;
-        });
-        assert(merger.isEmpty());
-        std::cout << "Done" << std::endl;
+                    colorSprite.assign(e.color, e.color + e.colorSize);
+                    transparencySprite.assign(e.transparency, e.transparency + e.transparencySize);
 
+                    // Identical sprites are still inserted under their own
+                    // ids, because each id binds to different objects.
+                    size_t duplicate = uniqueColorSprites.find(colorSprite);
+                    if(duplicate != size_t(-1))
+                    {
+                        std::vector<size_t> duplicateTransparency;
+                        transparencySprites->getSequence(duplicate, duplicateTransparency);
+                        if(duplicateTransparency == transparencySprite)
+                            numDuplicateSprites++;
+                    }
 
-        std::cout << "Building colorTree... ";
-        SequenceTree* colorTree = new SequenceTree(colorSprites, ids);
-        colorTree->writeToBinaryFile(SPRITE_COLOR_TREE_PATH);
-        delete colorTree;
-        colorSprites.resize(0);
-        std::cout << "Done " << std::endl;
-
-        std::cout << "Building transparencyTree... ";
-        transparencySprites.insert(transparencySprites.end(), mergeTransparencySprites.begin(), mergeTransparencySprites.end());
-        ids.insert(ids.end(), mergeIds.begin(), mergeIds.end());
-        mergeTransparencySprites.resize(0);
-        mergeIds.resize(0);
-        SequenceTree* transparencyTree = new SequenceTree(transparencySprites, ids);
-        transparencyTree->writeToBinaryFile(SPRITE_TRANSPARENCY_TREE_PATH);
-        delete transparencyTree;
-        transparencySprites.resize(0);
-        std::cout << "Done" << std::endl;
+                    size_t index = colorSprites->add(colorSprite, e.id);
+                    transparencySprites->add(transparencySprite, e.id);
+                    if(duplicate == size_t(-1))
+                        uniqueColorSprites.insert(colorSprite, index);
+                });
+            }
+            std::cout << "Done (" << numDuplicateSprites << " sprites identical to an earlier one)" << std::endl;
+
+            typedef std::chrono::steady_clock Clock;
+            std::cout << "Building colorTree... ";
+            Clock::time_point start = Clock::now();
+            colorSprites->build()->writeToBinaryFile(SPRITE_COLOR_TREE_PATH);
+            colorSprites.reset();
+            std::cout << "Done (" << std::chrono::duration<double>(Clock::now() - start).count() << " s)" << std::endl;
+
+            std::cout << "Building transparencyTree... ";
+            start = Clock::now();
+            cache.forEach(MERGES_KEY, [&](const SpriteSequenceCache::Entry& e)
+            {
+                transparencySprites->add(std::vector<size_t>(e.transparency, e.transparency + e.transparencySize), e.id);
+            });
+            transparencySprites->build()->writeToBinaryFile(SPRITE_TRANSPARENCY_TREE_PATH);
+            transparencySprites.reset();
+            std::cout << "Done (" << std::chrono::duration<double>(Clock::now() - start).count() << " s)" << std::endl;
+
+            VersionControl::commit(versionControlDir, "sprite-trees", TREES_KEY);
+
+            std::set<uint64_t> cacheKeys = {GRAPHICS_RESOURCES_KEY, MERGES_KEY};
+            for(const SheetInput& sheet : sheets)
+                cacheKeys.insert(sheet.key);
+            cache.retainOnly(cacheKeys);
+        }
 
-        std::cout << "Generating glyph samples... ";
-        auto fontSample = std::make_unique<FontSample>("Verdana", 6.f, 10.f, FontSample::Style::BOLD | FontSample::Style::NORMAL);
-        auto glyphs = std::make_unique<std::vector<FontSample::Glyph>>(fontSample->getGlyphs());
-        fontSample = std::make_unique<FontSample>("Verdana", 13.f, 15.f, FontSample::Style::BOLD | FontSample::Style::NORMAL);
-        glyphs->insert(glyphs->end(), fontSample->getGlyphs().begin(), fontSample->getGlyphs().end());
-        GlyphsFile::write(*glyphs, GLYPHS_PATH);
-        fontSample.reset();
-        glyphs.reset();
-        std::cout << "Done" << std::endl;
+        const uint64_t GLYPHS_KEY = getFontsKey();
+        if(!VersionControl::isUpToDate(versionControlDir, "glyphs", GLYPHS_KEY))
+        {
+            std::cout << "Generating glyph samples... ";
+            auto glyphs = std::make_unique<std::vector<FontSample::Glyph>>();
+            for(const FontParameters& font : FONTS)
+            {
+                FontSample fontSample(font.family, font.minPointSize, font.maxPointSize, font.styleFlags);
+                glyphs->insert(glyphs->end(), fontSample.getGlyphs().begin(), fontSample.getGlyphs().end());
+            }
+            GlyphsFile::write(*glyphs, GLYPHS_PATH);
+            VersionControl::commit(versionControlDir, "glyphs", GLYPHS_KEY);
+            std::cout << "Done" << std::endl;
+        }
 
         VersionControl::checkout(versionControlDir);
     }
 
-    std::cout << "Loading sprite object bindings... ";
-    auto bindings = std::make_unique<SpriteObjectBindings>(SPRITE_OBJECT_BINDINGS_PATH);
-    std::cout << "Done" << std::endl;
-
-    std::cout << "Loading sprite infos... ";
-    auto spriteInfo = std::make_unique<SpriteInfo>(cat.getSpriteSheets());
-    std::cout << "Done" << std::endl;
+    // Files are converted up front, since the context reads them later on.
+    {
+        StartupProfile::ScopedStep step(mStartupProfile, "Convert legacy files");
+        if(SpriteObjectBindings::isLegacyFile(SPRITE_OBJECT_BINDINGS_PATH))
+        {
+            std::cout << "Converting sprite object bindings... ";
+            SpriteObjectBindings::convertLegacyFile(SPRITE_OBJECT_BINDINGS_PATH, SPRITE_OBJECT_BINDINGS_PATH);
+            std::cout << "Done" << std::endl;
+        }
 
-    std::cout << "Loading trees... ";
-    auto spriteColorTree = std::make_unique<SequenceTree>(SPRITE_COLOR_TREE_PATH);
-    auto spriteTransparencyTree = std::make_unique<SequenceTree>(SPRITE_TRANSPARENCY_TREE_PATH);
-    std::cout << "Done" << std::endl;
+        for(const std::string& path : {SPRITE_COLOR_TREE_PATH, SPRITE_TRANSPARENCY_TREE_PATH})
+        {
+            if(SequenceTree::isLegacyFile(path))
+            {
+                std::cout << "Converting tree '" << path << "'... ";
+                SequenceTree::convertLegacyFile(path, path);
+                std::cout << "Done" << std::endl;
+            }
+        }
+    }
 
-    std::cout << "Loading glyph samples... ";
-    auto glyphs = std::make_unique<std::vector<FontSample::Glyph>>();
-    GlyphsFile::read(*glyphs, GLYPHS_PATH);
-    std::cout << "Done" << std::endl;
+    // Everything else is loaded in the background while the client starts.
+    TibiaContext::Loaders loaders;
+    loaders.objects = [objects, readObjects]()
+    {
+        return *objects ? std::move(*objects) : readObjects();
+    };
+    loaders.spriteObjectBindings = [SPRITE_OBJECT_BINDINGS_PATH]()
+    {
+        return std::make_unique<SpriteObjectBindings>(SPRITE_OBJECT_BINDINGS_PATH);
+    };
+    loaders.spriteColorTree = [SPRITE_COLOR_TREE_PATH]()
+    {
+        return std::make_unique<SequenceTree>(SPRITE_COLOR_TREE_PATH);
+    };
+    loaders.spriteTransparencyTree = [SPRITE_TRANSPARENCY_TREE_PATH]()
+    {
+        return std::make_unique<SequenceTree>(SPRITE_TRANSPARENCY_TREE_PATH);
+    };
+    loaders.spriteInfo = [cat]()
+    {
+        return std::make_unique<SpriteInfo>(cat->getSpriteSheets());
+    };
+    loaders.graphicsResourceNames = [GRAPHICS_RESOURCES_PATH]()
+    {
+        return std::make_unique<std::vector<std::string>>(GraphicsResourceReader::readNames(GRAPHICS_RESOURCES_PATH));
+    };
+    loaders.glyphs = [GLYPHS_PATH]()
+    {
+        auto glyphs = std::make_unique<std::vector<FontSample::Glyph>>();
+        if(!GlyphsFile::read(*glyphs, GLYPHS_PATH))
+            SB_THROW("Could not read the glyph samples.");
+        return glyphs;
+    };
 
-    mTibiaContext = std::make_unique<TibiaContext>
-    (
-        objects,
-        bindings,
-        spriteColorTree,
-        spriteTransparencyTree,
-        spriteInfo,
-        graphicsResourceNames,
-        glyphs
-    );
+    mTibiaContext = std::make_unique<TibiaContext>(loaders, &mStartupProfile);
 }
 
-ShankBot::ShankBot(std::string clientDir, std::string versionControlDir)
+ShankBot::ShankBot(std::string clientDir, std::string versionControlDir, std::string recordingPath)
 {
     srand(NULL);
-    initializeData(clientDir, versionControlDir);
+    try
+    {
+        initializeData(clientDir, versionControlDir);
 
-    std::cout << "Starting client" << std::endl;
-    mTibiaClient = std::unique_ptr<TibiaClient>(new TibiaClient(clientDir, *mTibiaContext));
+        std::cout << "Starting client" << std::endl;
+        mStartupProfile.measure("Launch client", [&]()
+        {
+            mTibiaClient = std::unique_ptr<TibiaClient>(new TibiaClient(clientDir, *mTibiaContext, recordingPath));
+        });
+    }
+    catch(...)
+    {
+        // A failed startup is the one most worth a report.
+        writeStartupReport();
+        throw;
+    }
 }
 
 void ShankBot::run()
 {
-    while(mTibiaClient->isAlive())
+    bool isFirstUpdate = true;
+    bool isReportWritten = false;
+    try
+    {
+        while(mTibiaClient->isAlive())
+        {
+            mTibiaClient->update();
+            if(isFirstUpdate)
+            {
+                mStartupProfile.mark("First client update");
+                isFirstUpdate = false;
+            }
+
+            // Written once the background loading is over too, so that the
+            // report shows how it overlapped with starting the client.
+            if(!isReportWritten && mTibiaContext->isLoadFinished())
+            {
+                writeStartupReport();
+                isReportWritten = true;
+                mTibiaContext->waitUntilLoaded();
+            }
+        }
+    }
+    catch(...)
+    {
+        if(!isReportWritten)
+            writeStartupReport();
+        throw;
+    }
+}
+
+void ShankBot::writeStartupReport() const
+{
+    // Set early in initializeData. Without it there is nothing to report.
+    if(mStartupReportPath.empty())
+        return;
+
+    try
+    {
+        mStartupProfile.writeReport(mStartupReportPath);
+        std::cout << "Wrote startup report to '" << mStartupReportPath << "'." << std::endl;
+    }
+    catch(const std::exception& e)
     {
-        mTibiaClient->update();
+        // Must not hide the error that ended startup.
+        std::cout << "Could not write startup report: " << e.what() << std::endl;
     }
 }
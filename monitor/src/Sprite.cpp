@@ -31,6 +31,19 @@
 using namespace GraphicsLayer;
 ///////////////////////////////////
 
+namespace
+{
+    std::vector<unsigned char> copyRows(const unsigned char* pixels, size_t width, size_t height, size_t stride)
+    {
+        const size_t ROW_SIZE = width * sb::utility::BYTES_PER_PIXEL_RGBA;
+        std::vector<unsigned char> rows;
+        rows.reserve(ROW_SIZE * height);
+        for(size_t y = 0; y < height; y++, pixels += stride)
+            rows.insert(rows.end(), pixels, pixels + ROW_SIZE);
+        return rows;
+    }
+}
+
 
 Sprite::Sprite(unsigned int id, unsigned short width, unsigned short height, const unsigned char* pixels)
 : id(id)
@@ -40,6 +53,11 @@ Sprite::Sprite(unsigned int id, unsigned short width, unsigned short height, con
 {
 }
 
+Sprite::Sprite(unsigned int id, unsigned short width, unsigned short height, const unsigned char* pixels, size_t stride)
+: Sprite(id, width, height, copyRows(pixels, width, height, stride))
+{
+}
+
 Sprite::Sprite(unsigned int id, unsigned short width, unsigned short height, const std::vector<unsigned char>& pixels)
 : id(id)
 , width(width)
@@ -27,7 +27,9 @@
 ///////////////////////////////////
 // Internal ShankBot headers
 #include "monitor/SpriteObjectBindings.hpp"
+#include "utility/utility.hpp"
 using namespace sb::tibiaassets;
+using namespace sb::utility;
 using namespace GraphicsLayer;
 ///////////////////////////////////
 
@@ -35,24 +37,59 @@ using namespace GraphicsLayer;
 // STD C++
 #include <sstream>
 #include <fstream>
+#include <algorithm>
+#include <cstring>
 ///////////////////////////////////
 
+const char SpriteObjectBindings::MAGIC[8] = {'S', 'B', 'S', 'O', 'B', 'I', 'N', 'D'};
+const uint32_t SpriteObjectBindings::VERSION;
+
 SpriteObjectBindings::SpriteObjectBindings(const std::vector<Object>& objects)
 {
-    mBindings.clear();
     parseObjects(objects);
 }
 
 SpriteObjectBindings::SpriteObjectBindings(std::string binPath)
 {
-    mBindings.clear();
-    readFromBinaryFile(binPath);
+    if(isLegacyFile(binPath))
+        readLegacyFile(binPath);
+    else
+        readFromBinaryFile(binPath);
 }
 
 void SpriteObjectBindings::readFromBinaryFile(std::string binPath)
+{
+    mFile = std::make_unique<MappedFile>(binPath);
+    const char* data = mFile->getData();
+    size_t size = mFile->getSize();
+
+    Header header;
+    if(size < sizeof(header))
+        SB_THROW("Sprite object bindings file '", binPath, "' is too small.");
+    memcpy(&header, data, sizeof(header));
+
+    if(memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+        SB_THROW("'", binPath, "' is not a sprite object bindings file.");
+
+    if(header.version != VERSION)
+        SB_THROW("Unsupported sprite object bindings version: ", header.version, ". Expected ", VERSION, ".");
+
+    size_t expectedSize = sizeof(header) + (size_t(header.numSprites) + 1 + header.numObjectIds) * sizeof(uint32_t);
+    if(size != expectedSize)
+        SB_THROW("Sprite object bindings file '", binPath, "' has size ", size, ". Expected ", expectedSize, ".");
+
+    mNumSprites = header.numSprites;
+    mOffsetsData = (const uint32_t*)(data + sizeof(header));
+    mObjectIdsData = mOffsetsData + mNumSprites + 1;
+    if(mOffsetsData[mNumSprites] != header.numObjectIds)
+        SB_THROW("Corrupt sprite object bindings file '", binPath, "'.");
+}
+
+void SpriteObjectBindings::readLegacyFile(std::string binPath)
 {
     std::ifstream file(binPath, std::ios::binary);
 
+    std::vector<std::pair<uint32_t, uint32_t>> bindings;
     unsigned int numSprites;
     file.read((char*)&numSprites, sizeof(numSprites));
     for(size_t i = 0; i < numSprites; i++)
@@ -60,8 +97,6 @@ void SpriteObjectBindings::readFromBinaryFile(std::string binPath)
         size_t spriteId;
         file.read((char*)&spriteId, sizeof(spriteId));
 
-        auto it = mBindings.insert(std::make_pair(spriteId, std::set<size_t>()));
-
         unsigned int numBindedObjects;
         file.read((char*)&numBindedObjects, sizeof(numBindedObjects));
 
@@ -69,61 +104,92 @@ void SpriteObjectBindings::readFromBinaryFile(std::string binPath)
         {
             size_t objectId;
             file.read((char*)&objectId, sizeof(objectId));
-            it.first->second.insert(objectId);
+            bindings.emplace_back(spriteId, objectId);
         }
     }
 
     file.close();
+
+    createRows(bindings);
 }
 
-void SpriteObjectBindings::writeToBinaryFile(std::string path) const
+bool SpriteObjectBindings::isLegacyFile(const std::string& path)
 {
-    std::ofstream file(path, std::ios::binary);
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    if(!file.read(magic, sizeof(magic)))
+        return true;
 
-    unsigned int numSprites = mBindings.size();
-    file.write((char*)&numSprites, sizeof(numSprites));
-    for(auto pair : mBindings)
-    {
-        file.write((char*)&pair.first, sizeof(pair.first));
+    return memcmp(magic, MAGIC, sizeof(MAGIC)) != 0;
+}
 
-        unsigned int numBindedObjects = pair.second.size();
-        file.write((char*)&numBindedObjects, sizeof(numBindedObjects));
+void SpriteObjectBindings::convertLegacyFile(const std::string& srcPath, const std::string& destPath)
+{
+    SpriteObjectBindings bindings(srcPath);
+    bindings.writeToBinaryFile(destPath);
+}
 
-        for(size_t object : pair.second)
-            file.write((char*)&object, sizeof(object));
-    }
+void SpriteObjectBindings::writeToBinaryFile(std::string path) const
+{
+    std::ofstream file(path, std::ios::binary);
 
-    file.close();
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.numSprites = mNumSprites;
+    header.numObjectIds = mOffsetsData[mNumSprites];
+    header.reserved = 0;
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)mOffsetsData, (mNumSprites + 1) * sizeof(uint32_t));
+    file.write((const char*)mObjectIdsData, header.numObjectIds * sizeof(uint32_t));
+
+    if(!file)
+        SB_THROW("Could not write sprite object bindings to '", path, "'.");
 }
 
 void SpriteObjectBindings::parseObjects(const std::vector<Object>& objects)
 {
+    std::vector<std::pair<uint32_t, uint32_t>> bindings;
     for(size_t i = 0; i < objects.size(); i++)
-        createBindings(objects[i], i);
+        createBindings(bindings, objects[i], i);
+
+    createRows(bindings);
 }
 
-void SpriteObjectBindings::createBindings(const Object& o, size_t globalId)
+void SpriteObjectBindings::createBindings(std::vector<std::pair<uint32_t, uint32_t>>& bindings, const Object& o, size_t globalId) const
 {
     for(const Object::SomeInfo& info : o.someInfos)
         for(size_t spriteId : info.spriteInfo.spriteIds)
         {
             if(spriteId != 0)
-            {
-                auto it = mBindings.insert(std::make_pair(spriteId, std::set<size_t>()));
-                it.first->second.insert(globalId);
-            }
+                bindings.emplace_back(spriteId, globalId);
         }
 }
 
-std::list<size_t> SpriteObjectBindings::getObjects(size_t spriteId) const
+void SpriteObjectBindings::createRows(std::vector<std::pair<uint32_t, uint32_t>>& bindings)
 {
-    std::list<size_t> objects;
+    std::sort(bindings.begin(), bindings.end());
+    bindings.erase(std::unique(bindings.begin(), bindings.end()), bindings.end());
 
-    auto found = mBindings.find(spriteId);
-    if(found == mBindings.end())
-        return objects;
+    mNumSprites = bindings.empty() ? 0 : bindings.back().first + 1;
+    mOffsets.assign(mNumSprites + 1, 0);
+    mObjectIds.resize(bindings.size());
+    for(size_t i = 0; i < bindings.size(); i++)
+    {
+        mOffsets[bindings[i].first + 1]++;
+        mObjectIds[i] = bindings[i].second;
+    }
+    for(size_t i = 0; i < mNumSprites; i++)
+        mOffsets[i + 1] += mOffsets[i];
 
-    objects.insert(objects.end(), found->second.begin(), found->second.end());
+    mOffsetsData = mOffsets.data();
+    mObjectIdsData = mObjectIds.data();
+}
+
+Span<uint32_t> SpriteObjectBindings::getObjects(size_t spriteId) const
+{
+    if(spriteId >= mNumSprites)
+        return Span<uint32_t>();
 
-    return objects;
+    return Span<uint32_t>(mObjectIdsData + mOffsetsData[spriteId], mObjectIdsData + mOffsetsData[spriteId + 1]);
 }
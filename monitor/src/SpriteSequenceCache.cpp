@@ -0,0 +1,190 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/SpriteSequenceCache.hpp"
+#include "utility/MappedFile.hpp"
+#include "utility/file.hpp"
+#include "utility/utility.hpp"
+using namespace GraphicsLayer;
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <cstdio>
+///////////////////////////////////
+
+const char SpriteSequenceCache::MAGIC[8] = {'S', 'B', 'S', 'P', 'R', 'S', 'E', 'Q'};
+const uint32_t SpriteSequenceCache::VERSION;
+const std::string SpriteSequenceCache::EXTENSION = ".seq";
+
+SpriteSequenceCache::Writer::Writer(const SpriteSequenceCache& cache, uint64_t key)
+: mPath(cache.getPath(key))
+, mTempPath(mPath + ".tmp")
+, mFile(mTempPath, std::ios::binary | std::ios::trunc)
+{
+    if(!mFile)
+        SB_THROW("Could not open '", mTempPath, "' for writing.");
+
+    Header header = {};
+    mFile.write((const char*)&header, sizeof(header));
+}
+
+SpriteSequenceCache::Writer::~Writer()
+{
+    if(!mIsFinished)
+    {
+        mFile.close();
+        std::remove(mTempPath.c_str());
+    }
+}
+
+void SpriteSequenceCache::Writer::add(unsigned int id, const std::vector<size_t>& color, const std::vector<size_t>& transparency)
+{
+    SB_EXPECT_FALSE(mIsFinished);
+
+    EntryHeader entry = {};
+    entry.id = id;
+    entry.colorSize = color.size();
+    entry.transparencySize = transparency.size();
+    mFile.write((const char*)&entry, sizeof(entry));
+    mFile.write((const char*)color.data(), color.size() * sizeof(size_t));
+    mFile.write((const char*)transparency.data(), transparency.size() * sizeof(size_t));
+    mNumEntries++;
+}
+
+void SpriteSequenceCache::Writer::finish()
+{
+    SB_EXPECT_FALSE(mIsFinished);
+
+    Header header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.sizeOfValue = sizeof(size_t);
+    header.numEntries = mNumEntries;
+    mFile.seekp(0);
+    mFile.write((const char*)&header, sizeof(header));
+    mFile.close();
+    if(!mFile)
+        SB_THROW("Could not write '", mTempPath, "'.");
+
+    std::remove(mPath.c_str());
+    if(std::rename(mTempPath.c_str(), mPath.c_str()) != 0)
+        SB_THROW("Could not move '", mTempPath, "' to '", mPath, "'.");
+
+    mIsFinished = true;
+}
+
+///////////////////////////////////
+
+SpriteSequenceCache::SpriteSequenceCache(std::string directory)
+: mDirectory(directory)
+{
+    file::makeDirIfNotExists(mDirectory);
+}
+
+bool SpriteSequenceCache::contains(uint64_t key) const
+{
+    std::ifstream file(getPath(key), std::ios::binary);
+    Header header;
+    if(!file.read((char*)&header, sizeof(header)))
+        return false;
+
+    return memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION && header.sizeOfValue == sizeof(size_t);
+}
+
+void SpriteSequenceCache::forEach(uint64_t key, const std::function<void(const Entry& entry)>& func) const
+{
+    const std::string path = getPath(key);
+    MappedFile file(path);
+    const char* data = file.getData();
+    const char* end = data + file.getSize();
+
+    Header header;
+    if(!readStreamSafe(header, data, end))
+        SB_THROW("Sprite sequence cache file '", path, "' is too small.");
+
+    if(memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.sizeOfValue != sizeof(size_t))
+        SB_THROW("'", path, "' is not a compatible sprite sequence cache file.");
+
+    for(uint32_t i = 0; i < header.numEntries; i++)
+    {
+        EntryHeader entryHeader;
+        if(!readStreamSafe(entryHeader, data, end))
+            SB_THROW("Sprite sequence cache file '", path, "' is truncated.");
+
+        size_t numValues = size_t(entryHeader.colorSize) + entryHeader.transparencySize;
+        if(size_t(end - data) < numValues * sizeof(size_t))
+            SB_THROW("Sprite sequence cache file '", path, "' is truncated.");
+
+        Entry entry;
+        entry.id = entryHeader.id;
+        entry.color = (const size_t*)data;
+        entry.colorSize = entryHeader.colorSize;
+        entry.transparency = entry.color + entry.colorSize;
+        entry.transparencySize = entryHeader.transparencySize;
+        data += numValues * sizeof(size_t);
+
+        func(entry);
+    }
+}
+
+void SpriteSequenceCache::retainOnly(const std::set<uint64_t>& keys) const
+{
+    std::vector<std::string> retired;
+    file::forEachFile(mDirectory, [&](const std::string& path)
+    {
+        uint64_t key;
+        if(!parseKey(file::basename(path), key) || keys.count(key) == 0)
+            retired.push_back(path);
+    });
+
+    for(const std::string& path : retired)
+        if(file::isFile(path))
+            std::remove(path.c_str());
+}
+
+std::string SpriteSequenceCache::getPath(uint64_t key) const
+{
+    std::stringstream sstream;
+    sstream << mDirectory << "/" << std::hex << std::setw(16) << std::setfill('0') << key << EXTENSION;
+    return sstream.str();
+}
+
+bool SpriteSequenceCache::parseKey(const std::string& fileName, uint64_t& key)
+{
+    if(fileName.size() != 16 + EXTENSION.size() || fileName.compare(16, EXTENSION.size(), EXTENSION) != 0)
+        return false;
+
+    std::stringstream sstream(fileName.substr(0, 16));
+    sstream >> std::hex >> key;
+    return !sstream.fail();
+}
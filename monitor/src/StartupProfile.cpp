@@ -0,0 +1,120 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/StartupProfile.hpp"
+#include "utility/utility.hpp"
+using namespace GraphicsLayer;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+///////////////////////////////////
+
+StartupProfile::StartupProfile()
+: mStart(Clock::now())
+, mMainThread(std::this_thread::get_id())
+{
+}
+
+///////////////////////////////////
+
+StartupProfile::ScopedStep::ScopedStep(StartupProfile& profile, std::string name)
+: mProfile(profile)
+, mName(name)
+, mStart(Clock::now())
+{
+}
+
+StartupProfile::ScopedStep::~ScopedStep()
+{
+    mProfile.add(mName, mStart, Clock::now());
+}
+
+///////////////////////////////////
+
+void StartupProfile::mark(const std::string& name)
+{
+    Clock::time_point now = Clock::now();
+    add(name, now, now);
+}
+
+///////////////////////////////////
+
+void StartupProfile::add(const std::string& name, Clock::time_point start, Clock::time_point end)
+{
+    Step step;
+    step.name = name;
+    if(std::this_thread::get_id() == mMainThread)
+        step.thread = "main";
+    else
+    {
+        std::stringstream sstream;
+        sstream << std::this_thread::get_id();
+        step.thread = sstream.str();
+    }
+    step.startMs = std::chrono::duration<double, std::milli>(start - mStart).count();
+    step.durationMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSteps.push_back(step);
+}
+
+///////////////////////////////////
+
+std::vector<StartupProfile::Step> StartupProfile::getSteps() const
+{
+    std::vector<Step> steps;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        steps = mSteps;
+    }
+
+    std::stable_sort(steps.begin(), steps.end(), [](const Step& lhs, const Step& rhs)
+    {
+        return lhs.startMs < rhs.startMs;
+    });
+    return steps;
+}
+
+///////////////////////////////////
+
+void StartupProfile::writeReport(const std::string& path) const
+{
+    std::ofstream file(path);
+    if(!file)
+        SB_THROW("Could not open '", path, "' for writing.");
+
+    file << std::fixed << std::setprecision(1);
+    file << std::left << std::setw(40) << "Step" << std::setw(12) << "Thread" << std::right << std::setw(12) << "Start (ms)" << std::setw(15) << "Duration (ms)" << std::endl;
+    for(const Step& step : getSteps())
+        file << std::left << std::setw(40) << step.name << std::setw(12) << step.thread << std::right << std::setw(12) << step.startMs << std::setw(15) << step.durationMs << std::endl;
+}
@@ -359,7 +359,7 @@ void TextBuilder::insert(unsigned char character, short topLeftX, short topLeftY
 
 void TextBuilder::build()
 {
-    for(const GlyphDraw& glyph : *mTextDraw.glyphDraws)
+    for(const GlyphDraw& glyph : mTextDraw.glyphDraws)
         insert(glyph.character, glyph.topLeft.x, glyph.topLeft.y, glyph.botRight.x, glyph.botRight.y);
 
     std::vector<Text> lines;
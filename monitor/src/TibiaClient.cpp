@@ -29,8 +29,6 @@
 #define WINVER _WIN32_WINNT_WS03
 #define _WIN32_WINNT _WIN32_WINNT_WS03
 #include <windows.h>
-#else
-#include <sys/mman.h>
 #endif // defined
 
 ///////////////////////////////////
@@ -38,6 +36,7 @@
 #include "monitor/TibiaClient.hpp"
 #include "injection/SharedMemoryProtocol.hpp"
 #include "utility/utility.hpp"
+#include "utility/SharedMemory.hpp"
 #include "monitor/Constants.hpp"
 #include "monitor/FrameFile.hpp"
 #include "monitor/TextBuilder.hpp"
@@ -80,22 +79,33 @@ using namespace sb::tibiaassets;
 
 ///////////////////////////////////
 // STD C
-#include <fcntl.h>
 #include <unistd.h>
 ///////////////////////////////////
 
-TibiaClient::TibiaClient(std::string clientDirectory, const TibiaContext& context)
+TibiaClient::TibiaClient(std::string clientDirectory, const TibiaContext& context, std::string recordingPath)
 : mContext(context)
 , mFrameParser(context)
 , mScene(context)
 , mGui(context)
 , mOutfitResolver(context)
+, mInterpreterPool(1)
+, mInterpreterGraph(mInterpreterPool)
 {
-
+    // Both only read the frame and the context.
+    mInterpreterGraph.addTask("Gui", [this]()
+    {
+        mGui.getData();
+    });
+    mInterpreterGraph.addTask("Scene", [this]()
+    {
+        mScene.update(*mInterpretedFrame);
+    });
 
     std::string sharedMemoryName;
     prepareSharedMemory(sharedMemoryName);
     mGraphicsMonitorReader.reset(new GraphicsMonitorReader(*this, context, mShm));
+    if(!recordingPath.empty())
+        mGraphicsMonitorReader->startRecording(recordingPath);
 
     char** tibiaEnv = prepareEnvironment();
     launchClient(tibiaEnv, clientDirectory, sharedMemoryName);
@@ -117,6 +127,11 @@ TibiaClient::~TibiaClient()
 
 void TibiaClient::close()
 {
+    // The reader's threads use the shared memory and its events, so they
+    // have to stop before any of it goes. MiniMap refers to the reader.
+    mMiniMap.reset();
+    mGraphicsMonitorReader.reset();
+
     if(mClientProcessHandle != NULL)
     {
         if(isAlive())
@@ -133,18 +148,15 @@ void TibiaClient::close()
         mClientProcessHandle = NULL;
     }
 
-    if(mShmHandle != NULL)
+    if(mSharedMemory != nullptr)
     {
         CloseHandle(mShm->window);
         CloseHandle(mShm->parentProcessHandle);
-        CloseHandle(mShm->semRead);
-        CloseHandle(mShm->semWrite);
-
-        UnmapViewOfFile(mShm);
-        CloseHandle(mShmHandle);
+        CloseHandle(mShm->frameCommittedEvent);
+        CloseHandle(mShm->slotReleasedEvent);
 
         mShm = nullptr;
-        mShmHandle = NULL;
+        mSharedMemory.reset();
     }
 }
 
@@ -288,6 +300,22 @@ std::shared_ptr<sb::messaging::Message> TibiaClient::handleGoRequest(const char*
     return response;
 }
 
+void TibiaClient::interpretFrame(const Frame& frame)
+{
+    // The state is known before parsing. Out of the game there is no scene,
+    // and the Gui is parsed when asked for.
+    mGui.update(frame);
+    if(mGui.getState() != Gui::State::GAME)
+        return;
+
+    // Gui parsing and the Scene run concurrently. MiniMap and
+    // OutfitResolver may send input or wait for frames, so they stay on
+    // the calling thread.
+    mInterpretedFrame = &frame;
+    mInterpreterGraph.run();
+    mInterpretedFrame = nullptr;
+}
+
 std::shared_ptr<sb::messaging::Message> TibiaClient::handleLoginRequest(const char* data, size_t size)
 {
     using namespace sb::messaging;
@@ -385,13 +413,12 @@ std::shared_ptr<sb::messaging::Message> TibiaClient::handleFrameRequest(const ch
     using namespace sb::messaging;;
     sb::Frame f;
 
-    mGui.update(frame);
+    interpretFrame(frame);
     if(mGui.getState() != Gui::State::GAME)
     {
         std::cout << "Cannot get frame. Not in game." << std::endl;
         return std::make_shared<FrameResponse>();
     }
-    mScene.update(frame);
     mMiniMap->update(frame);
     f.miniMap.x = mMiniMap->getX();
     f.miniMap.y = mMiniMap->getY();
@@ -408,7 +435,7 @@ std::shared_ptr<sb::messaging::Message> TibiaClient::handleFrameRequest(const ch
             const Scene::Tile& t = mScene.getTile(x, y);
             char currLayer = -1;
             std::vector<unsigned int>& objects = f.scene.objects[x][y];
-            for(const Scene::Object& o : t.knownLayerObjects)
+            for(const Scene::Object& o : t.objects)
             {
                 if(currLayer != o.layer)
                 {
@@ -541,11 +568,10 @@ void TibiaClient::update()
         mMiniMap->update(frame);
         lastFrameTime = std::chrono::steady_clock::now();
 
-        mGui.update(frame);
+        interpretFrame(frame);
         const Gui::Data& gui = mGui.getData();
         if(mGui.getState() == Gui::State::GAME)
         {
-            mScene.update(frame);
             mOutfitResolver.resolve(mScene, frame, *mGraphicsMonitorReader);
 
             std::cout << "Cap: " << gui.cap << std::endl;
@@ -1163,67 +1189,11 @@ void TibiaClient::update()
 
 void TibiaClient::prepareSharedMemory(std::string& sharedMemoryName)
 {
-    #if defined(_WIN32)
-
-    std::string sharedMemoryNamespace = "Local\\";
-    sharedMemoryName = sharedMemoryNamespace + sb::utility::randStr(SHARED_MEMORY_NAME_LENGTH - sharedMemoryNamespace.size());
-    mShmHandle = CreateFileMapping(
-             INVALID_HANDLE_VALUE,    // use paging file
-             NULL,                    // default security
-             PAGE_READWRITE,          // read/write access
-             0,                       // maximum object size (high-order DWORD)
-             NUM_BYTES,                // maximum object size (low-order DWORD)
-             sharedMemoryName.c_str());                 // name of mapping object
-
-    if (mShmHandle == NULL)
-    {
-        std::stringstream sstream;
-        sstream << "Could not create shared memory object (" << GetLastError() << ").";
-        THROW_RUNTIME_ERROR(sstream.str());
-    }
-
-    #else
-    int shmFd = shm_open("shared_memory", O_CREAT | O_TRUNC | O_RDWR, S_IRUSR | S_IWUSR);
-    int flags = fcntl(shmFd, F_GETFD);
-    flags &= ~FD_CLOEXEC;
-    fcntl(shmFd, F_SETFD, flags);
-
-    if(shmFd == -1)
-        THROW_RUNTIME_ERROR("Could not open shared memory.");
-
-    if(ftruncate(shmFd, NUM_BYTES) == -1)
-        THROW_RUNTIME_ERROR("Could not set shared memory size.");
-
-    mShmHandle = shmFd;
-    #endif // defined
-
-    mapSharedMemory();
-}
-
-void TibiaClient::mapSharedMemory()
-{
-    #if defined(_WIN32)
-    mShm = (SharedMemorySegment*)MapViewOfFile
-    (
-        mShmHandle,   // handle to map object
-        FILE_MAP_ALL_ACCESS, // read/write permission
-        0,
-        0,
-        NUM_BYTES
-    );
-
-    if(mShm == NULL)
-    {
-        std::stringstream sstream;
-        sstream << "Could not map shared memory (" << GetLastError() << ").";
-        THROW_RUNTIME_ERROR(sstream.str());
-    }
-    #else
-    mShm = (SharedMemorySegment*)mmap(nullptr, NUM_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, mShmHandle, 0);
-    if(mShm == MAP_FAILED)
-        THROW_RUNTIME_ERROR("Could not map shared memory.");
-    #endif // defined
-
+    sharedMemoryName = sb::utility::SharedMemory::generateName(SHARED_MEMORY_NAME_LENGTH);
+    mSharedMemory.reset(new sb::utility::SharedMemory(sharedMemoryName, NUM_BYTES, sb::utility::SharedMemory::Mode::CREATE));
+    mShm = (SharedMemorySegment*)mSharedMemory->getData();
+    mShm->frames.reset();
+    mShm->isPixelHashResyncRequested = false;
 }
 
 
@@ -1252,8 +1222,8 @@ void TibiaClient::launchClient(char** environment, std::string clientDirectory,
     parentSyncSecAttr.nLength = sizeof(SECURITY_ATTRIBUTES);
     parentSyncSecAttr.lpSecurityDescriptor = NULL;
     parentSyncSecAttr.bInheritHandle = TRUE;
-    mShm->semRead = CreateSemaphore(&parentSyncSecAttr, 0, 1, NULL);
-    mShm->semWrite = CreateSemaphore(&parentSyncSecAttr, 0, 1, NULL);
+    mShm->frameCommittedEvent = CreateEvent(&parentSyncSecAttr, FALSE, FALSE, NULL);
+    mShm->slotReleasedEvent = CreateEvent(&parentSyncSecAttr, FALSE, FALSE, NULL);
     mShm->parentProcessHandle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, TRUE, GetCurrentProcessId());
     if(mShm->parentProcessHandle == NULL)
     {
@@ -27,10 +27,64 @@
 ///////////////////////////////////
 // Internal ShankBot headers
 #include "monitor/TibiaContext.hpp"
+#include "utility/utility.hpp"
 using namespace GraphicsLayer;
 using namespace sb::tibiaassets;
 ///////////////////////////////////
 
+///////////////////////////////////
+// STD C++
+#include <chrono>
+///////////////////////////////////
+
+template<typename T>
+TibiaContext::Handle<T>::Handle()
+: mIsReady(false)
+, mReady(mPromise.get_future().share())
+{
+}
+
+template<typename T>
+void TibiaContext::Handle<T>::set(UPtr<T> value)
+{
+    mValue = std::move(value);
+    mIsReady.store(true, std::memory_order_release);
+    mPromise.set_value();
+}
+
+template<typename T>
+void TibiaContext::Handle<T>::setError(std::exception_ptr error)
+{
+    mPromise.set_exception(error);
+}
+
+template<typename T>
+bool TibiaContext::Handle<T>::isReady() const
+{
+    return mIsReady.load(std::memory_order_acquire);
+}
+
+template<typename T>
+bool TibiaContext::Handle<T>::isSettled() const
+{
+    return mReady.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+template<typename T>
+const T& TibiaContext::Handle<T>::get() const
+{
+    // Getters are called per draw, so the loaded case stays a single load
+    // and a predictable branch.
+    if(!mIsReady.load(std::memory_order_acquire))
+        mReady.get();
+
+    if(mValue == nullptr)
+        SB_THROW("The requested member of the Tibia context was not provided.");
+
+    return *mValue;
+}
+
+///////////////////////////////////
 
 TibiaContext::TibiaContext
 (
@@ -43,47 +97,161 @@ TibiaContext::TibiaContext
     UPtr<std::vector<FontSample::Glyph>>& glyphs
 )
 {
-    mObjects.reset(objects.release());
-    mSpriteObjectBindings.reset(spriteObjectBindings.release());
-    mSpriteColorTree.reset(spriteColorTree.release());
-    mSpriteTransparencyTree.reset(spriteTransparencyTree.release());
-    mSpriteInfo.reset(spriteInfo.release());
-    mGraphicsResourceNames.reset(graphicsResourceNames.release());
-    mGlyphs.reset(glyphs.release());
+    if(objects)
+        mObjectTraits.set(UPtr<ObjectTraits>(new ObjectTraits(*objects)));
+    else
+        mObjectTraits.set(nullptr);
+    mObjects.set(std::move(objects));
+    mSpriteObjectBindings.set(std::move(spriteObjectBindings));
+    mSpriteColorTree.set(std::move(spriteColorTree));
+    mSpriteTransparencyTree.set(std::move(spriteTransparencyTree));
+    mSpriteInfo.set(std::move(spriteInfo));
+    mGraphicsResourceNames.set(std::move(graphicsResourceNames));
+    if(glyphs)
+        mGlyphIndex.set(UPtr<GlyphIndex>(new GlyphIndex(*glyphs)));
+    else
+        mGlyphIndex.set(nullptr);
+    mGlyphs.set(std::move(glyphs));
+    mIsLoaded.set(UPtr<bool>(new bool(true)));
+}
+
+TibiaContext::TibiaContext(Loaders loaders, StartupProfile* profile)
+{
+    mLoader = std::thread([this, loaders, profile]() mutable
+    {
+        load(loaders, profile);
+    });
+}
+
+TibiaContext::~TibiaContext()
+{
+    if(mLoader.joinable())
+        mLoader.join();
+}
+
+void TibiaContext::load(Loaders& loaders, StartupProfile* profile)
+{
+    auto measure = [profile](const std::string& name, const std::function<void()>& func)
+    {
+        if(profile)
+            profile->measure(name, func);
+        else
+            func();
+    };
+
+    // Every handle is settled, with its value or with the first error, so
+    // that no getter waits forever.
+    std::exception_ptr error;
+    auto loadHandle = [&](const std::string& name, auto& handle, auto& loader)
+    {
+        if(error)
+        {
+            handle.setError(error);
+            return;
+        }
+
+        try
+        {
+            measure("Load " + name, [&]()
+            {
+                handle.set(loader());
+            });
+        }
+        catch(...)
+        {
+            error = std::current_exception();
+            handle.setError(error);
+        }
+    };
+    auto deriveHandle = [&](const std::string& name, auto& handle, auto&& derive)
+    {
+        auto loader = [&]()
+        {
+            return derive();
+        };
+        loadHandle(name, handle, loader);
+    };
+
+    // Text and sprite lookups happen on the first frame, object details are
+    // only needed once sprites have been matched.
+    loadHandle("glyphs", mGlyphs, loaders.glyphs);
+    deriveHandle("glyph index", mGlyphIndex, [this]()
+    {
+        return UPtr<GlyphIndex>(new GlyphIndex(mGlyphs.get()));
+    });
+    loadHandle("sprite color tree", mSpriteColorTree, loaders.spriteColorTree);
+    loadHandle("sprite transparency tree", mSpriteTransparencyTree, loaders.spriteTransparencyTree);
+    loadHandle("sprite object bindings", mSpriteObjectBindings, loaders.spriteObjectBindings);
+    loadHandle("graphics resource names", mGraphicsResourceNames, loaders.graphicsResourceNames);
+    loadHandle("sprite info", mSpriteInfo, loaders.spriteInfo);
+    loadHandle("objects", mObjects, loaders.objects);
+    deriveHandle("object traits", mObjectTraits, [this]()
+    {
+        return UPtr<ObjectTraits>(new ObjectTraits(mObjects.get()));
+    });
+
+    if(error)
+        mIsLoaded.setError(error);
+    else
+        mIsLoaded.set(UPtr<bool>(new bool(true)));
+}
+
+bool TibiaContext::isLoaded() const
+{
+    return mIsLoaded.isReady();
+}
+
+bool TibiaContext::isLoadFinished() const
+{
+    return mIsLoaded.isSettled();
+}
+
+void TibiaContext::waitUntilLoaded() const
+{
+    mIsLoaded.get();
 }
 
 const std::vector<Object>& TibiaContext::getObjects() const
 {
-    return *mObjects;
+    return mObjects.get();
+}
+
+const ObjectTraits& TibiaContext::getObjectTraits() const
+{
+    return mObjectTraits.get();
 }
 
 const SpriteObjectBindings& TibiaContext::getSpriteObjectBindings() const
 {
-    return *mSpriteObjectBindings;
+    return mSpriteObjectBindings.get();
 }
 
 const SequenceTree& TibiaContext::getSpriteColorTree() const
 {
-    return *mSpriteColorTree;
+    return mSpriteColorTree.get();
 }
 
 const SequenceTree& TibiaContext::getSpriteTransparencyTree() const
 {
-    return *mSpriteTransparencyTree;
+    return mSpriteTransparencyTree.get();
 }
 
 const SpriteInfo& TibiaContext::getSpriteInfo() const
 {
-    return *mSpriteInfo;
+    return mSpriteInfo.get();
 }
 
 const std::vector<std::string>& TibiaContext::getGraphicsResourceNames() const
 {
-    return *mGraphicsResourceNames;
+    return mGraphicsResourceNames.get();
 }
 
 const std::vector<FontSample::Glyph>& TibiaContext::getGlyphs() const
 {
-    return *mGlyphs;
+    return mGlyphs.get();
 }
 
+const GlyphIndex& TibiaContext::getGlyphIndex() const
+{
+    return mGlyphIndex.get();
+}
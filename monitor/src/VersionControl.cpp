@@ -29,6 +29,7 @@
 #include "monitor/VersionControl.hpp"
 #include "utility/file.hpp"
 #include "utility/utility.hpp"
+#include "utility/MappedFile.hpp"
 using namespace sb::utility::file;
 ///////////////////////////////////
 
@@ -40,6 +41,12 @@ using namespace sb::utility::file;
 ///////////////////////////////////
 // STD C++
 #include <fstream>
+#include <iomanip>
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C
+#include <cstdio>
 ///////////////////////////////////
 
 
@@ -50,6 +57,8 @@ using namespace GraphicsLayer;
 const std::string VersionControl::OLD_PATH = "/old";
 const std::string VersionControl::CURRENT_PATH = "/current";
 const std::string VersionControl::CURRENT_VERSION_PATH = CURRENT_PATH + "/version";
+const std::string VersionControl::CURRENT_MANIFEST_PATH = CURRENT_PATH + "/manifest";
+const std::string VersionControl::CACHE_PATH = "/cache";
 #if defined(_WIN32)
 const std::string VersionControl::CLIENT_MODULE_NAME = "/client.exe";
 #else
@@ -69,6 +78,11 @@ std::string VersionControl::getPath(std::string versionControlDir)
     return versionControlDir + CURRENT_PATH;
 }
 
+std::string VersionControl::getCachePath(std::string versionControlDir)
+{
+    return versionControlDir + CACHE_PATH;
+}
+
 bool VersionControl::hasNewVersion(std::string clientDir, std::string versionControlDir)
 {
     checkClientFiles(clientDir);
@@ -85,6 +99,8 @@ void VersionControl::prepareFiles(std::string versionControlDir)
 
     std::string currentVersionDir = versionControlDir + CURRENT_PATH;
     makeDirIfNotExists(currentVersionDir);
+
+    makeDirIfNotExists(getCachePath(versionControlDir));
 }
 
 void VersionControl::checkClientFiles(std::string clientDir)
@@ -113,6 +129,40 @@ void VersionControl::checkout(std::string versionControlDir)
     mVersionFile.toFile(currentVersionPath);
 }
 
+uint64_t VersionControl::hashFile(const std::string& path)
+{
+    sb::utility::MappedFile file(path);
+    return sb::utility::hash64(file.getData(), file.getSize());
+}
+
+uint64_t VersionControl::combineKeys(const std::vector<uint64_t>& keys)
+{
+    return sb::utility::hash64(keys.data(), keys.size() * sizeof(uint64_t));
+}
+
+bool VersionControl::isUpToDate(std::string versionControlDir, const std::string& artifact, uint64_t inputKey)
+{
+    std::string manifestPath = versionControlDir + CURRENT_MANIFEST_PATH;
+    if(!fileExists(manifestPath))
+        return false;
+
+    ManifestFile manifest = ManifestFile::fromFile(manifestPath);
+    auto it = manifest.keys.find(artifact);
+    return it != manifest.keys.end() && it->second == inputKey;
+}
+
+void VersionControl::commit(std::string versionControlDir, const std::string& artifact, uint64_t inputKey)
+{
+    prepareFiles(versionControlDir);
+    std::string manifestPath = versionControlDir + CURRENT_MANIFEST_PATH;
+    ManifestFile manifest;
+    if(fileExists(manifestPath))
+        manifest = ManifestFile::fromFile(manifestPath);
+
+    manifest.keys[artifact] = inputKey;
+    manifest.toFile(manifestPath);
+}
+
 
 bool VersionControl::updateVersion(std::string clientDir, std::string versionControlDir)
 {
@@ -133,14 +183,28 @@ bool VersionControl::updateVersion(std::string clientDir, std::string versionCon
     std::string currentVersionDir = sb::utility::file::getPath(currentVersionPath);
     std::string oldVersionsDir = versionControlDir + OLD_PATH;
     backup(oldVersionsDir, currentVersionDir);
-    recursiveRemove(currentVersionDir, false);
+
+    // The artifacts stay, so that only the stale ones are regenerated. The
+    // version is checked out again once they are.
+    if(remove(currentVersionPath.c_str()) != 0)
+        SB_THROW("Could not remove '" + currentVersionPath + "'.");
+
     return true;
 }
 
 void VersionControl::backup(std::string oldVersionsDir, std::string currentVersionDir)
 {
-    std::string backupPath = recursiveCopy(currentVersionDir, oldVersionsDir);
-    renameFile(backupPath, sb::utility::getDateTime());
+    // Only the version and manifest are kept. Every other file in the
+    // current directory is regenerated from the client files, and some of
+    // them are far too big to copy on every version bump.
+    std::string backupPath = oldVersionsDir + "/" + sb::utility::getDateTime();
+    makeDirIfNotExists(backupPath);
+    for(const std::string& path : {CURRENT_VERSION_PATH, CURRENT_MANIFEST_PATH})
+    {
+        std::string file = currentVersionDir + "/" + basename(path);
+        if(fileExists(file))
+            copyFile(file, backupPath);
+    }
 }
 
 std::string VersionControl::getTibiaVersion(std::string clientDir)
@@ -174,3 +238,22 @@ VersionControl::VersionFile VersionControl::VersionFile::fromFile(std::string pa
     file >> versionFile.version;
     return versionFile;
 }
+
+void VersionControl::ManifestFile::toFile(std::string path) const
+{
+    std::ofstream file(path);
+    for(const auto& pair : keys)
+        file    << pair.first << " " << std::hex << std::setw(16) << std::setfill('0') << pair.second << std::endl;
+    file.close();
+}
+
+VersionControl::ManifestFile VersionControl::ManifestFile::fromFile(std::string path)
+{
+    ManifestFile manifestFile;
+    std::ifstream file(path);
+    std::string artifact;
+    uint64_t key;
+    while(file >> artifact >> std::hex >> key)
+        manifestFile.keys[artifact] = key;
+    return manifestFile;
+}
@@ -34,7 +34,8 @@ int main(int argc, char** argv)
 
     std::string tibiaDir = "C:/Users/Vendrii/Documents/programming/projects/ShankBot/monitor/tibia";
     std::string versionControlDir = "C:/Users/Vendrii/Documents/programming/projects/ShankBot/monitor/version-control";
-    GraphicsLayer::ShankBot sb(tibiaDir, versionControlDir);
+    std::string recordingPath = (argc > 1 ? argv[1] : "");
+    GraphicsLayer::ShankBot sb(tibiaDir, versionControlDir, recordingPath);
     sb.run();
 
     return 0;
@@ -0,0 +1,68 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef GRAPHICS_LAYER_LATENCY_STATS_HPP
+#define GRAPHICS_LAYER_LATENCY_STATS_HPP
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <string>
+#include <ostream>
+///////////////////////////////////
+
+namespace GraphicsLayer
+{
+    // Collects latency samples of one stage and summarizes them.
+    class LatencyStats
+    {
+        public:
+            explicit LatencyStats(std::string name);
+
+            void add(double microseconds);
+
+            const std::string& getName() const;
+            size_t getCount() const;
+            double getTotal() const;
+            double getMean() const;
+            double getMax() const;
+
+            // Nearest rank percentile, p in [0, 100].
+            double getPercentile(double p) const;
+
+            static void printHeader(std::ostream& stream);
+            void print(std::ostream& stream) const;
+
+        private:
+            std::string mName;
+            mutable std::vector<double> mSamples;
+            mutable bool mIsSorted = true;
+            double mTotal = 0.0;
+    };
+}
+
+
+#endif // GRAPHICS_LAYER_LATENCY_STATS_HPP
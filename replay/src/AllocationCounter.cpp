@@ -0,0 +1,113 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "replay/AllocationCounter.hpp"
+using namespace GraphicsLayer;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <atomic>
+#include <new>
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C
+#include <cstdlib>
+///////////////////////////////////
+
+namespace
+{
+    std::atomic<size_t> numAllocations(0);
+
+    void* allocate(size_t size)
+    {
+        numAllocations.fetch_add(1, std::memory_order_relaxed);
+        if(void* data = std::malloc(size == 0 ? 1 : size))
+            return data;
+
+        throw std::bad_alloc();
+    }
+}
+
+size_t AllocationCounter::getCount()
+{
+    return numAllocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    numAllocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    numAllocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* data) noexcept
+{
+    std::free(data);
+}
+
+void operator delete[](void* data) noexcept
+{
+    std::free(data);
+}
+
+void operator delete(void* data, size_t) noexcept
+{
+    std::free(data);
+}
+
+void operator delete[](void* data, size_t) noexcept
+{
+    std::free(data);
+}
+
+void operator delete(void* data, const std::nothrow_t&) noexcept
+{
+    std::free(data);
+}
+
+void operator delete[](void* data, const std::nothrow_t&) noexcept
+{
+    std::free(data);
+}
@@ -0,0 +1,132 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "replay/LatencyStats.hpp"
+using namespace GraphicsLayer;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <algorithm>
+#include <iomanip>
+#include <cmath>
+///////////////////////////////////
+
+LatencyStats::LatencyStats(std::string name)
+: mName(name)
+{
+
+}
+
+///////////////////////////////////
+
+void LatencyStats::add(double microseconds)
+{
+    mSamples.push_back(microseconds);
+    mIsSorted = false;
+    mTotal += microseconds;
+}
+
+///////////////////////////////////
+
+const std::string& LatencyStats::getName() const
+{
+    return mName;
+}
+
+///////////////////////////////////
+
+size_t LatencyStats::getCount() const
+{
+    return mSamples.size();
+}
+
+///////////////////////////////////
+
+double LatencyStats::getTotal() const
+{
+    return mTotal;
+}
+
+///////////////////////////////////
+
+double LatencyStats::getMean() const
+{
+    return mSamples.empty() ? 0.0 : mTotal / mSamples.size();
+}
+
+///////////////////////////////////
+
+double LatencyStats::getMax() const
+{
+    return getPercentile(100.0);
+}
+
+///////////////////////////////////
+
+double LatencyStats::getPercentile(double p) const
+{
+    if(mSamples.empty())
+        return 0.0;
+
+    if(!mIsSorted)
+    {
+        std::sort(mSamples.begin(), mSamples.end());
+        mIsSorted = true;
+    }
+
+    size_t rank = std::ceil(p / 100.0 * mSamples.size());
+    return mSamples[std::min(std::max<size_t>(rank, 1), mSamples.size()) - 1];
+}
+
+///////////////////////////////////
+
+void LatencyStats::printHeader(std::ostream& stream)
+{
+    stream  << std::left << std::setw(20) << "stage" << std::right
+            << std::setw(10) << "count"
+            << std::setw(12) << "mean us"
+            << std::setw(12) << "p50 us"
+            << std::setw(12) << "p90 us"
+            << std::setw(12) << "p99 us"
+            << std::setw(12) << "max us" << std::endl;
+}
+
+///////////////////////////////////
+
+void LatencyStats::print(std::ostream& stream) const
+{
+    stream  << std::left << std::setw(20) << mName << std::right
+            << std::setw(10) << getCount()
+            << std::fixed << std::setprecision(1)
+            << std::setw(12) << getMean()
+            << std::setw(12) << getPercentile(50)
+            << std::setw(12) << getPercentile(90)
+            << std::setw(12) << getPercentile(99)
+            << std::setw(12) << getMax() << std::endl;
+}
@@ -0,0 +1,409 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "replay/LatencyStats.hpp"
+#include "replay/AllocationCounter.hpp"
+#include "monitor/FrameRecording.hpp"
+#include "monitor/FrameParser.hpp"
+#include "monitor/FramePipeline.hpp"
+#include "monitor/GuiParser.hpp"
+#include "monitor/TextParser.hpp"
+#include "monitor/RectParser.hpp"
+#include "monitor/GuiSpriteParser.hpp"
+#include "monitor/SceneParser.hpp"
+#include "monitor/SideBarWindowAssembler.hpp"
+#include "monitor/SideBarWindowDiff.hpp"
+#include "monitor/FrameInterpreter.hpp"
+#include "monitor/TibiaContext.hpp"
+#include "monitor/VersionControl.hpp"
+#include "monitor/SequenceTree.hpp"
+#include "monitor/SpriteObjectBindings.hpp"
+#include "monitor/SpriteInfo.hpp"
+#include "monitor/GlyphsFile.hpp"
+#include "tibiaassets/CatalogContent.hpp"
+#include "tibiaassets/AppearancesReader.hpp"
+#include "tibiaassets/GraphicsResourceReader.hpp"
+#include "utility/utility.hpp"
+#include "utility/WorkStealingPool.hpp"
+using namespace GraphicsLayer;
+using namespace sb::tibiaassets;
+using sb::utility::WorkStealingPool;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <iostream>
+#include <memory>
+#include <chrono>
+#include <cassert>
+#include <atomic>
+#include <iomanip>
+///////////////////////////////////
+
+// Feeds a frame recording made by ShankBotMonitor through the frame parsing
+// stages and reports how long each of them took. The client does not have
+// to be running, but its installation is still read: the context is built
+// from its catalog, appearances and graphics resources, together with the
+// sprite data ShankBotMonitor stored for that client version.
+//
+// Usage: ShankBotReplay <recording> <client dir> <version control dir> [passes] [parallel|pipelined]
+//
+// In parallel mode the parsers of a frame run concurrently, as the task
+// graph of a FrameInterpreter. In pipelined mode the recording is fed
+// through a FramePipeline, with a FrameInterpreter as its interpreter, and
+// the busy time of every stage is reported.
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    double getMicroseconds(Clock::time_point start, Clock::time_point end)
+    {
+        return std::chrono::duration<double, std::micro>(end - start).count();
+    }
+
+    // The same context ShankBot creates, loaded from the files it stored
+    // under the version control directory.
+    std::unique_ptr<TibiaContext> loadContext(const std::string& clientDir, const std::string& versionControlDir)
+    {
+        if(VersionControl::hasNewVersion(clientDir, versionControlDir))
+            SB_THROW("The stored data is out of date. Run ShankBotMonitor once to regenerate it.");
+
+        const std::string STORAGE_PATH = VersionControl::getPath(versionControlDir);
+        CatalogContent cat(clientDir + "/packages/Tibia/assets/catalog-content.json");
+        const std::list<CatalogContent::Appearances>& appearanceses = cat.getAppearances();
+        assert(appearanceses.size() == 1);
+
+        AppearancesReader appearances(appearanceses.front().path);
+        auto objects = std::make_unique<std::vector<Object>>(appearances.getObjects());
+        auto graphicsResourceNames = std::make_unique<std::vector<std::string>>(GraphicsResourceReader::readNames(clientDir + "/packages/Tibia/bin/graphics_resources.rcc"));
+        auto bindings = std::make_unique<SpriteObjectBindings>(STORAGE_PATH + "/sprite-object-bindings.bin");
+        auto spriteInfo = std::make_unique<SpriteInfo>(cat.getSpriteSheets());
+        auto spriteColorTree = std::make_unique<SequenceTree>(STORAGE_PATH + "/tree-sprite-color.bin");
+        auto spriteTransparencyTree = std::make_unique<SequenceTree>(STORAGE_PATH + "/tree-sprite-transparency.bin");
+        auto glyphs = std::make_unique<std::vector<FontSample::Glyph>>();
+        if(!GlyphsFile::read(*glyphs, STORAGE_PATH + "/glyphs.bin"))
+            SB_THROW("Could not read the glyph samples.");
+
+        return std::make_unique<TibiaContext>
+        (
+            objects,
+            bindings,
+            spriteColorTree,
+            spriteTransparencyTree,
+            spriteInfo,
+            graphicsResourceNames,
+            glyphs
+        );
+    }
+
+    struct Stats
+    {
+        LatencyStats frameParser = LatencyStats("FrameParser");
+        LatencyStats gui = LatencyStats("GuiParser");
+        LatencyStats text = LatencyStats("TextParser");
+        LatencyStats rect = LatencyStats("RectParser");
+        LatencyStats guiSprite = LatencyStats("GuiSpriteParser");
+        LatencyStats scene = LatencyStats("SceneParser");
+        LatencyStats sideBar = LatencyStats("SideBarWindowAssembler");
+        LatencyStats sideBarDiff = LatencyStats("SideBarWindowDiff");
+        LatencyStats frame = LatencyStats("Total per frame");
+        size_t numFailedFrames = 0;
+        size_t numFrameParserAllocations = 0;
+        size_t numAllocations = 0;
+        SharedMemoryProtocol::MessageCursor::Counters messages;
+        size_t numRejectedSegments = 0;
+        size_t numRecognitionCacheHits = 0;
+        size_t numRecognitionCacheMisses = 0;
+        std::vector<FramePipeline::StageStats> stages;
+        size_t numPipelinedFrames = 0;
+    };
+
+    // One pass over the whole recording. The parsers are created anew, since
+    // FrameParser has to see the recording from its first slot. Given a
+    // pool, the parsers of a frame run concurrently on it.
+    void replay(const FrameRecording::Reader& recording, const TibiaContext& context, Stats& stats, WorkStealingPool* pool)
+    {
+        std::unique_ptr<FrameInterpreter> interpreter;
+        if(pool)
+            interpreter.reset(new FrameInterpreter(context, *pool));
+
+        // In the order of FrameInterpreter::Task.
+        LatencyStats* taskStats[] = {&stats.gui, &stats.text, &stats.rect, &stats.guiSprite, &stats.scene, &stats.sideBar, &stats.sideBarDiff};
+        static_assert(sizeof(taskStats) / sizeof(*taskStats) == size_t(FrameInterpreter::Task::NUM_TASKS), "Every task needs its stats.");
+
+        FrameParser frameParser(context);
+        GuiParser gui;
+        TextParser text;
+        RectParser rect;
+        GuiSpriteParser guiSprite;
+        SceneParser scene(context);
+        SideBarWindowAssembler sideBar(context);
+        SideBarWindowDiff sideBarDiff;
+        for(const FrameRecording::Chunk& chunk : recording.getChunks())
+        {
+            const size_t numAllocationsStart = AllocationCounter::getCount();
+            Clock::time_point start = Clock::now();
+            std::list<Frame> frames = frameParser.parse(chunk.data, chunk.size);
+            Clock::time_point end = Clock::now();
+            stats.frameParser.add(getMicroseconds(start, end));
+            stats.numFrameParserAllocations += AllocationCounter::getCount() - numAllocationsStart;
+
+            // A frame spanning several slots is completed by the last one, so
+            // it is charged for that slot only.
+            double frameParserTime = getMicroseconds(start, end);
+            for(const Frame& frame : frames)
+            {
+                try
+                {
+                    if(interpreter)
+                    {
+                        Clock::time_point frameStart = Clock::now();
+                        interpreter->interpret(frame);
+                        Clock::time_point frameEnd = Clock::now();
+                        for(size_t i = 0; i < size_t(FrameInterpreter::Task::NUM_TASKS); i++)
+                            taskStats[i]->add(interpreter->getMicroseconds(FrameInterpreter::Task(i)));
+
+                        stats.frame.add(frameParserTime + getMicroseconds(frameStart, frameEnd));
+                        frameParserTime = 0.0;
+                        continue;
+                    }
+
+                    Clock::time_point stageStart = Clock::now();
+                    auto lap = [&stageStart](LatencyStats& stageStats)
+                    {
+                        Clock::time_point stageEnd = Clock::now();
+                        stageStats.add(getMicroseconds(stageStart, stageEnd));
+                        stageStart = stageEnd;
+                    };
+
+                    Clock::time_point frameStart = stageStart;
+                    gui.parse(frame);
+                    lap(stats.gui);
+                    text.parse(frame, gui.getData());
+                    lap(stats.text);
+                    rect.parse(frame);
+                    lap(stats.rect);
+                    guiSprite.parse(frame);
+                    lap(stats.guiSprite);
+                    scene.parse(frame);
+                    lap(stats.scene);
+                    sideBar.assemble(frame, gui.getData(), text.getData(), rect.getData(), guiSprite.getData());
+                    lap(stats.sideBar);
+                    sideBarDiff.parse(frame, sideBar.getData());
+                    lap(stats.sideBarDiff);
+                    stats.frame.add(frameParserTime + getMicroseconds(frameStart, stageStart));
+                }
+                catch(const std::exception& e)
+                {
+                    stats.numFailedFrames++;
+                    std::cerr << "Frame " << stats.frame.getCount() + stats.numFailedFrames << " failed: " << e.what() << std::endl;
+                }
+
+                frameParserTime = 0.0;
+            }
+
+            // Includes releasing the frames, which hands them back to the pool.
+            frames.clear();
+            stats.numAllocations += AllocationCounter::getCount() - numAllocationsStart;
+        }
+
+        stats.messages += frameParser.getMessageCounters();
+        stats.numRejectedSegments += frameParser.getNumRejectedSegments();
+        stats.numRecognitionCacheHits += frameParser.getNumRecognitionCacheHits();
+        stats.numRecognitionCacheMisses += frameParser.getNumRecognitionCacheMisses();
+    }
+
+    // The same work as replay(), split into the stages of a FramePipeline.
+    void replayPipelined(const FrameRecording::Reader& recording, const TibiaContext& context, Stats& stats)
+    {
+        size_t chunkIndex = 0;
+        auto source = [&recording, &chunkIndex](const char*& data, size_t& size)
+        {
+            if(chunkIndex >= recording.getChunks().size())
+                return false;
+
+            const FrameRecording::Chunk& chunk = recording.getChunks()[chunkIndex++];
+            data = chunk.data;
+            size = chunk.size;
+            return true;
+        };
+        // The chunks point into the mapped recording and outlive the pipeline.
+        auto release = [](){};
+        FramePipeline pipeline(context, source, release);
+
+        WorkStealingPool pool;
+        FrameInterpreter interpreter(context, pool);
+        std::atomic<size_t> numFailedFrames(0);
+        pipeline.addInterpreter("FrameInterpreter", [&](const FramePipeline::SharedFrame& frame)
+        {
+            try
+            {
+                interpreter.interpret(frame->frame);
+            }
+            catch(const std::exception& e)
+            {
+                numFailedFrames++;
+                std::cerr << "Frame " << frame->sequence << " failed: " << e.what() << std::endl;
+            }
+        });
+
+        pipeline.start();
+        pipeline.join();
+
+        stats.numFailedFrames += numFailedFrames;
+        stats.numPipelinedFrames += pipeline.getNumInterpretedFrames();
+        std::vector<FramePipeline::StageStats> stageStats = pipeline.getStageStats();
+        stats.stages.resize(stageStats.size());
+        for(size_t i = 0; i < stageStats.size(); i++)
+        {
+            FramePipeline::StageStats& s = stats.stages[i];
+            s.name = stageStats[i].name;
+            s.numItems += stageStats[i].numItems;
+            s.busyMicroseconds += stageStats[i].busyMicroseconds;
+            s.maxMicroseconds = std::max(s.maxMicroseconds, stageStats[i].maxMicroseconds);
+        }
+
+        stats.messages += pipeline.getFrameParser().getMessageCounters();
+        stats.numRejectedSegments += pipeline.getFrameParser().getNumRejectedSegments();
+        stats.numRecognitionCacheHits += pipeline.getFrameParser().getNumRecognitionCacheHits();
+        stats.numRecognitionCacheMisses += pipeline.getFrameParser().getNumRecognitionCacheMisses();
+    }
+
+    // The busy share of the wall clock time shows which stage bounds the
+    // throughput.
+    void printStages(const std::vector<FramePipeline::StageStats>& stages, double wallTime, std::ostream& stream)
+    {
+        stream << std::left << std::setw(28) << "Stage" << std::right
+               << std::setw(10) << "Count"
+               << std::setw(12) << "Mean (us)"
+               << std::setw(12) << "Max (us)"
+               << std::setw(10) << "Busy" << std::endl;
+        for(const FramePipeline::StageStats& s : stages)
+        {
+            stream << std::left << std::setw(28) << s.name << std::right << std::fixed << std::setprecision(1)
+                   << std::setw(10) << s.numItems
+                   << std::setw(12) << (s.numItems > 0 ? s.busyMicroseconds / s.numItems : 0.0)
+                   << std::setw(12) << s.maxMicroseconds
+                   << std::setw(9) << 100.0 * s.busyMicroseconds / wallTime << "%" << std::endl;
+        }
+        stream.unsetf(std::ios::floatfield);
+        stream << std::setprecision(6);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <recording> <client dir> <version control dir> [passes] [parallel|pipelined]" << std::endl;
+        return 1;
+    }
+
+    const size_t NUM_PASSES = (argc > 4 ? std::max(std::stoul(argv[4]), 1ul) : 1);
+    const std::string MODE = (argc > 5 ? argv[5] : "");
+    const bool IS_PIPELINED = (MODE == "pipelined");
+    if(!MODE.empty() && MODE != "parallel" && !IS_PIPELINED)
+    {
+        std::cerr << "Unknown mode: " << MODE << std::endl;
+        return 1;
+    }
+    try
+    {
+        std::cout << "Loading context... " << std::flush;
+        std::unique_ptr<TibiaContext> context = loadContext(argv[2], argv[3]);
+        std::cout << "Done" << std::endl;
+
+        std::cout << "Loading recording... " << std::flush;
+        FrameRecording::Reader recording(argv[1]);
+        std::cout << recording.getChunks().size() << " slots" << std::endl;
+
+        std::unique_ptr<WorkStealingPool> pool;
+        if(MODE == "parallel")
+            pool.reset(new WorkStealingPool());
+
+        Stats stats;
+        Clock::time_point start = Clock::now();
+        for(size_t i = 0; i < NUM_PASSES; i++)
+        {
+            if(IS_PIPELINED)
+                replayPipelined(recording, *context, stats);
+            else
+                replay(recording, *context, stats, pool.get());
+        }
+        double wallTime = getMicroseconds(start, Clock::now());
+
+        if(IS_PIPELINED)
+        {
+            printStages(stats.stages, wallTime, std::cout);
+            std::cout << std::endl;
+            std::cout << "Frames: " << stats.numPipelinedFrames << " (" << stats.numFailedFrames << " failed) in " << NUM_PASSES << " passes" << std::endl;
+            std::cout << "Frames per second: " << stats.numPipelinedFrames / (wallTime / 1e6) << " wall clock" << std::endl;
+        }
+        else
+        {
+            LatencyStats::printHeader(std::cout);
+            for(const LatencyStats* s : {&stats.frameParser, &stats.gui, &stats.text, &stats.rect, &stats.guiSprite, &stats.scene, &stats.sideBar, &stats.sideBarDiff, &stats.frame})
+                s->print(std::cout);
+
+            const size_t NUM_FRAMES = stats.frame.getCount();
+            std::cout << std::endl;
+            std::cout << "Frames: " << NUM_FRAMES << " (" << stats.numFailedFrames << " failed) in " << NUM_PASSES << " passes" << std::endl;
+            if(NUM_FRAMES > 0)
+            {
+                std::cout << "Frames per second: " << NUM_FRAMES / (stats.frame.getTotal() / 1e6) << " parsing, "
+                          << NUM_FRAMES / (wallTime / 1e6) << " wall clock" << std::endl;
+                std::cout << "Allocations per frame: " << double(stats.numAllocations) / NUM_FRAMES << " ("
+                          << double(stats.numFrameParserAllocations) / NUM_FRAMES << " in FrameParser)" << std::endl;
+            }
+        }
+
+        std::cout << std::endl;
+        std::cout << "Rejected segments: " << stats.numRejectedSegments << std::endl;
+        const size_t numRecognitionLookups = stats.numRecognitionCacheHits + stats.numRecognitionCacheMisses;
+        if(numRecognitionLookups > 0)
+            std::cout << "Tile recognition cache: " << stats.numRecognitionCacheHits << " hits, "
+                      << stats.numRecognitionCacheMisses << " misses ("
+                      << 100.0 * stats.numRecognitionCacheHits / numRecognitionLookups << "% hit rate)" << std::endl;
+        for(size_t i = 0; i < SharedMemoryProtocol::MessageCursor::NUM_MESSAGE_TYPES; i++)
+        {
+            if(stats.messages.numMessages[i] == 0)
+                continue;
+
+            SharedMemoryProtocol::Message::MessageType type = SharedMemoryProtocol::Message::MessageType(i);
+            std::cout << SharedMemoryProtocol::MessageCursor::getName(type) << ": " << stats.messages.numMessages[i] << " messages, "
+                      << stats.messages.numBytes[i] << " bytes" << std::endl;
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,313 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "tibiaassets/AppearancesReader.hpp"
+#include "utility/utility.hpp"
+using namespace sb::tibiaassets;
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <random>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <stdexcept>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// AppearancesReaderTest
+////////////////////////////////////////
+class AppearancesReaderTest : public ::testing::Test
+{
+public:
+    typedef std::vector<unsigned char> Bytes;
+
+    static void writeVarint(size_t v, Bytes& out)
+    {
+        while(v >= 0x80)
+        {
+            out.push_back((v & 0x7f) | 0x80);
+            v >>= 7;
+        }
+        out.push_back(v);
+    }
+
+    static void writeField(size_t op, const Bytes& field, Bytes& out)
+    {
+        writeVarint(op, out);
+        writeVarint(field.size(), out);
+        out.insert(out.end(), field.begin(), field.end());
+    }
+
+    static Bytes encode(const Object& o)
+    {
+        Bytes body;
+        body.push_back(0x08);
+        writeVarint(o.id, body);
+        for(const Object::SomeInfo& info : o.someInfos)
+        {
+            const Object::SpriteInfo& s = info.spriteInfo;
+            Bytes sprite = {0x08, s.numDirections, 0x10, s.numAddons, 0x18, s.numMounts, 0x20, s.numBlendFrames, 0x40, s.unknown1};
+            for(unsigned int id : s.spriteIds)
+            {
+                sprite.push_back(0x28);
+                writeVarint(id, sprite);
+            }
+            if(!s.animationInfo.frameInfos.empty())
+            {
+                Bytes animation = {0x08, 0x01};
+                for(const Object::FrameInfo& f : s.animationInfo.frameInfos)
+                {
+                    Bytes frame = {0x08};
+                    writeVarint(f.animationDelayMin, frame);
+                    frame.push_back(0x10);
+                    writeVarint(f.animationDelayMax, frame);
+                    writeField(0x32, frame, animation);
+                }
+                writeField(0x32, animation, sprite);
+            }
+
+            Bytes someInfo = {0x08, info.unknown1, 0x10, (unsigned char)info.animationType};
+            writeField(0x1a, sprite, someInfo);
+            writeField(0x12, someInfo, body);
+        }
+
+        const Object::ItemInfo& i = o.itemInfo;
+        Bytes item = {0x30, i.isStackable};
+        writeVarint(0xda, item);
+        writeVarint(2, item);
+        item.push_back(0x08);
+        item.push_back(i.height);
+        if(i.hasMarketInfo)
+        {
+            Bytes market = {0x10};
+            writeVarint(i.marketInfo.id1, market);
+            Bytes name(i.marketInfo.name.begin(), i.marketInfo.name.end());
+            writeField(0x22, name, market);
+            writeField(0x122, market, item);
+        }
+        writeField(0x1a, item, body);
+
+        Bytes out = {(unsigned char)o.type};
+        writeVarint(body.size(), out);
+        out.insert(out.end(), body.begin(), body.end());
+        return out;
+    }
+
+    static std::vector<Object> makeObjects(size_t numObjects, unsigned int seed)
+    {
+        const Object::Type TYPES[] = {Object::Type::ITEM, Object::Type::OUTFIT, Object::Type::EFFECT, Object::Type::PROJECTILE};
+        const char* NAMES[] = {"backpack", "sword", "apple", "a very long name that does not fit in small buffers"};
+        std::mt19937 rng(seed);
+        std::vector<Object> objects(numObjects);
+        for(size_t i = 0; i < numObjects; i++)
+        {
+            Object& o = objects[i];
+            o.type = TYPES[rng() % 4];
+            o.id = 100 + i;
+            o.someInfos.resize(1 + rng() % 3);
+            for(Object::SomeInfo& info : o.someInfos)
+            {
+                info.unknown1 = rng() % 2;
+                info.animationType = Object::AnimationType(rng() % 2);
+                Object::SpriteInfo& s = info.spriteInfo;
+                s.numDirections = 1 + rng() % 4;
+                s.numAddons = 1 + rng() % 3;
+                s.numMounts = 1 + rng() % 2;
+                s.numBlendFrames = 1 + rng() % 2;
+                s.unknown1 = rng() % 2;
+                s.spriteIds.resize(1 + rng() % 16);
+                for(unsigned int& id : s.spriteIds)
+                    id = rng() % 500000;
+                s.animationInfo.frameInfos.resize(rng() % 4);
+                for(Object::FrameInfo& f : s.animationInfo.frameInfos)
+                {
+                    f.animationDelayMin = rng() % 1000;
+                    f.animationDelayMax = f.animationDelayMin + rng() % 1000;
+                }
+            }
+            o.itemInfo.isStackable = rng() % 2;
+            o.itemInfo.height = rng() % 32;
+            o.itemInfo.hasMarketInfo = rng() % 2;
+            if(o.itemInfo.hasMarketInfo)
+            {
+                o.itemInfo.marketInfo.id1 = rng() % 10000;
+                o.itemInfo.marketInfo.name = NAMES[rng() % 4];
+            }
+        }
+
+        return objects;
+    }
+
+    void writeFile(const std::vector<Object>& objects)
+    {
+        std::ofstream file(PATH, std::ios::binary);
+        for(const Object& o : objects)
+        {
+            Bytes bytes = encode(o);
+            file.write((const char*)bytes.data(), bytes.size());
+        }
+    }
+
+    ~AppearancesReaderTest()
+    {
+        std::remove(PATH);
+    }
+
+    static void expectEqual(const Object& a, const Object& b)
+    {
+        ASSERT_EQ(a.type, b.type);
+        ASSERT_EQ(a.id, b.id);
+        ASSERT_EQ(a.someInfos.size(), b.someInfos.size());
+        for(size_t i = 0; i < a.someInfos.size(); i++)
+        {
+            const Object::SomeInfo& x = a.someInfos[i];
+            const Object::SomeInfo& y = b.someInfos[i];
+            ASSERT_EQ(x.unknown1, y.unknown1);
+            ASSERT_EQ(x.animationType, y.animationType);
+            ASSERT_EQ(x.spriteInfo.numDirections, y.spriteInfo.numDirections);
+            ASSERT_EQ(x.spriteInfo.numAddons, y.spriteInfo.numAddons);
+            ASSERT_EQ(x.spriteInfo.numMounts, y.spriteInfo.numMounts);
+            ASSERT_EQ(x.spriteInfo.numBlendFrames, y.spriteInfo.numBlendFrames);
+            ASSERT_EQ(x.spriteInfo.unknown1, y.spriteInfo.unknown1);
+            ASSERT_EQ(x.spriteInfo.spriteIds, y.spriteInfo.spriteIds);
+            const auto& xf = x.spriteInfo.animationInfo.frameInfos;
+            const auto& yf = y.spriteInfo.animationInfo.frameInfos;
+            ASSERT_EQ(xf.size(), yf.size());
+            for(size_t j = 0; j < xf.size(); j++)
+            {
+                ASSERT_EQ(xf[j].animationDelayMin, yf[j].animationDelayMin);
+                ASSERT_EQ(xf[j].animationDelayMax, yf[j].animationDelayMax);
+            }
+        }
+        ASSERT_EQ(a.itemInfo.isStackable, b.itemInfo.isStackable);
+        ASSERT_EQ(a.itemInfo.height, b.itemInfo.height);
+        ASSERT_EQ(a.itemInfo.hasMarketInfo, b.itemInfo.hasMarketInfo);
+        ASSERT_EQ(a.itemInfo.marketInfo.id1, b.itemInfo.marketInfo.id1);
+        ASSERT_EQ(a.itemInfo.marketInfo.name, b.itemInfo.marketInfo.name);
+    }
+
+    const char* PATH = "appearances-reader-test.dat";
+};
+
+TEST_F(AppearancesReaderTest, ObjectsRoundTrip)
+{
+    std::vector<Object> objects = makeObjects(500, 3);
+    writeFile(objects);
+
+    AppearancesReader reader(PATH);
+    const std::vector<Object>& read = reader.getObjects();
+    ASSERT_EQ(read.size(), objects.size());
+    for(size_t i = 0; i < objects.size(); i++)
+        expectEqual(objects[i], read[i]);
+}
+
+TEST_F(AppearancesReaderTest, ViewsMatchObjects)
+{
+    std::vector<Object> objects = makeObjects(200, 5);
+    writeFile(objects);
+
+    AppearancesReader reader(PATH);
+    const Appearances& appearances = reader.getAppearances();
+    ASSERT_EQ(appearances.size(), objects.size());
+    for(size_t i = 0; i < objects.size(); i++)
+    {
+        const Object& o = objects[i];
+        Appearances::ObjectView v = appearances[i];
+        ASSERT_EQ(v.getType(), o.type);
+        ASSERT_EQ(v.getId(), o.id);
+        ASSERT_STREQ(v.getName(), o.itemInfo.marketInfo.name.c_str());
+        ASSERT_TRUE(v.getItemInfo().marketInfo.name.empty());
+        ASSERT_EQ(v.getNumSomeInfos(), o.someInfos.size());
+        for(size_t j = 0; j < o.someInfos.size(); j++)
+        {
+            const Object::SpriteInfo& s = o.someInfos[j].spriteInfo;
+            Appearances::SomeInfoView info = v.getSomeInfo(j);
+            ASSERT_EQ(info.getSpriteHeader().numDirections, s.numDirections);
+            ASSERT_EQ(std::vector<unsigned int>(info.getSpriteIds().begin(), info.getSpriteIds().end()), s.spriteIds);
+            ASSERT_EQ(info.getFrameInfos().size(), s.animationInfo.frameInfos.size());
+        }
+    }
+
+    // The empty name plus the four distinct market names.
+    ASSERT_EQ(appearances.getNumNames(), 5);
+}
+
+TEST_F(AppearancesReaderTest, TruncatedFileThrows)
+{
+    std::vector<Object> objects = makeObjects(10, 7);
+    Bytes bytes;
+    for(const Object& o : objects)
+    {
+        Bytes b = encode(o);
+        bytes.insert(bytes.end(), b.begin(), b.end());
+    }
+    bytes.resize(bytes.size() - 3);
+    std::ofstream(PATH, std::ios::binary).write((const char*)bytes.data(), bytes.size());
+
+    ASSERT_THROW(AppearancesReader reader(PATH), std::runtime_error);
+}
+
+TEST_F(AppearancesReaderTest, LoadBenchmark)
+{
+    std::vector<Object> objects = makeObjects(40000, 11);
+    writeFile(objects);
+
+    using namespace std::chrono;
+    auto start = steady_clock::now();
+    AppearancesReader reader(PATH);
+    auto loaded = steady_clock::now();
+    std::vector<Object> adapted = reader.getAppearances().toObjects();
+    auto end = steady_clock::now();
+
+    size_t objectBytes = adapted.capacity() * sizeof(Object);
+    for(const Object& o : adapted)
+    {
+        objectBytes += o.someInfos.capacity() * sizeof(Object::SomeInfo);
+        for(const Object::SomeInfo& info : o.someInfos)
+        {
+            objectBytes += info.spriteInfo.spriteIds.capacity() * sizeof(unsigned int);
+            objectBytes += info.spriteInfo.animationInfo.frameInfos.capacity() * sizeof(Object::FrameInfo);
+        }
+        if(o.itemInfo.marketInfo.name.size() >= sizeof(std::string))
+            objectBytes += o.itemInfo.marketInfo.name.capacity() + 1;
+    }
+
+    std::cout << "Decode " << objects.size() << " objects: " << duration_cast<microseconds>(loaded - start).count() / 1000.f << " ms" << std::endl
+              << "Adapt to Object: " << duration_cast<microseconds>(end - loaded).count() / 1000.f << " ms" << std::endl
+              << "Arena: " << reader.getAppearances().getMemoryUsage() / 1024 << " KiB, "
+              << "Object: " << objectBytes / 1024 << " KiB" << std::endl;
+}
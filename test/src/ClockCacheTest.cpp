@@ -0,0 +1,106 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/ClockCache.hpp"
+using namespace sb::utility;
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// ClockCacheTest
+////////////////////////////////////////
+class ClockCacheTest : public ::testing::Test
+{
+};
+
+TEST_F(ClockCacheTest, CountsHitsAndMisses)
+{
+    ClockCache<int> cache(4);
+    EXPECT_EQ(cache.get(1), nullptr);
+    EXPECT_TRUE(cache.insert(1, 10));
+    ASSERT_NE(cache.get(1), nullptr);
+    EXPECT_EQ(*cache.get(1), 10);
+    EXPECT_EQ(cache.getNumHits(), 2);
+    EXPECT_EQ(cache.getNumMisses(), 1);
+}
+
+TEST_F(ClockCacheTest, InsertUpdatesExistingValue)
+{
+    ClockCache<int> cache(4);
+    EXPECT_TRUE(cache.insert(1, 10));
+    EXPECT_FALSE(cache.insert(1, 20));
+    EXPECT_EQ(cache.getSize(), 1);
+    EXPECT_EQ(*cache.get(1), 20);
+}
+
+TEST_F(ClockCacheTest, EvictsUnreferencedFirst)
+{
+    ClockCache<int> cache(3);
+    cache.insert(1, 10);
+    cache.insert(2, 20);
+    cache.insert(3, 30);
+
+    // 1 and 3 are referenced, so the hand passes them and takes 2.
+    cache.get(1);
+    cache.get(3);
+    cache.insert(4, 40);
+    EXPECT_EQ(cache.getSize(), 3);
+    EXPECT_EQ(cache.get(2), nullptr);
+    EXPECT_NE(cache.get(1), nullptr);
+    EXPECT_NE(cache.get(3), nullptr);
+    EXPECT_NE(cache.get(4), nullptr);
+}
+
+TEST_F(ClockCacheTest, EvictsInOrderWithoutHits)
+{
+    ClockCache<int> cache(2);
+    cache.insert(1, 10);
+    cache.insert(2, 20);
+    cache.insert(3, 30);
+    cache.insert(4, 40);
+    EXPECT_EQ(cache.get(1), nullptr);
+    EXPECT_EQ(cache.get(2), nullptr);
+    EXPECT_EQ(*cache.get(3), 30);
+    EXPECT_EQ(*cache.get(4), 40);
+}
+
+TEST_F(ClockCacheTest, ClearKeepsCounters)
+{
+    ClockCache<int> cache(2);
+    cache.insert(1, 10);
+    cache.get(1);
+    cache.clear();
+    EXPECT_EQ(cache.getSize(), 0);
+    EXPECT_EQ(cache.get(1), nullptr);
+    EXPECT_EQ(cache.getNumHits(), 1);
+    EXPECT_EQ(cache.getNumMisses(), 1);
+}
@@ -0,0 +1,137 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/FrameParser.hpp"
+#include "monitor/TibiaContext.hpp"
+using namespace GraphicsLayer;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <memory>
+#include <vector>
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C
+#include <cstring>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// FrameContinuationTest
+////////////////////////////////////////
+class FrameContinuationTest : public ::testing::Test
+{
+public:
+    FrameContinuationTest()
+    {
+        std::unique_ptr<std::vector<sb::tibiaassets::Object>> objects;
+        std::unique_ptr<SpriteObjectBindings> bindings;
+        std::unique_ptr<SequenceTree> colorTree;
+        std::unique_ptr<SequenceTree> transparencyTree;
+        std::unique_ptr<SpriteInfo> spriteInfo;
+        std::unique_ptr<std::vector<std::string>> graphicsResourceNames;
+        std::unique_ptr<std::vector<FontSample::Glyph>> glyphs;
+        context.reset(new TibiaContext(objects, bindings, colorTree, transparencyTree, spriteInfo, graphicsResourceNames, glyphs));
+    }
+
+    // Appends one slot to the data, the way FrameWriter lays it out. The
+    // slot optionally holds the pixels of a 1x1 screen.
+    void addSlot(unsigned short width, bool hasContinuation, bool discardsContinuedFrame, bool hasScreenPixels)
+    {
+        SharedMemoryProtocol::Frame frame;
+        frame.width = width;
+        frame.hasContinuation = hasContinuation;
+        frame.discardsContinuedFrame = discardsContinuedFrame;
+
+        std::vector<char> messages;
+        if(hasScreenPixels)
+        {
+            SharedMemoryProtocol::PixelData pixels;
+            pixels.messageType = SharedMemoryProtocol::Message::MessageType::SCREEN_PIXELS;
+            pixels.width = 1;
+            pixels.height = 1;
+            pixels.format = sb::utility::PixelFormat::RGBA;
+            const unsigned char rgba[] = {1, 2, 3, 4};
+            messages.resize(sizeof(pixels) + sizeof(rgba));
+            memcpy(messages.data(), &pixels, sizeof(pixels));
+            memcpy(messages.data() + sizeof(pixels), rgba, sizeof(rgba));
+        }
+
+        frame.size = sizeof(frame) + messages.size();
+        const size_t offset = data.size();
+        data.resize(offset + sizeof(frame));
+        memcpy(&data[offset], &frame, sizeof(frame));
+        data.insert(data.end(), messages.begin(), messages.end());
+    }
+
+    std::list<Frame> parse()
+    {
+        FrameParser parser(*context);
+        return parser.parse(data.data(), data.size());
+    }
+
+    std::unique_ptr<TibiaContext> context;
+    std::vector<char> data;
+};
+
+TEST_F(FrameContinuationTest, ContinuedSlotsAreStitched)
+{
+    addSlot(1, true, false, true);
+    addSlot(2, false, false, false);
+    std::list<Frame> frames = parse();
+    ASSERT_EQ(frames.size(), 1);
+    EXPECT_EQ(frames.front().width, 2);
+    EXPECT_NE(frames.front().screenPixels, nullptr);
+}
+
+TEST_F(FrameContinuationTest, FrameClearedMidWayIsDropped)
+{
+    addSlot(1, true, false, true);
+    addSlot(2, false, true, false);
+    addSlot(3, false, false, true);
+    std::list<Frame> frames = parse();
+    ASSERT_EQ(frames.size(), 2);
+    EXPECT_EQ(frames.front().width, 2);
+    EXPECT_EQ(frames.front().screenPixels, nullptr);
+    EXPECT_EQ(frames.back().width, 3);
+    EXPECT_NE(frames.back().screenPixels, nullptr);
+}
+
+TEST_F(FrameContinuationTest, DiscardWithoutContinuedFrameIsHarmless)
+{
+    addSlot(1, false, true, true);
+    std::list<Frame> frames = parse();
+    ASSERT_EQ(frames.size(), 1);
+    EXPECT_NE(frames.front().screenPixels, nullptr);
+}
@@ -70,6 +70,8 @@ public:
         frame.rectDraws = std::make_shared<std::vector<RectDraw>>(10);
         frame.fileIo = std::make_shared<std::vector<FileIo>>(10);
         frame.miniMapDraws = std::make_shared<std::vector<MiniMapDraw>>(10);
+        frame.arena = std::make_shared<sb::utility::MonotonicArena>();
+        sb::utility::MonotonicArena& arena = *frame.arena;
 
         unsigned short screenPixelsWidth = rand() % 500;
         unsigned short screenPixelsHeight = rand() % 500;
@@ -78,13 +80,13 @@ public:
         std::generate(screenPixels.begin(), screenPixels.end(), rand);
         frame.screenPixels = std::make_shared<RawImage>(screenPixelsFormat, screenPixelsHeight, screenPixelsWidth, screenPixels);
 
-        std::generate(frame.spriteDraws->begin(), frame.spriteDraws->end(), genSpriteDraw);
-        std::generate(frame.guiDraws->begin(), frame.guiDraws->end(), genGuiDraw);
-        std::generate(frame.guiSpriteDraws->begin(), frame.guiSpriteDraws->end(), genSpriteDraw);
-        std::generate(frame.textDraws->begin(), frame.textDraws->end(), genTextDraw);
-        std::generate(frame.rectDraws->begin(), frame.rectDraws->end(), genRectDraw);
+        std::generate(frame.spriteDraws->begin(), frame.spriteDraws->end(), [&arena](){return genSpriteDraw(arena);});
+        std::generate(frame.guiDraws->begin(), frame.guiDraws->end(), [&arena](){return genGuiDraw(arena);});
+        std::generate(frame.guiSpriteDraws->begin(), frame.guiSpriteDraws->end(), [&arena](){return genSpriteDraw(arena);});
+        std::generate(frame.textDraws->begin(), frame.textDraws->end(), [&arena](){return genTextDraw(arena);});
+        std::generate(frame.rectDraws->begin(), frame.rectDraws->end(), [&arena](){return genRectDraw(arena);});
 //        std::generate(frame.fileIo->begin(), frame.fileIo->end(), genFileIo);
-        std::generate(frame.miniMapDraws->begin(), frame.miniMapDraws->end(), genMiniMapDraw);
+        std::generate(frame.miniMapDraws->begin(), frame.miniMapDraws->end(), [&arena](){return genMiniMapDraw(arena);});
 
         emptyFrame.hasMiniMapMoved = rand();
         emptyFrame.miniMapX = rand();
@@ -116,81 +118,89 @@ public:
         std::remove(std::string(filePath + ".png").c_str());
     }
 
-    static void fillDraw(Draw& d)
+    static void fillDraw(Draw& d, sb::utility::MonotonicArena& arena)
     {
         d.topLeft.x = rand();
         d.topLeft.y = rand();
         d.botRight.x = rand();
         d.botRight.y = rand();
 
-        d.transform.reset(new sb::utility::Matrix<float, 4, 4>());
-        float* values = *d.transform->values;
+        sb::utility::Matrix<float, 4, 4>* transform = arena.create(sb::utility::Matrix<float, 4, 4>());
+        float* values = *transform->values;
         for(size_t i = 0; i < 4 * 4; i++)
         {
             *(values + i) = rand();
         }
+        d.transform = transform;
     }
 
-    static SpriteDraw genSpriteDraw()
+    static SpriteDraw genSpriteDraw(sb::utility::MonotonicArena& arena)
     {
         SpriteDraw d;
-        fillDraw(d);
+        fillDraw(d, arena);
 
         size_t numPairings = 3 + rand() % 5;
+        SpriteDraw::SpriteObjectPairing* pairings = arena.allocate<SpriteDraw::SpriteObjectPairing>(numPairings);
         for(size_t i = 0; i < numPairings; i++)
         {
-            SpriteDraw::SpriteObjectPairing p;
+            SpriteDraw::SpriteObjectPairing& p = pairings[i];
             p.spriteId = rand();
             size_t numObjects = 3 + rand() % 5;
+            uint32_t* objects = arena.allocate<uint32_t>(numObjects);
             for(size_t j = 0; j < numObjects; j++)
             {
-                p.objects.push_back(rand());
+                objects[j] = rand();
             }
-            d.pairings.push_back(p);
+            p.objects = sb::utility::Span<uint32_t>(objects, objects + numObjects);
         }
+        d.pairings = sb::utility::Span<SpriteDraw::SpriteObjectPairing>(pairings, pairings + numPairings);
 
         return d;
     }
 
-    static GuiDraw genGuiDraw()
+    static GuiDraw genGuiDraw(sb::utility::MonotonicArena& arena)
     {
         GuiDraw d;
-        fillDraw(d);
+        fillDraw(d, arena);
 
-        d.name = sb::utility::randStr(5 + rand() % 10);
+        std::string name = sb::utility::randStr(5 + rand() % 10);
+        sb::utility::Span<char> chars = arena.copy(name.data(), name.size());
+        d.name = sb::utility::StringView(chars.begin(), chars.size());
         return d;
     }
 
-    static TextDraw genTextDraw()
+    static TextDraw genTextDraw(sb::utility::MonotonicArena& arena)
     {
         TextDraw d;
-        fillDraw(d);
+        fillDraw(d, arena);
         d.color.packed = rand();
         d.isOutlined = rand();
 
-        d.glyphDraws.reset(new std::vector<GlyphDraw>(5 + rand() % 10));
-        for(GlyphDraw& g : *d.glyphDraws)
+        size_t numGlyphs = 5 + rand() % 10;
+        GlyphDraw* glyphs = arena.allocate<GlyphDraw>(numGlyphs);
+        for(size_t i = 0; i < numGlyphs; i++)
         {
-            fillDraw(g);
-            g.character = rand();
+            fillDraw(glyphs[i], arena);
+            glyphs[i].character = rand();
         }
+        d.glyphDraws = sb::utility::Span<GlyphDraw>(glyphs, glyphs + numGlyphs);
 
         return d;
     }
 
-    static RectDraw genRectDraw()
+    static RectDraw genRectDraw(sb::utility::MonotonicArena& arena)
     {
         RectDraw d;
-        fillDraw(d);
+        fillDraw(d, arena);
         d.color.packed = rand();
 
         return d;
     }
 
-    static MiniMapDraw genMiniMapDraw()
+    static MiniMapDraw genMiniMapDraw(sb::utility::MonotonicArena& arena)
     {
         MiniMapDraw d;
-        fillDraw(d);
+        fillDraw(d, arena);
         d.pixels.reset(new std::vector<unsigned char>(20 + rand() % 100));
         std::generate(d.pixels->begin(), d.pixels->end(), rand);
 
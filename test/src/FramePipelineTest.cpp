@@ -0,0 +1,274 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/FramePipeline.hpp"
+#include "monitor/TibiaContext.hpp"
+using namespace GraphicsLayer;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <memory>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <algorithm>
+#include <stdexcept>
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C
+#include <cstring>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// FramePipelineTest
+////////////////////////////////////////
+class FramePipelineTest : public ::testing::Test
+{
+public:
+    FramePipelineTest()
+    {
+        std::unique_ptr<std::vector<sb::tibiaassets::Object>> objects;
+        std::unique_ptr<SpriteObjectBindings> bindings;
+        std::unique_ptr<SequenceTree> colorTree;
+        std::unique_ptr<SequenceTree> transparencyTree;
+        std::unique_ptr<SpriteInfo> spriteInfo;
+        std::unique_ptr<std::vector<std::string>> graphicsResourceNames;
+        std::unique_ptr<std::vector<FontSample::Glyph>> glyphs;
+        context.reset(new TibiaContext(objects, bindings, colorTree, transparencyTree, spriteInfo, graphicsResourceNames, glyphs));
+    }
+
+    // Stands in for the shared memory slots. Segments stay put until the
+    // pipeline releases them.
+    struct HeldSegments
+    {
+        const std::vector<char>& hold(std::vector<char> segment)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            segments.push_back(std::move(segment));
+            maxNumHeld = std::max(maxNumHeld, segments.size());
+            return segments.back();
+        }
+
+        void release()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ASSERT_FALSE(segments.empty());
+            segments.pop_front();
+            numReleased++;
+        }
+
+        std::mutex mutex;
+        std::deque<std::vector<char>> segments;
+        size_t maxNumHeld = 0;
+        size_t numReleased = 0;
+    };
+
+    // Each segment holds one empty frame whose width is its index, so the
+    // frames can be told apart. Odd segments continue into the next one.
+    FramePipeline::SegmentSource createSource(size_t numSegments, bool hasContinuations = false)
+    {
+        std::shared_ptr<size_t> index = std::make_shared<size_t>(0);
+        return [this, index, numSegments, hasContinuations](const char*& data, size_t& size)
+        {
+            if(*index >= numSegments)
+                return false;
+
+            SharedMemoryProtocol::Frame frame;
+            frame.width = *index;
+            frame.hasContinuation = hasContinuations && *index % 2 == 0;
+            std::vector<char> segment(sizeof(frame));
+            memcpy(segment.data(), &frame, sizeof(frame));
+            const std::vector<char>& held = heldSegments.hold(std::move(segment));
+            data = held.data();
+            size = held.size();
+            (*index)++;
+            return true;
+        };
+    }
+
+    FramePipeline::SegmentRelease createRelease()
+    {
+        return [this]()
+        {
+            heldSegments.release();
+        };
+    }
+
+    struct Recorder
+    {
+        void operator()(const FramePipeline::SharedFrame& frame)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            widths.push_back(frame->frame.width);
+            sequences.push_back(frame->sequence);
+        }
+
+        std::mutex mutex;
+        std::vector<size_t> widths;
+        std::vector<size_t> sequences;
+    };
+
+    std::unique_ptr<TibiaContext> context;
+    HeldSegments heldSegments;
+};
+
+TEST_F(FramePipelineTest, EveryInterpreterSeesEveryFrameInOrder)
+{
+    const size_t NUM_SEGMENTS = 500;
+    FramePipeline pipeline(*context, createSource(NUM_SEGMENTS), createRelease(), 2);
+    Recorder a;
+    Recorder b;
+    pipeline.addInterpreter("A", [&a](const FramePipeline::SharedFrame& frame){a(frame);});
+    pipeline.addInterpreter("B", [&b](const FramePipeline::SharedFrame& frame){b(frame);});
+    pipeline.start();
+    pipeline.join();
+
+    ASSERT_EQ(a.widths.size(), NUM_SEGMENTS);
+    for(size_t i = 0; i < NUM_SEGMENTS; i++)
+    {
+        EXPECT_EQ(a.widths[i], i);
+        EXPECT_EQ(a.sequences[i], i);
+    }
+    EXPECT_EQ(a.widths, b.widths);
+    EXPECT_EQ(pipeline.getNumInterpretedFrames(), NUM_SEGMENTS);
+    EXPECT_EQ(heldSegments.numReleased, NUM_SEGMENTS);
+
+    std::vector<FramePipeline::StageStats> stats = pipeline.getStageStats();
+    ASSERT_EQ(stats.size(), 5);
+    EXPECT_EQ(stats[0].name, "Acquisition");
+    EXPECT_EQ(stats[0].numItems, NUM_SEGMENTS);
+    EXPECT_EQ(stats[1].name, "FrameParser");
+    EXPECT_EQ(stats[1].numItems, NUM_SEGMENTS);
+    EXPECT_EQ(stats[2].name, "A");
+    EXPECT_EQ(stats[2].numItems, NUM_SEGMENTS);
+    EXPECT_EQ(stats[3].name, "B");
+    EXPECT_EQ(stats[4].numItems, NUM_SEGMENTS);
+}
+
+TEST_F(FramePipelineTest, AcceptsQueueCapacityOtherThanPowerOfTwo)
+{
+    const size_t NUM_SEGMENTS = 50;
+    FramePipeline pipeline(*context, createSource(NUM_SEGMENTS), createRelease(), 5);
+    Recorder a;
+    pipeline.addInterpreter("A", [&a](const FramePipeline::SharedFrame& frame){a(frame);});
+    pipeline.start();
+    pipeline.join();
+    EXPECT_EQ(a.widths.size(), NUM_SEGMENTS);
+}
+
+TEST_F(FramePipelineTest, ContinuedFramesAreStampedOnce)
+{
+    FramePipeline pipeline(*context, createSource(10, true), createRelease());
+    Recorder recorder;
+    pipeline.addInterpreter("Recorder", [&recorder](const FramePipeline::SharedFrame& frame){recorder(frame);});
+    pipeline.start();
+    pipeline.join();
+
+    std::vector<size_t> widths = {1, 3, 5, 7, 9};
+    std::vector<size_t> sequences = {0, 1, 2, 3, 4};
+    EXPECT_EQ(recorder.widths, widths);
+    EXPECT_EQ(recorder.sequences, sequences);
+    EXPECT_EQ(pipeline.getStageStats()[1].numItems, 10);
+}
+
+TEST_F(FramePipelineTest, SegmentsAreHeldUntilParsed)
+{
+    const size_t NUM_SEGMENTS = 200;
+    const size_t QUEUE_CAPACITY = 2;
+    FramePipeline pipeline(*context, createSource(NUM_SEGMENTS), createRelease(), QUEUE_CAPACITY);
+    Recorder recorder;
+    pipeline.addInterpreter("Recorder", [&recorder](const FramePipeline::SharedFrame& frame){recorder(frame);});
+    pipeline.start();
+    pipeline.join();
+
+    EXPECT_EQ(recorder.widths.size(), NUM_SEGMENTS);
+    EXPECT_EQ(heldSegments.numReleased, NUM_SEGMENTS);
+    EXPECT_TRUE(heldSegments.segments.empty());
+    EXPECT_LE(heldSegments.maxNumHeld, QUEUE_CAPACITY + 2);
+}
+
+TEST_F(FramePipelineTest, InterpreterErrorStopsPipeline)
+{
+    FramePipeline pipeline(*context, createSource(size_t(-1)), createRelease());
+    pipeline.addInterpreter("Failing", [](const FramePipeline::SharedFrame& frame)
+    {
+        if(frame->sequence == 10)
+            throw std::runtime_error("Failed");
+    });
+    pipeline.start();
+    EXPECT_THROW(pipeline.join(), std::runtime_error);
+    EXPECT_TRUE(pipeline.isStopping());
+    EXPECT_EQ(pipeline.getNumInterpretedFrames(), 10);
+}
+
+TEST_F(FramePipelineTest, StopEndsEndlessSource)
+{
+    FramePipeline pipeline(*context, createSource(size_t(-1)), createRelease());
+    std::weak_ptr<const FramePipeline::StampedFrame> lastFrame;
+    std::mutex mutex;
+    pipeline.addInterpreter("Keeper", [&](const FramePipeline::SharedFrame& frame)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        lastFrame = frame;
+    });
+    pipeline.start();
+    while(pipeline.getNumInterpretedFrames() < 100);
+    pipeline.stop();
+    pipeline.join();
+    EXPECT_TRUE(lastFrame.expired());
+}
+
+TEST_F(FramePipelineTest, RejectedSegmentsRequestOnePixelHashResync)
+{
+    // Segments too short to hold a frame header are rejected.
+    std::shared_ptr<size_t> index = std::make_shared<size_t>(0);
+    FramePipeline pipeline(*context, [this, index](const char*& data, size_t& size)
+    {
+        if((*index)++ >= 3)
+            return false;
+
+        const std::vector<char>& segment = heldSegments.hold(std::vector<char>(1, 0));
+        data = segment.data();
+        size = segment.size();
+        return true;
+    }, createRelease());
+    size_t numResyncs = 0;
+    pipeline.setPixelHashResync([&numResyncs](){numResyncs++;});
+    pipeline.start();
+    pipeline.join();
+
+    EXPECT_EQ(pipeline.getFrameParser().getNumRejectedSegments(), 3);
+    EXPECT_EQ(numResyncs, 1);
+}
@@ -0,0 +1,169 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/FramePool.hpp"
+using namespace GraphicsLayer;
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <memory>
+#include <thread>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// FramePoolTest
+////////////////////////////////////////
+class FramePoolTest : public ::testing::Test
+{
+public:
+    static void fillFrame(Frame& frame, size_t numDraws)
+    {
+        for(size_t i = 0; i < numDraws; i++)
+        {
+            uint32_t objects[] = {uint32_t(i), uint32_t(i + 1)};
+            SpriteDraw::SpriteObjectPairing pairing;
+            pairing.spriteId = i;
+            pairing.objects = frame.arena->copy(objects, 2);
+
+            SpriteDraw draw;
+            draw.transform = frame.arena->create(Matrix<float, 4, 4>());
+            draw.pairings = frame.arena->copy(&pairing, 1);
+            frame.spriteDraws->push_back(draw);
+        }
+    }
+};
+
+TEST_F(FramePoolTest, ArenaAlignment)
+{
+    MonotonicArena arena(64);
+    for(size_t i = 0; i < 100; i++)
+    {
+        arena.allocate<char>(i % 7);
+        double* d = arena.allocate<double>(1);
+        EXPECT_EQ(size_t(d) % alignof(double), 0);
+        *d = i;
+    }
+}
+
+TEST_F(FramePoolTest, ArenaStopsAllocatingAfterReset)
+{
+    MonotonicArena arena(64);
+    for(size_t i = 0; i < 1000; i++)
+        arena.allocate<uint32_t>(10);
+
+    size_t numChunkAllocations = arena.getNumChunkAllocations();
+    EXPECT_GT(numChunkAllocations, 1);
+
+    for(size_t pass = 0; pass < 3; pass++)
+    {
+        arena.reset();
+        EXPECT_EQ(arena.getNumBytesUsed(), 0);
+        for(size_t i = 0; i < 1000; i++)
+            arena.allocate<uint32_t>(10);
+    }
+    EXPECT_EQ(arena.getNumChunkAllocations(), numChunkAllocations + 1);
+}
+
+TEST_F(FramePoolTest, ArenaCopy)
+{
+    MonotonicArena arena;
+    std::vector<int> values = {1, 2, 3, 4, 5};
+    Span<int> copy = arena.copy(values.data(), values.size());
+    ASSERT_EQ(copy.size(), values.size());
+    EXPECT_NE(copy.begin(), values.data());
+    EXPECT_TRUE(std::equal(copy.begin(), copy.end(), values.begin()));
+    EXPECT_TRUE(arena.copy(values.data(), 0).empty());
+}
+
+TEST_F(FramePoolTest, ReleasedFramesAreReused)
+{
+    FramePool pool;
+    const std::vector<SpriteDraw>* draws;
+    {
+        Frame frame = pool.acquire();
+        fillFrame(frame, 100);
+        draws = frame.spriteDraws.get();
+        EXPECT_EQ(pool.getNumFree(), 0);
+    }
+    EXPECT_EQ(pool.getNumFree(), 1);
+
+    Frame frame = pool.acquire();
+    EXPECT_EQ(frame.spriteDraws.get(), draws);
+    EXPECT_TRUE(frame.spriteDraws->empty());
+    EXPECT_GE(frame.spriteDraws->capacity(), 100);
+    EXPECT_EQ(frame.arena->getNumBytesUsed(), 0);
+    EXPECT_EQ(pool.getNumCreated(), 1);
+}
+
+TEST_F(FramePoolTest, FrameIsKeptAliveByAnyMember)
+{
+    FramePool pool;
+    std::shared_ptr<std::vector<SpriteDraw>> draws;
+    {
+        Frame frame = pool.acquire();
+        fillFrame(frame, 10);
+        draws = frame.spriteDraws;
+    }
+    EXPECT_EQ(pool.getNumFree(), 0);
+    ASSERT_EQ(draws->size(), 10);
+    EXPECT_EQ((*draws)[9].pairings.front().objects[1], 10);
+
+    draws = nullptr;
+    EXPECT_EQ(pool.getNumFree(), 1);
+}
+
+TEST_F(FramePoolTest, FrameOutlivesPool)
+{
+    Frame frame;
+    {
+        FramePool pool;
+        frame = pool.acquire();
+    }
+    fillFrame(frame, 10);
+    EXPECT_EQ(frame.spriteDraws->size(), 10);
+}
+
+TEST_F(FramePoolTest, ReleaseOnOtherThread)
+{
+    FramePool pool(2);
+    for(size_t i = 0; i < 100; i++)
+    {
+        Frame frame = pool.acquire();
+        fillFrame(frame, 10);
+        std::thread([](Frame f){f = Frame();}, std::move(frame)).join();
+    }
+    EXPECT_EQ(pool.getNumCreated(), 1);
+    EXPECT_EQ(pool.getNumFree(), 1);
+}
@@ -0,0 +1,128 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/FrameRecording.hpp"
+using namespace GraphicsLayer;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <random>
+#include <cstdio>
+#include <stdexcept>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// FrameRecordingTest
+////////////////////////////////////////
+class FrameRecordingTest : public ::testing::Test
+{
+public:
+    FrameRecordingTest()
+    {
+        std::mt19937 rng(23);
+        for(size_t i = 0; i < 50; i++)
+        {
+            // Odd sizes, so that the padding between chunks gets exercised.
+            std::vector<char> slot(rng() % 5000);
+            for(char& c : slot)
+                c = rng();
+
+            slots.push_back(slot);
+        }
+        slots.push_back(std::vector<char>());
+    }
+
+    ~FrameRecordingTest()
+    {
+        std::remove(filePath.c_str());
+    }
+
+    void write()
+    {
+        FrameRecording::Writer writer(filePath);
+        for(const std::vector<char>& slot : slots)
+            writer.write(slot.data(), slot.size());
+
+        EXPECT_EQ(writer.getNumChunks(), slots.size());
+    }
+
+    std::vector<std::vector<char>> slots;
+    std::string filePath = "frameRecordingTest.bin";
+};
+
+TEST_F(FrameRecordingTest, ReadMatchesWrite)
+{
+    write();
+
+    FrameRecording::Reader reader(filePath);
+    const std::vector<FrameRecording::Chunk>& chunks = reader.getChunks();
+    ASSERT_EQ(chunks.size(), slots.size());
+    uint64_t previousTime = 0;
+    for(size_t i = 0; i < chunks.size(); i++)
+    {
+        ASSERT_EQ(chunks[i].size, slots[i].size());
+        EXPECT_EQ(std::vector<char>(chunks[i].data, chunks[i].data + chunks[i].size), slots[i]);
+        EXPECT_EQ(size_t(chunks[i].data) % 8, 0);
+        EXPECT_GE(chunks[i].time, previousTime);
+        previousTime = chunks[i].time;
+    }
+}
+
+TEST_F(FrameRecordingTest, RejectsTruncatedRecording)
+{
+    write();
+
+    FILE* file = std::fopen(filePath.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    std::vector<char> data(1 << 20);
+    data.resize(std::fread(data.data(), 1, data.size(), file));
+    std::fclose(file);
+
+    file = std::fopen(filePath.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fwrite(data.data(), 1, data.size() - 100, file);
+    std::fclose(file);
+
+    EXPECT_THROW(FrameRecording::Reader reader(filePath), std::runtime_error);
+}
+
+TEST_F(FrameRecordingTest, RejectsOtherFiles)
+{
+    FILE* file = std::fopen(filePath.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fputs("Not a frame recording", file);
+    std::fclose(file);
+
+    EXPECT_THROW(FrameRecording::Reader reader(filePath), std::runtime_error);
+}
@@ -0,0 +1,228 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "injection/SharedMemoryProtocol.hpp"
+#include "injection/FrameRing.hpp"
+#include "utility/SharedMemory.hpp"
+using namespace GraphicsLayer::SharedMemoryProtocol;
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <thread>
+#include <memory>
+#include <cstring>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+typedef FrameRing<4, 1 << 12> TestRing;
+
+////////////////////////////////////////
+// SyntheticProducer
+////////////////////////////////////////
+// Stands in for the injected side. Maps the segment by name on its own and
+// writes frames in the shared memory wire format, one VERTEX_BUFFER_WRITE
+// message per frame with a payload derived from the frame number.
+class SyntheticProducer
+{
+public:
+    SyntheticProducer(const std::string& name, size_t numFrames)
+    : mSharedMemory(name, sizeof(TestRing), SharedMemory::Mode::OPEN)
+    , mRing(*(TestRing*)mSharedMemory.getData())
+    , mNumFrames(numFrames)
+    {
+    }
+
+    static size_t getPayloadSize(size_t frameNumber)
+    {
+        const size_t MAX_PAYLOAD = TestRing::getSlotSize() - sizeof(Frame) - sizeof(VertexBufferWrite);
+        return (frameNumber * 2654435761u) % (MAX_PAYLOAD + 1);
+    }
+
+    static char getPayloadByte(size_t frameNumber, size_t i)
+    {
+        return char(frameNumber * 31 + i);
+    }
+
+    void run()
+    {
+        for(size_t n = 0; n < mNumFrames; n++)
+        {
+            TestRing::Slot* slot;
+            while((slot = mRing.getWriteSlot()) == nullptr)
+                std::this_thread::yield();
+
+            size_t payloadSize = getPayloadSize(n);
+
+            Frame* frame = (Frame*)slot->data;
+            *frame = Frame();
+            frame->size = sizeof(Frame) + sizeof(VertexBufferWrite) + payloadSize;
+            frame->width = n;
+            frame->height = n >> 16;
+
+            VertexBufferWrite write;
+            write.messageType = Message::MessageType::VERTEX_BUFFER_WRITE;
+            write.bufferId = n;
+            write.numBytes = payloadSize;
+            memcpy(slot->data + sizeof(Frame), &write, sizeof(write));
+
+            char* payload = slot->data + sizeof(Frame) + sizeof(write);
+            for(size_t i = 0; i < payloadSize; i++)
+                payload[i] = getPayloadByte(n, i);
+
+            slot->size = frame->size;
+            mRing.commitWriteSlot();
+        }
+    }
+
+private:
+    SharedMemory mSharedMemory;
+    TestRing& mRing;
+    size_t mNumFrames;
+};
+
+////////////////////////////////////////
+// FrameRingTest
+////////////////////////////////////////
+class FrameRingTest : public ::testing::Test
+{
+public:
+    FrameRingTest()
+    : sharedMemory(SharedMemory::generateName(32), sizeof(TestRing), SharedMemory::Mode::CREATE)
+    , ring(*(TestRing*)sharedMemory.getData())
+    {
+        ring.reset();
+    }
+
+    void expectFrame(const TestRing::Slot& slot, size_t frameNumber) const
+    {
+        size_t payloadSize = SyntheticProducer::getPayloadSize(frameNumber);
+        ASSERT_EQ(slot.size, sizeof(Frame) + sizeof(VertexBufferWrite) + payloadSize);
+
+        const Frame& frame = *(const Frame*)slot.data;
+        ASSERT_EQ(frame.size, slot.size);
+        ASSERT_EQ(frame.width + (size_t(frame.height) << 16), frameNumber);
+
+        const VertexBufferWrite& write = *(const VertexBufferWrite*)(slot.data + sizeof(Frame));
+        ASSERT_EQ(write.messageType, Message::MessageType::VERTEX_BUFFER_WRITE);
+        ASSERT_EQ(write.bufferId, frameNumber);
+        ASSERT_EQ(write.numBytes, payloadSize);
+
+        const char* payload = slot.data + sizeof(Frame) + sizeof(write);
+        for(size_t i = 0; i < payloadSize; i++)
+            ASSERT_EQ(payload[i], SyntheticProducer::getPayloadByte(frameNumber, i));
+    }
+
+    SharedMemory sharedMemory;
+    TestRing& ring;
+};
+
+TEST_F(FrameRingTest, EmptyAfterReset)
+{
+    EXPECT_EQ(ring.getNumFrames(), 0);
+    EXPECT_EQ(ring.getReadSlot(), nullptr);
+    EXPECT_NE(ring.getWriteSlot(), nullptr);
+}
+
+TEST_F(FrameRingTest, FullAfterNumSlotsCommits)
+{
+    for(size_t i = 0; i < TestRing::getNumSlots(); i++)
+    {
+        ASSERT_NE(ring.getWriteSlot(), nullptr);
+        ring.commitWriteSlot();
+    }
+
+    EXPECT_EQ(ring.getNumFrames(), TestRing::getNumSlots());
+    EXPECT_EQ(ring.getWriteSlot(), nullptr);
+
+    ring.releaseReadSlot();
+    EXPECT_NE(ring.getWriteSlot(), nullptr);
+}
+
+TEST_F(FrameRingTest, SlotsAreHeldUntilReleased)
+{
+    for(size_t i = 0; i < TestRing::getNumSlots(); i++)
+    {
+        ring.getWriteSlot()->size = i;
+        ring.commitWriteSlot();
+    }
+
+    for(size_t i = 0; i < TestRing::getNumSlots(); i++)
+    {
+        ASSERT_NE(ring.getReadSlot(i), nullptr);
+        EXPECT_EQ(ring.getReadSlot(i)->size, i);
+    }
+    EXPECT_EQ(ring.getReadSlot(TestRing::getNumSlots()), nullptr);
+    EXPECT_EQ(ring.getWriteSlot(), nullptr);
+
+    ring.releaseReadSlot();
+    EXPECT_EQ(ring.getReadSlot(0)->size, 1);
+    EXPECT_EQ(ring.getReadSlot(TestRing::getNumSlots() - 1), nullptr);
+    ASSERT_NE(ring.getWriteSlot(), nullptr);
+}
+
+TEST_F(FrameRingTest, SyntheticProducerStress)
+{
+    const size_t NUM_FRAMES = 200000;
+    SyntheticProducer producer(sharedMemory.getName(), NUM_FRAMES);
+    std::thread producerThread(&SyntheticProducer::run, &producer);
+
+    size_t frameNumber = 0;
+    while(frameNumber < NUM_FRAMES && !HasFatalFailure())
+    {
+        const TestRing::Slot* slot = ring.getReadSlot();
+        if(slot == nullptr)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        expectFrame(*slot, frameNumber);
+        ring.releaseReadSlot();
+        frameNumber++;
+    }
+
+    // Let the producer finish on a fatal failure instead of leaving it blocked on a full ring.
+    while(frameNumber < NUM_FRAMES)
+    {
+        if(ring.getReadSlot() != nullptr)
+        {
+            ring.releaseReadSlot();
+            frameNumber++;
+        }
+    }
+
+    producerThread.join();
+    EXPECT_EQ(ring.getNumFrames(), 0);
+}
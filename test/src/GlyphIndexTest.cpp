@@ -0,0 +1,134 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/GlyphIndex.hpp"
+using namespace GraphicsLayer;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <random>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// GlyphIndexTest
+////////////////////////////////////////
+class GlyphIndexTest : public ::testing::Test
+{
+public:
+    GlyphIndexTest()
+    : rng(3)
+    {
+        for(size_t i = 0; i < 2000; i++)
+            glyphs.push_back(createGlyph());
+
+        // Duplicates, as different point sizes can render the same pixels.
+        for(size_t i = 0; i < 100; i++)
+            glyphs.push_back(glyphs[rng() % glyphs.size()]);
+
+        index.reset(new GlyphIndex(glyphs));
+    }
+
+    FontSample::Glyph createGlyph()
+    {
+        FontSample::Glyph glyph;
+        glyph.width = 4 + rng() % 8;
+        glyph.height = 8 + rng() % 6;
+        glyph.character = 'a' + rng() % 26;
+        glyph.data.resize(glyph.width * glyph.height);
+        for(unsigned char& pixel : glyph.data)
+        {
+            pixel = (rng() % 3 == 0 ? rng() : 0);
+            glyph.sum += pixel;
+        }
+
+        return glyph;
+    }
+
+    // The filter getChar used to apply to every glyph.
+    std::vector<uint32_t> findCandidatesLinear(unsigned short width, unsigned short height, size_t sum) const
+    {
+        std::vector<uint32_t> candidates;
+        for(size_t i = 0; i < glyphs.size(); i++)
+        {
+            const FontSample::Glyph& lhs = glyphs[i];
+            if(sum > lhs.sum * GlyphIndex::SUM_EPSILON || lhs.sum > sum * GlyphIndex::SUM_EPSILON)
+                continue;
+
+            if((lhs.width <= width && lhs.height <= height) || (width <= lhs.width && height <= lhs.height))
+                candidates.push_back(i);
+        }
+
+        return candidates;
+    }
+
+    std::mt19937 rng;
+    std::vector<FontSample::Glyph> glyphs;
+    std::unique_ptr<GlyphIndex> index;
+};
+
+TEST_F(GlyphIndexTest, CandidatesMatchLinearFilter)
+{
+    std::vector<uint32_t> candidates;
+    for(size_t i = 0; i < 1000; i++)
+    {
+        FontSample::Glyph query = createGlyph();
+        index->findCandidates(query.width, query.height, query.sum, candidates);
+        ASSERT_EQ(candidates, findCandidatesLinear(query.width, query.height, query.sum));
+    }
+}
+
+TEST_F(GlyphIndexTest, FindExactReturnsFirstIdenticalGlyph)
+{
+    for(size_t i = 0; i < glyphs.size(); i++)
+    {
+        const FontSample::Glyph& glyph = glyphs[i];
+        size_t expect = i;
+        for(size_t j = 0; j < i; j++)
+        {
+            if(glyphs[j].width == glyph.width && glyphs[j].height == glyph.height && glyphs[j].data == glyph.data)
+            {
+                expect = j;
+                break;
+            }
+        }
+
+        EXPECT_EQ(index->findExact(glyph.data.data(), glyph.width, glyph.height), expect);
+    }
+
+    FontSample::Glyph unknown = createGlyph();
+    unknown.data[0] ^= 1;
+    unknown.data[1] ^= 1;
+    EXPECT_EQ(index->findExact(unknown.data.data(), unknown.width, unknown.height), GlyphIndex::NO_GLYPH);
+}
@@ -0,0 +1,209 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "lzma/lzma.hpp"
+#include "lzma/LzmaLib.h"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <random>
+#include <chrono>
+#include <iostream>
+#include <vector>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// LzmaTest
+////////////////////////////////////////
+class LzmaTest : public ::testing::Test
+{
+public:
+    struct Compressed
+    {
+        std::vector<unsigned char> original;
+        std::vector<unsigned char> data;
+        unsigned char props[LZMA_PROPS_SIZE];
+    };
+
+    // Sheet sized images of repeated tiles with some noise, which compress
+    // about as well as real sprite sheets. Every other stream uses other
+    // literal context bits, so that decoders have to resize their tables.
+    LzmaTest()
+    {
+        std::mt19937 rng(19);
+        streams.resize(NUM_STREAMS);
+        for(size_t i = 0; i < streams.size(); i++)
+        {
+            Compressed& c = streams[i];
+            c.original.resize(SHEET_SIZE);
+            std::vector<unsigned char> tile(32 * 4);
+            for(unsigned char& b : tile)
+                b = rng();
+            for(size_t j = 0; j < c.original.size(); j++)
+                c.original[j] = (rng() % 16 == 0 ? rng() : tile[j % tile.size()]);
+
+            c.data.resize(c.original.size() + c.original.size() / 3 + 128);
+            size_t size = c.data.size();
+            size_t propsSize = LZMA_PROPS_SIZE;
+            int result = LzmaCompress(c.data.data(), &size, c.original.data(), c.original.size(), c.props, &propsSize, 1, 1 << 20, i % 2 == 0 ? 3 : 0, -1, -1, -1, 1);
+            EXPECT_EQ(result, SZ_OK);
+            c.data.resize(size);
+        }
+    }
+
+    std::vector<sb::lzma::Stream> makeStreams(std::vector<std::vector<unsigned char>>& outputs) const
+    {
+        std::vector<sb::lzma::Stream> batch(streams.size());
+        outputs.resize(streams.size());
+        for(size_t i = 0; i < streams.size(); i++)
+        {
+            outputs[i].assign(streams[i].original.size(), 0);
+            batch[i].src = streams[i].data.data();
+            batch[i].srcLen = streams[i].data.size();
+            batch[i].props = streams[i].props;
+            batch[i].propsSize = LZMA_PROPS_SIZE;
+            batch[i].dest = outputs[i].data();
+            batch[i].destLen = outputs[i].size();
+        }
+        return batch;
+    }
+
+    static const size_t NUM_STREAMS = 16;
+    static const size_t SHEET_SIZE = 384 * 384 * 4;
+    std::vector<Compressed> streams;
+};
+
+TEST_F(LzmaTest, DecoderMatchesUncompress)
+{
+    sb::lzma::Decoder decoder;
+    std::vector<unsigned char> output(SHEET_SIZE);
+    for(const Compressed& c : streams)
+    {
+        size_t destLen = output.size();
+        size_t srcLen = c.data.size();
+        ASSERT_EQ(decoder.decode(output.data(), &destLen, c.data.data(), &srcLen, c.props, LZMA_PROPS_SIZE), SZ_OK);
+        ASSERT_EQ(destLen, c.original.size());
+        ASSERT_EQ(srcLen, c.data.size());
+        ASSERT_EQ(output, c.original);
+    }
+}
+
+TEST_F(LzmaTest, DecoderReportsTruncatedInput)
+{
+    sb::lzma::Decoder decoder;
+    std::vector<unsigned char> output(SHEET_SIZE);
+    const Compressed& c = streams.front();
+
+    size_t destLen = output.size();
+    size_t srcLen = c.data.size() / 2;
+    ASSERT_EQ(decoder.decode(output.data(), &destLen, c.data.data(), &srcLen, c.props, LZMA_PROPS_SIZE), SZ_ERROR_INPUT_EOF);
+    ASSERT_LT(destLen, c.original.size());
+
+    destLen = output.size();
+    srcLen = 2;
+    ASSERT_EQ(decoder.decode(output.data(), &destLen, c.data.data(), &srcLen, c.props, LZMA_PROPS_SIZE), SZ_ERROR_INPUT_EOF);
+
+    // The decoder is still usable afterwards.
+    destLen = output.size();
+    srcLen = c.data.size();
+    ASSERT_EQ(decoder.decode(output.data(), &destLen, c.data.data(), &srcLen, c.props, LZMA_PROPS_SIZE), SZ_OK);
+    ASSERT_EQ(output, c.original);
+}
+
+TEST_F(LzmaTest, BatchMatchesOriginals)
+{
+    for(size_t numThreads : {1, 3, 0})
+    {
+        std::vector<std::vector<unsigned char>> outputs;
+        std::vector<sb::lzma::Stream> batch = makeStreams(outputs);
+        sb::lzma::decodeBatch(batch, numThreads);
+        for(size_t i = 0; i < streams.size(); i++)
+        {
+            ASSERT_EQ(batch[i].result, SZ_OK) << numThreads;
+            ASSERT_EQ(batch[i].destLen, streams[i].original.size());
+            ASSERT_EQ(outputs[i], streams[i].original) << numThreads;
+        }
+    }
+
+    std::vector<sb::lzma::Stream> empty;
+    sb::lzma::decodeBatch(empty);
+}
+
+TEST_F(LzmaTest, Benchmark)
+{
+    const size_t NUM_RUNS = 3;
+    const double MEGABYTES = double(NUM_STREAMS * SHEET_SIZE * NUM_RUNS) / (1 << 20);
+    std::vector<unsigned char> output(SHEET_SIZE);
+    typedef std::chrono::steady_clock Clock;
+    auto mbPerSecond = [MEGABYTES](Clock::time_point start)
+    {
+        return MEGABYTES / std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    Clock::time_point start = Clock::now();
+    for(size_t run = 0; run < NUM_RUNS; run++)
+        for(const Compressed& c : streams)
+        {
+            size_t destLen = output.size();
+            size_t srcLen = c.data.size();
+            ASSERT_EQ(sb::lzma::uncompress(output.data(), &destLen, c.data.data(), &srcLen, c.props, LZMA_PROPS_SIZE), SZ_OK);
+        }
+    double uncompress = mbPerSecond(start);
+
+    sb::lzma::Decoder decoder;
+    start = Clock::now();
+    for(size_t run = 0; run < NUM_RUNS; run++)
+        for(const Compressed& c : streams)
+        {
+            size_t destLen = output.size();
+            size_t srcLen = c.data.size();
+            ASSERT_EQ(decoder.decode(output.data(), &destLen, c.data.data(), &srcLen, c.props, LZMA_PROPS_SIZE), SZ_OK);
+        }
+    double decode = mbPerSecond(start);
+
+    std::vector<std::vector<unsigned char>> outputs;
+    std::vector<sb::lzma::Stream> batch = makeStreams(outputs);
+    start = Clock::now();
+    for(size_t run = 0; run < NUM_RUNS; run++)
+    {
+        std::vector<sb::lzma::Stream> b = batch;
+        sb::lzma::decodeBatch(b);
+    }
+    double decodeBatch = mbPerSecond(start);
+
+    std::cout << "Decompressed: " << MEGABYTES << " MB" << std::endl;
+    std::cout << "uncompress: " << uncompress << " MB/s" << std::endl;
+    std::cout << "Decoder: " << decode << " MB/s" << std::endl;
+    std::cout << "decodeBatch, all threads: " << decodeBatch << " MB/s" << std::endl;
+}
@@ -0,0 +1,195 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "injection/MessageCursor.hpp"
+using namespace GraphicsLayer::SharedMemoryProtocol;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <string>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// MessageCursorTest
+////////////////////////////////////////
+class MessageCursorTest : public ::testing::Test
+{
+public:
+    struct Recorder
+    {
+        std::vector<Message::MessageType> types;
+        std::vector<std::string> payloads;
+
+        template<typename Header>
+        void operator()(const Header& header, const char* payload, size_t payloadSize)
+        {
+            types.push_back(header.messageType);
+            payloads.emplace_back(payload, payloadSize);
+        }
+    };
+
+    template<typename Header>
+    void add(Header header, Message::MessageType type, const std::string& payload = "")
+    {
+        header.messageType = type;
+        // Unaligned on purpose, like in the frame slots.
+        const size_t offset = segment.size();
+        segment.resize(offset + sizeof(header));
+        memcpy(&segment[offset], &header, sizeof(header));
+        segment.insert(segment.end(), payload.begin(), payload.end());
+    }
+
+    void addValidMessages()
+    {
+        typedef Message::MessageType Type;
+        PixelData pixels;
+        pixels.width = 2;
+        pixels.height = 1;
+        pixels.format = sb::utility::PixelFormat::RGBA;
+        add(pixels, Type::PIXEL_DATA, "abcdefgh");
+        add(TextureData(), Type::TEXTURE_DATA);
+
+        VertexBufferWrite write;
+        write.numBytes = 3;
+        add(write, Type::VERTEX_BUFFER_WRITE, "xyz");
+        add(DrawCall(), Type::DRAW_CALL);
+        add(pixels, Type::PIXEL_DATA_REF);
+
+        FileIo io;
+        io.pathSize = 4;
+        add(io, Type::FILE_IO, "path");
+        add(TransformationMatrix(), Type::TRANSFORMATION_MATRIX);
+    }
+
+    bool walk(size_t size, Recorder& recorder)
+    {
+        MessageCursor cursor(segment.data(), segment.data() + size);
+        return cursor.forEach(recorder);
+    }
+
+    std::vector<char> segment;
+};
+
+TEST_F(MessageCursorTest, DispatchesByType)
+{
+    typedef Message::MessageType Type;
+    addValidMessages();
+    Recorder recorder;
+    MessageCursor cursor(segment.data(), segment.data() + segment.size());
+    ASSERT_TRUE(cursor.forEach(recorder));
+    EXPECT_TRUE(cursor.isAtEnd());
+
+    std::vector<Type> types = {Type::PIXEL_DATA, Type::TEXTURE_DATA, Type::VERTEX_BUFFER_WRITE, Type::DRAW_CALL, Type::PIXEL_DATA_REF, Type::FILE_IO, Type::TRANSFORMATION_MATRIX};
+    EXPECT_EQ(recorder.types, types);
+    std::vector<std::string> payloads = {"abcdefgh", "", "xyz", "", "", "path", ""};
+    EXPECT_EQ(recorder.payloads, payloads);
+
+    const MessageCursor::Counters& counters = cursor.getCounters();
+    EXPECT_EQ(counters.numMessages[size_t(Type::PIXEL_DATA)], 1);
+    EXPECT_EQ(counters.numBytes[size_t(Type::PIXEL_DATA)], sizeof(PixelData) + 8);
+    EXPECT_EQ(counters.numBytes[size_t(Type::DRAW_CALL)], sizeof(DrawCall));
+    EXPECT_EQ(counters.numMessages[size_t(Type::UNIFORM_4_F)], 0);
+
+    uint64_t numBytes = 0;
+    for(uint64_t n : counters.numBytes)
+        numBytes += n;
+    EXPECT_EQ(numBytes, segment.size());
+}
+
+TEST_F(MessageCursorTest, RejectsEveryTruncation)
+{
+    addValidMessages();
+    Recorder complete;
+    ASSERT_TRUE(walk(segment.size(), complete));
+
+    // Cutting the segment anywhere inside a message stops right before it.
+    for(size_t size = 0; size < segment.size(); size++)
+    {
+        Recorder recorder;
+        MessageCursor cursor(segment.data(), segment.data() + size);
+        bool isValid = cursor.forEach(recorder);
+        EXPECT_EQ(isValid, cursor.isAtEnd());
+        EXPECT_LE(cursor.getPosition(), segment.data() + size);
+        EXPECT_LE(recorder.types.size(), complete.types.size());
+    }
+}
+
+TEST_F(MessageCursorTest, RejectsUnknownType)
+{
+    add(TextureData(), Message::MessageType::TEXTURE_DATA);
+    add(TextureData(), Message::MessageType::INVALID);
+    add(TextureData(), Message::MessageType::TEXTURE_DATA);
+    segment.push_back(char(200));
+
+    Recorder recorder;
+    MessageCursor cursor(segment.data(), segment.data() + segment.size());
+    EXPECT_FALSE(cursor.forEach(recorder));
+    EXPECT_EQ(recorder.types.size(), 1);
+    EXPECT_EQ(cursor.getPosition(), segment.data() + sizeof(TextureData));
+}
+
+TEST_F(MessageCursorTest, RejectsInvalidPixelFormat)
+{
+    PixelData pixels;
+    pixels.width = 1;
+    pixels.height = 1;
+    pixels.format = sb::utility::PixelFormat(17);
+    add(pixels, Message::MessageType::PIXEL_DATA, "abcd");
+
+    Recorder recorder;
+    EXPECT_FALSE(walk(segment.size(), recorder));
+    EXPECT_TRUE(recorder.types.empty());
+}
+
+TEST_F(MessageCursorTest, RejectsOversizedPayload)
+{
+    PixelData pixels;
+    pixels.width = 0xffff;
+    pixels.height = 0xffff;
+    pixels.format = sb::utility::PixelFormat::RGBA;
+    add(pixels, Message::MessageType::SCREEN_PIXELS, "abcd");
+
+    Recorder recorder;
+    EXPECT_FALSE(walk(segment.size(), recorder));
+    EXPECT_TRUE(recorder.types.empty());
+}
+
+TEST_F(MessageCursorTest, EmptySegment)
+{
+    Recorder recorder;
+    MessageCursor cursor(nullptr, nullptr);
+    EXPECT_TRUE(cursor.forEach(recorder));
+    EXPECT_TRUE(recorder.types.empty());
+}
@@ -0,0 +1,141 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/ObjectTraits.hpp"
+using namespace GraphicsLayer;
+using namespace sb::tibiaassets;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <random>
+#include <chrono>
+#include <iostream>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// ObjectTraitsTest
+////////////////////////////////////////
+class ObjectTraitsTest : public ::testing::Test
+{
+public:
+    ObjectTraitsTest()
+    {
+        const Object::Type TYPES[] = {Object::Type::ITEM, Object::Type::OUTFIT, Object::Type::EFFECT, Object::Type::PROJECTILE};
+        std::mt19937 rng(13);
+        objects.resize(NUM_OBJECTS);
+        for(Object& o : objects)
+        {
+            o.type = TYPES[rng() % 4];
+            Object::ItemInfo& i = o.itemInfo;
+            i.isGround = rng() % 2;
+            i.isBlocking = rng() % 2;
+            i.isMovable = rng() % 2;
+            i.isContainer = rng() % 2;
+            i.isPickupable = rng() % 2;
+            i.walkSpeed = rng() % 1000;
+            i.topOrder = rng() % 4;
+            i.offsetX = rng() % 16;
+            i.offsetY = rng() % 16;
+            i.bodyRestriction = rng() % 2 ? Object::BodyRestriction::NONE : Object::BodyRestriction(rng() % 12);
+            if(rng() % 2)
+            {
+                o.someInfos.resize(1);
+                o.someInfos.front().spriteInfo.numMounts = 1 + rng() % 2;
+                o.someInfos.front().spriteInfo.spriteIds.resize(8);
+            }
+        }
+    }
+
+    static const size_t NUM_OBJECTS = 40000;
+    std::vector<Object> objects;
+};
+
+TEST_F(ObjectTraitsTest, MatchesObjects)
+{
+    ObjectTraits traits(objects);
+    ASSERT_EQ(traits.size(), objects.size());
+    for(size_t i = 0; i < objects.size(); i++)
+    {
+        const Object& o = objects[i];
+        const ObjectTraits::Traits& t = traits[i];
+        ASSERT_EQ(t.getType(), o.type);
+        ASSERT_EQ(t.isGround(), o.itemInfo.isGround);
+        ASSERT_EQ(t.isBlocking(), o.itemInfo.isBlocking);
+        ASSERT_EQ(t.isMovable(), o.itemInfo.isMovable);
+        ASSERT_EQ(t.isContainer(), o.itemInfo.isContainer);
+        ASSERT_EQ(t.isPickupable(), o.itemInfo.isPickupable);
+        ASSERT_EQ(t.getWalkSpeed(), o.itemInfo.walkSpeed);
+        ASSERT_EQ(t.getTopOrder(), o.itemInfo.topOrder);
+        ASSERT_EQ(t.getOffsetX(), o.itemInfo.offsetX);
+        ASSERT_EQ(t.getOffsetY(), o.itemInfo.offsetY);
+        ASSERT_EQ(t.getBodyRestriction(), o.itemInfo.bodyRestriction);
+        ASSERT_EQ(t.hasMounts(), !o.someInfos.empty() && o.someInfos.front().spriteInfo.numMounts > 1);
+    }
+}
+
+TEST_F(ObjectTraitsTest, LookupBenchmark)
+{
+    ObjectTraits traits(objects);
+    std::mt19937 rng(17);
+    std::vector<size_t> ids(1 << 20);
+    for(size_t& id : ids)
+        id = rng() % objects.size();
+
+    using namespace std::chrono;
+    size_t fromObjects = 0;
+    auto start = steady_clock::now();
+    for(size_t id : ids)
+    {
+        const Object::ItemInfo& i = objects[id].itemInfo;
+        if(i.isGround && i.topOrder == 0)
+            fromObjects += i.walkSpeed;
+        if(i.isBlocking && !i.isMovable)
+            fromObjects += i.offsetX;
+    }
+    auto middle = steady_clock::now();
+    size_t fromTraits = 0;
+    for(size_t id : ids)
+    {
+        const ObjectTraits::Traits& t = traits[id];
+        if(t.isGround() && t.getTopOrder() == 0)
+            fromTraits += t.getWalkSpeed();
+        if(t.isBlocking() && !t.isMovable())
+            fromTraits += t.getOffsetX();
+    }
+    auto end = steady_clock::now();
+
+    ASSERT_EQ(fromObjects, fromTraits);
+    std::cout << "Object: " << duration_cast<microseconds>(middle - start).count() / 1000.f << " ms" << std::endl
+              << "ObjectTraits: " << duration_cast<microseconds>(end - middle).count() / 1000.f << " ms" << std::endl;
+}
@@ -0,0 +1,189 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/FrameParser.hpp"
+#include "monitor/TibiaContext.hpp"
+using namespace GraphicsLayer;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <memory>
+#include <vector>
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C
+#include <cstring>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// PixelHashResyncTest
+////////////////////////////////////////
+class PixelHashResyncTest : public ::testing::Test
+{
+public:
+    static const unsigned int TILE_BUFFER_ID = 7;
+
+    PixelHashResyncTest()
+    {
+        std::unique_ptr<std::vector<sb::tibiaassets::Object>> objects;
+        std::unique_ptr<SpriteObjectBindings> bindings;
+        std::unique_ptr<SequenceTree> colorTree;
+        std::unique_ptr<SequenceTree> transparencyTree;
+        std::unique_ptr<SpriteInfo> spriteInfo;
+        std::unique_ptr<std::vector<std::string>> graphicsResourceNames;
+        std::unique_ptr<std::vector<FontSample::Glyph>> glyphs;
+        context.reset(new TibiaContext(objects, bindings, colorTree, transparencyTree, spriteInfo, graphicsResourceNames, glyphs));
+        parser.reset(new FrameParser(*context));
+    }
+
+    template<typename T>
+    void addMessage(const T& message, size_t numPayloadBytes = 0)
+    {
+        const size_t offset = messages.size();
+        messages.resize(offset + sizeof(message) + numPayloadBytes, 0);
+        memcpy(&messages[offset], &message, sizeof(message));
+    }
+
+    void addTileBuffer()
+    {
+        SharedMemoryProtocol::TextureData tex;
+        tex.messageType = SharedMemoryProtocol::Message::MessageType::TEXTURE_DATA;
+        tex.width = 4096;
+        tex.height = 4096;
+        tex.id = TILE_BUFFER_ID;
+        addMessage(tex);
+    }
+
+    SharedMemoryProtocol::PixelData createUpload(SharedMemoryProtocol::Message::MessageType type, uint64_t hash) const
+    {
+        SharedMemoryProtocol::PixelData p;
+        p.messageType = type;
+        p.texX = 32;
+        p.texY = 64;
+        p.width = 32;
+        p.height = 32;
+        p.targetTextureId = TILE_BUFFER_ID;
+        p.format = sb::utility::PixelFormat::RGBA;
+        p.hash = hash;
+        return p;
+    }
+
+    void addReference(uint64_t hash)
+    {
+        addMessage(createUpload(SharedMemoryProtocol::Message::MessageType::PIXEL_DATA_REF, hash));
+    }
+
+    // The pixels are cut short, as if the slot ended in the middle of them.
+    void addTruncatedUpload(uint64_t hash)
+    {
+        addMessage(createUpload(SharedMemoryProtocol::Message::MessageType::PIXEL_DATA, hash), 100);
+    }
+
+    // Parses the messages added so far as one slot of a frame of its own.
+    void parseSlot(bool clearsPixelHashes = false)
+    {
+        SharedMemoryProtocol::Frame frame;
+        frame.clearsPixelHashes = clearsPixelHashes;
+        frame.size = sizeof(frame) + messages.size();
+        std::vector<char> data(sizeof(frame));
+        memcpy(data.data(), &frame, sizeof(frame));
+        data.insert(data.end(), messages.begin(), messages.end());
+        messages.clear();
+        parser->parse(data.data(), data.size());
+    }
+
+    std::unique_ptr<TibiaContext> context;
+    std::unique_ptr<FrameParser> parser;
+    std::vector<char> messages;
+};
+
+const unsigned int PixelHashResyncTest::TILE_BUFFER_ID;
+
+TEST_F(PixelHashResyncTest, NothingIsRequestedWhileInSync)
+{
+    addTileBuffer();
+    parseSlot();
+    parseSlot(true);
+    EXPECT_FALSE(parser->takePixelHashResyncRequest());
+}
+
+TEST_F(PixelHashResyncTest, RejectedUploadFollowedByReferenceRequestsResync)
+{
+    addTileBuffer();
+    parseSlot();
+    addTruncatedUpload(42);
+    parseSlot();
+    ASSERT_EQ(parser->getNumRejectedSegments(), 1);
+
+    addReference(42);
+    parseSlot();
+    EXPECT_TRUE(parser->takePixelHashResyncRequest());
+    EXPECT_FALSE(parser->takePixelHashResyncRequest());
+}
+
+TEST_F(PixelHashResyncTest, ReferenceFromBeforeParserStartRequestsResync)
+{
+    addTileBuffer();
+    addReference(42);
+    parseSlot();
+    EXPECT_TRUE(parser->takePixelHashResyncRequest());
+}
+
+TEST_F(PixelHashResyncTest, RequestIsRepeatedOnlyAfterResync)
+{
+    addTileBuffer();
+    addReference(42);
+    parseSlot();
+    ASSERT_TRUE(parser->takePixelHashResyncRequest());
+
+    // References the injected side sent before it saw the request.
+    addReference(43);
+    parseSlot();
+    EXPECT_FALSE(parser->takePixelHashResyncRequest());
+
+    parseSlot(true);
+    EXPECT_FALSE(parser->takePixelHashResyncRequest());
+
+    addReference(44);
+    parseSlot();
+    EXPECT_TRUE(parser->takePixelHashResyncRequest());
+}
+
+TEST_F(PixelHashResyncTest, RejectionAfterResyncRequestsAgain)
+{
+    addTruncatedUpload(42);
+    parseSlot(true);
+    EXPECT_TRUE(parser->takePixelHashResyncRequest());
+}
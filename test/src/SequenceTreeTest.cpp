@@ -0,0 +1,447 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/SequenceTree.hpp"
+#include "utility/ThreadPool.hpp"
+using namespace GraphicsLayer;
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// SequenceTreeTest
+////////////////////////////////////////
+// Builds a color and a transparency tree from random sprites. Values are
+// drawn from a small alphabet so that sprites share long prefixes and
+// several sprites end up with equal transparency sequences, like they do
+// for real sprite sheets.
+class SequenceTreeTest : public ::testing::Test
+{
+public:
+    SequenceTreeTest()
+    {
+        const size_t NUM_SPRITES = 20000;
+        std::mt19937 rng(1);
+        for(size_t i = 0; i < NUM_SPRITES; i++)
+        {
+            colorSequences.push_back(createSequence(rng, 4));
+            transparencySequences.push_back(createSequence(rng, 2));
+            ids.push_back(i);
+        }
+
+        colorTree.reset(new SequenceTree(colorSequences, ids));
+        transparencyTree.reset(new SequenceTree(transparencySequences, ids));
+
+        // Half of the queries are known sprites, the rest are mostly misses.
+        const size_t NUM_QUERIES = 512;
+        for(size_t i = 0; i < NUM_QUERIES; i++)
+        {
+            if(i % 2 == 0)
+            {
+                size_t sprite = rng() % NUM_SPRITES;
+                queryColors.push_back(colorSequences[sprite]);
+                queryTransparencies.push_back(transparencySequences[sprite]);
+            }
+            else
+            {
+                queryColors.push_back(createSequence(rng, 4));
+                queryTransparencies.push_back(createSequence(rng, 2));
+            }
+        }
+
+        for(size_t i = 0; i < NUM_QUERIES; i++)
+        {
+            SequenceTree::BatchQuery query;
+            query.primary = queryColors[i].data();
+            query.primarySize = queryColors[i].size();
+            query.secondary = queryTransparencies[i].data();
+            query.secondarySize = queryTransparencies[i].size();
+            queries.push_back(query);
+        }
+    }
+
+    static std::vector<size_t> createSequence(std::mt19937& rng, size_t numValues)
+    {
+        std::vector<size_t> sequence(1 + rng() % 24);
+        for(size_t& value : sequence)
+            value = rng() % numValues;
+
+        return sequence;
+    }
+
+    // The per call path FrameParser used before findBatch.
+    bool findIntersection(size_t query, std::list<unsigned int>& matchingIds) const
+    {
+        std::list<unsigned int> ids;
+        if(!colorTree->find(queryColors[query], ids))
+            return false;
+
+        std::list<unsigned int> tIds;
+        transparencyTree->find(queryTransparencies[query], tIds);
+
+        for(unsigned int id : ids)
+            if(std::find(tIds.begin(), tIds.end(), id) != tIds.end())
+                matchingIds.push_back(id);
+
+        matchingIds.sort();
+        matchingIds.unique();
+        return true;
+    }
+
+    void expectMatchesFind(const SequenceTree::BatchResults& results) const
+    {
+        ASSERT_EQ(results.offsets.size(), queries.size() + 1);
+        ASSERT_EQ(results.offsets.back(), results.ids.size());
+        for(size_t i = 0; i < queries.size(); i++)
+        {
+            std::list<unsigned int> expectIds;
+            bool expectFound = findIntersection(i, expectIds);
+            EXPECT_EQ(bool(results.isPrimaryFound[i]), expectFound);
+
+            std::list<unsigned int> actualIds(results.ids.begin() + results.offsets[i], results.ids.begin() + results.offsets[i + 1]);
+            EXPECT_EQ(actualIds, expectIds);
+        }
+    }
+
+    static std::string getImage(const SequenceTree& tree)
+    {
+        const std::string filePath = "sequenceTreeTest.bin";
+        tree.writeToBinaryFile(filePath);
+        std::ifstream file(filePath, std::ios::binary);
+        std::stringstream image;
+        image << file.rdbuf();
+        file.close();
+        std::remove(filePath.c_str());
+        return image.str();
+    }
+
+    std::vector<std::vector<size_t>> colorSequences;
+    std::vector<std::vector<size_t>> transparencySequences;
+    std::vector<unsigned int> ids;
+    std::unique_ptr<SequenceTree> colorTree;
+    std::unique_ptr<SequenceTree> transparencyTree;
+
+    std::vector<std::vector<size_t>> queryColors;
+    std::vector<std::vector<size_t>> queryTransparencies;
+    std::vector<SequenceTree::BatchQuery> queries;
+};
+
+TEST_F(SequenceTreeTest, FindBatchMatchesFind)
+{
+    SequenceTree::BatchResults results;
+    SequenceTree::findBatch(*colorTree, *transparencyTree, queries.data(), queries.size(), results);
+    expectMatchesFind(results);
+}
+
+TEST_F(SequenceTreeTest, FindBatchWithPoolMatchesFind)
+{
+    ThreadPool pool(4);
+    SequenceTree::BatchResults results;
+    for(size_t i = 0; i < 3; i++)
+    {
+        SequenceTree::findBatch(*colorTree, *transparencyTree, queries.data(), queries.size(), results, &pool);
+        expectMatchesFind(results);
+    }
+}
+
+TEST_F(SequenceTreeTest, FindBatchBenchmark)
+{
+    typedef std::chrono::steady_clock Clock;
+    const size_t NUM_ITERATIONS = 200;
+
+    size_t numFound = 0;
+    Clock::time_point start = Clock::now();
+    for(size_t n = 0; n < NUM_ITERATIONS; n++)
+    {
+        for(size_t i = 0; i < queries.size(); i++)
+        {
+            std::list<unsigned int> matchingIds;
+            findIntersection(i, matchingIds);
+            numFound += matchingIds.size();
+        }
+    }
+    double perCallTime = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / NUM_ITERATIONS;
+
+    SequenceTree::BatchResults results;
+    size_t numBatchFound = 0;
+    start = Clock::now();
+    for(size_t n = 0; n < NUM_ITERATIONS; n++)
+    {
+        SequenceTree::findBatch(*colorTree, *transparencyTree, queries.data(), queries.size(), results);
+        numBatchFound += results.ids.size();
+    }
+    double batchTime = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / NUM_ITERATIONS;
+
+    ThreadPool pool;
+    size_t numPoolFound = 0;
+    start = Clock::now();
+    for(size_t n = 0; n < NUM_ITERATIONS; n++)
+    {
+        SequenceTree::findBatch(*colorTree, *transparencyTree, queries.data(), queries.size(), results, &pool);
+        numPoolFound += results.ids.size();
+    }
+    double poolTime = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / NUM_ITERATIONS;
+
+    EXPECT_EQ(numBatchFound, numFound);
+    EXPECT_EQ(numPoolFound, numFound);
+
+    std::cout << queries.size() << " queries per batch" << std::endl;
+    std::cout << "find + list intersection: " << perCallTime << " us/batch" << std::endl;
+    std::cout << "findBatch:                " << batchTime << " us/batch" << std::endl;
+    std::cout << "findBatch, " << pool.getNumThreads() << " threads:    " << poolTime << " us/batch" << std::endl;
+}
+
+TEST_F(SequenceTreeTest, ThreadCountDoesNotChangeTree)
+{
+    const std::string image = getImage(*colorTree);
+    for(size_t numThreads : {1, 2, 5})
+        EXPECT_EQ(getImage(SequenceTree(colorSequences, ids, numThreads)), image);
+}
+
+TEST_F(SequenceTreeTest, BuilderMatchesVectors)
+{
+    const std::string spillFilePath = "sequenceTreeTest.spill";
+    for(size_t numThreads : {1, 4})
+    {
+        SequenceTree::Builder builder(spillFilePath);
+        for(size_t i = 0; i < transparencySequences.size(); i++)
+            EXPECT_EQ(builder.add(transparencySequences[i], ids[i]), i);
+
+        EXPECT_EQ(builder.getNumSequences(), transparencySequences.size());
+        std::vector<size_t> sequence;
+        for(size_t i = 0; i < transparencySequences.size(); i += 101)
+        {
+            builder.getSequence(i, sequence);
+            ASSERT_EQ(sequence, transparencySequences[i]);
+        }
+
+        // Empty sequences are counted, but never end up in the tree.
+        builder.add(std::vector<size_t>(), ids.size());
+        builder.getSequence(ids.size(), sequence);
+        EXPECT_TRUE(sequence.empty());
+
+        EXPECT_EQ(getImage(*builder.build(numThreads)), getImage(*transparencyTree));
+        EXPECT_THROW(builder.add(transparencySequences.front(), 0), std::runtime_error);
+    }
+
+    EXPECT_FALSE(std::ifstream(spillFilePath).good());
+}
+
+TEST_F(SequenceTreeTest, MappedFileMatchesMemory)
+{
+    const std::string filePath = "sequenceTreeTest.bin";
+    colorTree->writeToBinaryFile(filePath);
+    EXPECT_FALSE(SequenceTree::isLegacyFile(filePath));
+    {
+        SequenceTree mapped(filePath);
+        EXPECT_EQ(mapped.getSize(), colorTree->getSize());
+        for(const std::vector<size_t>& query : queryColors)
+        {
+            std::list<unsigned int> expectIds;
+            std::list<unsigned int> actualIds;
+            EXPECT_EQ(mapped.find(query, actualIds), colorTree->find(query, expectIds));
+            EXPECT_EQ(actualIds, expectIds);
+        }
+
+        for(unsigned int id = 0; id < ids.size(); id += 97)
+            EXPECT_EQ(mapped.trace(id), colorTree->trace(id));
+    }
+    std::remove(filePath.c_str());
+}
+
+TEST_F(SequenceTreeTest, LegacyFileIsConverted)
+{
+    // Node by node, depth first: elements, level and child keys. The tree
+    // holds {1} as 6, {1, 2} as 5 and {3} as 7.
+    struct LegacyNode
+    {
+        std::vector<unsigned int> ids;
+        unsigned int level;
+        std::vector<size_t> childKeys;
+    };
+    const std::vector<LegacyNode> nodes =
+    {
+        {{}, 0, {1, 3}},
+        {{6}, 1, {2}},
+        {{5}, 2, {}},
+        {{7}, 1, {}},
+    };
+
+    // getImage() writes to its own file, which must not be the mapped one.
+    const std::string legacyPath = "sequenceTreeTest.legacy";
+    const std::string filePath = "sequenceTreeTest.converted";
+    {
+        std::ofstream file(legacyPath, std::ios::binary);
+        for(const LegacyNode& node : nodes)
+        {
+            const unsigned int numElements = node.ids.size();
+            const std::vector<int> numValuesIgnored(numElements, 0);
+            const unsigned short numChildren = node.childKeys.size();
+            file.write((const char*)&numElements, sizeof(numElements));
+            file.write((const char*)node.ids.data(), sizeof(unsigned int) * numElements);
+            file.write((const char*)numValuesIgnored.data(), sizeof(int) * numElements);
+            file.write((const char*)&node.level, sizeof(node.level));
+            file.write((const char*)&numChildren, sizeof(numChildren));
+            file.write((const char*)node.childKeys.data(), sizeof(size_t) * numChildren);
+        }
+    }
+
+    ASSERT_TRUE(SequenceTree::isLegacyFile(legacyPath));
+    SequenceTree::convertLegacyFile(legacyPath, filePath);
+    ASSERT_FALSE(SequenceTree::isLegacyFile(filePath));
+
+    SequenceTree tree(filePath);
+    EXPECT_EQ(tree.getSize(), 3);
+    auto find = [&tree](const std::vector<size_t>& sequence)
+    {
+        std::list<unsigned int> ids;
+        tree.find(sequence, ids);
+        return ids;
+    };
+    EXPECT_EQ(find({1}), std::list<unsigned int>{6});
+    EXPECT_EQ(find({1, 2}), std::list<unsigned int>{5});
+    EXPECT_EQ(find({3}), std::list<unsigned int>{7});
+    EXPECT_TRUE(find({2}).empty());
+    EXPECT_EQ(tree.trace(5), (std::list<size_t>{1, 2}));
+    EXPECT_EQ(getImage(SequenceTree(legacyPath)), getImage(tree));
+
+    // A legacy file that ends early is rejected.
+    std::string legacy;
+    {
+        std::ifstream file(legacyPath, std::ios::binary);
+        std::stringstream content;
+        content << file.rdbuf();
+        legacy = content.str();
+    }
+    std::ofstream(legacyPath, std::ios::binary).write(legacy.data(), legacy.size() - 4);
+    EXPECT_THROW(SequenceTree tree(legacyPath), std::runtime_error);
+
+    std::remove(legacyPath.c_str());
+    std::remove(filePath.c_str());
+}
+
+TEST_F(SequenceTreeTest, CorruptFilesAreRejected)
+{
+    const std::string image = getImage(*colorTree);
+    const std::string filePath = "sequenceTreeTest.bin";
+    auto load = [&filePath](const std::string& corrupt)
+    {
+        std::ofstream(filePath, std::ios::binary).write(corrupt.data(), corrupt.size());
+        SequenceTree tree(filePath);
+    };
+    ASSERT_NO_THROW(load(image));
+
+    EXPECT_THROW(load(image.substr(0, image.size() - 8)), std::runtime_error);
+
+    std::string badVersion = image;
+    badVersion[offsetof(SequenceTree::Header, version)] ^= 0x7f;
+    EXPECT_THROW(load(badVersion), std::runtime_error);
+
+    // Offsets into the arrays, as laid out by SequenceTree.
+    SequenceTree::Header header;
+    memcpy(&header, image.data(), sizeof(header));
+    ASSERT_GT(header.numEdges, 0);
+    auto align = [](size_t offset)
+    {
+        return (offset + 7) & ~size_t(7);
+    };
+    const size_t levels = align(sizeof(header));
+    const size_t childOffsets = align(levels + sizeof(uint32_t) * header.numNodes);
+    const size_t childKeys = align(childOffsets + sizeof(uint32_t) * (header.numNodes + 1));
+    const size_t childNodes = align(childKeys + sizeof(size_t) * header.numEdges);
+
+    std::string badChild = image;
+    const uint32_t outOfRange = header.numNodes;
+    memcpy(&badChild[childNodes], &outOfRange, sizeof(outOfRange));
+    EXPECT_THROW(load(badChild), std::runtime_error);
+
+    std::string cycle = image;
+    const uint32_t root = 0;
+    memcpy(&cycle[childNodes], &root, sizeof(root));
+    EXPECT_THROW(load(cycle), std::runtime_error);
+
+    std::string badOffset = image;
+    const uint32_t pastEnd = header.numEdges + 1;
+    memcpy(&badOffset[childOffsets + sizeof(uint32_t)], &pastEnd, sizeof(pastEnd));
+    EXPECT_THROW(load(badOffset), std::runtime_error);
+
+    std::remove(filePath.c_str());
+}
+
+TEST_F(SequenceTreeTest, BuildBenchmark)
+{
+    typedef std::chrono::steady_clock Clock;
+    std::mt19937 rng(2);
+    std::vector<std::vector<size_t>> sequences;
+    std::vector<unsigned int> sequenceIds;
+    for(size_t i = 0; i < 100000; i++)
+    {
+        sequences.push_back(createSequence(rng, 4));
+        sequences.back().resize(sequences.back().size() * 16, sequences.back().back());
+        sequenceIds.push_back(i);
+    }
+
+    Clock::time_point start = Clock::now();
+    size_t size = SequenceTree(sequences, sequenceIds, 1).getSize();
+    double singleTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    start = Clock::now();
+    EXPECT_EQ(SequenceTree(sequences, sequenceIds).getSize(), size);
+    double parallelTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    SequenceTree::Builder builder("sequenceTreeTest.spill");
+    for(size_t i = 0; i < sequences.size(); i++)
+        builder.add(sequences[i], sequenceIds[i]);
+    sequences.clear();
+    start = Clock::now();
+    EXPECT_EQ(builder.build()->getSize(), size);
+    double spillTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::cout << size << " sequences" << std::endl;
+    std::cout << "1 thread:            " << singleTime << " ms" << std::endl;
+    std::cout << "All threads:         " << parallelTime << " ms" << std::endl;
+    std::cout << "All threads, spilled: " << spillTime << " ms" << std::endl;
+}
@@ -0,0 +1,196 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "tibiaassets/SpriteAtlas.hpp"
+#include "tibiaassets/constants.hpp"
+#include "utility/utility.hpp"
+using namespace sb::tibiaassets;
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <random>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// SpriteAtlasTest
+////////////////////////////////////////
+class SpriteAtlasTest : public ::testing::Test
+{
+public:
+    struct SpriteSheet
+    {
+        unsigned int firstSpriteId;
+        unsigned char tileWidth;
+        unsigned char tileHeight;
+        size_t numSprites;
+        std::vector<unsigned char> pixels;
+        size_t stride;
+    };
+
+    SpriteAtlasTest()
+    {
+        std::mt19937 rng(29);
+        const unsigned char TILE_SIZES[][2] = {{1, 1}, {1, 2}, {2, 1}, {2, 2}};
+        unsigned int id = FIRST_SPRITE_ID;
+        for(const auto& size : TILE_SIZES)
+        {
+            SpriteSheet sheet;
+            sheet.firstSpriteId = id;
+            sheet.tileWidth = size[0];
+            sheet.tileHeight = size[1];
+            sheet.numSprites = 3;
+            sheet.stride = sheet.numSprites * sheet.tileWidth * constants::TILE_PIXEL_WIDTH * BYTES_PER_PIXEL_RGBA;
+            sheet.pixels.resize(sheet.stride * sheet.tileHeight * constants::TILE_PIXEL_HEIGHT);
+            for(unsigned char& p : sheet.pixels)
+                p = rng();
+
+            sheets.push_back(sheet);
+            id += sheet.numSprites + 5; // Leave gaps in the ids.
+        }
+        lastSpriteId = id;
+    }
+
+    ~SpriteAtlasTest()
+    {
+        std::remove(filePath.c_str());
+    }
+
+    // Sprites are views into their sheet, as handed out by SpriteReader.
+    SpriteReader::Sprite getSprite(const SpriteSheet& sheet, size_t index) const
+    {
+        SpriteReader::Sprite spr;
+        spr.stride = sheet.stride;
+        spr.pixels = sheet.pixels.data() + index * sheet.tileWidth * constants::TILE_PIXEL_WIDTH * BYTES_PER_PIXEL_RGBA;
+        spr.tileWidth = sheet.tileWidth;
+        spr.tileHeight = sheet.tileHeight;
+        spr.id = sheet.firstSpriteId + index;
+        spr.area = index;
+        return spr;
+    }
+
+    void write(bool isFinished = true)
+    {
+        SpriteAtlas::Writer writer(filePath, CATALOG_KEY, FIRST_SPRITE_ID, lastSpriteId);
+        for(auto sheet = sheets.rbegin(); sheet != sheets.rend(); sheet++)
+            for(size_t i = 0; i < sheet->numSprites; i++)
+                writer.add(getSprite(*sheet, i));
+
+        if(isFinished)
+            writer.finish();
+    }
+
+    static const unsigned int FIRST_SPRITE_ID = 10;
+    static const uint64_t CATALOG_KEY = 0x1234567890abcdef;
+    unsigned int lastSpriteId;
+    std::vector<SpriteSheet> sheets;
+    std::string filePath = "spriteAtlasTest.bin";
+};
+
+const unsigned int SpriteAtlasTest::FIRST_SPRITE_ID;
+const uint64_t SpriteAtlasTest::CATALOG_KEY;
+
+TEST_F(SpriteAtlasTest, ReadMatchesWrite)
+{
+    write();
+
+    SpriteAtlas atlas(filePath);
+    EXPECT_EQ(atlas.getCatalogKey(), CATALOG_KEY);
+    EXPECT_EQ(atlas.getNumSprites(), sheets.size() * 3);
+    for(const SpriteSheet& sheet : sheets)
+    {
+        for(size_t i = 0; i < sheet.numSprites; i++)
+        {
+            SpriteReader::Sprite expected = getSprite(sheet, i);
+            ASSERT_TRUE(atlas.hasSprite(expected.id));
+            SpriteReader::Sprite spr = atlas.getSprite(expected.id);
+            ASSERT_NE(spr.pixels, nullptr);
+            EXPECT_EQ(spr.id, expected.id);
+            EXPECT_EQ(spr.tileWidth, expected.tileWidth);
+            EXPECT_EQ(spr.tileHeight, expected.tileHeight);
+            EXPECT_EQ(spr.area, expected.area);
+            EXPECT_EQ(size_t(spr.pixels) % 16, 0);
+
+            const size_t ROW_SIZE = spr.tileWidth * constants::TILE_PIXEL_WIDTH * BYTES_PER_PIXEL_RGBA;
+            ASSERT_EQ(spr.stride, ROW_SIZE);
+            for(size_t y = 0; y < spr.tileHeight * constants::TILE_PIXEL_HEIGHT; y++)
+                ASSERT_EQ(0, memcmp(spr.pixels + y * spr.stride, expected.pixels + y * expected.stride, ROW_SIZE));
+        }
+    }
+}
+
+TEST_F(SpriteAtlasTest, MissingSprites)
+{
+    write();
+
+    SpriteAtlas atlas(filePath);
+    for(unsigned int id : {0u, FIRST_SPRITE_ID - 1, FIRST_SPRITE_ID + 3, lastSpriteId, lastSpriteId + 1, ~0u})
+    {
+        EXPECT_FALSE(atlas.hasSprite(id));
+        EXPECT_EQ(atlas.getSprite(id).pixels, nullptr);
+    }
+}
+
+TEST_F(SpriteAtlasTest, RejectsOutOfRangeSprites)
+{
+    SpriteAtlas::Writer writer(filePath, CATALOG_KEY, FIRST_SPRITE_ID + 1, lastSpriteId);
+    EXPECT_THROW(writer.add(getSprite(sheets.front(), 0)), std::runtime_error);
+}
+
+TEST_F(SpriteAtlasTest, RejectsUnfinishedAtlas)
+{
+    write(false);
+    EXPECT_THROW(SpriteAtlas atlas(filePath), std::runtime_error);
+}
+
+TEST_F(SpriteAtlasTest, RejectsTruncatedAtlas)
+{
+    write();
+
+    FILE* file = std::fopen(filePath.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    std::vector<char> data(1 << 20);
+    data.resize(std::fread(data.data(), 1, data.size(), file));
+    std::fclose(file);
+
+    file = std::fopen(filePath.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fwrite(data.data(), 1, data.size() - 100, file);
+    std::fclose(file);
+
+    EXPECT_THROW(SpriteAtlas atlas(filePath), std::runtime_error);
+}
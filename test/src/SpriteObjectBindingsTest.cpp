@@ -0,0 +1,156 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/SpriteObjectBindings.hpp"
+using namespace GraphicsLayer;
+using namespace sb::tibiaassets;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <random>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <cstdio>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// SpriteObjectBindingsTest
+////////////////////////////////////////
+class SpriteObjectBindingsTest : public ::testing::Test
+{
+public:
+    SpriteObjectBindingsTest()
+    {
+        std::mt19937 rng(19);
+        objects.resize(NUM_OBJECTS);
+        for(size_t i = 0; i < objects.size(); i++)
+        {
+            Object& o = objects[i];
+            o.someInfos.resize(1 + rng() % 2);
+            for(Object::SomeInfo& info : o.someInfos)
+            {
+                info.spriteInfo.spriteIds.resize(rng() % 12);
+                for(unsigned int& id : info.spriteInfo.spriteIds)
+                {
+                    // Sprites shared between objects are common, as are zeros.
+                    id = rng() % 8 == 0 ? 0 : rng() % MAX_SPRITE_ID;
+                    expected[id].insert(i);
+                }
+            }
+        }
+        expected.erase(0);
+    }
+
+    ~SpriteObjectBindingsTest()
+    {
+        std::remove(PATH);
+    }
+
+    void expectMatches(const SpriteObjectBindings& bindings) const
+    {
+        for(size_t spriteId = 0; spriteId < MAX_SPRITE_ID + 10; spriteId++)
+        {
+            auto it = expected.find(spriteId);
+            sb::utility::Span<uint32_t> found = bindings.getObjects(spriteId);
+            if(it == expected.end())
+                ASSERT_TRUE(found.empty()) << spriteId;
+            else
+                ASSERT_EQ(std::vector<size_t>(found.begin(), found.end()), std::vector<size_t>(it->second.begin(), it->second.end()));
+        }
+    }
+
+    static const size_t NUM_OBJECTS = 20000;
+    static const size_t MAX_SPRITE_ID = 50000;
+    const char* PATH = "sprite-object-bindings-test.bin";
+    std::vector<Object> objects;
+    std::map<size_t, std::set<size_t>> expected;
+};
+
+TEST_F(SpriteObjectBindingsTest, BuiltMatchesObjects)
+{
+    expectMatches(SpriteObjectBindings(objects));
+}
+
+TEST_F(SpriteObjectBindingsTest, MappedMatchesBuilt)
+{
+    SpriteObjectBindings(objects).writeToBinaryFile(PATH);
+    ASSERT_FALSE(SpriteObjectBindings::isLegacyFile(PATH));
+    expectMatches(SpriteObjectBindings(PATH));
+}
+
+TEST_F(SpriteObjectBindingsTest, ConvertsLegacyFile)
+{
+    {
+        std::ofstream file(PATH, std::ios::binary);
+        unsigned int numSprites = expected.size();
+        file.write((char*)&numSprites, sizeof(numSprites));
+        for(const auto& pair : expected)
+        {
+            file.write((char*)&pair.first, sizeof(pair.first));
+            unsigned int numBindedObjects = pair.second.size();
+            file.write((char*)&numBindedObjects, sizeof(numBindedObjects));
+            for(size_t object : pair.second)
+                file.write((char*)&object, sizeof(object));
+        }
+    }
+
+    ASSERT_TRUE(SpriteObjectBindings::isLegacyFile(PATH));
+    SpriteObjectBindings::convertLegacyFile(PATH, PATH);
+    ASSERT_FALSE(SpriteObjectBindings::isLegacyFile(PATH));
+    expectMatches(SpriteObjectBindings(PATH));
+}
+
+TEST_F(SpriteObjectBindingsTest, LookupBenchmark)
+{
+    SpriteObjectBindings(objects).writeToBinaryFile(PATH);
+    SpriteObjectBindings bindings(PATH);
+
+    std::mt19937 rng(23);
+    std::vector<size_t> ids(1 << 20);
+    for(size_t& id : ids)
+        id = rng() % MAX_SPRITE_ID;
+
+    using namespace std::chrono;
+    size_t sum = 0;
+    auto start = steady_clock::now();
+    for(size_t id : ids)
+        for(uint32_t object : bindings.getObjects(id))
+            sum += object;
+    auto end = steady_clock::now();
+
+    std::cout << ids.size() << " lookups: " << duration_cast<microseconds>(end - start).count() / 1000.f << " ms (" << sum << ")" << std::endl;
+}
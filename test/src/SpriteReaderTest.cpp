@@ -0,0 +1,219 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "tibiaassets/SpriteReader.hpp"
+#include "tibiaassets/SpriteAtlas.hpp"
+#include "tibiaassets/CatalogContent.hpp"
+#include "tibiaassets/constants.hpp"
+#include "utility/utility.hpp"
+using namespace sb::tibiaassets;
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <fstream>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <cstdio>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// SpriteReaderTest
+////////////////////////////////////////
+// Runs against the sprite sheets of an installed client. The tests pass
+// without doing anything when the client files are missing.
+class SpriteReaderTest : public ::testing::Test
+{
+public:
+    static constexpr const char* CATALOG_PATH = "../monitor/tibia/packages/Tibia/assets/catalog-content.json";
+
+    SpriteReaderTest()
+    {
+        if(std::ifstream(CATALOG_PATH).good())
+            cat.reset(new CatalogContent(CATALOG_PATH));
+    }
+
+    // Hashes every sprite, row by row, so that strided views and copied
+    // sprites can be compared.
+    std::map<unsigned int, size_t> hashSprites(bool isOrdered, size_t numThreads, std::vector<unsigned int>* order = nullptr) const
+    {
+        std::map<unsigned int, size_t> hashes;
+        SpriteReader(*cat).forEachSprite([&](const SpriteReader::Sprite& spr)
+        {
+            const size_t ROW_SIZE = spr.tileWidth * constants::TILE_PIXEL_WIDTH * BYTES_PER_PIXEL_RGBA;
+            const size_t HEIGHT = spr.tileHeight * constants::TILE_PIXEL_HEIGHT;
+            size_t hash = 0;
+            for(size_t y = 0; y < HEIGHT; y++)
+                for(size_t x = 0; x < ROW_SIZE; x++)
+                    hash = hash * 31 + spr.pixels[y * spr.stride + x];
+
+            hashes[spr.id] = hash;
+            if(order)
+                order->push_back(spr.id);
+            return true;
+        }, isOrdered, numThreads);
+        return hashes;
+    }
+
+    std::unique_ptr<CatalogContent> cat;
+};
+
+TEST_F(SpriteReaderTest, OrderedVisitsSpritesInSheetOrder)
+{
+    if(!cat)
+        return;
+
+    std::vector<unsigned int> order;
+    std::map<unsigned int, size_t> hashes = hashSprites(true, 0, &order);
+    ASSERT_EQ(hashes.size(), order.size());
+
+    std::vector<unsigned int> expectedOrder;
+    for(const CatalogContent::SpriteSheet& sheet : cat->getSpriteSheets())
+        for(int id = sheet.firstSpriteId; id <= sheet.lastSpriteId; id++)
+            expectedOrder.push_back(id);
+    ASSERT_EQ(expectedOrder, order);
+}
+
+TEST_F(SpriteReaderTest, ParallelMatchesSingleThread)
+{
+    if(!cat)
+        return;
+
+    std::map<unsigned int, size_t> expected = hashSprites(true, 1);
+    ASSERT_EQ(expected, hashSprites(true, 0));
+    ASSERT_EQ(expected, hashSprites(false, 0));
+}
+
+TEST_F(SpriteReaderTest, StridedViewMatchesGetSprite)
+{
+    if(!cat)
+        return;
+
+    SpriteReader reader(*cat);
+    size_t numChecked = 0;
+    reader.forEachSprite([&](const SpriteReader::Sprite& spr)
+    {
+        if(spr.id % 997 != 0)
+            return true;
+
+        SpriteReader::Sprite copy = reader.getSprite(spr.id);
+        const size_t ROW_SIZE = spr.tileWidth * constants::TILE_PIXEL_WIDTH * BYTES_PER_PIXEL_RGBA;
+        const size_t HEIGHT = spr.tileHeight * constants::TILE_PIXEL_HEIGHT;
+        for(size_t y = 0; y < HEIGHT; y++)
+            EXPECT_EQ(0, memcmp(spr.pixels + y * spr.stride, copy.pixels + y * copy.stride, ROW_SIZE));
+
+        numChecked++;
+        return numChecked < 20;
+    });
+}
+
+TEST_F(SpriteReaderTest, AtlasLookupMatchesSheets)
+{
+    if(!cat)
+        return;
+
+    // Only every 997th sprite goes into the atlas, to keep the file small.
+    const std::string ATLAS_PATH = "spriteReaderTest.atlas";
+    unsigned int firstSpriteId;
+    unsigned int lastSpriteId;
+    SpriteAtlas::getSpriteIdRange(*cat, firstSpriteId, lastSpriteId);
+    SpriteAtlas::Writer writer(ATLAS_PATH, SpriteAtlas::getCatalogKey(*cat), firstSpriteId, lastSpriteId);
+    std::map<unsigned int, size_t> expected;
+    for(const auto& hash : hashSprites(true, 0))
+        if(hash.first % 997 == 0)
+            expected.insert(hash);
+    SpriteReader(*cat).forEachSprite([&](const SpriteReader::Sprite& spr)
+    {
+        if(spr.id % 997 == 0)
+            writer.add(spr);
+        return true;
+    });
+    writer.finish();
+
+    {
+        SpriteAtlas atlas(ATLAS_PATH);
+        SpriteReader reader(*cat, atlas);
+        for(const auto& hash : expected)
+        {
+            SpriteReader::Sprite spr = reader.getSprite(hash.first);
+            ASSERT_NE(spr.pixels, nullptr);
+            const size_t ROW_SIZE = spr.tileWidth * constants::TILE_PIXEL_WIDTH * BYTES_PER_PIXEL_RGBA;
+            const size_t HEIGHT = spr.tileHeight * constants::TILE_PIXEL_HEIGHT;
+            size_t h = 0;
+            for(size_t y = 0; y < HEIGHT; y++)
+                for(size_t x = 0; x < ROW_SIZE; x++)
+                    h = h * 31 + spr.pixels[y * spr.stride + x];
+            EXPECT_EQ(hash.second, h);
+        }
+        const unsigned int MISSING_ID = (firstSpriteId % 997 == 0 ? firstSpriteId + 1 : firstSpriteId);
+        EXPECT_EQ(reader.getSprite(MISSING_ID).pixels, nullptr);
+    }
+    std::remove(ATLAS_PATH.c_str());
+}
+
+TEST_F(SpriteReaderTest, Benchmark)
+{
+    if(!cat)
+    {
+        std::cout << "No client files at " << CATALOG_PATH << ", skipping benchmark." << std::endl;
+        return;
+    }
+
+    auto time = [this](bool isOrdered, size_t numThreads)
+    {
+        auto start = std::chrono::steady_clock::now();
+        size_t numSprites = 0;
+        SpriteReader(*cat).forEachSprite([&numSprites](const SpriteReader::Sprite&)
+        {
+            numSprites++;
+            return true;
+        }, isOrdered, numThreads);
+        auto end = std::chrono::steady_clock::now();
+        return std::make_pair(numSprites, std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+    };
+
+    auto single = time(true, 1);
+    auto ordered = time(true, 0);
+    auto unordered = time(false, 0);
+
+    std::cout << "Sprites: " << single.first << std::endl;
+    std::cout << "1 thread: " << single.second << "ms" << std::endl;
+    std::cout << "All threads, ordered: " << ordered.second << "ms" << std::endl;
+    std::cout << "All threads, unordered: " << unordered.second << "ms" << std::endl;
+    ASSERT_EQ(single.first, ordered.first);
+    ASSERT_EQ(single.first, unordered.first);
+}
@@ -0,0 +1,146 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/SpriteSequenceCache.hpp"
+#include "utility/file.hpp"
+using namespace GraphicsLayer;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <random>
+#include <vector>
+#include <set>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// SpriteSequenceCacheTest
+////////////////////////////////////////
+class SpriteSequenceCacheTest : public ::testing::Test
+{
+public:
+    struct Entry
+    {
+        unsigned int id;
+        std::vector<size_t> color;
+        std::vector<size_t> transparency;
+    };
+
+    SpriteSequenceCacheTest()
+    : cache(DIRECTORY)
+    {
+        std::mt19937 rng(18);
+        entries.resize(100);
+        for(size_t i = 0; i < entries.size(); i++)
+        {
+            Entry& e = entries[i];
+            e.id = i * 3 + 1;
+            e.color.resize(rng() % 50);
+            e.transparency.resize(rng() % 50);
+            for(size_t& v : e.color)
+                v = rng();
+            for(size_t& v : e.transparency)
+                v = rng();
+        }
+    }
+
+    ~SpriteSequenceCacheTest()
+    {
+        cache.retainOnly({});
+        sb::utility::file::recursiveRemove(DIRECTORY);
+    }
+
+    void write(uint64_t key)
+    {
+        SpriteSequenceCache::Writer writer(cache, key);
+        for(const Entry& e : entries)
+            writer.add(e.id, e.color, e.transparency);
+        writer.finish();
+    }
+
+    const char* DIRECTORY = "SpriteSequenceCacheTest";
+    SpriteSequenceCache cache;
+    std::vector<Entry> entries;
+};
+
+TEST_F(SpriteSequenceCacheTest, ReadsBackWrittenEntries)
+{
+    const uint64_t KEY = 0x0123456789abcdef;
+    ASSERT_FALSE(cache.contains(KEY));
+    write(KEY);
+    ASSERT_TRUE(cache.contains(KEY));
+
+    size_t i = 0;
+    cache.forEach(KEY, [&](const SpriteSequenceCache::Entry& e)
+    {
+        ASSERT_LT(i, entries.size());
+        ASSERT_EQ(e.id, entries[i].id);
+        ASSERT_EQ(std::vector<size_t>(e.color, e.color + e.colorSize), entries[i].color);
+        ASSERT_EQ(std::vector<size_t>(e.transparency, e.transparency + e.transparencySize), entries[i].transparency);
+        i++;
+    });
+    ASSERT_EQ(i, entries.size());
+}
+
+TEST_F(SpriteSequenceCacheTest, UnfinishedWriteIsNotCached)
+{
+    const uint64_t KEY = 7;
+    {
+        SpriteSequenceCache::Writer writer(cache, KEY);
+        writer.add(entries[0].id, entries[0].color, entries[0].transparency);
+    }
+    ASSERT_FALSE(cache.contains(KEY));
+
+    {
+        SpriteSequenceCache::Writer writer(cache, KEY);
+        writer.finish();
+    }
+    ASSERT_TRUE(cache.contains(KEY));
+
+    size_t numEntries = 0;
+    cache.forEach(KEY, [&](const SpriteSequenceCache::Entry&){ numEntries++; });
+    ASSERT_EQ(numEntries, 0);
+}
+
+TEST_F(SpriteSequenceCacheTest, RetainOnlyRemovesRetiredKeys)
+{
+    const std::vector<uint64_t> KEYS = {1, 2, 3, uint64_t(-1)};
+    for(uint64_t key : KEYS)
+        write(key);
+
+    cache.retainOnly({2, uint64_t(-1)});
+    ASSERT_FALSE(cache.contains(1));
+    ASSERT_TRUE(cache.contains(2));
+    ASSERT_FALSE(cache.contains(3));
+    ASSERT_TRUE(cache.contains(uint64_t(-1)));
+}
@@ -0,0 +1,161 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/SpscQueue.hpp"
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <memory>
+#include <thread>
+#include <vector>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// SpscQueueTest
+////////////////////////////////////////
+class SpscQueueTest : public ::testing::Test
+{
+};
+
+TEST_F(SpscQueueTest, RoundsCapacityUp)
+{
+    EXPECT_EQ(SpscQueue<int>(1).getCapacity(), 1);
+    EXPECT_EQ(SpscQueue<int>(3).getCapacity(), 4);
+    EXPECT_EQ(SpscQueue<int>(8).getCapacity(), 8);
+}
+
+TEST_F(SpscQueueTest, TryPushStopsWhenFull)
+{
+    SpscQueue<int> queue(2);
+    int value = 1;
+    EXPECT_TRUE(queue.tryPush(value));
+    value = 2;
+    EXPECT_TRUE(queue.tryPush(value));
+    value = 3;
+    EXPECT_FALSE(queue.tryPush(value));
+    EXPECT_EQ(queue.getSize(), 2);
+
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(value, 1);
+    value = 3;
+    EXPECT_TRUE(queue.tryPush(value));
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(value, 3);
+    EXPECT_FALSE(queue.tryPop(value));
+}
+
+TEST_F(SpscQueueTest, MovesOwnershipThrough)
+{
+    SpscQueue<std::shared_ptr<int>> queue(4);
+    std::shared_ptr<int> value = std::make_shared<int>(5);
+    std::weak_ptr<int> weak = value;
+    ASSERT_TRUE(queue.push(std::move(value)));
+    EXPECT_EQ(value, nullptr);
+
+    std::shared_ptr<int> popped;
+    ASSERT_TRUE(queue.pop(popped));
+    EXPECT_EQ(*popped, 5);
+    popped.reset();
+    EXPECT_TRUE(weak.expired());
+}
+
+TEST_F(SpscQueueTest, CloseDrainsBeforeFailing)
+{
+    SpscQueue<int> queue(4);
+    ASSERT_TRUE(queue.push(1));
+    ASSERT_TRUE(queue.push(2));
+    queue.close();
+    EXPECT_FALSE(queue.push(3));
+
+    int value = 0;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_FALSE(queue.pop(value));
+}
+
+TEST_F(SpscQueueTest, CloseWakesBlockedConsumer)
+{
+    SpscQueue<int> queue(1);
+    bool isPopped = true;
+    std::thread consumer([&]()
+    {
+        int value;
+        isPopped = queue.pop(value);
+    });
+    queue.close();
+    consumer.join();
+    EXPECT_FALSE(isPopped);
+}
+
+TEST_F(SpscQueueTest, CloseWakesBlockedProducer)
+{
+    SpscQueue<int> queue(1);
+    ASSERT_TRUE(queue.push(1));
+    bool isPushed = true;
+    std::thread producer([&]()
+    {
+        isPushed = queue.push(2);
+    });
+    queue.close();
+    producer.join();
+    EXPECT_FALSE(isPushed);
+}
+
+TEST_F(SpscQueueTest, KeepsOrderAcrossThreads)
+{
+    const size_t NUM_VALUES = 200000;
+    SpscQueue<size_t> queue(8);
+    std::thread producer([&]()
+    {
+        for(size_t i = 0; i < NUM_VALUES; i++)
+            ASSERT_TRUE(queue.push(size_t(i)));
+
+        queue.close();
+    });
+
+    std::vector<size_t> values;
+    size_t value;
+    while(queue.pop(value))
+        values.push_back(value);
+
+    producer.join();
+    ASSERT_EQ(values.size(), NUM_VALUES);
+    for(size_t i = 0; i < NUM_VALUES; i++)
+        ASSERT_EQ(values[i], i);
+}
@@ -0,0 +1,164 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/TaskGraph.hpp"
+#include "utility/WorkStealingPool.hpp"
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <stdexcept>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// TaskGraphTest
+////////////////////////////////////////
+class TaskGraphTest : public ::testing::Test
+{
+public:
+    TaskGraphTest()
+    : pool(3)
+    , graph(pool)
+    {
+    }
+
+    std::function<void()> record(size_t id)
+    {
+        return [this, id]()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(id);
+        };
+    }
+
+    size_t getPosition(size_t id) const
+    {
+        return std::find(order.begin(), order.end(), id) - order.begin();
+    }
+
+    WorkStealingPool pool;
+    TaskGraph graph;
+    std::mutex mutex;
+    std::vector<size_t> order;
+};
+
+TEST_F(TaskGraphTest, RunsDependenciesFirst)
+{
+    // 0 -> 1 -> 3 -> 5, 0 -> 2 -> 3, 4 -> 5
+    TaskGraph::TaskId t0 = graph.addTask("0", record(0));
+    TaskGraph::TaskId t1 = graph.addTask("1", record(1), {t0});
+    TaskGraph::TaskId t2 = graph.addTask("2", record(2), {t0});
+    TaskGraph::TaskId t3 = graph.addTask("3", record(3), {t1, t2});
+    TaskGraph::TaskId t4 = graph.addTask("4", record(4));
+    graph.addTask("5", record(5), {t3, t4});
+    EXPECT_EQ(graph.getNumTasks(), 6);
+    EXPECT_EQ(graph.getName(t3), "3");
+
+    for(size_t run = 0; run < 100; run++)
+    {
+        order.clear();
+        graph.run();
+        ASSERT_EQ(order.size(), 6);
+        EXPECT_LT(getPosition(0), getPosition(1));
+        EXPECT_LT(getPosition(0), getPosition(2));
+        EXPECT_LT(getPosition(1), getPosition(3));
+        EXPECT_LT(getPosition(2), getPosition(3));
+        EXPECT_LT(getPosition(3), getPosition(5));
+        EXPECT_LT(getPosition(4), getPosition(5));
+    }
+}
+
+TEST_F(TaskGraphTest, RejectsUnknownDependency)
+{
+    graph.addTask("0", record(0));
+    EXPECT_THROW(graph.addTask("1", record(1), {1}), std::runtime_error);
+}
+
+TEST_F(TaskGraphTest, SkipsRemainingTasksAfterThrow)
+{
+    TaskGraph::TaskId t0 = graph.addTask("0", []()
+    {
+        throw std::logic_error("Failed");
+    });
+    graph.addTask("1", record(1), {t0});
+    EXPECT_THROW(graph.run(), std::logic_error);
+    EXPECT_TRUE(order.empty());
+
+    // The graph stays usable.
+    EXPECT_THROW(graph.run(), std::logic_error);
+}
+
+TEST_F(TaskGraphTest, RunsIndependentTasksConcurrently)
+{
+    const std::chrono::milliseconds DURATION(50);
+    std::vector<TaskGraph::TaskId> ids;
+    for(size_t i = 0; i < 4; i++)
+        ids.push_back(graph.addTask("Sleep", [DURATION](){std::this_thread::sleep_for(DURATION);}));
+    graph.addTask("Join", record(0), ids);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    graph.run();
+    std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now() - start;
+    EXPECT_LT(duration, 3 * DURATION);
+    EXPECT_EQ(order.size(), 1);
+    EXPECT_GE(graph.getMicroseconds(ids[0]), 40000.0);
+}
+
+TEST_F(TaskGraphTest, WorkersStealFromEachOther)
+{
+    // Every task is pushed from one worker, so the others have to steal.
+    std::atomic<size_t> numDone(0);
+    const size_t NUM_TASKS = 64;
+    pool.push([&]()
+    {
+        for(size_t i = 0; i < NUM_TASKS; i++)
+        {
+            pool.push([&]()
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                numDone++;
+                pool.wake();
+            });
+        }
+    });
+    pool.helpUntil([&](){return numDone == NUM_TASKS;});
+    EXPECT_EQ(numDone, NUM_TASKS);
+    EXPECT_GT(pool.getNumSteals(), 0);
+}
@@ -0,0 +1,147 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/TibiaContext.hpp"
+#include "monitor/StartupProfile.hpp"
+using namespace GraphicsLayer;
+using namespace sb::tibiaassets;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+#include <algorithm>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// TibiaContextTest
+////////////////////////////////////////
+class TibiaContextTest : public ::testing::Test
+{
+public:
+    TibiaContextTest()
+    {
+        // Trees, bindings and sprite infos need files, so they are left
+        // empty. Only the getters that are not called need valid values.
+        loaders.spriteObjectBindings = []() { return nullptr; };
+        loaders.spriteColorTree = []() { return nullptr; };
+        loaders.spriteTransparencyTree = []() { return nullptr; };
+        loaders.spriteInfo = []() { return nullptr; };
+        loaders.glyphs = []() { return std::make_unique<std::vector<FontSample::Glyph>>(); };
+        loaders.graphicsResourceNames = []()
+        {
+            return std::make_unique<std::vector<std::string>>(std::vector<std::string>{"a.png", "b.png"});
+        };
+        loaders.objects = [this]()
+        {
+            while(!isObjectsReleased)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            auto objects = std::make_unique<std::vector<Object>>(3);
+            (*objects)[1].id = 7;
+            return objects;
+        };
+    }
+
+    TibiaContext::Loaders loaders;
+    std::atomic<bool> isObjectsReleased{false};
+};
+
+TEST_F(TibiaContextTest, GettersWaitForTheirMember)
+{
+    StartupProfile profile;
+    TibiaContext context(loaders, &profile);
+
+    // Names load before objects, so they are available while objects block.
+    ASSERT_EQ(context.getGraphicsResourceNames().size(), 2);
+    ASSERT_FALSE(context.isLoaded());
+
+    isObjectsReleased = true;
+    ASSERT_EQ(context.getObjects().size(), 3);
+    ASSERT_EQ(context.getObjects()[1].id, 7);
+    ASSERT_EQ(context.getObjectTraits().size(), 3);
+    context.waitUntilLoaded();
+    ASSERT_TRUE(context.isLoaded());
+
+    std::vector<StartupProfile::Step> steps = profile.getSteps();
+    auto hasStep = [&steps](const std::string& name)
+    {
+        return std::any_of(steps.begin(), steps.end(), [&name](const StartupProfile::Step& s) { return s.name == name; });
+    };
+    ASSERT_TRUE(hasStep("Load objects"));
+    ASSERT_TRUE(hasStep("Load object traits"));
+    ASSERT_TRUE(hasStep("Load glyphs"));
+}
+
+TEST_F(TibiaContextTest, LoadErrorIsRethrownByLaterGetters)
+{
+    loaders.spriteInfo = []() -> std::unique_ptr<SpriteInfo>
+    {
+        throw std::runtime_error("No sprite sheets.");
+    };
+    isObjectsReleased = true;
+    TibiaContext context(loaders);
+
+    ASSERT_EQ(context.getGraphicsResourceNames().size(), 2);
+    ASSERT_THROW(context.getSpriteInfo(), std::runtime_error);
+    ASSERT_THROW(context.getObjects(), std::runtime_error);
+    ASSERT_THROW(context.waitUntilLoaded(), std::runtime_error);
+    ASSERT_TRUE(context.isLoadFinished());
+    ASSERT_FALSE(context.isLoaded());
+}
+
+TEST_F(TibiaContextTest, MissingMembersThrowInsteadOfDereferencingNull)
+{
+    std::unique_ptr<std::vector<Object>> objects;
+    std::unique_ptr<SpriteObjectBindings> bindings;
+    std::unique_ptr<SequenceTree> colorTree;
+    std::unique_ptr<SequenceTree> transparencyTree;
+    std::unique_ptr<SpriteInfo> spriteInfo;
+    std::unique_ptr<std::vector<std::string>> graphicsResourceNames;
+    std::unique_ptr<std::vector<FontSample::Glyph>> glyphs;
+    TibiaContext context(objects, bindings, colorTree, transparencyTree, spriteInfo, graphicsResourceNames, glyphs);
+
+    ASSERT_TRUE(context.isLoadFinished());
+    ASSERT_THROW(context.getObjectTraits(), std::runtime_error);
+    ASSERT_THROW(context.getGlyphIndex(), std::runtime_error);
+    ASSERT_THROW(context.getSpriteColorTree(), std::runtime_error);
+}
+
+TEST_F(TibiaContextTest, DestroyedWhileLoading)
+{
+    isObjectsReleased = true;
+    TibiaContext context(loaders);
+}
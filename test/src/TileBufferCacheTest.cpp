@@ -0,0 +1,314 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "monitor/TileBufferCache.hpp"
+using namespace GraphicsLayer;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <map>
+#include <random>
+#include <chrono>
+#include <iostream>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// TileBufferCacheTest
+////////////////////////////////////////
+// Checks the cache against a row major map, which is what it used to be.
+class TileBufferCacheTest : public ::testing::Test
+{
+public:
+    static const size_t WIDTH = 1 << 14;
+    typedef TileBufferCache<unsigned int> Cache;
+    typedef std::map<size_t, unsigned int> Reference;
+
+    TileBufferCacheTest()
+    : cache(WIDTH)
+    , rng(5)
+    {
+    }
+
+    void set(size_t x, size_t y, unsigned int value)
+    {
+        cache.set(0, x, y, value);
+        reference[x + y * WIDTH] = value;
+    }
+
+    void fill(size_t numElements, size_t maxX, size_t maxY)
+    {
+        for(size_t i = 0; i < numElements; i++)
+            set(rng() % maxX, rng() % maxY, rng());
+    }
+
+    std::list<Cache::AreaElement> getReferenceArea(size_t x, size_t y, size_t width, size_t height) const
+    {
+        std::list<Cache::AreaElement> elements;
+        for(const auto& pair : reference)
+        {
+            size_t elementX = pair.first % WIDTH;
+            size_t elementY = pair.first / WIDTH;
+            if(elementX >= x && elementX < x + width && elementY >= y && elementY < y + height)
+                elements.push_back({elementX, elementY, pair.second});
+        }
+
+        return elements;
+    }
+
+    void removeReferenceArea(size_t x, size_t y, size_t width, size_t height)
+    {
+        for(const Cache::AreaElement& e : getReferenceArea(x, y, width, height))
+            reference.erase(e.x + e.y * WIDTH);
+    }
+
+    bool getReferenceTopLeft(size_t x, size_t y, Cache::AreaElement& element) const
+    {
+        size_t minDiff = -1;
+        for(const auto& pair : reference)
+        {
+            size_t elementX = pair.first % WIDTH;
+            size_t elementY = pair.first / WIDTH;
+            if(pair.first < x + y * WIDTH && elementX <= x && elementY <= y && x - elementX + y - elementY <= minDiff)
+            {
+                minDiff = x - elementX + y - elementY;
+                element = {elementX, elementY, pair.second};
+            }
+        }
+
+        return minDiff != size_t(-1);
+    }
+
+    bool getReferenceBotRight(size_t x, size_t y, Cache::AreaElement& element) const
+    {
+        size_t minDiff = -1;
+        for(const auto& pair : reference)
+        {
+            size_t elementX = pair.first % WIDTH;
+            size_t elementY = pair.first / WIDTH;
+            if(elementX >= x && elementY >= y && elementX - x + elementY - y < minDiff)
+            {
+                minDiff = elementX - x + elementY - y;
+                element = {elementX, elementY, pair.second};
+            }
+        }
+
+        return minDiff != size_t(-1);
+    }
+
+    std::vector<unsigned int> traverse(size_t x, size_t y, bool traverseForward, size_t maxElements) const
+    {
+        std::vector<unsigned int> values;
+        cache.forEach(0, [&values, maxElements](const unsigned int& value, const size_t&, const size_t&)
+        {
+            values.push_back(value);
+            return values.size() < maxElements;
+        }, x, y, traverseForward);
+
+        return values;
+    }
+
+    std::vector<unsigned int> traverseReference(size_t x, size_t y, bool traverseForward, size_t maxElements) const
+    {
+        std::vector<unsigned int> values;
+        if(reference.empty())
+            return values;
+
+        auto it = reference.begin();
+        if(x != 0 || y != 0)
+        {
+            it = reference.lower_bound(x + y * WIDTH);
+            if(it == reference.end())
+                it--;
+        }
+
+        if(traverseForward)
+        {
+            for(; it != reference.end() && values.size() < maxElements; it++)
+                values.push_back(it->second);
+        }
+        else
+        {
+            for(it++; it != reference.begin() && values.size() < maxElements;)
+                values.push_back((--it)->second);
+        }
+
+        return values;
+    }
+
+    static void expectEq(const std::list<Cache::AreaElement>& lhs, const std::list<Cache::AreaElement>& rhs)
+    {
+        ASSERT_EQ(lhs.size(), rhs.size());
+        for(auto l = lhs.begin(), r = rhs.begin(); l != lhs.end(); l++, r++)
+        {
+            EXPECT_EQ(l->x, r->x);
+            EXPECT_EQ(l->y, r->y);
+            EXPECT_EQ(l->element, r->element);
+        }
+    }
+
+    Cache cache;
+    Reference reference;
+    std::mt19937 rng;
+};
+
+const size_t TileBufferCacheTest::WIDTH;
+
+TEST_F(TileBufferCacheTest, Get)
+{
+    fill(2000, 480, 352);
+    for(size_t y = 0; y < 352; y++)
+        for(size_t x = 0; x < 480; x++)
+        {
+            unsigned int value;
+            auto it = reference.find(x + y * WIDTH);
+            ASSERT_EQ(cache.get(0, x, y, value), it != reference.end());
+            if(it != reference.end())
+            {
+                ASSERT_EQ(value, it->second);
+            }
+        }
+
+    unsigned int value;
+    EXPECT_FALSE(cache.get(1, 0, 0, value));
+}
+
+TEST_F(TileBufferCacheTest, AreaQueriesMatchReference)
+{
+    fill(3000, 600, 400);
+    for(size_t n = 0; n < 500; n++)
+    {
+        size_t x = rng() % 600;
+        size_t y = rng() % 400;
+        size_t width = 1 + rng() % 100;
+        size_t height = 1 + rng() % 100;
+
+        // getByArea has always covered width rows, not height.
+        ASSERT_NO_FATAL_FAILURE(expectEq(cache.getByArea(0, x, y, width, height), getReferenceArea(x, y, width, width)));
+
+        if(n % 10 == 0)
+        {
+            cache.removeByArea(0, x, y, width, height);
+            removeReferenceArea(x, y, width, height);
+            ASSERT_NO_FATAL_FAILURE(expectEq(cache.getByArea(0, 0, 0, 1000, 1000), getReferenceArea(0, 0, 1000, 1000)));
+        }
+
+        if(n % 25 == 0)
+            fill(100, 600, 400);
+    }
+}
+
+TEST_F(TileBufferCacheTest, ClosestMatchesReference)
+{
+    fill(300, 600, 400);
+    for(size_t n = 0; n < 2000; n++)
+    {
+        size_t x = rng() % 700;
+        size_t y = rng() % 500;
+
+        Cache::AreaElement expect;
+        Cache::AreaElement element;
+        bool isFound = getReferenceTopLeft(x, y, expect);
+        ASSERT_EQ(cache.getClosestTopLeft(0, x, y, element), isFound);
+        if(isFound)
+        {
+            ASSERT_NO_FATAL_FAILURE(expectEq({element}, {expect}));
+        }
+
+        isFound = getReferenceBotRight(x, y, expect);
+        ASSERT_EQ(cache.getClosestBotRight(0, x, y, element), isFound);
+        if(isFound)
+        {
+            ASSERT_NO_FATAL_FAILURE(expectEq({element}, {expect}));
+        }
+    }
+}
+
+TEST_F(TileBufferCacheTest, ForEachMatchesReference)
+{
+    EXPECT_TRUE(traverse(0, 0, true, -1).empty());
+
+    fill(1000, 600, 400);
+    EXPECT_EQ(traverse(0, 0, true, -1), traverseReference(0, 0, true, -1));
+    EXPECT_EQ(traverse(0, 0, false, -1), traverseReference(0, 0, false, -1));
+    EXPECT_EQ(traverse(599, 1000, true, -1), traverseReference(599, 1000, true, -1));
+    for(size_t n = 0; n < 500; n++)
+    {
+        size_t x = rng() % 700;
+        size_t y = rng() % 500;
+        size_t maxElements = 1 + rng() % 50;
+        ASSERT_EQ(traverse(x, y, true, maxElements), traverseReference(x, y, true, maxElements));
+        ASSERT_EQ(traverse(x, y, false, maxElements), traverseReference(x, y, false, maxElements));
+    }
+}
+
+TEST_F(TileBufferCacheTest, RemoveAndClear)
+{
+    set(10, 20, 1);
+    set(40, 20, 2);
+    cache.remove(0, 10, 20);
+
+    unsigned int value;
+    EXPECT_FALSE(cache.get(0, 10, 20, value));
+    EXPECT_TRUE(cache.get(0, 40, 20, value));
+    EXPECT_EQ(value, 2);
+
+    cache.clear(0);
+    EXPECT_FALSE(cache.get(0, 40, 20, value));
+    EXPECT_TRUE(cache.getByArea(0, 0, 0, 100, 100).empty());
+}
+
+TEST_F(TileBufferCacheTest, AreaBenchmark)
+{
+    typedef std::chrono::steady_clock Clock;
+    const size_t NUM_ITERATIONS = 20000;
+
+    // Tile sheet sized texture with 32x32 tiles.
+    for(size_t y = 0; y < 4096; y += 32)
+        for(size_t x = 0; x < 4096; x += 32)
+            set(x, y, rng());
+
+    size_t numFound = 0;
+    Clock::time_point start = Clock::now();
+    for(size_t n = 0; n < NUM_ITERATIONS; n++)
+    {
+        size_t x = rng() % 4000;
+        size_t y = rng() % 4000;
+        numFound += cache.getByArea(0, x, y, 64, 64).size();
+        cache.removeByArea(0, x, y, 32, 32);
+        cache.set(0, x, y, n);
+    }
+    double time = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / NUM_ITERATIONS;
+    std::cout << "Area query and update: " << time << "us" << std::endl;
+    EXPECT_GT(numFound, 0);
+}
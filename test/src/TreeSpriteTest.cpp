@@ -0,0 +1,241 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/utility.hpp"
+#include "utility/simd.hpp"
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <random>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// TreeSpriteTest
+////////////////////////////////////////
+// Compares the tree sprite conversions at every supported SIMD level with
+// the byte by byte versions they replaced.
+class TreeSpriteTest : public ::testing::Test
+{
+public:
+    TreeSpriteTest()
+    : originalLevel(getSimdLevel())
+    {
+    }
+
+    ~TreeSpriteTest()
+    {
+        setSimdLevel(originalLevel);
+    }
+
+    static std::vector<size_t> referenceColorTreeSprite(const unsigned char* pixels, size_t width, size_t height, bool isBgra, bool* isBlank)
+    {
+        std::vector<unsigned char> sprite;
+        sprite.push_back(width);
+        sprite.push_back(height);
+        for(size_t i = 0; i < width * height * BYTES_PER_PIXEL_RGBA; i += BYTES_PER_PIXEL_RGBA)
+        {
+            if(pixels[i + 3] == 255)
+            {
+                sprite.push_back(pixels[i + (isBgra ? 2 : 0)]);
+                sprite.push_back(pixels[i + 1]);
+                sprite.push_back(pixels[i + (isBgra ? 0 : 2)]);
+            }
+        }
+        *isBlank = (sprite.size() == 2);
+        return packBytes(sprite);
+    }
+
+    static std::vector<size_t> referenceTransparencyTreeSprite(const unsigned char* rgba, size_t width, size_t height, bool* isBlank)
+    {
+        std::vector<unsigned char> sprite;
+        sprite.push_back(width);
+        sprite.push_back(height);
+        size_t stripSize = 0;
+        for(size_t i = 0; i < width * height * BYTES_PER_PIXEL_RGBA; i += BYTES_PER_PIXEL_RGBA)
+        {
+            if(rgba[i + 3] == 255)
+            {
+                if(stripSize == 0)
+                    compressSmallEndianMultiByteValue<size_t>(i, sprite);
+
+                stripSize++;
+            }
+            else if(stripSize > 0)
+            {
+                compressSmallEndianMultiByteValue<size_t>(stripSize, sprite);
+                stripSize = 0;
+            }
+        }
+        *isBlank = (sprite.size() == 2);
+        return packBytes(sprite);
+    }
+
+    // Runs of fully transparent, fully opaque and mixed pixels, so that
+    // every path of the kernels gets exercised.
+    static std::vector<unsigned char> createPixels(std::mt19937& rng, size_t numPixels)
+    {
+        std::vector<unsigned char> pixels(numPixels * BYTES_PER_PIXEL_RGBA);
+        for(size_t p = 0; p < numPixels;)
+        {
+            size_t runSize = 1 + rng() % 40;
+            unsigned int runType = rng() % 3;
+            for(size_t i = 0; i < runSize && p < numPixels; i++, p++)
+            {
+                unsigned char* pixel = pixels.data() + p * BYTES_PER_PIXEL_RGBA;
+                pixel[0] = rng();
+                pixel[1] = rng();
+                pixel[2] = rng();
+                if(runType == 0)
+                    pixel[3] = 0;
+                else if(runType == 1)
+                    pixel[3] = 255;
+                else
+                    pixel[3] = (rng() % 2 ? 255 : rng());
+            }
+        }
+
+        return pixels;
+    }
+
+    static std::vector<SimdLevel> getLevels()
+    {
+        std::vector<SimdLevel> levels = {SimdLevel::SCALAR};
+        if(getSupportedSimdLevel() >= SimdLevel::SSE2)
+            levels.push_back(SimdLevel::SSE2);
+        if(getSupportedSimdLevel() >= SimdLevel::AVX2)
+            levels.push_back(SimdLevel::AVX2);
+
+        return levels;
+    }
+
+    SimdLevel originalLevel;
+};
+
+TEST_F(TreeSpriteTest, MatchesReferenceAtEverySimdLevel)
+{
+    for(SimdLevel level : getLevels())
+    {
+        setSimdLevel(level);
+        ASSERT_EQ(getSimdLevel(), level);
+
+        std::mt19937 rng(7);
+        std::vector<size_t> colorSprite;
+        std::vector<size_t> bgraColorSprite;
+        std::vector<size_t> transparencySprite;
+        for(size_t n = 0; n < 3000; n++)
+        {
+            size_t width = 1 + rng() % 70;
+            size_t height = 1 + rng() % 70;
+            std::vector<unsigned char> pixels = createPixels(rng, width * height);
+
+            bool expectBlank;
+            bool isBlank;
+            std::vector<size_t> expect = referenceColorTreeSprite(pixels.data(), width, height, false, &expectBlank);
+            rgbaToColorTreeSprite(pixels.data(), width, height, colorSprite, &isBlank);
+            ASSERT_EQ(colorSprite, expect) << "Level " << (int)level << ", sprite " << n;
+            ASSERT_EQ(isBlank, expectBlank);
+            ASSERT_EQ(rgbaToColorTreeSprite(pixels.data(), width, height), expect);
+
+            expect = referenceColorTreeSprite(pixels.data(), width, height, true, &expectBlank);
+            bgraToColorTreeSprite(pixels.data(), width, height, bgraColorSprite, &isBlank);
+            ASSERT_EQ(bgraColorSprite, expect) << "Level " << (int)level << ", sprite " << n;
+            ASSERT_EQ(isBlank, expectBlank);
+
+            expect = referenceTransparencyTreeSprite(pixels.data(), width, height, &expectBlank);
+            rgbaToTransparencyTreeSprite(pixels.data(), width, height, transparencySprite, &isBlank);
+            ASSERT_EQ(transparencySprite, expect) << "Level " << (int)level << ", sprite " << n;
+            ASSERT_EQ(isBlank, expectBlank);
+        }
+    }
+}
+
+TEST_F(TreeSpriteTest, BlankSprite)
+{
+    std::vector<unsigned char> pixels(32 * 32 * BYTES_PER_PIXEL_RGBA, 0);
+    for(SimdLevel level : getLevels())
+    {
+        setSimdLevel(level);
+        bool isBlank = false;
+        std::vector<size_t> sprite;
+        rgbaToColorTreeSprite(pixels.data(), 32, 32, sprite, &isBlank);
+        EXPECT_TRUE(isBlank);
+        EXPECT_EQ(sprite.size(), 1);
+        EXPECT_EQ(sprite[0], size_t(32 | (32 << 8)));
+    }
+}
+
+TEST_F(TreeSpriteTest, StridedMatchesContiguous)
+{
+    for(SimdLevel level : getLevels())
+    {
+        setSimdLevel(level);
+        std::mt19937 rng(9);
+        std::vector<size_t> expect;
+        std::vector<size_t> sprite;
+        for(size_t n = 0; n < 500; n++)
+        {
+            // A sprite somewhere inside a larger sheet.
+            size_t width = 1 + rng() % 64;
+            size_t height = 1 + rng() % 64;
+            size_t sheetWidth = width + rng() % 64;
+            size_t offsetX = rng() % (sheetWidth - width + 1);
+            const size_t STRIDE = sheetWidth * BYTES_PER_PIXEL_RGBA;
+            std::vector<unsigned char> sheet = createPixels(rng, sheetWidth * height);
+            const unsigned char* view = sheet.data() + offsetX * BYTES_PER_PIXEL_RGBA;
+
+            std::vector<unsigned char> pixels;
+            for(size_t y = 0; y < height; y++)
+                pixels.insert(pixels.end(), view + y * STRIDE, view + y * STRIDE + width * BYTES_PER_PIXEL_RGBA);
+
+            bool expectBlank;
+            bool isBlank;
+            rgbaToColorTreeSprite(pixels.data(), width, height, expect, &expectBlank);
+            rgbaToColorTreeSprite(view, width, height, STRIDE, sprite, &isBlank);
+            ASSERT_EQ(sprite, expect) << "Level " << (int)level << ", sprite " << n;
+            ASSERT_EQ(isBlank, expectBlank);
+
+            bgraToColorTreeSprite(pixels.data(), width, height, expect, &expectBlank);
+            bgraToColorTreeSprite(view, width, height, STRIDE, sprite, &isBlank);
+            ASSERT_EQ(sprite, expect) << "Level " << (int)level << ", sprite " << n;
+            ASSERT_EQ(isBlank, expectBlank);
+
+            rgbaToTransparencyTreeSprite(pixels.data(), width, height, expect, &expectBlank);
+            rgbaToTransparencyTreeSprite(view, width, height, STRIDE, sprite, &isBlank);
+            ASSERT_EQ(sprite, expect) << "Level " << (int)level << ", sprite " << n;
+            ASSERT_EQ(isBlank, expectBlank);
+        }
+    }
+}
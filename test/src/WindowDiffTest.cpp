@@ -0,0 +1,381 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/utility.hpp"
+#include "utility/simd.hpp"
+#include "monitor/GlyphsFile.hpp"
+using namespace sb::utility;
+using namespace GraphicsLayer;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <random>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+///////////////////////////////////
+
+////////////////////////////////////////
+// Google Test
+#include "gtest/gtest.h"
+////////////////////////////////////////
+
+////////////////////////////////////////
+// WindowDiffTest
+////////////////////////////////////////
+// Compares the window diffs at every supported SIMD level with the pixel by
+// pixel versions they replaced.
+class WindowDiffTest : public ::testing::Test
+{
+public:
+    // Copy of the glyphs stored by ShankBot under its version control
+    // directory. The benchmark falls back to random glyphs without it.
+    static const std::string GLYPHS_PATH;
+
+    WindowDiffTest()
+    : originalLevel(getSimdLevel())
+    {
+    }
+
+    ~WindowDiffTest()
+    {
+        setSimdLevel(originalLevel);
+    }
+
+    static size_t referenceMovingWindowMinDiff(const unsigned char* lhs, size_t lhsWidth, size_t lhsHeight, const unsigned char* rhs, size_t rhsWidth, size_t rhsHeight, size_t rhsSum)
+    {
+        const size_t RHS_SIZE = rhsWidth * rhsHeight;
+        if(rhsSum == size_t(-1))
+        {
+            rhsSum = 0;
+            for(size_t i = 0; i < RHS_SIZE; i++)
+                rhsSum += rhs[i];
+        }
+
+        size_t minDiff = -1;
+        for(size_t x = 0; x < rhsWidth - lhsWidth + 1; x++)
+            for(size_t y = 0; y < rhsHeight - lhsHeight + 1; y++)
+            {
+                size_t diff = 0;
+                size_t currentRhsSum = rhsSum;
+                for(size_t lhsIndex = 0, rhsIndex = x + y * rhsWidth;
+                    lhsIndex < lhsWidth * lhsHeight && rhsIndex < RHS_SIZE;
+                    lhsIndex += lhsWidth, rhsIndex += rhsWidth)
+                {
+                    for(size_t i = 0; i < lhsWidth; i++)
+                    {
+                        currentRhsSum -= rhs[rhsIndex + i];
+                        int d = (int)lhs[lhsIndex + i] - (int)rhs[rhsIndex + i];
+                        diff += d < 0 ? -d : d;
+                    }
+                }
+
+                diff += currentRhsSum;
+                if(diff == 0)
+                    return 0;
+
+                if(diff < minDiff)
+                    minDiff = diff;
+            }
+
+        return minDiff;
+    }
+
+    static size_t referenceCenterDiff(const unsigned char* lhs, size_t lhsWidth, size_t lhsHeight, size_t lhsCenter, const unsigned char* rhs, size_t rhsWidth, size_t rhsHeight, size_t rhsCenter)
+    {
+        const size_t RHS_SIZE = rhsWidth * rhsHeight;
+        size_t rhsSum = 0;
+        for(size_t i = 0; i < RHS_SIZE; i++)
+            rhsSum += rhs[i];
+
+        size_t diff = 0;
+        for(size_t lhsIndex = 0, rhsIndex = rhsCenter - (lhsCenter / lhsWidth) * rhsWidth - lhsCenter % lhsWidth;
+            lhsIndex < lhsWidth * lhsHeight && rhsIndex < RHS_SIZE;
+            lhsIndex += lhsWidth, rhsIndex += rhsWidth)
+        {
+            for(size_t i = 0; i < lhsWidth; i++)
+            {
+                // Rows running past the end of rhs compare against zeros.
+                unsigned char r = (rhsIndex + i < RHS_SIZE ? rhs[rhsIndex + i] : 0);
+                rhsSum -= r;
+                int d = (int)lhs[lhsIndex + i] - (int)r;
+                diff += d < 0 ? -d : d;
+            }
+        }
+
+        return diff + rhsSum;
+    }
+
+    // Glyph like pixels: mostly background with some bright strokes.
+    static std::vector<unsigned char> createPixels(std::mt19937& rng, size_t numPixels)
+    {
+        std::vector<unsigned char> pixels(numPixels);
+        for(unsigned char& p : pixels)
+            p = (rng() % 3 == 0 ? 128 + rng() % 128 : 0);
+
+        return pixels;
+    }
+
+    static size_t getSum(const std::vector<unsigned char>& pixels)
+    {
+        size_t sum = 0;
+        for(unsigned char p : pixels)
+            sum += p;
+
+        return sum;
+    }
+
+    static std::vector<SimdLevel> getLevels()
+    {
+        std::vector<SimdLevel> levels = {SimdLevel::SCALAR};
+        if(getSupportedSimdLevel() >= SimdLevel::SSE2)
+            levels.push_back(SimdLevel::SSE2);
+        if(getSupportedSimdLevel() >= SimdLevel::AVX2)
+            levels.push_back(SimdLevel::AVX2);
+
+        return levels;
+    }
+
+    static std::vector<FontSample::Glyph> loadGlyphs()
+    {
+        std::vector<FontSample::Glyph> glyphs;
+        if(GlyphsFile::read(glyphs, GLYPHS_PATH) && !glyphs.empty())
+            return glyphs;
+
+        std::cout << "Could not read " << GLYPHS_PATH << ", using random glyphs." << std::endl;
+        glyphs.clear();
+        std::mt19937 rng(3);
+        for(size_t i = 0; i < 1000; i++)
+        {
+            FontSample::Glyph glyph;
+            glyph.character = 32 + i % 95;
+            glyph.width = 4 + rng() % 9;
+            glyph.height = 8 + rng() % 7;
+            glyph.data = createPixels(rng, glyph.width * glyph.height);
+            glyph.sum = getSum(glyph.data);
+            glyphs.push_back(glyph);
+        }
+
+        return glyphs;
+    }
+
+    SimdLevel originalLevel;
+};
+
+const std::string WindowDiffTest::GLYPHS_PATH = "glyphs.bin";
+
+TEST_F(WindowDiffTest, MovingWindowMinDiffMatchesReference)
+{
+    for(SimdLevel level : getLevels())
+    {
+        setSimdLevel(level);
+        std::mt19937 rng(11);
+        for(size_t n = 0; n < 2000; n++)
+        {
+            size_t rhsWidth = 1 + rng() % 40;
+            size_t rhsHeight = 1 + rng() % 20;
+            size_t lhsWidth = 1 + rng() % rhsWidth;
+            size_t lhsHeight = 1 + rng() % rhsHeight;
+            std::vector<unsigned char> rhs = createPixels(rng, rhsWidth * rhsHeight);
+            std::vector<unsigned char> lhs;
+            if(n % 4 == 0)
+            {
+                // Exact sub image, so that the zero diff exit is covered.
+                size_t x = rng() % (rhsWidth - lhsWidth + 1);
+                size_t y = rng() % (rhsHeight - lhsHeight + 1);
+                for(size_t j = 0; j < lhsHeight; j++)
+                    lhs.insert(lhs.end(), rhs.begin() + (y + j) * rhsWidth + x, rhs.begin() + (y + j) * rhsWidth + x + lhsWidth);
+            }
+            else
+            {
+                lhs = createPixels(rng, lhsWidth * lhsHeight);
+            }
+
+            size_t expect = referenceMovingWindowMinDiff(lhs.data(), lhsWidth, lhsHeight, rhs.data(), rhsWidth, rhsHeight, -1);
+            ASSERT_EQ(movingWindowMinDiff(lhs.data(), lhsWidth, lhsHeight, rhs.data(), rhsWidth, rhsHeight), expect) << "Level " << (int)level << ", case " << n;
+            ASSERT_EQ(movingWindowMinDiff(lhs.data(), lhsWidth, lhsHeight, rhs.data(), rhsWidth, rhsHeight, getSum(rhs)), expect);
+        }
+    }
+}
+
+TEST_F(WindowDiffTest, CenterDiffMatchesReference)
+{
+    for(SimdLevel level : getLevels())
+    {
+        setSimdLevel(level);
+        std::mt19937 rng(13);
+        for(size_t n = 0; n < 2000; n++)
+        {
+            size_t rhsWidth = 1 + rng() % 40;
+            size_t rhsHeight = 1 + rng() % 20;
+            size_t lhsWidth = 1 + rng() % rhsWidth;
+            size_t lhsHeight = 1 + rng() % rhsHeight;
+            std::vector<unsigned char> lhs = createPixels(rng, lhsWidth * lhsHeight);
+            std::vector<unsigned char> rhs = createPixels(rng, rhsWidth * rhsHeight);
+            size_t lhsCenter = computeCenter(lhs.data(), lhsWidth, lhsHeight);
+            size_t rhsCenter = computeCenter(rhs.data(), rhsWidth, rhsHeight);
+
+            size_t expect = referenceCenterDiff(lhs.data(), lhsWidth, lhsHeight, lhsCenter, rhs.data(), rhsWidth, rhsHeight, rhsCenter);
+            ASSERT_EQ(centerDiff(lhs.data(), lhsWidth, lhsHeight, lhsCenter, rhs.data(), rhsWidth, rhsHeight, rhsCenter), expect) << "Level " << (int)level << ", case " << n;
+        }
+    }
+}
+
+TEST_F(WindowDiffTest, BatchMatchesSingleDiffs)
+{
+    std::mt19937 rng(17);
+    std::vector<std::vector<unsigned char>> pixels;
+    std::vector<WindowDiffTemplate> templates;
+    for(size_t i = 0; i < 200; i++)
+    {
+        size_t width = 1 + rng() % 12;
+        size_t height = 1 + rng() % 12;
+        pixels.push_back(createPixels(rng, width * height));
+        templates.push_back({nullptr, width, height, getSum(pixels.back())});
+    }
+    for(size_t i = 0; i < templates.size(); i++)
+        templates[i].pixels = pixels[i].data();
+
+    for(SimdLevel level : getLevels())
+    {
+        setSimdLevel(level);
+        for(size_t n = 0; n < 50; n++)
+        {
+            size_t width = 1 + rng() % 12;
+            size_t height = 1 + rng() % 12;
+            std::vector<unsigned char> image = createPixels(rng, width * height);
+            if(n % 5 == 0)
+            {
+                size_t i = rng() % templates.size();
+                width = templates[i].width;
+                height = templates[i].height;
+                image = pixels[i];
+            }
+
+            std::vector<size_t> expect(templates.size());
+            size_t best = -1;
+            for(size_t i = 0; i < templates.size(); i++)
+            {
+                const WindowDiffTemplate& t = templates[i];
+                if(t.width <= width && t.height <= height)
+                    expect[i] = referenceMovingWindowMinDiff(t.pixels, t.width, t.height, image.data(), width, height, -1);
+                else if(width <= t.width && height <= t.height)
+                    expect[i] = referenceMovingWindowMinDiff(image.data(), width, height, t.pixels, t.width, t.height, t.sum);
+                else
+                    expect[i] = -1;
+
+                best = std::min(best, expect[i]);
+            }
+
+            std::vector<size_t> diffs(templates.size());
+            movingWindowMinDiffs(image.data(), width, height, -1, templates.data(), templates.size(), diffs.data());
+            ASSERT_EQ(diffs, expect) << "Level " << (int)level << ", case " << n;
+
+            // Abandoned templates only need to be no better than the best.
+            movingWindowMinDiffs(image.data(), width, height, getSum(image), templates.data(), templates.size(), diffs.data(), true);
+            size_t firstBest = std::find(expect.begin(), expect.end(), best) - expect.begin();
+            for(size_t i = 0; i < templates.size(); i++)
+            {
+                if(i == firstBest)
+                    ASSERT_EQ(diffs[i], best);
+                else
+                    ASSERT_GE(diffs[i], best);
+            }
+        }
+    }
+}
+
+TEST_F(WindowDiffTest, GlyphBenchmark)
+{
+    typedef std::chrono::steady_clock Clock;
+    std::vector<FontSample::Glyph> glyphs = loadGlyphs();
+
+    std::vector<WindowDiffTemplate> templates;
+    for(const FontSample::Glyph& glyph : glyphs)
+        templates.push_back({glyph.data.data(), glyph.width, glyph.height, glyph.sum});
+
+    // Glyphs as they come out of a frame: one pixel of margin and some noise.
+    std::mt19937 rng(19);
+    std::vector<std::vector<unsigned char>> images;
+    std::vector<size_t> widths;
+    std::vector<size_t> heights;
+    for(size_t i = 0; i < 100; i++)
+    {
+        const FontSample::Glyph& glyph = glyphs[rng() % glyphs.size()];
+        size_t width = glyph.width + 2;
+        size_t height = glyph.height + 2;
+        std::vector<unsigned char> image(width * height, 0);
+        for(size_t y = 0; y < glyph.height; y++)
+            for(size_t x = 0; x < glyph.width; x++)
+                image[(y + 1) * width + x + 1] = glyph.data[y * glyph.width + x];
+        image[rng() % image.size()] ^= 0x40;
+
+        images.push_back(image);
+        widths.push_back(width);
+        heights.push_back(height);
+    }
+
+    std::vector<size_t> diffs(templates.size());
+    size_t referenceMin = 0;
+    Clock::time_point start = Clock::now();
+    for(size_t i = 0; i < images.size(); i++)
+    {
+        size_t minDiff = -1;
+        for(const WindowDiffTemplate& t : templates)
+        {
+            size_t diff = -1;
+            if(t.width <= widths[i] && t.height <= heights[i])
+                diff = referenceMovingWindowMinDiff(t.pixels, t.width, t.height, images[i].data(), widths[i], heights[i], -1);
+            else if(widths[i] <= t.width && heights[i] <= t.height)
+                diff = referenceMovingWindowMinDiff(images[i].data(), widths[i], heights[i], t.pixels, t.width, t.height, t.sum);
+
+            minDiff = std::min(minDiff, diff);
+            if(minDiff == 0)
+                break;
+        }
+        referenceMin += minDiff;
+    }
+    double referenceTime = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / images.size();
+    std::cout << "Reference: " << referenceTime << "us per image against " << templates.size() << " glyphs" << std::endl;
+
+    for(SimdLevel level : getLevels())
+    {
+        setSimdLevel(level);
+        size_t batchMin = 0;
+        start = Clock::now();
+        for(size_t i = 0; i < images.size(); i++)
+        {
+            movingWindowMinDiffs(images[i].data(), widths[i], heights[i], -1, templates.data(), templates.size(), diffs.data(), true);
+            batchMin += *std::min_element(diffs.begin(), diffs.end());
+        }
+        double batchTime = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / images.size();
+        std::cout << "Level " << (int)level << ": " << batchTime << "us per image" << std::endl;
+        EXPECT_EQ(batchMin, referenceMin);
+    }
+}
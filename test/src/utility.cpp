@@ -233,7 +233,7 @@ void expectEq(const Draw& d1, const Draw& d2)
 void expectEq(const SpriteDraw::SpriteObjectPairing& p1, const SpriteDraw::SpriteObjectPairing& p2)
 {
     EXPECT_EQ(p1.spriteId, p2.spriteId);
-    EXPECT_EQ(p1.objects, p2.objects);
+    EXPECT_EQ(std::vector<uint32_t>(p1.objects.begin(), p1.objects.end()), std::vector<uint32_t>(p2.objects.begin(), p2.objects.end()));
 }
 
 void expectEq(const SpriteDraw& d1, const SpriteDraw& d2)
@@ -32,6 +32,7 @@
 #include "monitor/Gui.hpp"
 #include "monitor/Scene.hpp"
 #include "utility/Matrix.hpp"
+#include "utility/Span.hpp"
 #include "monitor/FontSample.hpp"
 namespace GraphicsLayer
 {
@@ -95,6 +96,8 @@ namespace test
     void expectEq(const std::list<T>& p1, const std::list<T>& p2);
     template<typename T>
     void expectEq(const std::vector<T>& p1, const std::vector<T>& p2);
+    template<typename T>
+    void expectEq(const sb::utility::Span<T>& p1, const sb::utility::Span<T>& p2);
     template<typename T, size_t N>
     void expectEq(const std::array<T, N>& p1, const std::array<T, N>& p2);
     template<size_t N, size_t M>
@@ -150,6 +153,20 @@ namespace test
         }
     }
 
+    template<typename T>
+    void expectEq(const sb::utility::Span<T>& p1, const sb::utility::Span<T>& p2)
+    {
+        EXPECT_EQ(p1.size(), p2.size());
+        if(p1.size() != p2.size())
+        {
+            return;
+        }
+
+        for(size_t i = 0; i < p1.size(); i++)
+        {
+            expectEq(p1[i], p2[i]);
+        }
+    }
 
     template<typename T, size_t N>
     void expectEq(const std::array<T, N>& p1, const std::array<T, N>& p2)
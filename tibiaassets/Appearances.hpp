@@ -0,0 +1,150 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef SB_TIBIAASSETS_APPEARANCES_HPP
+#define SB_TIBIAASSETS_APPEARANCES_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "tibiaassets/config.hpp"
+#include "tibiaassets/Object.hpp"
+#include "utility/Span.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <cstdint>
+///////////////////////////////////
+
+namespace sb
+{
+namespace tibiaassets
+{
+    // Decoded appearances stored as flat arrays. Every object, some info,
+    // sprite id, frame info and market name lives in one of a handful of
+    // contiguous vectors, so loading does a few large allocations instead
+    // of several per object. Views index into the arrays and are only
+    // valid while the owning Appearances is alive.
+    class SHANK_BOT_TIBIAASSETS_DECLSPEC Appearances
+    {
+        public:
+            template<typename T>
+            using Span = sb::utility::Span<T>;
+
+            struct SpriteHeader
+            {
+                unsigned char numDirections = 0;
+                unsigned char numAddons = 0;
+                unsigned char numMounts = 0;
+                unsigned char numBlendFrames = 0;
+                unsigned char unknown1 = 0;
+            };
+
+            class SHANK_BOT_TIBIAASSETS_DECLSPEC SomeInfoView
+            {
+                public:
+                    SomeInfoView(const Appearances& appearances, size_t index);
+
+                    unsigned char getUnknown1() const;
+                    Object::AnimationType getAnimationType() const;
+                    const SpriteHeader& getSpriteHeader() const;
+                    Span<uint32_t> getSpriteIds() const;
+                    Span<Object::FrameInfo> getFrameInfos() const;
+
+                    Object::SomeInfo toSomeInfo() const;
+
+                private:
+                    const Appearances& mAppearances;
+                    size_t mIndex;
+            };
+
+            class SHANK_BOT_TIBIAASSETS_DECLSPEC ObjectView
+            {
+                public:
+                    ObjectView(const Appearances& appearances, size_t index);
+
+                    Object::Type getType() const;
+                    unsigned int getId() const;
+                    size_t getNumSomeInfos() const;
+                    SomeInfoView getSomeInfo(size_t i) const;
+                    // The market name is not part of the returned info,
+                    // see getName().
+                    const Object::ItemInfo& getItemInfo() const;
+                    const char* getName() const;
+
+                    Object toObject() const;
+
+                private:
+                    const Appearances& mAppearances;
+                    size_t mIndex;
+            };
+
+        public:
+            size_t size() const;
+            bool empty() const;
+            ObjectView operator[](size_t i) const;
+
+            // Adapter for code that still works on Object.
+            std::vector<Object> toObjects() const;
+
+            size_t getNumNames() const;
+            // Heap bytes held by the arrays.
+            size_t getMemoryUsage() const;
+
+        private:
+            friend class AppearancesReader;
+
+            void clear();
+            void shrinkToFit();
+
+        private:
+            // Per object.
+            std::vector<Object::Type> mTypes;
+            std::vector<unsigned int> mIds;
+            std::vector<Object::ItemInfo> mItemInfos;
+            std::vector<uint32_t> mNameOffsets;
+            std::vector<uint32_t> mSomeInfoBegins{0};
+
+            // Per some info.
+            std::vector<unsigned char> mUnknown1s;
+            std::vector<Object::AnimationType> mAnimationTypes;
+            std::vector<SpriteHeader> mSpriteHeaders;
+            std::vector<uint32_t> mSpriteIdBegins{0};
+            std::vector<uint32_t> mFrameInfoBegins{0};
+
+            // Shared.
+            std::vector<uint32_t> mSpriteIds;
+            std::vector<Object::FrameInfo> mFrameInfos;
+            // Interned, null terminated market names. Offset 0 is the empty name.
+            std::vector<char> mNames{'\0'};
+            size_t mNumNames = 1;
+    };
+}
+}
+
+
+#endif // SB_TIBIAASSETS_APPEARANCES_HPP
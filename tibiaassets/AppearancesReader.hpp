@@ -31,11 +31,12 @@
 // Internal ShankBot headers
 #include "tibiaassets/config.hpp"
 #include "tibiaassets/Object.hpp"
+#include "tibiaassets/Appearances.hpp"
 namespace sb
 {
 namespace utility
 {
-    struct Buffer;
+    struct BufferView;
 }
 }
 ///////////////////////////////////
@@ -44,6 +45,8 @@ namespace utility
 // STD C++
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <mutex>
 ///////////////////////////////////
 
 namespace sb
@@ -176,36 +179,40 @@ class SHANK_BOT_TIBIAASSETS_DECLSPEC AppearancesReader
         };
 
     public:
+        // The file is memory mapped and decoded straight into flat arrays.
         explicit AppearancesReader(std::string path);
+        const Appearances& getAppearances() const;
+        // Adapter for Object based code. Built from the arrays on first call.
         const std::vector<Object>& getObjects() const;
     private:
 
         void readAppearances(std::string path);
+        uint32_t internName(const std::string& name);
 
-        bool readBoolean(sb::utility::Buffer& stream) const;
-        std::string readString(sb::utility::Buffer& stream) const;
+        bool readBoolean(sb::utility::BufferView& stream) const;
+        std::string readString(sb::utility::BufferView& stream) const;
 
-        Object readObject(sb::utility::Buffer& stream) const;
+        void readObject(sb::utility::BufferView& stream);
 
-        Object::SomeInfo readSomeInfo(sb::utility::Buffer& stream) const;
-        Object::SpriteInfo readSpriteInfo(sb::utility::Buffer& stream) const;
-        Object::AnimationInfo readAnimationInfo(sb::utility::Buffer& stream) const;
-        Object::FrameInfo readFrameInfo(sb::utility::Buffer& stream) const;
+        void readSomeInfo(sb::utility::BufferView& stream);
+        void readSpriteInfo(sb::utility::BufferView& stream);
+        void readAnimationInfo(sb::utility::BufferView& stream);
+        Object::FrameInfo readFrameInfo(sb::utility::BufferView& stream) const;
 
-        Object::ItemInfo readItemInfo(sb::utility::Buffer& stream) const;
-        Object::BodyRestriction readBodyRestriction(sb::utility::Buffer& stream) const;
-        Object::VocationRestriction readVocationRestriction(sb::utility::Buffer& stream) const;
-        Object::ClassRestriction readClassRestriction(sb::utility::Buffer& stream) const;
-        Object::MarketInfo readMarketInfo(sb::utility::Buffer& stream) const;
-        void readLightInfo(unsigned char& distance, unsigned short& color, sb::utility::Buffer& stream) const;
-        void readOffset(unsigned char& x, unsigned char& y, sb::utility::Buffer& stream) const;
-        unsigned short readWalkSpeed(sb::utility::Buffer& stream) const;
-        Object::MiniMapColor readMinimapColor(sb::utility::Buffer& stream) const;
-        unsigned char readHeight(sb::utility::Buffer& stream) const;
-        unsigned short readMaxCharacters(sb::utility::Buffer& stream) const;
-        unsigned char readDefaultAction(sb::utility::Buffer& stream) const;
+        Object::ItemInfo readItemInfo(sb::utility::BufferView& stream) const;
+        Object::BodyRestriction readBodyRestriction(sb::utility::BufferView& stream) const;
+        Object::VocationRestriction readVocationRestriction(sb::utility::BufferView& stream) const;
+        Object::ClassRestriction readClassRestriction(sb::utility::BufferView& stream) const;
+        Object::MarketInfo readMarketInfo(sb::utility::BufferView& stream) const;
+        void readLightInfo(unsigned char& distance, unsigned short& color, sb::utility::BufferView& stream) const;
+        void readOffset(unsigned char& x, unsigned char& y, sb::utility::BufferView& stream) const;
+        unsigned short readWalkSpeed(sb::utility::BufferView& stream) const;
+        Object::MiniMapColor readMinimapColor(sb::utility::BufferView& stream) const;
+        unsigned char readHeight(sb::utility::BufferView& stream) const;
+        unsigned short readMaxCharacters(sb::utility::BufferView& stream) const;
+        unsigned char readDefaultAction(sb::utility::BufferView& stream) const;
 
-        void readItemUnknown15(sb::utility::Buffer& stream) const;
+        void readItemUnknown15(sb::utility::BufferView& stream) const;
 
     private:
         unsigned short mNumItems;
@@ -213,7 +220,11 @@ class SHANK_BOT_TIBIAASSETS_DECLSPEC AppearancesReader
         unsigned short mNumEffects;
         unsigned short mNumProjectiles;
 
-        std::vector<Object> mObjects;
+        Appearances mAppearances;
+        std::unordered_map<std::string, uint32_t> mNameOffsets;
+
+        mutable std::vector<Object> mObjects;
+        mutable std::once_flag mObjectsFlag;
 };
 }
 }
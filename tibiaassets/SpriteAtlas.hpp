@@ -0,0 +1,107 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef SB_TIBIAASSETS_SPRITE_ATLAS_HPP
+#define SB_TIBIAASSETS_SPRITE_ATLAS_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "tibiaassets/config.hpp"
+#include "tibiaassets/SpriteReader.hpp"
+#include "utility/MappedFile.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+///////////////////////////////////
+
+namespace sb
+{
+namespace tibiaassets
+{
+    class CatalogContent;
+
+    // Every sprite of a catalog decoded to RGBA and stored in one file, so
+    // that a sprite can be looked up by id without decompressing its sheet.
+    // The file is mapped, and sprites handed out by getSprite point into the
+    // mapping for as long as the atlas lives.
+    class SHANK_BOT_TIBIAASSETS_DECLSPEC SpriteAtlas
+    {
+        public:
+            // Sprites may be added in any order. The file is only readable
+            // once finish has been called.
+            class SHANK_BOT_TIBIAASSETS_DECLSPEC Writer
+            {
+                public:
+                    Writer(const std::string& filePath, uint64_t catalogKey, unsigned int firstSpriteId, unsigned int lastSpriteId);
+
+                    void add(const SpriteReader::Sprite& spr);
+                    void finish();
+
+                private:
+                    std::ofstream mFile;
+                    std::string mFilePath;
+                    uint64_t mCatalogKey;
+                    unsigned int mFirstSpriteId;
+                    std::vector<char> mIndex;
+                    uint64_t mOffset;
+                    std::vector<char> mRows;
+            };
+
+        public:
+            explicit SpriteAtlas(const std::string& filePath);
+
+            // Identifies the sprites of a catalog by its sprite sheet file
+            // names, which change whenever the sheets do.
+            static uint64_t getCatalogKey(const CatalogContent& catalog);
+            static void getSpriteIdRange(const CatalogContent& catalog, unsigned int& firstSpriteId, unsigned int& lastSpriteId);
+            static bool isUpToDate(const std::string& filePath, const CatalogContent& catalog);
+            static void build(const CatalogContent& catalog, const std::string& filePath);
+
+            uint64_t getCatalogKey() const;
+            size_t getNumSprites() const;
+            bool hasSprite(unsigned int id) const;
+
+            // The pixels are nullptr if there is no sprite with the given id.
+            SpriteReader::Sprite getSprite(unsigned int id) const;
+
+        private:
+            sb::utility::MappedFile mFile;
+            uint64_t mCatalogKey;
+            unsigned int mFirstSpriteId;
+            unsigned int mNumIds;
+            size_t mNumSprites = 0;
+            const char* mIndex;
+    };
+}
+}
+
+
+#endif // SB_TIBIAASSETS_SPRITE_ATLAS_HPP
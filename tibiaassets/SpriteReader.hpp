@@ -30,54 +30,86 @@
 ///////////////////////////////////
 // Internal ShankBot headers
 #include "tibiaassets/config.hpp"
-namespace sb
-{
-namespace tibiaassets
-{
-    class CatalogContent;
-}
-}
+#include "tibiaassets/CatalogContent.hpp"
 ///////////////////////////////////
 
 ///////////////////////////////////
 // STD C++
 #include <vector>
 #include <string>
-#include <istream>
 #include <functional>
 ///////////////////////////////////
 
+///////////////////////////////////
+// Qt
+class QImage;
+///////////////////////////////////
+
 namespace sb
 {
 namespace tibiaassets
 {
+    class SpriteAtlas;
     class SHANK_BOT_TIBIAASSETS_DECLSPEC SpriteReader
     {
         public:
             struct Sprite
             {
-                const unsigned char* pixels;
+                const unsigned char* pixels; // RGBA
+                size_t stride; // Bytes from the start of one row of pixels to the next.
                 unsigned char tileWidth;
                 unsigned char tileHeight;
                 unsigned int id;
                 unsigned int area;
             };
 
-        private:
-
+            // The LZMA stream of a compressed sprite sheet, pointing into the
+            // (mapped) file it is read from.
+            struct LzmaStream
+            {
+                const unsigned char* props;
+                size_t propsSize;
+                const unsigned char* data;
+                size_t dataSize;
+                size_t decompressedSize;
+            };
 
         public:
             explicit SpriteReader(const CatalogContent& catalog);
-            void forEachSprite(std::function<bool(const Sprite& spr)> func) const;
+            // Looks sprites up in the atlas instead of decoding their sheet.
+            // The atlas has to outlive the reader.
+            SpriteReader(const CatalogContent& catalog, const SpriteAtlas& atlas);
+
+            // Sprite sheets are decompressed and decoded on numThreads worker
+            // threads (zero means one per hardware thread), while func is
+            // called on the calling thread. The pixels of a sprite point into
+            // its decoded sheet and are only valid during the call. Sheets are
+            // handed over as soon as they are decoded, unless isOrdered is set,
+            // in which case the sprites come in catalog order. Stops when func
+            // returns false.
+            void forEachSprite(std::function<bool(const Sprite& spr)> func, bool isOrdered = false, size_t numThreads = 0) const;
+            // As above, but only for the given sheets of the catalog.
+            void forEachSprite(const std::vector<const CatalogContent::SpriteSheet*>& sheets, std::function<bool(const Sprite& spr)> func, bool isOrdered = false, size_t numThreads = 0) const;
+            // The pixels are nullptr if there is no sprite with the given id.
+            // With an atlas they point into its mapping. Without one, the sheet
+            // of the sprite is decoded, and the pixels are only valid until the
+            // next call.
             Sprite getSprite(unsigned int id) const;
 
+            // Parses the header Tibia puts in front of the LZMA stream of a
+            // sprite sheet. Returns false if data is not a compressed sheet.
+            static bool readTibiaLzmaHeader(const unsigned char* data, size_t size, LzmaStream& stream);
+
         private:
-            bool validateTibiaLzmaHeader(std::istream& stream) const;
             std::vector<unsigned char> decompressTibiaLzma(std::string path) const;
+            QImage decodeSpriteSheet(const CatalogContent::SpriteSheet& sheet) const;
+            bool forEachSpriteInSheet(const CatalogContent::SpriteSheet& sheet, const QImage& image, const std::function<bool(const Sprite& spr)>& func) const;
 
         private:
             unsigned int mNumSprites;
             const CatalogContent& mCatalog;
+            const SpriteAtlas* mAtlas = nullptr;
+            mutable std::vector<unsigned char> mSpritePixels;
     };
 }
 }
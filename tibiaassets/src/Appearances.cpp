@@ -0,0 +1,232 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "tibiaassets/Appearances.hpp"
+using namespace sb::tibiaassets;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <cassert>
+///////////////////////////////////
+
+namespace
+{
+    template<typename T>
+    size_t capacityBytes(const std::vector<T>& v)
+    {
+        return v.capacity() * sizeof(T);
+    }
+}
+
+///////////////////////////////////
+
+Appearances::SomeInfoView::SomeInfoView(const Appearances& appearances, size_t index)
+: mAppearances(appearances)
+, mIndex(index)
+{
+    assert(mIndex < mAppearances.mUnknown1s.size());
+}
+
+unsigned char Appearances::SomeInfoView::getUnknown1() const
+{
+    return mAppearances.mUnknown1s[mIndex];
+}
+
+Object::AnimationType Appearances::SomeInfoView::getAnimationType() const
+{
+    return mAppearances.mAnimationTypes[mIndex];
+}
+
+const Appearances::SpriteHeader& Appearances::SomeInfoView::getSpriteHeader() const
+{
+    return mAppearances.mSpriteHeaders[mIndex];
+}
+
+Appearances::Span<uint32_t> Appearances::SomeInfoView::getSpriteIds() const
+{
+    const uint32_t* ids = mAppearances.mSpriteIds.data();
+    return Span<uint32_t>(ids + mAppearances.mSpriteIdBegins[mIndex], ids + mAppearances.mSpriteIdBegins[mIndex + 1]);
+}
+
+Appearances::Span<Object::FrameInfo> Appearances::SomeInfoView::getFrameInfos() const
+{
+    const Object::FrameInfo* infos = mAppearances.mFrameInfos.data();
+    return Span<Object::FrameInfo>(infos + mAppearances.mFrameInfoBegins[mIndex], infos + mAppearances.mFrameInfoBegins[mIndex + 1]);
+}
+
+Object::SomeInfo Appearances::SomeInfoView::toSomeInfo() const
+{
+    Object::SomeInfo info;
+    info.unknown1 = getUnknown1();
+    info.animationType = getAnimationType();
+
+    const SpriteHeader& header = getSpriteHeader();
+    Object::SpriteInfo& spriteInfo = info.spriteInfo;
+    spriteInfo.numDirections = header.numDirections;
+    spriteInfo.numAddons = header.numAddons;
+    spriteInfo.numMounts = header.numMounts;
+    spriteInfo.numBlendFrames = header.numBlendFrames;
+    spriteInfo.unknown1 = header.unknown1;
+
+    Span<uint32_t> ids = getSpriteIds();
+    spriteInfo.spriteIds.assign(ids.begin(), ids.end());
+
+    Span<Object::FrameInfo> frames = getFrameInfos();
+    spriteInfo.animationInfo.frameInfos.assign(frames.begin(), frames.end());
+
+    return info;
+}
+
+///////////////////////////////////
+
+Appearances::ObjectView::ObjectView(const Appearances& appearances, size_t index)
+: mAppearances(appearances)
+, mIndex(index)
+{
+    assert(mIndex < mAppearances.size());
+}
+
+Object::Type Appearances::ObjectView::getType() const
+{
+    return mAppearances.mTypes[mIndex];
+}
+
+unsigned int Appearances::ObjectView::getId() const
+{
+    return mAppearances.mIds[mIndex];
+}
+
+size_t Appearances::ObjectView::getNumSomeInfos() const
+{
+    return mAppearances.mSomeInfoBegins[mIndex + 1] - mAppearances.mSomeInfoBegins[mIndex];
+}
+
+Appearances::SomeInfoView Appearances::ObjectView::getSomeInfo(size_t i) const
+{
+    assert(i < getNumSomeInfos());
+    return SomeInfoView(mAppearances, mAppearances.mSomeInfoBegins[mIndex] + i);
+}
+
+const Object::ItemInfo& Appearances::ObjectView::getItemInfo() const
+{
+    return mAppearances.mItemInfos[mIndex];
+}
+
+const char* Appearances::ObjectView::getName() const
+{
+    return mAppearances.mNames.data() + mAppearances.mNameOffsets[mIndex];
+}
+
+Object Appearances::ObjectView::toObject() const
+{
+    Object o;
+    o.type = getType();
+    o.id = getId();
+
+    size_t numSomeInfos = getNumSomeInfos();
+    o.someInfos.reserve(numSomeInfos);
+    for(size_t i = 0; i < numSomeInfos; i++)
+        o.someInfos.push_back(getSomeInfo(i).toSomeInfo());
+
+    o.itemInfo = getItemInfo();
+    o.itemInfo.marketInfo.name = getName();
+
+    return o;
+}
+
+///////////////////////////////////
+
+size_t Appearances::size() const
+{
+    return mTypes.size();
+}
+
+bool Appearances::empty() const
+{
+    return mTypes.empty();
+}
+
+Appearances::ObjectView Appearances::operator[](size_t i) const
+{
+    return ObjectView(*this, i);
+}
+
+std::vector<Object> Appearances::toObjects() const
+{
+    std::vector<Object> objects;
+    objects.reserve(size());
+    for(size_t i = 0; i < size(); i++)
+        objects.push_back((*this)[i].toObject());
+
+    return objects;
+}
+
+size_t Appearances::getNumNames() const
+{
+    return mNumNames;
+}
+
+size_t Appearances::getMemoryUsage() const
+{
+    return capacityBytes(mTypes) +
+           capacityBytes(mIds) +
+           capacityBytes(mItemInfos) +
+           capacityBytes(mNameOffsets) +
+           capacityBytes(mSomeInfoBegins) +
+           capacityBytes(mUnknown1s) +
+           capacityBytes(mAnimationTypes) +
+           capacityBytes(mSpriteHeaders) +
+           capacityBytes(mSpriteIdBegins) +
+           capacityBytes(mFrameInfoBegins) +
+           capacityBytes(mSpriteIds) +
+           capacityBytes(mFrameInfos) +
+           capacityBytes(mNames);
+}
+
+void Appearances::clear()
+{
+    *this = Appearances();
+}
+
+void Appearances::shrinkToFit()
+{
+    mTypes.shrink_to_fit();
+    mIds.shrink_to_fit();
+    mItemInfos.shrink_to_fit();
+    mNameOffsets.shrink_to_fit();
+    mSomeInfoBegins.shrink_to_fit();
+    mUnknown1s.shrink_to_fit();
+    mAnimationTypes.shrink_to_fit();
+    mSpriteHeaders.shrink_to_fit();
+    mSpriteIdBegins.shrink_to_fit();
+    mFrameInfoBegins.shrink_to_fit();
+    mSpriteIds.shrink_to_fit();
+    mFrameInfos.shrink_to_fit();
+    mNames.shrink_to_fit();
+}
@@ -28,6 +28,7 @@
 // Internal ShankBot headers
 #include "tibiaassets/AppearancesReader.hpp"
 #include "utility/utility.hpp"
+#include "utility/MappedFile.hpp"
 using namespace sb::tibiaassets;
 using namespace sb::utility;
 ///////////////////////////////////
@@ -37,6 +38,7 @@ using namespace sb::utility;
 #include <sstream>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 ///////////////////////////////////
 
 AppearancesReader::AppearancesReader(std::string path)
@@ -44,41 +46,62 @@ AppearancesReader::AppearancesReader(std::string path)
     readAppearances(path);
 }
 
+const Appearances& AppearancesReader::getAppearances() const
+{
+    return mAppearances;
+}
+
 const std::vector<Object>& AppearancesReader::getObjects() const
 {
+    std::call_once(mObjectsFlag, [this]()
+    {
+        mObjects = mAppearances.toObjects();
+    });
     return mObjects;
 }
 
 void AppearancesReader::readAppearances(std::string path)
 {
-    std::ifstream file(path, std::ios::binary);
-    if(!file.good())
+    if(!std::ifstream(path, std::ios::binary).good())
     {
         return;
     }
 
-    file.seekg(0, file.end);
-    size_t fileSize = file.tellg();
-    file.seekg(0);
-
-    if(fileSize == 0)
+    MappedFile file(path);
+    if(file.getSize() == 0)
     {
         return;
     }
 
-    Buffer buffer;
-    buffer.data.resize(fileSize);
-    file.read(&buffer.data[0], fileSize);
-    file.close();
-
-    while(buffer.curr < buffer.data.size())
+    BufferView buffer(file.getData(), file.getSize());
+    while(buffer.curr < buffer.size)
     {
-        mObjects.push_back(readObject(buffer));
+        readObject(buffer);
     }
+
+    mNameOffsets.clear();
+    mAppearances.shrinkToFit();
 }
 
+uint32_t AppearancesReader::internName(const std::string& name)
+{
+    if(name.empty())
+        return 0;
+
+    auto it = mNameOffsets.find(name);
+    if(it != mNameOffsets.end())
+        return it->second;
+
+    std::vector<char>& names = mAppearances.mNames;
+    uint32_t offset = names.size();
+    names.insert(names.end(), name.begin(), name.end());
+    names.push_back('\0');
+    mAppearances.mNumNames++;
+    mNameOffsets.emplace(name, offset);
+    return offset;
+}
 
-Object::FrameInfo AppearancesReader::readFrameInfo(Buffer& stream) const
+Object::FrameInfo AppearancesReader::readFrameInfo(BufferView& stream) const
 {
     Object::FrameInfo info;
     size_t size = readTibiaSizeIndicator(stream);
@@ -112,9 +135,8 @@ Object::FrameInfo AppearancesReader::readFrameInfo(Buffer& stream) const
     return info;
 }
 
-Object::AnimationInfo AppearancesReader::readAnimationInfo(Buffer& stream) const
+void AppearancesReader::readAnimationInfo(BufferView& stream)
 {
-    Object::AnimationInfo info;
     size_t size = readTibiaSizeIndicator(stream);
     int streamStart = stream.tellg();
 
@@ -146,7 +168,7 @@ Object::AnimationInfo AppearancesReader::readAnimationInfo(Buffer& stream) const
                 break;
 
             case AnimationInfoOpCode::FRAME_INFO:
-                info.frameInfos.push_back(readFrameInfo(stream));
+                mAppearances.mFrameInfos.push_back(readFrameInfo(stream));
                 break;
 
             default:
@@ -160,14 +182,12 @@ Object::AnimationInfo AppearancesReader::readAnimationInfo(Buffer& stream) const
         SB_THROW("Size error when reading AnimationInfo starting at position ", streamStart, ".", "\n",
                  "Expected ", size, " bytes, but read ", (int)stream.tellg() - streamStart, ".", "\n");
     }
-
-    return info;
 }
 
 
-Object::SpriteInfo AppearancesReader::readSpriteInfo(Buffer& stream) const
+void AppearancesReader::readSpriteInfo(BufferView& stream)
 {
-    Object::SpriteInfo info;
+    Appearances::SpriteHeader& info = mAppearances.mSpriteHeaders.back();
     size_t size = readTibiaSizeIndicator(stream);
     int streamStart = stream.tellg();
 
@@ -209,11 +229,12 @@ Object::SpriteInfo AppearancesReader::readSpriteInfo(Buffer& stream) const
                 break;
 
             case SpriteInfoOpCode::ANIMATION_INFO:
-                info.animationInfo = readAnimationInfo(stream);
+                mAppearances.mFrameInfos.resize(mAppearances.mFrameInfoBegins.back());
+                readAnimationInfo(stream);
                 break;
 
             case SpriteInfoOpCode::SPRITE_ID:
-                info.spriteIds.push_back(readTibiaSizeIndicator(stream));
+                mAppearances.mSpriteIds.push_back(readTibiaSizeIndicator(stream));
                 break;
 
             default:
@@ -226,14 +247,16 @@ Object::SpriteInfo AppearancesReader::readSpriteInfo(Buffer& stream) const
         SB_THROW("Size error when reading SpriteInfo starting at position ", streamStart, ".", "\n",
                  "Expected ", size, " bytes, but read ", (int)stream.tellg() - streamStart, ".", "\n");
     }
-
-    return info;
 }
 
 
-Object::SomeInfo AppearancesReader::readSomeInfo(Buffer& stream) const
+void AppearancesReader::readSomeInfo(BufferView& stream)
 {
-    Object::SomeInfo info;
+    Appearances& a = mAppearances;
+    a.mUnknown1s.emplace_back();
+    a.mAnimationTypes.push_back(Object::AnimationType::IDLE);
+    a.mSpriteHeaders.emplace_back();
+
     size_t size = readTibiaSizeIndicator(stream);
     int streamStart = stream.tellg();
 
@@ -244,15 +267,18 @@ Object::SomeInfo AppearancesReader::readSomeInfo(Buffer& stream) const
         switch(op)
         {
             case SomeInfoOpCode::UNKNOWN1:
-                readStream(info.unknown1, stream);
+                readStream(a.mUnknown1s.back(), stream);
                 break;
 
             case SomeInfoOpCode::ANIMATION_TYPE:
-                readStream(info.animationType, stream);
+                readStream(a.mAnimationTypes.back(), stream);
                 break;
 
             case SomeInfoOpCode::SPRITE_INFO:
-                info.spriteInfo = readSpriteInfo(stream);
+                a.mSpriteHeaders.back() = Appearances::SpriteHeader();
+                a.mSpriteIds.resize(a.mSpriteIdBegins.back());
+                a.mFrameInfos.resize(a.mFrameInfoBegins.back());
+                readSpriteInfo(stream);
                 break;
 
              default:
@@ -266,11 +292,12 @@ Object::SomeInfo AppearancesReader::readSomeInfo(Buffer& stream) const
                  "Expected ", size, " bytes, but read ", (int)stream.tellg() - streamStart, ".", "\n");
     }
 
-    return info;
+    a.mSpriteIdBegins.push_back(a.mSpriteIds.size());
+    a.mFrameInfoBegins.push_back(a.mFrameInfos.size());
 }
 
 
-bool AppearancesReader::readBoolean(Buffer& stream) const
+bool AppearancesReader::readBoolean(BufferView& stream) const
 {
     unsigned char byte;
     readStream(byte, stream);
@@ -282,7 +309,7 @@ bool AppearancesReader::readBoolean(Buffer& stream) const
     return byte == 0x01;
 }
 
-Object::BodyRestriction AppearancesReader::readBodyRestriction(Buffer& stream) const
+Object::BodyRestriction AppearancesReader::readBodyRestriction(BufferView& stream) const
 {
     size_t size = readTibiaSizeIndicator(stream);
     int streamStart = stream.tellg();
@@ -310,7 +337,7 @@ Object::BodyRestriction AppearancesReader::readBodyRestriction(Buffer& stream) c
 
 
 
-unsigned short AppearancesReader::readWalkSpeed(Buffer& stream) const
+unsigned short AppearancesReader::readWalkSpeed(BufferView& stream) const
 {
     size_t size = readTibiaSizeIndicator(stream);
     int streamStart = stream.tellg();
@@ -333,7 +360,7 @@ unsigned short AppearancesReader::readWalkSpeed(Buffer& stream) const
     return walkSpeed;
 }
 
-Object::MiniMapColor AppearancesReader::readMinimapColor(Buffer& stream) const
+Object::MiniMapColor AppearancesReader::readMinimapColor(BufferView& stream) const
 {
     size_t size = readTibiaSizeIndicator(stream);
     int streamStart = stream.tellg();
@@ -385,7 +412,7 @@ Object::MiniMapColor AppearancesReader::readMinimapColor(Buffer& stream) const
     return miniMapColor;
 }
 
-void AppearancesReader::readOffset(unsigned char& x, unsigned char& y, Buffer& stream) const
+void AppearancesReader::readOffset(unsigned char& x, unsigned char& y, BufferView& stream) const
 {
     size_t size = readTibiaSizeIndicator(stream);
     int streamStart = stream.tellg();
@@ -413,7 +440,7 @@ void AppearancesReader::readOffset(unsigned char& x, unsigned char& y, Buffer& s
 }
 
 
-void AppearancesReader::readLightInfo(unsigned char& distance, unsigned short& color, Buffer& stream) const
+void AppearancesReader::readLightInfo(unsigned char& distance, unsigned short& color, BufferView& stream) const
 {
     size_t size = readTibiaSizeIndicator(stream);
     int streamStart = stream.tellg();
@@ -441,7 +468,7 @@ void AppearancesReader::readLightInfo(unsigned char& distance, unsigned short& c
 }
 
 
-Object::VocationRestriction AppearancesReader::readVocationRestriction(Buffer& stream) const
+Object::VocationRestriction AppearancesReader::readVocationRestriction(BufferView& stream) const
 {
     Object::VocationRestriction b;
     readStream(b, stream);
@@ -455,7 +482,7 @@ Object::VocationRestriction AppearancesReader::readVocationRestriction(Buffer& s
 }
 
 
-Object::ClassRestriction AppearancesReader::readClassRestriction(Buffer& stream) const
+Object::ClassRestriction AppearancesReader::readClassRestriction(BufferView& stream) const
 {
     Object::ClassRestriction b;
     readStream(b, stream);
@@ -468,7 +495,7 @@ Object::ClassRestriction AppearancesReader::readClassRestriction(Buffer& stream)
     return b;
 }
 
-std::string AppearancesReader::readString(Buffer& stream) const
+std::string AppearancesReader::readString(BufferView& stream) const
 {
     size_t size = readTibiaSizeIndicator(stream);
 
@@ -480,7 +507,7 @@ std::string AppearancesReader::readString(Buffer& stream) const
     return str;
 }
 
-Object::MarketInfo AppearancesReader::readMarketInfo(Buffer& stream) const
+Object::MarketInfo AppearancesReader::readMarketInfo(BufferView& stream) const
 {
     Object::MarketInfo info;
     size_t size = readTibiaSizeIndicator(stream);
@@ -532,7 +559,7 @@ Object::MarketInfo AppearancesReader::readMarketInfo(Buffer& stream) const
     return info;
 }
 
-unsigned char AppearancesReader::readHeight(Buffer& stream) const
+unsigned char AppearancesReader::readHeight(BufferView& stream) const
 {
     size_t size = readTibiaSizeIndicator(stream);
     int streamStart = stream.tellg();
@@ -556,7 +583,7 @@ unsigned char AppearancesReader::readHeight(Buffer& stream) const
     return height;
 }
 
-void AppearancesReader::readItemUnknown15(Buffer& stream) const
+void AppearancesReader::readItemUnknown15(BufferView& stream) const
 {
     size_t size = readTibiaSizeIndicator(stream);
     int streamStart = stream.tellg();
@@ -577,7 +604,7 @@ void AppearancesReader::readItemUnknown15(Buffer& stream) const
     }
 }
 
-unsigned short AppearancesReader::readMaxCharacters(Buffer& stream) const
+unsigned short AppearancesReader::readMaxCharacters(BufferView& stream) const
 {
     size_t size = readTibiaSizeIndicator(stream);
     int streamStart = stream.tellg();
@@ -600,7 +627,7 @@ unsigned short AppearancesReader::readMaxCharacters(Buffer& stream) const
     return maxCharacters;
 }
 
-unsigned char AppearancesReader::readDefaultAction(Buffer& stream) const
+unsigned char AppearancesReader::readDefaultAction(BufferView& stream) const
 {
     size_t size = readTibiaSizeIndicator(stream);
     int streamStart = stream.tellg();
@@ -625,7 +652,7 @@ unsigned char AppearancesReader::readDefaultAction(Buffer& stream) const
 }
 
 
-Object::ItemInfo AppearancesReader::readItemInfo(Buffer& stream) const
+Object::ItemInfo AppearancesReader::readItemInfo(BufferView& stream) const
 {
     Object::ItemInfo info;
     size_t size = readTibiaSizeIndicator(stream);
@@ -812,13 +839,13 @@ Object::ItemInfo AppearancesReader::readItemInfo(Buffer& stream) const
     return info;
 }
 
-Object AppearancesReader::readObject(Buffer& stream) const
+void AppearancesReader::readObject(BufferView& stream)
 {
-    Object o;
-    readStream(o.type, stream);
+    Object::Type type;
+    readStream(type, stream);
 
     typedef Object::Type Type;
-    switch(o.type)
+    switch(type)
     {
         case Type::ITEM:
         case Type::OUTFIT:
@@ -827,7 +854,7 @@ Object AppearancesReader::readObject(Buffer& stream) const
             break;
 
          default:
-            SB_THROW("Expected object type op code, got '", (int)o.type, "', at position ", (int)stream.tellg() - 1, ".", "\n");
+            SB_THROW("Expected object type op code, got '", (int)type, "', at position ", (int)stream.tellg() - 1, ".", "\n");
     }
 
     size_t objectSize = readTibiaSizeIndicator(stream);
@@ -842,22 +869,23 @@ Object AppearancesReader::readObject(Buffer& stream) const
         SB_THROW("Expected Object ID op code, got ", (int)op, ", at position ", stream.tellg(), ".", "\n");
     }
 
-    o.id = readTibiaSizeIndicator(stream);
+    unsigned int id = readTibiaSizeIndicator(stream);
+    Object::ItemInfo itemInfo;
     while((int)stream.tellg() - streamStart < objectSize)
     {
         readStream(op, stream);
         switch(op)
         {
             case ObjectOpCode::SOME_INFO:
-                o.someInfos.push_back(readSomeInfo(stream));
+                readSomeInfo(stream);
                 break;
 
             case ObjectOpCode::ITEM_INFO:
-                o.itemInfo = readItemInfo(stream);
+                itemInfo = readItemInfo(stream);
                 break;
 
             default:
-                SB_THROW("Expected an Object op code, got '", (int)o.type, "', at position ", (int)stream.tellg() - 1, ".", "\n");
+                SB_THROW("Expected an Object op code, got '", (int)op, "', at position ", (int)stream.tellg() - 1, ".", "\n");
         }
     }
 
@@ -867,7 +895,13 @@ Object AppearancesReader::readObject(Buffer& stream) const
                  "Expected ", objectSize, " bytes, but read ", (int)stream.tellg() - streamStart, ".", "\n");
     }
 
-    return o;
+    Appearances& a = mAppearances;
+    a.mTypes.push_back(type);
+    a.mIds.push_back(id);
+    a.mNameOffsets.push_back(internName(itemInfo.marketInfo.name));
+    std::string().swap(itemInfo.marketInfo.name);
+    a.mItemInfos.push_back(std::move(itemInfo));
+    a.mSomeInfoBegins.push_back(a.mUnknown1s.size());
 }
 
 
@@ -108,8 +108,10 @@ std::vector<std::string> GraphicsResourceReader::readNames(const std::string& pa
             else
             {
 
+                // Only the header is looked at. The names index the resources
+                // readResources decodes, so it has to skip the same files.
                 QImageReader reader(file.absoluteFilePath());
-                if(!reader.read().isNull())
+                if(reader.canRead())
                 {
                     std::string name = file.absoluteFilePath().toStdString();
 
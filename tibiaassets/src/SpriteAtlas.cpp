@@ -0,0 +1,331 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "tibiaassets/SpriteAtlas.hpp"
+#include "tibiaassets/CatalogContent.hpp"
+#include "tibiaassets/constants.hpp"
+#include "utility/utility.hpp"
+#include "utility/file.hpp"
+using namespace sb::tibiaassets;
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <algorithm>
+#include <limits>
+#include <cstring>
+///////////////////////////////////
+
+// File layout:
+//  char     magic[8]
+//  uint32_t version
+//  uint32_t reserved
+//  uint64_t catalogKey, zero until the writer has finished
+//  uint32_t firstSpriteId
+//  uint32_t numIds
+//  Index entries, one per id from firstSpriteId on:
+//      uint64_t offset, zero if there is no sprite with the id
+//      uint8_t  tileWidth
+//      uint8_t  tileHeight
+//      uint16_t reserved
+//      uint32_t area
+//  Sprites as tightly packed RGBA, each starting at a multiple of ALIGNMENT
+namespace
+{
+    const char MAGIC[8] = {'S', 'B', 'S', 'P', 'R', 'A', 'T', 'L'};
+    const uint32_t VERSION = 1;
+    const size_t HEADER_SIZE = 32;
+    const size_t CATALOG_KEY_OFFSET = 16;
+    const size_t INDEX_ENTRY_SIZE = 16;
+    const size_t ALIGNMENT = 16;
+
+    struct IndexEntry
+    {
+        uint64_t offset;
+        uint8_t tileWidth;
+        uint8_t tileHeight;
+        uint16_t reserved;
+        uint32_t area;
+    };
+    static_assert(sizeof(IndexEntry) == INDEX_ENTRY_SIZE, "Unexpected padding in sprite atlas index entries.");
+
+    size_t getPadding(uint64_t offset)
+    {
+        return (ALIGNMENT - offset % ALIGNMENT) % ALIGNMENT;
+    }
+
+    size_t getSpriteSize(const IndexEntry& e)
+    {
+        return e.tileWidth * constants::TILE_PIXEL_WIDTH * e.tileHeight * constants::TILE_PIXEL_HEIGHT * BYTES_PER_PIXEL_RGBA;
+    }
+}
+
+///////////////////////////////////
+
+SpriteAtlas::Writer::Writer(const std::string& filePath, uint64_t catalogKey, unsigned int firstSpriteId, unsigned int lastSpriteId)
+: mFile(filePath, std::ios::binary)
+, mFilePath(filePath)
+, mCatalogKey(catalogKey)
+, mFirstSpriteId(firstSpriteId)
+{
+    if(!mFile.good())
+        SB_THROW("Could not open sprite atlas '", filePath, "' for writing.");
+
+    if(lastSpriteId < firstSpriteId)
+        SB_THROW("Invalid sprite id range [", firstSpriteId, ", ", lastSpriteId, "] for sprite atlas '", filePath, "'.");
+
+    if(catalogKey == 0)
+        SB_THROW("A catalog key of zero marks an unfinished sprite atlas.");
+
+    const uint32_t numIds = lastSpriteId - firstSpriteId + 1;
+    mIndex.resize(numIds * INDEX_ENTRY_SIZE, 0);
+
+    // The header is written again by finish, with the catalog key set.
+    const char zeros[HEADER_SIZE] = {};
+    writeStream(*zeros, mFile, HEADER_SIZE);
+    writeStream(*mIndex.data(), mFile, mIndex.size());
+    mOffset = HEADER_SIZE + mIndex.size();
+    writeStream(*zeros, mFile, getPadding(mOffset));
+    mOffset += getPadding(mOffset);
+
+    if(mFile.fail())
+        SB_THROW("Failed to write the index of sprite atlas '", filePath, "'.");
+}
+
+///////////////////////////////////
+
+void SpriteAtlas::Writer::add(const SpriteReader::Sprite& spr)
+{
+    const size_t numIds = mIndex.size() / INDEX_ENTRY_SIZE;
+    if(spr.id < mFirstSpriteId || spr.id - mFirstSpriteId >= numIds)
+        SB_THROW("Sprite ", spr.id, " is outside the id range of sprite atlas '", mFilePath, "'.");
+
+    IndexEntry e = {};
+    e.offset = mOffset;
+    e.tileWidth = spr.tileWidth;
+    e.tileHeight = spr.tileHeight;
+    e.area = spr.area;
+
+    const size_t ROW_SIZE = spr.tileWidth * constants::TILE_PIXEL_WIDTH * BYTES_PER_PIXEL_RGBA;
+    const size_t HEIGHT = spr.tileHeight * constants::TILE_PIXEL_HEIGHT;
+    const size_t SIZE = getSpriteSize(e);
+    mRows.resize(SIZE + getPadding(SIZE));
+    for(size_t y = 0; y < HEIGHT; y++)
+        memcpy(mRows.data() + y * ROW_SIZE, spr.pixels + y * spr.stride, ROW_SIZE);
+    std::fill(mRows.begin() + SIZE, mRows.end(), 0);
+
+    writeStream(*mRows.data(), mFile, mRows.size());
+    if(mFile.fail())
+        SB_THROW("Failed to write sprite ", spr.id, " to sprite atlas '", mFilePath, "'.");
+
+    memcpy(mIndex.data() + (spr.id - mFirstSpriteId) * INDEX_ENTRY_SIZE, &e, INDEX_ENTRY_SIZE);
+    mOffset += mRows.size();
+}
+
+///////////////////////////////////
+
+void SpriteAtlas::Writer::finish()
+{
+    const uint32_t reserved = 0;
+    const uint32_t numIds = mIndex.size() / INDEX_ENTRY_SIZE;
+    mFile.seekp(0);
+    writeStream(*MAGIC, mFile, sizeof(MAGIC));
+    writeStream(VERSION, mFile);
+    writeStream(reserved, mFile);
+    writeStream(mCatalogKey, mFile);
+    writeStream(mFirstSpriteId, mFile);
+    writeStream(numIds, mFile);
+    writeStream(*mIndex.data(), mFile, mIndex.size());
+    mFile.close();
+
+    if(mFile.fail())
+        SB_THROW("Failed to finish sprite atlas '", mFilePath, "'.");
+}
+
+///////////////////////////////////
+
+SpriteAtlas::SpriteAtlas(const std::string& filePath)
+: mFile(filePath)
+{
+    const char* data = mFile.getData();
+    const char* const end = data + mFile.getSize();
+
+    char magic[sizeof(MAGIC)];
+    uint32_t version;
+    uint32_t reserved;
+    if(!readStreamSafe(*magic, data, end, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+        SB_THROW("'", filePath, "' is not a finished sprite atlas.");
+
+    if(!readStreamSafe(version, data, end) || !readStreamSafe(reserved, data, end) ||
+       !readStreamSafe(mCatalogKey, data, end) || !readStreamSafe(mFirstSpriteId, data, end) ||
+       !readStreamSafe(mNumIds, data, end))
+        SB_THROW("Sprite atlas '", filePath, "' has a truncated header.");
+
+    if(version != VERSION)
+        SB_THROW("Unsupported sprite atlas version ", version, " in '", filePath, "'.");
+
+    if(mCatalogKey == 0)
+        SB_THROW("Sprite atlas '", filePath, "' was never finished.");
+
+    if(uint64_t(mNumIds) * INDEX_ENTRY_SIZE > uint64_t(end - data))
+        SB_THROW("Sprite atlas '", filePath, "' has a truncated index.");
+
+    mIndex = data;
+    for(size_t i = 0; i < mNumIds; i++)
+    {
+        IndexEntry e;
+        memcpy(&e, mIndex + i * INDEX_ENTRY_SIZE, INDEX_ENTRY_SIZE);
+        if(e.offset == 0)
+            continue;
+
+        if(e.offset > mFile.getSize() || getSpriteSize(e) > mFile.getSize() - e.offset)
+            SB_THROW("Sprite ", mFirstSpriteId + i, " of sprite atlas '", filePath, "' is out of bounds.");
+
+        mNumSprites++;
+    }
+}
+
+///////////////////////////////////
+
+uint64_t SpriteAtlas::getCatalogKey(const CatalogContent& catalog)
+{
+    uint64_t key = 0;
+    for(const CatalogContent::SpriteSheet& sheet : catalog.getSpriteSheets())
+    {
+        const std::string name = file::basename(sheet.path);
+        const int32_t values[] = {int32_t(sheet.spriteSize), sheet.firstSpriteId, sheet.lastSpriteId, sheet.area};
+        key = hash64(name.data(), name.size(), key);
+        key = hash64(values, sizeof(values), key);
+    }
+
+    return (key == 0 ? 1 : key);
+}
+
+///////////////////////////////////
+
+void SpriteAtlas::getSpriteIdRange(const CatalogContent& catalog, unsigned int& firstSpriteId, unsigned int& lastSpriteId)
+{
+    firstSpriteId = std::numeric_limits<unsigned int>::max();
+    lastSpriteId = 0;
+    for(const CatalogContent::SpriteSheet& sheet : catalog.getSpriteSheets())
+    {
+        firstSpriteId = std::min<unsigned int>(firstSpriteId, sheet.firstSpriteId);
+        lastSpriteId = std::max<unsigned int>(lastSpriteId, sheet.lastSpriteId);
+    }
+
+    if(firstSpriteId > lastSpriteId)
+        SB_THROW("The catalog has no sprite sheets.");
+}
+
+///////////////////////////////////
+
+bool SpriteAtlas::isUpToDate(const std::string& filePath, const CatalogContent& catalog)
+{
+    // Only the header is read, so that this stays cheap where the whole atlas
+    // does not fit into the address space.
+    std::ifstream file(filePath, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    uint32_t version;
+    char reserved[4];
+    uint64_t catalogKey;
+    readStream(*magic, file, sizeof(magic));
+    readStream(version, file);
+    readStream(*reserved, file, sizeof(reserved));
+    readStream(catalogKey, file);
+
+    return file.good() &&
+           memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 &&
+           version == VERSION &&
+           catalogKey == getCatalogKey(catalog);
+}
+
+///////////////////////////////////
+
+void SpriteAtlas::build(const CatalogContent& catalog, const std::string& filePath)
+{
+    unsigned int firstSpriteId;
+    unsigned int lastSpriteId;
+    getSpriteIdRange(catalog, firstSpriteId, lastSpriteId);
+
+    Writer writer(filePath, getCatalogKey(catalog), firstSpriteId, lastSpriteId);
+    SpriteReader(catalog).forEachSprite([&writer](const SpriteReader::Sprite& spr)
+    {
+        writer.add(spr);
+        return true;
+    });
+    writer.finish();
+}
+
+///////////////////////////////////
+
+uint64_t SpriteAtlas::getCatalogKey() const
+{
+    return mCatalogKey;
+}
+
+///////////////////////////////////
+
+size_t SpriteAtlas::getNumSprites() const
+{
+    return mNumSprites;
+}
+
+///////////////////////////////////
+
+bool SpriteAtlas::hasSprite(unsigned int id) const
+{
+    if(id < mFirstSpriteId || id - mFirstSpriteId >= mNumIds)
+        return false;
+
+    uint64_t offset;
+    memcpy(&offset, mIndex + (id - mFirstSpriteId) * INDEX_ENTRY_SIZE, sizeof(offset));
+    return offset != 0;
+}
+
+///////////////////////////////////
+
+SpriteReader::Sprite SpriteAtlas::getSprite(unsigned int id) const
+{
+    SpriteReader::Sprite spr = {};
+    if(id < mFirstSpriteId || id - mFirstSpriteId >= mNumIds)
+        return spr;
+
+    IndexEntry e;
+    memcpy(&e, mIndex + (id - mFirstSpriteId) * INDEX_ENTRY_SIZE, INDEX_ENTRY_SIZE);
+    if(e.offset == 0)
+        return spr;
+
+    spr.pixels = reinterpret_cast<const unsigned char*>(mFile.getData() + e.offset);
+    spr.stride = e.tileWidth * constants::TILE_PIXEL_WIDTH * BYTES_PER_PIXEL_RGBA;
+    spr.tileWidth = e.tileWidth;
+    spr.tileHeight = e.tileHeight;
+    spr.id = id;
+    spr.area = e.area;
+    return spr;
+}
@@ -27,10 +27,14 @@
 ///////////////////////////////////
 // Internal ShankBot headers
 #include "tibiaassets/SpriteReader.hpp"
+#include "tibiaassets/SpriteAtlas.hpp"
 #include "utility/utility.hpp"
 #include "utility/file.hpp"
 #include "tibiaassets/CatalogContent.hpp"
 #include "tibiaassets/constants.hpp"
+#include "utility/ThreadPool.hpp"
+#include "utility/MappedFile.hpp"
+#include "utility/BufferView.hpp"
 using namespace sb::tibiaassets;
 using namespace sb::utility;
 ///////////////////////////////////
@@ -42,6 +46,11 @@ using namespace sb::utility;
 #include <cassert>
 #include <sstream>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
 ///////////////////////////////////
 
 ///////////////////////////////////
@@ -62,62 +71,61 @@ SpriteReader::SpriteReader(const CatalogContent& catalog)
 {
 }
 
-bool SpriteReader::validateTibiaLzmaHeader(std::istream& stream) const
+SpriteReader::SpriteReader(const CatalogContent& catalog, const SpriteAtlas& atlas)
+: mCatalog(catalog)
+, mAtlas(&atlas)
 {
-    if(stream.bad())
-        return false;
-
-    unsigned char byte;
-    readStream(byte, stream);
-    if(byte != 0x00)
-        return false;
+}
 
-    if(stream.bad())
-        return false;
+bool SpriteReader::readTibiaLzmaHeader(const unsigned char* data, size_t size, LzmaStream& stream)
+{
+    BufferView view((const char*)data, size);
+    try
+    {
+        unsigned char header[3];
+        readStream(*header, view, sizeof(header));
+        if(header[0] != 0x00 || header[1] != 0x70 || header[2] > 0x14)
+            return false;
 
-    readStream(byte, stream);
-    if(byte != 0x70)
-        return false;
+        stream.decompressedSize = readTibiaSizeIndicator(view);
+        readTibiaSizeIndicator(view); // Compressed size
 
-    if(stream.bad())
-        return false;
+        stream.propsSize = 5;
+        stream.props = data + view.tellg();
+        view.seekg(stream.propsSize, BufferView::cur);
 
-    readStream(byte, stream);
-    if(byte > 0x14)
+        // The size in the LZMA header repeats the decompressed size.
+        view.seekg(8, BufferView::cur);
+    }
+    catch(const std::runtime_error&)
+    {
         return false;
+    }
 
+    // The stream runs to the end of the file and stops by itself.
+    stream.data = data + view.tellg();
+    stream.dataSize = size - view.tellg();
     return true;
 }
 
-
-
 std::vector<unsigned char> SpriteReader::decompressTibiaLzma(std::string path) const
 {
-    std::ifstream file(path, std::ios::binary | std::ios::in);
+    // One decoder per worker thread, so that its tables are reused across
+    // the sheets that thread decodes.
+    thread_local sb::lzma::Decoder decoder;
 
-    if(!validateTibiaLzmaHeader(file))
+    MappedFile file(path);
+    LzmaStream stream;
+    if(!readTibiaLzmaHeader((const unsigned char*)file.getData(), file.getSize(), stream))
     {
         std::cout << "Failed to decompress \"" << path << "\". Invalid header." << std::endl;
         return std::vector<unsigned char>();
     }
 
-    size_t decompressedSize = sb::utility::readTibiaSizeIndicator(file);
-    unsigned int compressedSize = sb::utility::readTibiaSizeIndicator(file);
-
-    unsigned char props[5]; // LZMA property bytes
-    readStream(*props, file, 5);
-
-    readStream(compressedSize, file);
-    file.seekg(4, std::ios::cur);
-
-    unsigned char* data = new unsigned char[compressedSize];
-    readStream(*data, file, compressedSize);
-    file.close();
-
-    std::vector<unsigned char> decompressedFile;
-    decompressedFile.resize(decompressedSize);
-    int result = sb::lzma::uncompress(decompressedFile.data(), &decompressedSize, data, &compressedSize, props, 5);
-    delete[] data;
+    std::vector<unsigned char> decompressedFile(stream.decompressedSize);
+    size_t decompressedSize = decompressedFile.size();
+    size_t compressedSize = stream.dataSize;
+    int result = decoder.decode(decompressedFile.data(), &decompressedSize, stream.data, &compressedSize, stream.props, stream.propsSize);
     switch(result)
     {
         case SZ_OK:
@@ -150,11 +158,15 @@ std::vector<unsigned char> SpriteReader::decompressTibiaLzma(std::string path) c
             break;
     }
 
+    decompressedFile.resize(decompressedSize);
     return decompressedFile;
 }
 
 SpriteReader::Sprite SpriteReader::getSprite(unsigned int id) const
 {
+    if(mAtlas)
+        return mAtlas->getSprite(id);
+
     auto sheetIt = std::find_if(mCatalog.getSpriteSheets().begin(),
                                 mCatalog.getSpriteSheets().end(),
                                 [id](const CatalogContent::SpriteSheet& sheet)
@@ -189,45 +201,126 @@ SpriteReader::Sprite SpriteReader::getSprite(unsigned int id) const
     size_t y = (spriteIndex / spritesPerRow) * SPRITE_PIXEL_HEIGHT;
 
     QImage sprite = decompressedSpriteSheet.copy(x, y, SPRITE_PIXEL_WIDTH, SPRITE_PIXEL_HEIGHT);
-    s.pixels = new unsigned char[sprite.byteCount()];
-    memcpy((void*)s.pixels, sprite.bits(), sprite.byteCount());
+    mSpritePixels.assign(sprite.bits(), sprite.bits() + sprite.byteCount());
+    s.pixels = mSpritePixels.data();
+    s.stride = SPRITE_PIXEL_WIDTH * sb::utility::BYTES_PER_PIXEL_RGBA;
 
     return s;
 }
 
+QImage SpriteReader::decodeSpriteSheet(const CatalogContent::SpriteSheet& sheet) const
+{
+    std::vector<unsigned char> data = decompressTibiaLzma(sheet.path + ".lzma");
+    QImage image = QImage::fromData(data.data(), data.size());
+    return image.convertToFormat(QImage::Format_RGBA8888);
+}
 
-void SpriteReader::forEachSprite(std::function<bool(const Sprite& spr)> func) const
+bool SpriteReader::forEachSpriteInSheet(const CatalogContent::SpriteSheet& sheet, const QImage& image, const std::function<bool(const Sprite& spr)>& func) const
 {
-    const std::list<CatalogContent::SpriteSheet>& spriteSheets = mCatalog.getSpriteSheets();
-    for(const CatalogContent::SpriteSheet& spriteSheet : spriteSheets)
+    Sprite spr;
+    CatalogContent::getSpriteTileSize(sheet.spriteSize, spr.tileWidth, spr.tileHeight);
+    spr.area = sheet.area;
+    spr.id = sheet.firstSpriteId;
+    spr.stride = image.bytesPerLine();
+
+    const size_t SPRITE_SHEET_PIXEL_WIDTH = image.width();
+    const size_t SPRITE_SHEET_PIXEL_HEIGHT = image.height();
+    const size_t SPRITE_PIXEL_WIDTH = spr.tileWidth * constants::TILE_PIXEL_WIDTH;
+    const size_t SPRITE_PIXEL_HEIGHT = spr.tileHeight * constants::TILE_PIXEL_HEIGHT;
+    const size_t NUM_SPRITES = sheet.lastSpriteId - sheet.firstSpriteId + 1;
+    const unsigned char* pixels = image.constBits();
+
+    for(size_t y = 0, spriteNr = 0; y + SPRITE_PIXEL_HEIGHT <= SPRITE_SHEET_PIXEL_HEIGHT; y += SPRITE_PIXEL_HEIGHT)
     {
-        Sprite spr;
-        CatalogContent::getSpriteTileSize(spriteSheet.spriteSize, spr.tileWidth, spr.tileHeight);
-        spr.area = spriteSheet.area;
-        spr.id = spriteSheet.firstSpriteId;
+        for(size_t x = 0; x + SPRITE_PIXEL_WIDTH <= SPRITE_SHEET_PIXEL_WIDTH && spriteNr < NUM_SPRITES; x += SPRITE_PIXEL_WIDTH, spriteNr++)
+        {
+            spr.pixels = pixels + y * spr.stride + x * sb::utility::BYTES_PER_PIXEL_RGBA;
+            if(!func(spr))
+                return false;
+            spr.id++;
+        }
+    }
+
+    return true;
+}
 
-        std::vector<unsigned char> data = decompressTibiaLzma(spriteSheet.path + ".lzma");
 
-        QImage decompressedSpriteSheet = QImage::fromData(data.data(), data.size());
+void SpriteReader::forEachSprite(std::function<bool(const Sprite& spr)> func, bool isOrdered, size_t numThreads) const
+{
+    std::vector<const CatalogContent::SpriteSheet*> sheets;
+    for(const CatalogContent::SpriteSheet& sheet : mCatalog.getSpriteSheets())
+        sheets.push_back(&sheet);
 
-        decompressedSpriteSheet = decompressedSpriteSheet.convertToFormat(QImage::Format_RGBA8888);
-        const size_t SPRITE_SHEET_PIXEL_WIDTH = decompressedSpriteSheet.width();
-        const size_t SPRITE_SHEET_PIXEL_HEIGHT = decompressedSpriteSheet.height();
-        const size_t SPRITE_PIXEL_WIDTH = spr.tileWidth * constants::TILE_PIXEL_WIDTH;
-        const size_t SPRITE_PIXEL_HEIGHT = spr.tileHeight * constants::TILE_PIXEL_HEIGHT;
-        const size_t NUM_SPRITES = spriteSheet.lastSpriteId - spriteSheet.firstSpriteId + 1;
+    forEachSprite(sheets, func, isOrdered, numThreads);
+}
 
-        for(size_t y = 0, spriteNr = 0; y < SPRITE_SHEET_PIXEL_HEIGHT; y += SPRITE_PIXEL_HEIGHT)
+void SpriteReader::forEachSprite(const std::vector<const CatalogContent::SpriteSheet*>& spriteSheets, std::function<bool(const Sprite& spr)> func, bool isOrdered, size_t numThreads) const
+{
+    struct DecodedSheet
+    {
+        QImage image;
+        std::exception_ptr error;
+    };
+
+    std::mutex mutex;
+    std::condition_variable sheetDecoded;
+    std::map<size_t, DecodedSheet> decodedSheets;
+
+    // Declared last, so that the workers are joined before the state they
+    // write to goes away, also when func stops early or throws.
+    sb::utility::ThreadPool pool(numThreads);
+
+    // Decoded sheets are large, so only a few are kept ahead of func.
+    const size_t MAX_NUM_PENDING_SHEETS = 2 * pool.getNumThreads();
+    size_t numSubmittedSheets = 0;
+    auto submitSheet = [&]()
+    {
+        const size_t index = numSubmittedSheets++;
+        pool.push([&, index]()
         {
-            for(size_t x = 0; x < SPRITE_SHEET_PIXEL_WIDTH && spriteNr < NUM_SPRITES; x += SPRITE_PIXEL_WIDTH, spriteNr++)
+            DecodedSheet decoded;
+            try
+            {
+                decoded.image = decodeSpriteSheet(*spriteSheets[index]);
+            }
+            catch(...)
             {
-                QImage sprite = decompressedSpriteSheet.copy(x, y, SPRITE_PIXEL_WIDTH, SPRITE_PIXEL_HEIGHT);
-                spr.pixels = sprite.constBits();
-                if(!func(spr))
-                    return;
-                spr.id++;
+                decoded.error = std::current_exception();
             }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            decodedSheets[index] = std::move(decoded);
+            sheetDecoded.notify_one();
+        });
+    };
+
+    while(numSubmittedSheets < spriteSheets.size() && numSubmittedSheets < MAX_NUM_PENDING_SHEETS)
+        submitSheet();
+
+    for(size_t nextSheet = 0; nextSheet < spriteSheets.size(); nextSheet++)
+    {
+        size_t index;
+        DecodedSheet decoded;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            sheetDecoded.wait(lock, [&]()
+            {
+                return isOrdered ? decodedSheets.count(nextSheet) > 0 : !decodedSheets.empty();
+            });
+
+            auto it = (isOrdered ? decodedSheets.find(nextSheet) : decodedSheets.begin());
+            index = it->first;
+            decoded = std::move(it->second);
+            decodedSheets.erase(it);
         }
+
+        if(numSubmittedSheets < spriteSheets.size())
+            submitSheet();
+
+        if(decoded.error)
+            std::rethrow_exception(decoded.error);
+
+        if(!forEachSpriteInSheet(*spriteSheets[index], decoded.image, func))
+            return;
     }
 }
-
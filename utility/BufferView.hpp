@@ -0,0 +1,71 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef SB_UTILITY_BUFFER_VIEW_HPP
+#define SB_UTILITY_BUFFER_VIEW_HPP
+
+
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/config.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <ios>
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+    // Non-owning counterpart of Buffer, e.g. over a MappedFile. Reads past
+    // the end throw instead of running off the mapping.
+    struct SHANK_BOT_UTILITY_DECLSPEC BufferView
+    {
+        static const std::ios_base::seekdir cur = std::ios_base::cur;
+        static const std::ios_base::seekdir beg = std::ios_base::beg;
+        static const std::ios_base::seekdir end = std::ios_base::end;
+
+        BufferView() = default;
+        BufferView(const char* data, size_t size);
+
+        const char* data = nullptr;
+        size_t size = 0;
+        size_t curr = 0;
+
+        size_t tellg() const;
+        BufferView& seekg(std::streampos pos);
+        BufferView& seekg(std::streampos off, std::ios_base::seekdir way);
+
+        // Kept out of line so that reads stay small enough to inline.
+        void throwReadPastEnd(size_t numBytes) const;
+    };
+}
+}
+
+#endif // SB_UTILITY_BUFFER_VIEW_HPP
@@ -0,0 +1,85 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef SB_UTILITY_CLOCK_CACHE_HPP
+#define SB_UTILITY_CLOCK_CACHE_HPP
+
+///////////////////////////////////
+// STD C++
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+    // Bounded map from a 64 bit hash to a value, evicting with the CLOCK
+    // approximation of least recently used. A hit only sets a reference
+    // bit, so lookups never reorder anything.
+    template<typename T>
+    class ClockCache
+    {
+        public:
+            explicit ClockCache(size_t capacity);
+
+            // Counts a hit or a miss. The pointer is valid until the next
+            // insert or clear.
+            T* get(uint64_t hash);
+
+            // Returns false, and only updates the value, if the hash is
+            // already cached.
+            bool insert(uint64_t hash, const T& value);
+            void clear();
+
+            size_t getSize() const;
+            size_t getCapacity() const;
+            size_t getNumHits() const;
+            size_t getNumMisses() const;
+
+        private:
+            struct Slot
+            {
+                uint64_t hash;
+                T value;
+                bool isReferenced;
+            };
+
+            std::unordered_map<uint64_t, size_t> mSlotIndices;
+            std::vector<Slot> mSlots;
+            size_t mHand = 0;
+            size_t mCapacity;
+            size_t mNumHits = 0;
+            size_t mNumMisses = 0;
+    };
+}
+}
+
+#include "utility/ClockCache.inl"
+
+#endif // SB_UTILITY_CLOCK_CACHE_HPP
@@ -0,0 +1,145 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/utility.hpp"
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+///////////////////////////////////
+
+template<typename T>
+ClockCache<T>::ClockCache(size_t capacity)
+: mCapacity(capacity)
+{
+    SB_EXPECT(mCapacity, >, 0);
+    mSlotIndices.reserve(mCapacity);
+    mSlots.reserve(mCapacity);
+}
+
+///////////////////////////////////
+
+template<typename T>
+T* ClockCache<T>::get(uint64_t hash)
+{
+    auto it = mSlotIndices.find(hash);
+    if(it == mSlotIndices.end())
+    {
+        mNumMisses++;
+        return nullptr;
+    }
+
+    mNumHits++;
+    Slot& slot = mSlots[it->second];
+    slot.isReferenced = true;
+    return &slot.value;
+}
+
+///////////////////////////////////
+
+template<typename T>
+bool ClockCache<T>::insert(uint64_t hash, const T& value)
+{
+    auto it = mSlotIndices.find(hash);
+    if(it != mSlotIndices.end())
+    {
+        mSlots[it->second].value = value;
+        return false;
+    }
+
+    if(mSlots.size() < mCapacity)
+    {
+        mSlotIndices.emplace(hash, mSlots.size());
+        mSlots.push_back({hash, value, false});
+        return true;
+    }
+
+    // Sweeps past referenced slots, clearing their bit, until one that has
+    // not been hit since the last sweep is found.
+    while(mSlots[mHand].isReferenced)
+    {
+        mSlots[mHand].isReferenced = false;
+        mHand = (mHand + 1) % mCapacity;
+    }
+
+    Slot& victim = mSlots[mHand];
+    mSlotIndices.erase(victim.hash);
+    mSlotIndices.emplace(hash, mHand);
+    victim.hash = hash;
+    victim.value = value;
+    mHand = (mHand + 1) % mCapacity;
+    return true;
+}
+
+///////////////////////////////////
+
+template<typename T>
+void ClockCache<T>::clear()
+{
+    mSlotIndices.clear();
+    mSlots.clear();
+    mHand = 0;
+}
+
+///////////////////////////////////
+
+template<typename T>
+size_t ClockCache<T>::getSize() const
+{
+    return mSlots.size();
+}
+
+///////////////////////////////////
+
+template<typename T>
+size_t ClockCache<T>::getCapacity() const
+{
+    return mCapacity;
+}
+
+///////////////////////////////////
+
+template<typename T>
+size_t ClockCache<T>::getNumHits() const
+{
+    return mNumHits;
+}
+
+///////////////////////////////////
+
+template<typename T>
+size_t ClockCache<T>::getNumMisses() const
+{
+    return mNumMisses;
+}
+
+///////////////////////////////////
+}
+}
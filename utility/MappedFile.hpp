@@ -0,0 +1,71 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef SB_UTILITY_MAPPED_FILE_HPP
+#define SB_UTILITY_MAPPED_FILE_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/config.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <string>
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+    // Read only memory mapping of a whole file.
+    class SHANK_BOT_UTILITY_DECLSPEC MappedFile
+    {
+        public:
+            explicit MappedFile(const std::string& path);
+            ~MappedFile();
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            const char* getData() const;
+            size_t getSize() const;
+            const std::string& getPath() const;
+
+        private:
+            std::string mPath;
+            const char* mData = nullptr;
+            size_t mSize = 0;
+            #if defined(_WIN32)
+            void* mFile = nullptr;
+            void* mMapping = nullptr;
+            #else
+            int mFd = -1;
+            #endif // defined
+    };
+}
+}
+
+#endif // SB_UTILITY_MAPPED_FILE_HPP
@@ -44,22 +44,11 @@ namespace utility
             memcpy(values, v, sizeof(values));
         }
 
-        Matrix(const Matrix<T, N, M>& other)
-        {
-            memcpy(values, other.values, sizeof(values));
-        }
-
         Matrix()
         : values{{0}}
         {
         }
 
-        Matrix<T, N, M>& operator=(const Matrix<T, N, M>& other)
-        {
-            memcpy(values, other.values, sizeof(values));
-            return *this;
-        }
-
         T* operator[](size_t n)
         {
             return values[n];
@@ -0,0 +1,107 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef SB_UTILITY_MONOTONIC_ARENA_HPP
+#define SB_UTILITY_MONOTONIC_ARENA_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/config.hpp"
+#include "utility/Span.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C
+#include <cstddef>
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+    // Bump allocator for objects that all die at the same time. Memory is
+    // only given back by reset(), which invalidates everything allocated
+    // since the previous reset. Objects are never destructed, so only
+    // trivially destructible types may be allocated.
+    class SHANK_BOT_UTILITY_DECLSPEC MonotonicArena
+    {
+        public:
+            explicit MonotonicArena(size_t chunkSize = 64 * 1024);
+            ~MonotonicArena();
+            MonotonicArena(const MonotonicArena&) = delete;
+            MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+            void* allocate(size_t size, size_t alignment);
+
+            // Default constructs numElements elements of T.
+            template<typename T>
+            T* allocate(size_t numElements);
+
+            template<typename T>
+            T* create(const T& value);
+
+            template<typename T>
+            Span<T> copy(const T* data, size_t numElements);
+
+            // Frees everything at once. When more than one chunk was needed
+            // since the last reset, they are replaced by one chunk large enough
+            // for all of them, so that a steady workload stops allocating.
+            void reset();
+
+            size_t getNumBytesUsed() const;
+            size_t getNumBytesReserved() const;
+
+            // Number of chunks allocated from the system since construction.
+            size_t getNumChunkAllocations() const;
+
+        private:
+            void addChunk(size_t minSize);
+
+        private:
+            struct Chunk
+            {
+                char* data;
+                size_t size;
+            };
+
+            std::vector<Chunk> mChunks;
+            size_t mChunkSize;
+            char* mCurrent = nullptr;
+            char* mEnd = nullptr;
+            size_t mNumBytesUsed = 0;
+            size_t mNumChunkAllocations = 0;
+    };
+}
+}
+
+#include "utility/MonotonicArena.inl"
+
+#endif // SB_UTILITY_MONOTONIC_ARENA_HPP
@@ -0,0 +1,80 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// STD C++
+#include <type_traits>
+#include <new>
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C
+#include <cstring>
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+///////////////////////////////////
+
+template<typename T>
+T* MonotonicArena::allocate(size_t numElements)
+{
+    static_assert(std::is_trivially_destructible<T>::value, "Arena allocated objects are never destructed.");
+    T* elements = (T*)allocate(sizeof(T) * numElements, alignof(T));
+    for(size_t i = 0; i < numElements; i++)
+        new(elements + i) T();
+
+    return elements;
+}
+
+///////////////////////////////////
+
+template<typename T>
+T* MonotonicArena::create(const T& value)
+{
+    static_assert(std::is_trivially_destructible<T>::value, "Arena allocated objects are never destructed.");
+    return new(allocate(sizeof(T), alignof(T))) T(value);
+}
+
+///////////////////////////////////
+
+template<typename T>
+Span<T> MonotonicArena::copy(const T* data, size_t numElements)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Arena copies are made with memcpy.");
+    if(numElements == 0)
+        return Span<T>();
+
+    T* elements = (T*)allocate(sizeof(T) * numElements, alignof(T));
+    memcpy(elements, data, sizeof(T) * numElements);
+    return Span<T>(elements, elements + numElements);
+}
+
+///////////////////////////////////
+}
+}
@@ -0,0 +1,82 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef SB_UTILITY_SHARED_MEMORY_HPP
+#define SB_UTILITY_SHARED_MEMORY_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/config.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <string>
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+    // Named shared memory segment. Backed by a paging file mapping on Windows
+    // and by shm_open on POSIX systems. The creating side owns the name and
+    // unlinks it on destruction.
+    class SHANK_BOT_UTILITY_DECLSPEC SharedMemory
+    {
+        public:
+            enum class Mode : unsigned char
+            {
+                CREATE,
+                OPEN
+            };
+
+        public:
+            explicit SharedMemory(const std::string& name, size_t size, Mode mode);
+            ~SharedMemory();
+            SharedMemory(const SharedMemory&) = delete;
+            SharedMemory& operator=(const SharedMemory&) = delete;
+
+            void* getData() const;
+            size_t getSize() const;
+            const std::string& getName() const;
+
+            static std::string generateName(size_t length);
+
+        private:
+            std::string mName;
+            size_t mSize = 0;
+            Mode mMode;
+            void* mData = nullptr;
+            #if defined(_WIN32)
+            void* mHandle = nullptr;
+            #else
+            int mFd = -1;
+            #endif // defined
+    };
+}
+}
+
+#endif // SB_UTILITY_SHARED_MEMORY_HPP
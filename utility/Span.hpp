@@ -0,0 +1,66 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef SB_UTILITY_SPAN_HPP
+#define SB_UTILITY_SPAN_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/config.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C
+#include <cstddef>
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+    // Non-owning view of contiguous elements.
+    template<typename T>
+    class Span
+    {
+        public:
+            Span() = default;
+            Span(const T* begin, const T* end) : mBegin(begin), mEnd(end) {}
+
+            const T* begin() const {return mBegin;}
+            const T* end() const {return mEnd;}
+            size_t size() const {return mEnd - mBegin;}
+            bool empty() const {return mBegin == mEnd;}
+            const T& operator[](size_t i) const {return mBegin[i];}
+            const T& front() const {return *mBegin;}
+
+        private:
+            const T* mBegin = nullptr;
+            const T* mEnd = nullptr;
+    };
+}
+}
+
+#endif // SB_UTILITY_SPAN_HPP
@@ -0,0 +1,97 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef SB_UTILITY_SPSC_QUEUE_HPP
+#define SB_UTILITY_SPSC_QUEUE_HPP
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+    // Bounded queue between exactly one producer thread and one consumer
+    // thread. Pushing and popping only touch two atomic counters; the mutex
+    // is taken only when one side has to sleep, or has to wake the other.
+    template<typename T>
+    class SpscQueue
+    {
+        public:
+            // Capacity is rounded up to a power of two.
+            explicit SpscQueue(size_t capacity);
+            SpscQueue(const SpscQueue&) = delete;
+            SpscQueue& operator=(const SpscQueue&) = delete;
+
+            // Producer side. Blocks while the queue is full. Returns false,
+            // without pushing, once the queue is closed.
+            bool push(T&& value);
+            bool tryPush(T& value);
+
+            // Consumer side. Blocks while the queue is empty. Returns false
+            // once the queue is closed and every pushed element is popped.
+            bool pop(T& value);
+            bool tryPop(T& value);
+
+            // Wakes both sides. May be called from any thread.
+            void close();
+            bool isClosed() const;
+
+            size_t getSize() const;
+            size_t getCapacity() const;
+
+        private:
+            void notify();
+
+            template<typename Predicate>
+            void wait(Predicate isReady);
+
+        private:
+            static const size_t CACHE_LINE_SIZE = 64;
+
+            std::vector<T> mElements;
+            const size_t mMask;
+            char mPadding0[CACHE_LINE_SIZE];
+            std::atomic<size_t> mHead; // Written by the producer only.
+            char mPadding1[CACHE_LINE_SIZE];
+            std::atomic<size_t> mTail; // Written by the consumer only.
+            char mPadding2[CACHE_LINE_SIZE];
+            std::atomic<bool> mIsClosed;
+            std::atomic<size_t> mNumWaiting;
+            std::mutex mMutex;
+            std::condition_variable mChanged;
+    };
+}
+}
+
+#include "utility/SpscQueue.inl"
+
+#endif // SB_UTILITY_SPSC_QUEUE_HPP
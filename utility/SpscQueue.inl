@@ -0,0 +1,191 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// STD C++
+#include <utility>
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+///////////////////////////////////
+
+template<typename T>
+SpscQueue<T>::SpscQueue(size_t capacity)
+: mMask([capacity]()
+{
+    size_t powerOfTwo = 1;
+    while(powerOfTwo < capacity)
+        powerOfTwo <<= 1;
+
+    return powerOfTwo - 1;
+}())
+, mHead(0)
+, mTail(0)
+, mIsClosed(false)
+, mNumWaiting(0)
+{
+    mElements.resize(mMask + 1);
+}
+
+///////////////////////////////////
+
+template<typename T>
+bool SpscQueue<T>::push(T&& value)
+{
+    while(!tryPush(value))
+    {
+        if(mIsClosed)
+            return false;
+
+        wait([this]()
+        {
+            return mHead.load() - mTail.load() <= mMask || mIsClosed;
+        });
+    }
+
+    return true;
+}
+
+///////////////////////////////////
+
+template<typename T>
+bool SpscQueue<T>::tryPush(T& value)
+{
+    if(mIsClosed)
+        return false;
+
+    size_t head = mHead.load(std::memory_order_relaxed);
+    if(head - mTail.load(std::memory_order_acquire) > mMask)
+        return false;
+
+    mElements[head & mMask] = std::move(value);
+    mHead.store(head + 1);
+    notify();
+    return true;
+}
+
+///////////////////////////////////
+
+template<typename T>
+bool SpscQueue<T>::pop(T& value)
+{
+    while(!tryPop(value))
+    {
+        // Elements pushed before closing are still handed out.
+        if(mIsClosed && mHead.load() == mTail.load(std::memory_order_relaxed))
+            return false;
+
+        wait([this]()
+        {
+            return mHead.load() != mTail.load(std::memory_order_relaxed) || mIsClosed;
+        });
+    }
+
+    return true;
+}
+
+///////////////////////////////////
+
+template<typename T>
+bool SpscQueue<T>::tryPop(T& value)
+{
+    size_t tail = mTail.load(std::memory_order_relaxed);
+    if(mHead.load(std::memory_order_acquire) == tail)
+        return false;
+
+    value = std::move(mElements[tail & mMask]);
+    mTail.store(tail + 1);
+    notify();
+    return true;
+}
+
+///////////////////////////////////
+
+template<typename T>
+void SpscQueue<T>::close()
+{
+    mIsClosed = true;
+    std::lock_guard<std::mutex> lock(mMutex);
+    mChanged.notify_all();
+}
+
+///////////////////////////////////
+
+template<typename T>
+bool SpscQueue<T>::isClosed() const
+{
+    return mIsClosed;
+}
+
+///////////////////////////////////
+
+template<typename T>
+size_t SpscQueue<T>::getSize() const
+{
+    return mHead.load() - mTail.load();
+}
+
+///////////////////////////////////
+
+template<typename T>
+size_t SpscQueue<T>::getCapacity() const
+{
+    return mMask + 1;
+}
+
+///////////////////////////////////
+
+template<typename T>
+void SpscQueue<T>::notify()
+{
+    // The counter store before this and the increment in wait() are both
+    // sequentially consistent, so either the sleeper sees the new counter
+    // or this sees the sleeper. Locking makes sure it is already waiting.
+    if(mNumWaiting.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mChanged.notify_all();
+    }
+}
+
+///////////////////////////////////
+
+template<typename T>
+template<typename Predicate>
+void SpscQueue<T>::wait(Predicate isReady)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mNumWaiting++;
+    mChanged.wait(lock, isReady);
+    mNumWaiting--;
+}
+
+///////////////////////////////////
+}
+}
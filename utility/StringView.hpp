@@ -0,0 +1,106 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef SB_UTILITY_STRING_VIEW_HPP
+#define SB_UTILITY_STRING_VIEW_HPP
+
+///////////////////////////////////
+// STD C++
+#include <string>
+#include <ostream>
+#include <algorithm>
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C
+#include <cstring>
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+    // Non-owning view of a string. Converts implicitly to std::string, so
+    // that it can be handed to functions taking one.
+    class StringView
+    {
+        public:
+            static const size_t npos = std::string::npos;
+
+        public:
+            StringView() = default;
+            StringView(const char* data, size_t size) : mData(data), mSize(size) {}
+
+            const char* data() const {return mData;}
+            size_t size() const {return mSize;}
+            bool empty() const {return mSize == 0;}
+            const char* begin() const {return mData;}
+            const char* end() const {return mData + mSize;}
+            const char& operator[](size_t i) const {return mData[i];}
+
+            std::string str() const {return std::string(mData, mSize);}
+            operator std::string() const {return str();}
+
+            size_t find(const char* str) const
+            {
+                const size_t size = strlen(str);
+                const char* it = std::search(begin(), end(), str, str + size);
+                return it == end() && size != 0 ? npos : it - begin();
+            }
+
+            bool operator==(const StringView& other) const
+            {
+                return mSize == other.mSize && std::equal(begin(), end(), other.begin());
+            }
+
+            bool operator!=(const StringView& other) const
+            {
+                return !(*this == other);
+            }
+
+            bool operator==(const std::string& other) const
+            {
+                return *this == StringView(other.data(), other.size());
+            }
+
+            bool operator!=(const std::string& other) const
+            {
+                return !(*this == other);
+            }
+
+        private:
+            const char* mData = nullptr;
+            size_t mSize = 0;
+    };
+
+    inline std::ostream& operator<<(std::ostream& stream, const StringView& str)
+    {
+        return stream.write(str.data(), str.size());
+    }
+}
+}
+
+#endif // SB_UTILITY_STRING_VIEW_HPP
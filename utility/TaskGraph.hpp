@@ -0,0 +1,111 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef SB_UTILITY_TASK_GRAPH_HPP
+#define SB_UTILITY_TASK_GRAPH_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/config.hpp"
+namespace sb
+{
+namespace utility
+{
+    class WorkStealingPool;
+}
+}
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <exception>
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+    // Fixed set of tasks with dependencies between them, run as a whole as
+    // many times as needed. Each run starts every task once all of its
+    // dependencies have finished, on the threads of a WorkStealingPool.
+    class SHANK_BOT_UTILITY_DECLSPEC TaskGraph
+    {
+        public:
+            typedef size_t TaskId;
+
+        public:
+            explicit TaskGraph(WorkStealingPool& pool);
+            TaskGraph(const TaskGraph&) = delete;
+            TaskGraph& operator=(const TaskGraph&) = delete;
+
+            // Dependencies must already be added, which keeps the graph
+            // acyclic.
+            TaskId addTask(std::string name, std::function<void()> function, const std::vector<TaskId>& dependencies = {});
+
+            // Returns once every task has run. The calling thread runs tasks
+            // too. Once a task throws, the tasks not yet started are skipped,
+            // and the first exception is rethrown.
+            void run();
+
+            size_t getNumTasks() const;
+            const std::string& getName(TaskId id) const;
+
+            // How long the task took in the last run.
+            double getMicroseconds(TaskId id) const;
+
+        private:
+            struct Task
+            {
+                std::string name;
+                std::function<void()> function;
+                std::vector<TaskId> successors;
+                size_t numDependencies = 0;
+                std::atomic<size_t> numPendingDependencies;
+                double microseconds = 0.0;
+            };
+
+        private:
+            void schedule(Task& task);
+            void execute(Task& task);
+
+        private:
+            WorkStealingPool& mPool;
+            std::vector<std::unique_ptr<Task>> mTasks;
+            std::atomic<size_t> mNumRemainingTasks;
+            std::atomic<bool> mIsFailed;
+            std::mutex mErrorMutex;
+            std::exception_ptr mError;
+    };
+}
+}
+
+#endif // SB_UTILITY_TASK_GRAPH_HPP
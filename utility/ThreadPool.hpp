@@ -0,0 +1,85 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef SB_UTILITY_THREAD_POOL_HPP
+#define SB_UTILITY_THREAD_POOL_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/config.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+    // Fixed set of worker threads pulling tasks from one shared queue.
+    class SHANK_BOT_UTILITY_DECLSPEC ThreadPool
+    {
+        public:
+            // Zero means one thread per hardware thread.
+            explicit ThreadPool(size_t numThreads = 0);
+            ~ThreadPool();
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            // Exceptions thrown by the task are rethrown by the future.
+            std::future<void> push(std::function<void()> task);
+
+            // Splits [0, size) into ranges of at least grainSize elements and
+            // calls function(begin, end) for each of them. The calling thread
+            // runs one of the ranges itself. Returns when every range is done
+            // and rethrows the first exception, if any. Must not be called
+            // from a task running in this pool.
+            void parallelFor(size_t size, size_t grainSize, const std::function<void(size_t begin, size_t end)>& function);
+
+            size_t getNumThreads() const;
+
+        private:
+            void run();
+
+        private:
+            std::vector<std::thread> mThreads;
+            std::queue<std::packaged_task<void()>> mTasks;
+            std::mutex mMutex;
+            std::condition_variable mTaskAvailable;
+            bool mIsStopping = false;
+    };
+}
+}
+
+#endif // SB_UTILITY_THREAD_POOL_HPP
@@ -0,0 +1,104 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef SB_UTILITY_WORK_STEALING_POOL_HPP
+#define SB_UTILITY_WORK_STEALING_POOL_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/config.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+    // Worker threads with a task deque each. A worker pushes and pops its
+    // own tasks at the back, so that a task's follow-ups run while its data
+    // is still in cache, and steals from the front of the others' deques
+    // when it runs dry. Tasks pushed from outside the pool go to a deque of
+    // their own, which helpUntil() works on too.
+    class SHANK_BOT_UTILITY_DECLSPEC WorkStealingPool
+    {
+        public:
+            // Zero means one thread per hardware thread, minus the thread
+            // expected to call helpUntil().
+            explicit WorkStealingPool(size_t numThreads = 0);
+            ~WorkStealingPool();
+            WorkStealingPool(const WorkStealingPool&) = delete;
+            WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+            // Tasks must not throw.
+            void push(std::function<void()> task);
+
+            // Runs tasks on the calling thread until isDone() returns true.
+            // Whatever makes it true has to call wake() afterwards.
+            void helpUntil(const std::function<bool()>& isDone);
+            void wake();
+
+            size_t getNumThreads() const;
+            size_t getNumSteals() const;
+
+        private:
+            struct Queue
+            {
+                std::mutex mutex;
+                std::deque<std::function<void()>> tasks;
+            };
+
+        private:
+            void run(size_t queueIndex);
+            bool popOrSteal(size_t queueIndex, std::function<void()>& task);
+            size_t getQueueIndex() const;
+
+        private:
+            // The last queue is for threads outside of the pool.
+            std::vector<std::unique_ptr<Queue>> mQueues;
+            std::vector<std::thread> mThreads;
+
+            std::atomic<size_t> mNumQueued;
+            std::atomic<size_t> mNumSleeping;
+            std::atomic<size_t> mNumSteals;
+            std::mutex mSleepMutex;
+            std::condition_variable mWake;
+            bool mIsStopping = false;
+    };
+}
+}
+
+#endif // SB_UTILITY_WORK_STEALING_POOL_HPP
@@ -0,0 +1,62 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+#ifndef SB_UTILITY_SIMD_HPP
+#define SB_UTILITY_SIMD_HPP
+
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/config.hpp"
+///////////////////////////////////
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    #define SB_UTILITY_X86_SIMD
+#endif
+
+namespace sb
+{
+namespace utility
+{
+    enum class SimdLevel : unsigned char
+    {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    // Highest instruction set supported by the CPU.
+    SHANK_BOT_UTILITY_DECLSPEC SimdLevel getSupportedSimdLevel();
+
+    // Instruction set the vectorized utility functions dispatch to. Defaults
+    // to the supported level. Setting a lower one is mostly useful for
+    // comparing kernels; levels above the supported one are clamped.
+    SHANK_BOT_UTILITY_DECLSPEC SimdLevel getSimdLevel();
+    SHANK_BOT_UTILITY_DECLSPEC void setSimdLevel(SimdLevel level);
+}
+}
+
+
+#endif // SB_UTILITY_SIMD_HPP
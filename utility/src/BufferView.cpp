@@ -0,0 +1,84 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/BufferView.hpp"
+#include "utility/utility.hpp"
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+///////////////////////////////////
+
+BufferView::BufferView(const char* data, size_t size)
+: data(data)
+, size(size)
+{
+}
+
+size_t BufferView::tellg() const
+{
+    return curr;
+}
+
+BufferView& BufferView::seekg(std::streampos pos)
+{
+    return seekg(pos, beg);
+}
+
+BufferView& BufferView::seekg(std::streampos off, std::ios_base::seekdir way)
+{
+    using W = std::ios_base;
+    size_t pos;
+    switch(way)
+    {
+        case W::beg:
+            pos = off;
+            break;
+        case W::cur:
+            pos = curr + off;
+            break;
+        case W::end:
+            pos = size + off;
+            break;
+
+        default:
+            SB_THROW("Unimplemented seekg.");
+    }
+
+    if(pos > size)
+        SB_THROW("Seek to ", pos, " is past the end of the ", size, " byte buffer.");
+
+    curr = pos;
+    return *this;
+}
+
+void BufferView::throwReadPastEnd(size_t numBytes) const
+{
+    SB_THROW("Read of ", numBytes, " bytes at position ", curr, " is past the end of the ", size, " byte buffer.");
+}
@@ -0,0 +1,146 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/MappedFile.hpp"
+#include "utility/utility.hpp"
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+#endif // _WIN32
+///////////////////////////////////
+
+///////////////////////////////////
+// Windows
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif // _WIN32
+///////////////////////////////////
+
+MappedFile::MappedFile(const std::string& path)
+: mPath(path)
+{
+    #if defined(_WIN32)
+    mFile = CreateFile(mPath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(mFile == INVALID_HANDLE_VALUE)
+        SB_THROW("Could not open file '", mPath, "' (", GetLastError(), ").");
+
+    LARGE_INTEGER size;
+    if(GetFileSizeEx(mFile, &size) == 0)
+    {
+        DWORD error = GetLastError();
+        CloseHandle(mFile);
+        SB_THROW("Could not get size of file '", mPath, "' (", error, ").");
+    }
+    mSize = size.QuadPart;
+
+    if(mSize == 0)
+        return;
+
+    mMapping = CreateFileMapping(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(mMapping == NULL)
+    {
+        DWORD error = GetLastError();
+        CloseHandle(mFile);
+        SB_THROW("Could not create file mapping of '", mPath, "' (", error, ").");
+    }
+
+    mData = (const char*)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+    if(mData == NULL)
+    {
+        DWORD error = GetLastError();
+        CloseHandle(mMapping);
+        CloseHandle(mFile);
+        SB_THROW("Could not map file '", mPath, "' (", error, ").");
+    }
+    #else
+    mFd = open(mPath.c_str(), O_RDONLY);
+    if(mFd == -1)
+        SB_THROW("Could not open file '", mPath, "' (", strerror(errno), ").");
+
+    struct stat s;
+    if(fstat(mFd, &s) == -1)
+    {
+        int error = errno;
+        close(mFd);
+        SB_THROW("Could not get size of file '", mPath, "' (", strerror(error), ").");
+    }
+    mSize = s.st_size;
+
+    if(mSize == 0)
+        return;
+
+    void* data = mmap(nullptr, mSize, PROT_READ, MAP_SHARED, mFd, 0);
+    if(data == MAP_FAILED)
+    {
+        int error = errno;
+        close(mFd);
+        SB_THROW("Could not map file '", mPath, "' (", strerror(error), ").");
+    }
+    mData = (const char*)data;
+    #endif // defined
+}
+
+MappedFile::~MappedFile()
+{
+    #if defined(_WIN32)
+    if(mData != nullptr)
+        UnmapViewOfFile(mData);
+    if(mMapping != nullptr)
+        CloseHandle(mMapping);
+    CloseHandle(mFile);
+    #else
+    if(mData != nullptr)
+        munmap((void*)mData, mSize);
+    close(mFd);
+    #endif // defined
+}
+
+const char* MappedFile::getData() const
+{
+    return mData;
+}
+
+size_t MappedFile::getSize() const
+{
+    return mSize;
+}
+
+const std::string& MappedFile::getPath() const
+{
+    return mPath;
+}
@@ -0,0 +1,118 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/MonotonicArena.hpp"
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <algorithm>
+#include <cassert>
+///////////////////////////////////
+
+MonotonicArena::MonotonicArena(size_t chunkSize)
+: mChunkSize(std::max<size_t>(chunkSize, 1))
+{
+}
+
+MonotonicArena::~MonotonicArena()
+{
+    for(const Chunk& chunk : mChunks)
+        delete[] chunk.data;
+}
+
+void* MonotonicArena::allocate(size_t size, size_t alignment)
+{
+    assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+    size_t padding = -size_t(mCurrent) & (alignment - 1);
+    if(mCurrent == nullptr || size + padding > size_t(mEnd - mCurrent))
+    {
+        addChunk(size + alignment);
+        padding = -size_t(mCurrent) & (alignment - 1);
+    }
+
+    char* data = mCurrent + padding;
+    mCurrent = data + size;
+    mNumBytesUsed += size + padding;
+    return data;
+}
+
+void MonotonicArena::reset()
+{
+    if(mChunks.size() > 1)
+    {
+        size_t totalSize = 0;
+        for(const Chunk& chunk : mChunks)
+        {
+            totalSize += chunk.size;
+            delete[] chunk.data;
+        }
+        mChunks.clear();
+        mChunkSize = std::max(mChunkSize, totalSize);
+        addChunk(totalSize);
+    }
+
+    if(!mChunks.empty())
+    {
+        mCurrent = mChunks.back().data;
+        mEnd = mCurrent + mChunks.back().size;
+    }
+    mNumBytesUsed = 0;
+}
+
+void MonotonicArena::addChunk(size_t minSize)
+{
+    Chunk chunk;
+    chunk.size = std::max(mChunkSize, minSize);
+    chunk.data = new char[chunk.size];
+    mChunks.push_back(chunk);
+    mNumChunkAllocations++;
+
+    mCurrent = chunk.data;
+    mEnd = chunk.data + chunk.size;
+}
+
+size_t MonotonicArena::getNumBytesUsed() const
+{
+    return mNumBytesUsed;
+}
+
+size_t MonotonicArena::getNumBytesReserved() const
+{
+    size_t size = 0;
+    for(const Chunk& chunk : mChunks)
+        size += chunk.size;
+
+    return size;
+}
+
+size_t MonotonicArena::getNumChunkAllocations() const
+{
+    return mNumChunkAllocations;
+}
@@ -0,0 +1,154 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/SharedMemory.hpp"
+#include "utility/utility.hpp"
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+#endif // _WIN32
+///////////////////////////////////
+
+///////////////////////////////////
+// Windows
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif // _WIN32
+///////////////////////////////////
+
+SharedMemory::SharedMemory(const std::string& name, size_t size, Mode mode)
+: mName(name)
+, mSize(size)
+, mMode(mode)
+{
+    #if defined(_WIN32)
+    if(mMode == Mode::CREATE)
+    {
+        mHandle = CreateFileMapping
+        (
+            INVALID_HANDLE_VALUE,   // use paging file
+            NULL,                   // default security
+            PAGE_READWRITE,         // read/write access
+            0,                      // maximum object size (high-order DWORD)
+            mSize,                  // maximum object size (low-order DWORD)
+            mName.c_str()           // name of mapping object
+        );
+    }
+    else
+    {
+        mHandle = OpenFileMapping(FILE_MAP_ALL_ACCESS, FALSE, mName.c_str());
+    }
+
+    if(mHandle == NULL)
+        SB_THROW("Could not ", mMode == Mode::CREATE ? "create" : "open", " shared memory object '", mName, "' (", GetLastError(), ").");
+
+    mData = MapViewOfFile(mHandle, FILE_MAP_ALL_ACCESS, 0, 0, mSize);
+    if(mData == NULL)
+    {
+        DWORD error = GetLastError();
+        CloseHandle(mHandle);
+        SB_THROW("Could not map shared memory '", mName, "' (", error, ").");
+    }
+    #else
+    if(mMode == Mode::CREATE)
+        mFd = shm_open(mName.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    else
+        mFd = shm_open(mName.c_str(), O_RDWR, 0);
+
+    if(mFd == -1)
+        SB_THROW("Could not ", mMode == Mode::CREATE ? "create" : "open", " shared memory object '", mName, "' (", strerror(errno), ").");
+
+    if(mMode == Mode::CREATE && ftruncate(mFd, mSize) == -1)
+    {
+        int error = errno;
+        close(mFd);
+        shm_unlink(mName.c_str());
+        SB_THROW("Could not set size of shared memory '", mName, "' (", strerror(error), ").");
+    }
+
+    mData = mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+    if(mData == MAP_FAILED)
+    {
+        int error = errno;
+        close(mFd);
+        if(mMode == Mode::CREATE)
+            shm_unlink(mName.c_str());
+        SB_THROW("Could not map shared memory '", mName, "' (", strerror(error), ").");
+    }
+    #endif // defined
+}
+
+SharedMemory::~SharedMemory()
+{
+    #if defined(_WIN32)
+    UnmapViewOfFile(mData);
+    CloseHandle(mHandle);
+    #else
+    munmap(mData, mSize);
+    close(mFd);
+    if(mMode == Mode::CREATE)
+        shm_unlink(mName.c_str());
+    #endif // defined
+}
+
+void* SharedMemory::getData() const
+{
+    return mData;
+}
+
+size_t SharedMemory::getSize() const
+{
+    return mSize;
+}
+
+const std::string& SharedMemory::getName() const
+{
+    return mName;
+}
+
+std::string SharedMemory::generateName(size_t length)
+{
+    #if defined(_WIN32)
+    std::string prefix = "Local\\";
+    #else
+    std::string prefix = "/";
+    #endif // defined
+
+    SB_EXPECT(length, >, prefix.size());
+    return prefix + randStr(length - prefix.size());
+}
@@ -0,0 +1,146 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/TaskGraph.hpp"
+#include "utility/WorkStealingPool.hpp"
+#include "utility/utility.hpp"
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <chrono>
+///////////////////////////////////
+
+TaskGraph::TaskGraph(WorkStealingPool& pool)
+: mPool(pool)
+, mNumRemainingTasks(0)
+, mIsFailed(false)
+{
+
+}
+
+TaskGraph::TaskId TaskGraph::addTask(std::string name, std::function<void()> function, const std::vector<TaskId>& dependencies)
+{
+    const TaskId id = mTasks.size();
+    std::unique_ptr<Task> task(new Task());
+    task->name = name;
+    task->function = function;
+    task->numDependencies = dependencies.size();
+    for(TaskId dependency : dependencies)
+    {
+        SB_EXPECT(dependency, <, id);
+        mTasks[dependency]->successors.push_back(id);
+    }
+
+    mTasks.push_back(std::move(task));
+    return id;
+}
+
+void TaskGraph::run()
+{
+    if(mTasks.empty())
+        return;
+
+    for(const std::unique_ptr<Task>& task : mTasks)
+        task->numPendingDependencies = task->numDependencies;
+
+    mNumRemainingTasks = mTasks.size();
+    mIsFailed = false;
+    mError = nullptr;
+    for(const std::unique_ptr<Task>& task : mTasks)
+        if(task->numDependencies == 0)
+            schedule(*task);
+
+    mPool.helpUntil([this]()
+    {
+        return mNumRemainingTasks == 0;
+    });
+
+    if(mError)
+        std::rethrow_exception(mError);
+}
+
+size_t TaskGraph::getNumTasks() const
+{
+    return mTasks.size();
+}
+
+const std::string& TaskGraph::getName(TaskId id) const
+{
+    return mTasks.at(id)->name;
+}
+
+double TaskGraph::getMicroseconds(TaskId id) const
+{
+    return mTasks.at(id)->microseconds;
+}
+
+void TaskGraph::schedule(Task& task)
+{
+    mPool.push([this, &task]()
+    {
+        execute(task);
+    });
+}
+
+void TaskGraph::execute(Task& task)
+{
+    typedef std::chrono::steady_clock Clock;
+    task.microseconds = 0.0;
+    if(!mIsFailed)
+    {
+        Clock::time_point start = Clock::now();
+        try
+        {
+            task.function();
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(mErrorMutex);
+            if(!mError)
+                mError = std::current_exception();
+
+            mIsFailed = true;
+        }
+        task.microseconds = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+
+    for(TaskId id : task.successors)
+    {
+        Task& successor = *mTasks[id];
+        if(--successor.numPendingDependencies == 0)
+            schedule(successor);
+    }
+
+    // Nothing of this graph may be touched after the last task is counted,
+    // since run() may return right away.
+    WorkStealingPool& pool = mPool;
+    if(--mNumRemainingTasks == 0)
+        pool.wake();
+}
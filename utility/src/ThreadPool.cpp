@@ -0,0 +1,146 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/ThreadPool.hpp"
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <algorithm>
+///////////////////////////////////
+
+ThreadPool::ThreadPool(size_t numThreads)
+{
+    if(numThreads == 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    for(size_t i = 0; i < numThreads; i++)
+        mThreads.emplace_back(&ThreadPool::run, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsStopping = true;
+    }
+    mTaskAvailable.notify_all();
+
+    for(std::thread& thread : mThreads)
+        thread.join();
+}
+
+std::future<void> ThreadPool::push(std::function<void()> task)
+{
+    std::packaged_task<void()> packagedTask(std::move(task));
+    std::future<void> future = packagedTask.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTasks.push(std::move(packagedTask));
+    }
+    mTaskAvailable.notify_one();
+
+    return future;
+}
+
+void ThreadPool::parallelFor(size_t size, size_t grainSize, const std::function<void(size_t begin, size_t end)>& function)
+{
+    if(size == 0)
+        return;
+
+    grainSize = std::max<size_t>(grainSize, 1);
+    const size_t numRanges = std::min((size + grainSize - 1) / grainSize, mThreads.size() + 1);
+    const size_t rangeSize = (size + numRanges - 1) / numRanges;
+
+    std::vector<std::future<void>> futures;
+    for(size_t begin = rangeSize; begin < size; begin += rangeSize)
+    {
+        const size_t end = std::min(begin + rangeSize, size);
+        futures.push_back(push([&function, begin, end]()
+        {
+            function(begin, end);
+        }));
+    }
+
+    // Every future has to be waited for before rethrowing, since the tasks
+    // reference function.
+    std::exception_ptr exception;
+    try
+    {
+        function(0, std::min(rangeSize, size));
+    }
+    catch(...)
+    {
+        exception = std::current_exception();
+    }
+
+    for(std::future<void>& future : futures)
+    {
+        try
+        {
+            future.get();
+        }
+        catch(...)
+        {
+            if(!exception)
+                exception = std::current_exception();
+        }
+    }
+
+    if(exception)
+        std::rethrow_exception(exception);
+}
+
+size_t ThreadPool::getNumThreads() const
+{
+    return mThreads.size();
+}
+
+void ThreadPool::run()
+{
+    while(true)
+    {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mTaskAvailable.wait(lock, [this]()
+            {
+                return mIsStopping || !mTasks.empty();
+            });
+
+            if(mTasks.empty())
+                return;
+
+            task = std::move(mTasks.front());
+            mTasks.pop();
+        }
+
+        task();
+    }
+}
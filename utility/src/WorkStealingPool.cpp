@@ -0,0 +1,194 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/WorkStealingPool.hpp"
+using namespace sb::utility;
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <algorithm>
+///////////////////////////////////
+
+namespace
+{
+    // Which pool the current thread works for, and on which queue.
+    thread_local const WorkStealingPool* currentPool = nullptr;
+    thread_local size_t currentQueueIndex = 0;
+}
+
+WorkStealingPool::WorkStealingPool(size_t numThreads)
+: mNumQueued(0)
+, mNumSleeping(0)
+, mNumSteals(0)
+{
+    if(numThreads == 0)
+        numThreads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+    for(size_t i = 0; i < numThreads + 1; i++)
+        mQueues.emplace_back(new Queue());
+
+    for(size_t i = 0; i < numThreads; i++)
+        mThreads.emplace_back(&WorkStealingPool::run, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mIsStopping = true;
+    }
+    mWake.notify_all();
+
+    for(std::thread& thread : mThreads)
+        thread.join();
+}
+
+void WorkStealingPool::push(std::function<void()> task)
+{
+    // Counted first, so that the count never drops below the number of
+    // tasks in the queues. Same handshake as in SpscQueue: either a sleeper
+    // sees the new count, or this sees the sleeper.
+    mNumQueued++;
+    Queue& queue = *mQueues[getQueueIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    if(mNumSleeping > 0)
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mWake.notify_one();
+    }
+}
+
+void WorkStealingPool::helpUntil(const std::function<bool()>& isDone)
+{
+    const size_t queueIndex = getQueueIndex();
+    std::function<void()> task;
+    while(!isDone())
+    {
+        if(popOrSteal(queueIndex, task))
+        {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mNumSleeping++;
+        mWake.wait(lock, [this, &isDone]()
+        {
+            return mNumQueued > 0 || isDone();
+        });
+        mNumSleeping--;
+    }
+}
+
+void WorkStealingPool::wake()
+{
+    std::lock_guard<std::mutex> lock(mSleepMutex);
+    mWake.notify_all();
+}
+
+size_t WorkStealingPool::getNumThreads() const
+{
+    return mThreads.size();
+}
+
+size_t WorkStealingPool::getNumSteals() const
+{
+    return mNumSteals;
+}
+
+void WorkStealingPool::run(size_t queueIndex)
+{
+    currentPool = this;
+    currentQueueIndex = queueIndex;
+
+    std::function<void()> task;
+    while(true)
+    {
+        if(popOrSteal(queueIndex, task))
+        {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mNumSleeping++;
+        mWake.wait(lock, [this]()
+        {
+            return mNumQueued > 0 || mIsStopping;
+        });
+        mNumSleeping--;
+        if(mIsStopping && mNumQueued == 0)
+            return;
+    }
+}
+
+bool WorkStealingPool::popOrSteal(size_t queueIndex, std::function<void()>& task)
+{
+    if(mNumQueued == 0)
+        return false;
+
+    {
+        Queue& queue = *mQueues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            mNumQueued--;
+            return true;
+        }
+    }
+
+    for(size_t i = 1; i < mQueues.size(); i++)
+    {
+        Queue& queue = *mQueues[(queueIndex + i) % mQueues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            mNumQueued--;
+            mNumSteals++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t WorkStealingPool::getQueueIndex() const
+{
+    return currentPool == this ? currentQueueIndex : mQueues.size() - 1;
+}
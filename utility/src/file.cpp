@@ -398,6 +398,7 @@ void renameFile(std::string path, std::string newName)
 
 uint64_t getFileModifiedTime(const std::string& file)
 {
+    #if defined(_WIN32)
     HANDLE hFile = CreateFile(file.c_str(),               // file to open
                        GENERIC_READ,          // open for reading
                        FILE_SHARE_READ,       // share for reading
@@ -416,6 +417,15 @@ uint64_t getFileModifiedTime(const std::string& file)
     CloseHandle(hFile);
 
     return modified;
+    #else
+    struct stat st = {0};
+    if(stat(file.c_str(), &st) == -1)
+        SB_THROW("Failed to get file time.");
+
+    // Only compared with other modified times, so the unit differs from
+    // the one of FILETIME.
+    return uint64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    #endif // defined
 }
 
 
@@ -0,0 +1,93 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/simd.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <atomic>
+///////////////////////////////////
+
+namespace sb
+{
+namespace utility
+{
+
+namespace
+{
+    SimdLevel detectSimdLevel()
+    {
+    #if defined(SB_UTILITY_X86_SIMD)
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2"))
+            return SimdLevel::AVX2;
+
+        if(__builtin_cpu_supports("sse2"))
+            return SimdLevel::SSE2;
+    #endif
+
+        return SimdLevel::SCALAR;
+    }
+
+    std::atomic<SimdLevel>& getSelectedSimdLevel()
+    {
+        static std::atomic<SimdLevel> level(getSupportedSimdLevel());
+        return level;
+    }
+}
+
+///////////////////////////////////
+
+SimdLevel getSupportedSimdLevel()
+{
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+///////////////////////////////////
+
+SimdLevel getSimdLevel()
+{
+    return getSelectedSimdLevel().load(std::memory_order_relaxed);
+}
+
+///////////////////////////////////
+
+void setSimdLevel(SimdLevel level)
+{
+    if(level > getSupportedSimdLevel())
+        level = getSupportedSimdLevel();
+
+    getSelectedSimdLevel().store(level, std::memory_order_relaxed);
+}
+
+///////////////////////////////////
+
+}
+}
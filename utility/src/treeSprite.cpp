@@ -0,0 +1,452 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/utility.hpp"
+#include "utility/simd.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <cstring>
+///////////////////////////////////
+
+#if defined(SB_UTILITY_X86_SIMD)
+///////////////////////////////////
+// Intrinsics
+#include <immintrin.h>
+///////////////////////////////////
+#endif
+
+namespace sb
+{
+namespace utility
+{
+
+namespace
+{
+    // The kernels may store up to this many bytes past the end of their output.
+    const size_t SLACK = 32;
+    const unsigned char OPAQUE = 255;
+
+    ///////////////////////////////////
+
+    template<bool IS_BGRA>
+    inline unsigned char* appendColor(const unsigned char* pixel, unsigned char* out)
+    {
+        out[0] = pixel[IS_BGRA ? 2 : 0];
+        out[1] = pixel[1];
+        out[2] = pixel[IS_BGRA ? 0 : 2];
+        return out + 3;
+    }
+
+    // Same encoding as compressSmallEndianMultiByteValue: the lowest byte,
+    // followed by the next bytes up to the first zero byte.
+    inline unsigned char* appendValue(size_t value, unsigned char* out)
+    {
+        *out++ = value & 0xff;
+        for(size_t j = 1; j < sizeof(size_t); j++)
+        {
+            unsigned char byte = (value >> (8 * j)) & 0xff;
+            if(byte == 0)
+                break;
+
+            *out++ = byte;
+        }
+
+        return out;
+    }
+
+    ///////////////////////////////////
+
+    template<bool IS_BGRA>
+    unsigned char* colorScalar(const unsigned char* pixels, size_t begin, size_t end, unsigned char* out)
+    {
+        for(size_t p = begin; p < end; p++)
+        {
+            const unsigned char* pixel = pixels + p * BYTES_PER_PIXEL_RGBA;
+            if(pixel[3] == OPAQUE)
+                out = appendColor<IS_BGRA>(pixel, out);
+        }
+
+        return out;
+    }
+
+    // Strip offsets are counted from firstPixel, the index of pixels[0] in
+    // the whole sprite.
+    unsigned char* transparencyScalar(const unsigned char* pixels, size_t begin, size_t end, size_t firstPixel, size_t& stripSize, unsigned char* out)
+    {
+        for(size_t p = begin; p < end; p++)
+        {
+            if(pixels[p * BYTES_PER_PIXEL_RGBA + 3] == OPAQUE)
+            {
+                if(stripSize == 0)
+                    out = appendValue((firstPixel + p) * BYTES_PER_PIXEL_RGBA, out);
+
+                stripSize++;
+            }
+            else if(stripSize > 0)
+            {
+                out = appendValue(stripSize, out);
+                stripSize = 0;
+            }
+        }
+
+        return out;
+    }
+
+#if defined(SB_UTILITY_X86_SIMD)
+    ///////////////////////////////////
+
+    // The masks below come from _mm_movemask_epi8 on an alpha comparison, so
+    // pixel k of a block is opaque if bit 4 * k + 3 is set.
+
+    template<bool IS_BGRA>
+    inline unsigned char* appendColors(const unsigned char* pixels, unsigned int mask, size_t numPixels, unsigned char* out)
+    {
+        for(size_t k = 0; k < numPixels; k++)
+            if(mask & (8u << (4 * k)))
+                out = appendColor<IS_BGRA>(pixels + k * BYTES_PER_PIXEL_RGBA, out);
+
+        return out;
+    }
+
+    inline unsigned char* appendStrips(size_t firstPixel, unsigned int mask, size_t numPixels, size_t& stripSize, unsigned char* out)
+    {
+        for(size_t k = 0; k < numPixels; k++)
+        {
+            if(mask & (8u << (4 * k)))
+            {
+                if(stripSize == 0)
+                    out = appendValue((firstPixel + k) * BYTES_PER_PIXEL_RGBA, out);
+
+                stripSize++;
+            }
+            else if(stripSize > 0)
+            {
+                out = appendValue(stripSize, out);
+                stripSize = 0;
+            }
+        }
+
+        return out;
+    }
+
+    // Writes 3 bytes per pixel through 4 byte stores, so one byte of slack is needed.
+    template<bool IS_BGRA>
+    inline unsigned char* appendOpaqueColors(const unsigned char* pixels, size_t numPixels, unsigned char* out)
+    {
+        for(size_t k = 0; k < numPixels; k++)
+        {
+            uint32_t pixel;
+            memcpy(&pixel, pixels + k * BYTES_PER_PIXEL_RGBA, sizeof(pixel));
+            if(IS_BGRA)
+                pixel = (pixel & 0xff00ff00) | ((pixel >> 16) & 0xff) | ((pixel & 0xff) << 16);
+
+            memcpy(out, &pixel, sizeof(pixel));
+            out += 3;
+        }
+
+        return out;
+    }
+
+    ///////////////////////////////////
+
+    template<bool IS_BGRA>
+    __attribute__((target("sse2")))
+    unsigned char* colorSse2(const unsigned char* pixels, size_t numPixels, unsigned char* out)
+    {
+        const unsigned int ALL_OPAQUE = 0x8888;
+        const __m128i opaque = _mm_set1_epi8(char(OPAQUE));
+        size_t p = 0;
+        for(; p + 4 <= numPixels; p += 4)
+        {
+            const unsigned char* block = pixels + p * BYTES_PER_PIXEL_RGBA;
+            __m128i v = _mm_loadu_si128((const __m128i*)block);
+            unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, opaque)) & ALL_OPAQUE;
+            if(mask == 0)
+                continue;
+
+            if(mask == ALL_OPAQUE)
+                out = appendOpaqueColors<IS_BGRA>(block, 4, out);
+            else
+                out = appendColors<IS_BGRA>(block, mask, 4, out);
+        }
+
+        return colorScalar<IS_BGRA>(pixels, p, numPixels, out);
+    }
+
+    __attribute__((target("sse2")))
+    unsigned char* transparencySse2(const unsigned char* pixels, size_t numPixels, size_t firstPixel, size_t& stripSize, unsigned char* out)
+    {
+        const unsigned int ALL_OPAQUE = 0x8888;
+        const __m128i opaque = _mm_set1_epi8(char(OPAQUE));
+        size_t p = 0;
+        for(; p + 4 <= numPixels; p += 4)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(pixels + p * BYTES_PER_PIXEL_RGBA));
+            unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, opaque)) & ALL_OPAQUE;
+            if(mask == ALL_OPAQUE && stripSize > 0)
+                stripSize += 4;
+            else if(mask != 0 || stripSize > 0)
+                out = appendStrips(firstPixel + p, mask, 4, stripSize, out);
+        }
+
+        return transparencyScalar(pixels, p, numPixels, firstPixel, stripSize, out);
+    }
+
+    ///////////////////////////////////
+
+    template<bool IS_BGRA>
+    __attribute__((target("avx2")))
+    unsigned char* colorAvx2(const unsigned char* pixels, size_t numPixels, unsigned char* out)
+    {
+        const unsigned int ALL_OPAQUE = 0x88888888;
+        const __m256i opaque = _mm256_set1_epi8(char(OPAQUE));
+
+        // Packs the color channels of the four pixels of each lane into its
+        // lowest 12 bytes.
+        const __m256i packColors = IS_BGRA ?
+            _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                             2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1) :
+            _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                             0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+        size_t p = 0;
+        for(; p + 8 <= numPixels; p += 8)
+        {
+            const unsigned char* block = pixels + p * BYTES_PER_PIXEL_RGBA;
+            __m256i v = _mm256_loadu_si256((const __m256i*)block);
+            unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, opaque)) & ALL_OPAQUE;
+            if(mask == 0)
+                continue;
+
+            if(mask == ALL_OPAQUE)
+            {
+                __m256i colors = _mm256_shuffle_epi8(v, packColors);
+                _mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(colors));
+                _mm_storeu_si128((__m128i*)(out + 12), _mm256_extracti128_si256(colors, 1));
+                out += 24;
+            }
+            else
+                out = appendColors<IS_BGRA>(block, mask, 8, out);
+        }
+
+        return colorScalar<IS_BGRA>(pixels, p, numPixels, out);
+    }
+
+    __attribute__((target("avx2")))
+    unsigned char* transparencyAvx2(const unsigned char* pixels, size_t numPixels, size_t firstPixel, size_t& stripSize, unsigned char* out)
+    {
+        const unsigned int ALL_OPAQUE = 0x88888888;
+        const __m256i opaque = _mm256_set1_epi8(char(OPAQUE));
+        size_t p = 0;
+        for(; p + 8 <= numPixels; p += 8)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(pixels + p * BYTES_PER_PIXEL_RGBA));
+            unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, opaque)) & ALL_OPAQUE;
+            if(mask == ALL_OPAQUE && stripSize > 0)
+                stripSize += 8;
+            else if(mask != 0 || stripSize > 0)
+                out = appendStrips(firstPixel + p, mask, 8, stripSize, out);
+        }
+
+        return transparencyScalar(pixels, p, numPixels, firstPixel, stripSize, out);
+    }
+#endif // defined(SB_UTILITY_X86_SIMD)
+
+    ///////////////////////////////////
+
+    unsigned char* beginTreeSprite(std::vector<size_t>& sprite, size_t maxSize, size_t width, size_t height)
+    {
+        const size_t numValues = (maxSize + SLACK + sizeof(size_t) - 1) / sizeof(size_t);
+        if(sprite.size() < numValues)
+            sprite.resize(numValues);
+
+        unsigned char* bytes = (unsigned char*)sprite.data();
+        bytes[0] = width;
+        bytes[1] = height;
+        return bytes + 2;
+    }
+
+    // Zero pads and trims the sprite the same way packBytes does.
+    void endTreeSprite(std::vector<size_t>& sprite, const unsigned char* end, bool* isBlank)
+    {
+        unsigned char* bytes = (unsigned char*)sprite.data();
+        const size_t size = end - bytes;
+        const size_t numValues = (size + sizeof(size_t) - 1) / sizeof(size_t);
+        memset(bytes + size, 0, numValues * sizeof(size_t) - size);
+        sprite.resize(numValues);
+
+        if(isBlank)
+            *isBlank = (size == 2);
+    }
+
+    template<bool IS_BGRA>
+    unsigned char* color(const unsigned char* pixels, size_t numPixels, unsigned char* out)
+    {
+        switch(getSimdLevel())
+        {
+        #if defined(SB_UTILITY_X86_SIMD)
+            case SimdLevel::AVX2:
+                return colorAvx2<IS_BGRA>(pixels, numPixels, out);
+
+            case SimdLevel::SSE2:
+                return colorSse2<IS_BGRA>(pixels, numPixels, out);
+        #endif
+
+            default:
+                return colorScalar<IS_BGRA>(pixels, 0, numPixels, out);
+        }
+    }
+
+    unsigned char* transparency(const unsigned char* pixels, size_t numPixels, size_t firstPixel, size_t& stripSize, unsigned char* out)
+    {
+        switch(getSimdLevel())
+        {
+        #if defined(SB_UTILITY_X86_SIMD)
+            case SimdLevel::AVX2:
+                return transparencyAvx2(pixels, numPixels, firstPixel, stripSize, out);
+
+            case SimdLevel::SSE2:
+                return transparencySse2(pixels, numPixels, firstPixel, stripSize, out);
+        #endif
+
+            default:
+                return transparencyScalar(pixels, 0, numPixels, firstPixel, stripSize, out);
+        }
+    }
+
+    // Rows of a sprite without padding between them are handled as one.
+    inline bool isContiguous(size_t width, size_t height, size_t stride)
+    {
+        return height <= 1 || stride == width * BYTES_PER_PIXEL_RGBA;
+    }
+
+    template<bool IS_BGRA>
+    void toColorTreeSprite(const unsigned char* pixels, size_t width, size_t height, size_t stride, std::vector<size_t>& sprite, bool* isBlank)
+    {
+        const size_t numPixels = width * height;
+        unsigned char* out = beginTreeSprite(sprite, 2 + numPixels * 3, width, height);
+        if(isContiguous(width, height, stride))
+            out = color<IS_BGRA>(pixels, numPixels, out);
+        else
+            for(size_t y = 0; y < height; y++)
+                out = color<IS_BGRA>(pixels + y * stride, width, out);
+
+        endTreeSprite(sprite, out, isBlank);
+    }
+}
+
+///////////////////////////////////
+
+void rgbaToColorTreeSprite(const unsigned char* rgba, size_t width, size_t height, std::vector<size_t>& sprite, bool* isBlank)
+{
+    toColorTreeSprite<false>(rgba, width, height, width * BYTES_PER_PIXEL_RGBA, sprite, isBlank);
+}
+
+///////////////////////////////////
+
+void rgbaToColorTreeSprite(const unsigned char* rgba, size_t width, size_t height, size_t stride, std::vector<size_t>& sprite, bool* isBlank)
+{
+    toColorTreeSprite<false>(rgba, width, height, stride, sprite, isBlank);
+}
+
+///////////////////////////////////
+
+void bgraToColorTreeSprite(const unsigned char* bgra, size_t width, size_t height, std::vector<size_t>& sprite, bool* isBlank)
+{
+    toColorTreeSprite<true>(bgra, width, height, width * BYTES_PER_PIXEL_RGBA, sprite, isBlank);
+}
+
+///////////////////////////////////
+
+void bgraToColorTreeSprite(const unsigned char* bgra, size_t width, size_t height, size_t stride, std::vector<size_t>& sprite, bool* isBlank)
+{
+    toColorTreeSprite<true>(bgra, width, height, stride, sprite, isBlank);
+}
+
+///////////////////////////////////
+
+void rgbaToTransparencyTreeSprite(const unsigned char* rgba, size_t width, size_t height, std::vector<size_t>& sprite, bool* isBlank)
+{
+    rgbaToTransparencyTreeSprite(rgba, width, height, width * BYTES_PER_PIXEL_RGBA, sprite, isBlank);
+}
+
+///////////////////////////////////
+
+void rgbaToTransparencyTreeSprite(const unsigned char* rgba, size_t width, size_t height, size_t stride, std::vector<size_t>& sprite, bool* isBlank)
+{
+    const size_t numPixels = width * height;
+
+    // Strips are only written when they end, so a strip reaching the last
+    // pixel is left out. The stored trees depend on that. Strips continue
+    // from the end of one row to the start of the next.
+    size_t stripSize = 0;
+    if(isBigEndian())
+    {
+        std::vector<unsigned char> bytes;
+        bytes.push_back(width);
+        bytes.push_back(height);
+        for(size_t p = 0; p < numPixels; p++)
+        {
+            if(rgba[(p / width) * stride + (p % width) * BYTES_PER_PIXEL_RGBA + 3] == OPAQUE)
+            {
+                if(stripSize == 0)
+                    compressBigEndianMultiByteValue<size_t>(p * BYTES_PER_PIXEL_RGBA, bytes);
+
+                stripSize++;
+            }
+            else if(stripSize > 0)
+            {
+                compressBigEndianMultiByteValue<size_t>(stripSize, bytes);
+                stripSize = 0;
+            }
+        }
+
+        if(isBlank)
+            *isBlank = (bytes.size() == 2);
+        sprite = packBytes(bytes);
+        return;
+    }
+
+    // Every strip is at most an offset and a length.
+    const size_t maxNumStrips = (numPixels + 1) / 2;
+    unsigned char* out = beginTreeSprite(sprite, 2 + maxNumStrips * 2 * sizeof(size_t), width, height);
+    if(isContiguous(width, height, stride))
+        out = transparency(rgba, numPixels, 0, stripSize, out);
+    else
+        for(size_t y = 0; y < height; y++)
+            out = transparency(rgba + y * stride, width, y * width, stripSize, out);
+
+    endTreeSprite(sprite, out, isBlank);
+}
+
+///////////////////////////////////
+
+}
+}
@@ -228,83 +228,27 @@ std::vector<size_t> rgbaToTransparencyTreeSprite(const std::vector<unsigned char
 
 std::vector<size_t> rgbaToColorTreeSprite(const unsigned char* rgba, size_t width, size_t height, bool* isBlank)
 {
-    std::vector<unsigned char> sprite;
-    sprite.push_back(width);
-    sprite.push_back(height);
-    size_t size = width * height * BYTES_PER_PIXEL_RGBA;
-    for(size_t i = 0; i + BYTES_PER_PIXEL_RGBA - 1 < size; i += BYTES_PER_PIXEL_RGBA)
-    {
-        if(rgba[i + BYTES_PER_PIXEL_RGBA - 1] == 255)
-        {
-            sprite.push_back(rgba[i]);
-            sprite.push_back(rgba[i + 1]);
-            sprite.push_back(rgba[i + 2]);
-        }
-    }
-    if(isBlank)
-        *isBlank = (sprite.size() == 2);
-    return packBytes(sprite);
+    std::vector<size_t> sprite;
+    rgbaToColorTreeSprite(rgba, width, height, sprite, isBlank);
+    return sprite;
 }
 
 ///////////////////////////////////
 
 std::vector<size_t> bgraToColorTreeSprite(const unsigned char* bgra, size_t width, size_t height, bool* isBlank)
 {
-    unsigned char* rgba = bgraToRgba(bgra, width, height);
-
-    std::vector<size_t> sprite = rgbaToColorTreeSprite(rgba, width, height, isBlank);
-    delete[] rgba;
+    std::vector<size_t> sprite;
+    bgraToColorTreeSprite(bgra, width, height, sprite, isBlank);
     return sprite;
-//
-//    std::vector<unsigned char> sprite;
-//    sprite.push_back(width);
-//    sprite.push_back(height);
-//    size_t size = width * height * BYTES_PER_PIXEL_RGBA;
-//    for(size_t i = 0; i + BYTES_PER_PIXEL_RGBA - 1 < size; i += BYTES_PER_PIXEL_RGBA)
-//    {
-//        if(bgra[i + BYTES_PER_PIXEL_RGBA - 1] != 0)
-//        {
-//            sprite.push_back(bgra[i + 2]);
-//            sprite.push_back(bgra[i + 1]);
-//            sprite.push_back(bgra[i]);
-//        }
-//    }
-//
-//    if(isBlank)
-//        *isBlank = (sprite.size() == 2);
-//    return packBytes(sprite);
 }
 
 ///////////////////////////////////
 
 std::vector<size_t> rgbaToTransparencyTreeSprite(const unsigned char* rgba, size_t width, size_t height, bool* isBlank)
 {
-    std::vector<unsigned char> sprite;
-    sprite.push_back(width);
-    sprite.push_back(height);
-    size_t size = width * height * BYTES_PER_PIXEL_RGBA;
-    size_t stripSize = 0;
-    auto compressor = isBigEndian() ? compressBigEndianMultiByteValue<size_t> : compressSmallEndianMultiByteValue<size_t>;
-    for(size_t i = 0; i + BYTES_PER_PIXEL_RGBA - 1 < size; i += BYTES_PER_PIXEL_RGBA)
-    {
-        if(rgba[i + BYTES_PER_PIXEL_RGBA - 1] == 255)
-        {
-            if(stripSize == 0)
-            {
-                compressor(i, sprite);
-            }
-
-            stripSize++;
-        }
-        else if(stripSize > 0)
-        {
-            compressor(stripSize, sprite);
-            stripSize = 0;
-        }
-    }
-    if(isBlank)
-        *isBlank = (sprite.size() == 2);
-    return packBytes(sprite);
+    std::vector<size_t> sprite;
+    rgbaToTransparencyTreeSprite(rgba, width, height, sprite, isBlank);
+    return sprite;
 }
 
 ///////////////////////////////////
@@ -329,12 +273,17 @@ size_t readTibiaSizeIndicatorHelper(StreamT& stream)
     return size;
 }
 
-__declspec(dllexport) size_t readTibiaSizeIndicator(std::istream& stream)
+size_t readTibiaSizeIndicator(std::istream& stream)
+{
+    return readTibiaSizeIndicatorHelper(stream);
+}
+
+size_t readTibiaSizeIndicator(Buffer& stream)
 {
     return readTibiaSizeIndicatorHelper(stream);
 }
 
-__declspec(dllexport) size_t readTibiaSizeIndicator(Buffer& stream)
+size_t readTibiaSizeIndicator(BufferView& stream)
 {
     return readTibiaSizeIndicatorHelper(stream);
 }
@@ -376,61 +325,107 @@ std::string randStr(size_t length)
 
 ///////////////////////////////////
 
-size_t movingWindowMinDiff
-(
-    const unsigned char* lhs,
-    size_t lhsWidth, size_t lhsHeight,
-    const unsigned char* rhs,
-    size_t rhsWidth, size_t rhsHeight,
-    size_t rhsSum
-)
+namespace
 {
-    if(lhsWidth > rhsWidth || lhsHeight > rhsHeight)
-        SB_THROW("LHS size cannot be higher than RHS size.");
+    const uint64_t XXH_PRIME64_1 = 11400714785074694791ULL;
+    const uint64_t XXH_PRIME64_2 = 14029467366897019727ULL;
+    const uint64_t XXH_PRIME64_3 = 1609587929392839161ULL;
+    const uint64_t XXH_PRIME64_4 = 9650029242287828579ULL;
+    const uint64_t XXH_PRIME64_5 = 2870177450012600261ULL;
 
-    const size_t NUM_ITERATIONS_X = rhsWidth - lhsWidth + 1;
-    const size_t NUM_ITERATIONS_Y = rhsHeight - lhsHeight + 1;
-    const size_t LHS_ROW_SIZE = lhsWidth;
-    const size_t RHS_ROW_SIZE = rhsWidth;
-    const size_t LHS_SIZE = lhsHeight * LHS_ROW_SIZE;
-    const size_t RHS_SIZE = rhsHeight * RHS_ROW_SIZE;
-    size_t minDiff = -1;
+    inline uint64_t rotl64(uint64_t x, unsigned int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
 
-    if(rhsSum == -1)
+    inline uint64_t read64(const unsigned char* p)
     {
-        rhsSum = 0;
-        for(size_t i = 0; i < RHS_SIZE; i++)
-        {
-            rhsSum += rhs[i];
-        }
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline uint32_t read32(const unsigned char* p)
+    {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
     }
 
-    for(size_t x = 0; x < NUM_ITERATIONS_X; x++)
-        for(size_t y = 0; y < NUM_ITERATIONS_Y; y++)
+    inline uint64_t xxhRound(uint64_t acc, uint64_t input)
+    {
+        acc += input * XXH_PRIME64_2;
+        acc = rotl64(acc, 31);
+        return acc * XXH_PRIME64_1;
+    }
+
+    inline uint64_t xxhMergeRound(uint64_t acc, uint64_t val)
+    {
+        acc ^= xxhRound(0, val);
+        return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+}
+
+uint64_t hash64(const void* data, size_t size, uint64_t seed)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    const unsigned char* const END = p + size;
+    uint64_t h;
+
+    if(size >= 32)
+    {
+        const unsigned char* const LIMIT = END - 32;
+        uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        uint64_t v2 = seed + XXH_PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME64_1;
+        do
         {
-            size_t diff = 0;
-            size_t currentRhsSum = rhsSum;
-            for(size_t lhsIndex = 0, rhsIndex = x + y * RHS_ROW_SIZE;
-                lhsIndex < LHS_SIZE && rhsIndex < RHS_SIZE;
-                lhsIndex += LHS_ROW_SIZE, rhsIndex += RHS_ROW_SIZE)
-            {
-                for(size_t i = 0; i < LHS_ROW_SIZE; i++)
-                {
-                    currentRhsSum -= rhs[rhsIndex + i];
-                    int d = (int)lhs[lhsIndex + i] - (int)rhs[rhsIndex + i];
-                    diff += d < 0 ? -d : d;
-                }
-            }
-
-            diff += currentRhsSum;
-            if(diff == 0)
-                return 0;
-
-            if(diff < minDiff)
-                minDiff = diff;
-        }
+            v1 = xxhRound(v1, read64(p));
+            v2 = xxhRound(v2, read64(p + 8));
+            v3 = xxhRound(v3, read64(p + 16));
+            v4 = xxhRound(v4, read64(p + 24));
+            p += 32;
+        } while(p <= LIMIT);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxhMergeRound(h, v1);
+        h = xxhMergeRound(h, v2);
+        h = xxhMergeRound(h, v3);
+        h = xxhMergeRound(h, v4);
+    }
+    else
+    {
+        h = seed + XXH_PRIME64_5;
+    }
+
+    h += size;
+
+    for(; p + 8 <= END; p += 8)
+    {
+        h ^= xxhRound(0, read64(p));
+        h = rotl64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+
+    if(p + 4 <= END)
+    {
+        h ^= uint64_t(read32(p)) * XXH_PRIME64_1;
+        h = rotl64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+
+    for(; p < END; p++)
+    {
+        h ^= (*p) * XXH_PRIME64_5;
+        h = rotl64(h, 11) * XXH_PRIME64_1;
+    }
 
-    return minDiff;
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
 }
 
 ///////////////////////////////////
@@ -462,52 +457,6 @@ auto tryStringify(std::stringstream& sstream, ...) -> decltype(void())
 
 ///////////////////////////////////
 
-size_t centerDiff
-(
-    const unsigned char* lhs,
-    size_t lhsWidth, size_t lhsHeight,
-    size_t lhsCenter,
-    const unsigned char* rhs,
-    size_t rhsWidth, size_t rhsHeight,
-    size_t rhsCenter,
-    size_t rhsSum
-)
-{
-    if(lhsWidth > rhsWidth || lhsHeight > rhsHeight)
-        SB_THROW("LHS size cannot be higher than RHS size.");
-
-    const size_t LHS_ROW_SIZE = lhsWidth;
-    const size_t RHS_ROW_SIZE = rhsWidth;
-    const size_t LHS_SIZE = lhsHeight * LHS_ROW_SIZE;
-    const size_t RHS_SIZE = rhsHeight * RHS_ROW_SIZE;
-    if(rhsSum == -1)
-    {
-        rhsSum = 0;
-        for(size_t i = 0; i < RHS_SIZE; i++)
-        {
-            rhsSum += rhs[i];
-        }
-    }
-
-    size_t diff = 0;
-    for(size_t lhsIndex = 0, rhsIndex = rhsCenter - (lhsCenter / lhsWidth) * RHS_ROW_SIZE - lhsCenter % lhsWidth;
-        lhsIndex < LHS_SIZE && rhsIndex < RHS_SIZE;
-        lhsIndex += LHS_ROW_SIZE, rhsIndex += RHS_ROW_SIZE)
-    {
-        for(size_t i = 0; i < LHS_ROW_SIZE; i++)
-        {
-            rhsSum -= rhs[rhsIndex + i];
-            int d = (int)lhs[lhsIndex + i] - (int)rhs[rhsIndex + i];
-            diff += d < 0 ? -d : d;
-        }
-    }
-
-    diff += rhsSum;
-    return diff;
-}
-
-///////////////////////////////////
-
 void worldToScreenCoords
 (
     float worldX, float worldY,
@@ -0,0 +1,460 @@
+// {SHANK_BOT_LICENSE_BEGIN}
+/****************************************************************
+****************************************************************
+*
+* ShankBot - Automation software for the MMORPG Tibia.
+* Copyright (C) 2016-2017 Mikael Hernvall
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* Contact:
+*       mikael.hernvall@gmail.com
+*
+****************************************************************
+****************************************************************/
+// {SHANK_BOT_LICENSE_END}
+///////////////////////////////////
+// Internal ShankBot headers
+#include "utility/utility.hpp"
+#include "utility/simd.hpp"
+///////////////////////////////////
+
+///////////////////////////////////
+// STD C++
+#include <vector>
+#include <memory>
+#include <cstring>
+///////////////////////////////////
+
+#if defined(SB_UTILITY_X86_SIMD)
+///////////////////////////////////
+// Intrinsics
+#include <immintrin.h>
+///////////////////////////////////
+#endif
+
+namespace sb
+{
+namespace utility
+{
+
+namespace
+{
+    const size_t CHUNK_SIZE = 16;
+    const size_t NO_LIMIT = -1;
+
+    // Image copied into zero padded rows, so that the kernels can load whole
+    // 16 byte chunks anywhere inside a row.
+    class PaddedImage
+    {
+        public:
+            PaddedImage(const unsigned char* pixels, size_t width, size_t height, size_t stride)
+            : mWidth(width)
+            , mHeight(height)
+            , mStride(stride)
+            , mPixels(stride * height + CHUNK_SIZE, 0)
+            {
+                for(size_t y = 0; y < height; y++)
+                    memcpy(&mPixels[y * stride], pixels + y * width, width);
+            }
+
+            // Enables getSum.
+            void computeIntegral()
+            {
+                const size_t INTEGRAL_WIDTH = mWidth + 1;
+                mIntegral.assign(INTEGRAL_WIDTH * (mHeight + 1), 0);
+                for(size_t y = 0; y < mHeight; y++)
+                {
+                    size_t rowSum = 0;
+                    for(size_t x = 0; x < mWidth; x++)
+                    {
+                        rowSum += mPixels[y * mStride + x];
+                        mIntegral[(y + 1) * INTEGRAL_WIDTH + x + 1] = mIntegral[y * INTEGRAL_WIDTH + x + 1] + rowSum;
+                    }
+                }
+            }
+
+            size_t getSum(size_t x, size_t y, size_t width, size_t height) const
+            {
+                const size_t INTEGRAL_WIDTH = mWidth + 1;
+                return  mIntegral[(y + height) * INTEGRAL_WIDTH + x + width] -
+                        mIntegral[y * INTEGRAL_WIDTH + x + width] -
+                        mIntegral[(y + height) * INTEGRAL_WIDTH + x] +
+                        mIntegral[y * INTEGRAL_WIDTH + x];
+            }
+
+            const unsigned char* getPixels() const
+            {
+                return mPixels.data();
+            }
+
+            size_t getWidth() const
+            {
+                return mWidth;
+            }
+
+            size_t getHeight() const
+            {
+                return mHeight;
+            }
+
+            size_t getStride() const
+            {
+                return mStride;
+            }
+
+        private:
+            size_t mWidth;
+            size_t mHeight;
+            size_t mStride;
+            std::vector<unsigned char> mPixels;
+            std::vector<size_t> mIntegral;
+    };
+
+    size_t getChunkedStride(size_t width)
+    {
+        return (width + CHUNK_SIZE - 1) / CHUNK_SIZE * CHUNK_SIZE;
+    }
+
+    // The window may start anywhere in a row of rhs, so every chunk read
+    // from it must stay inside the row padding.
+    PaddedImage createLhs(const unsigned char* pixels, size_t width, size_t height)
+    {
+        return PaddedImage(pixels, width, height, getChunkedStride(width));
+    }
+
+    PaddedImage createRhs(const unsigned char* pixels, size_t width, size_t height)
+    {
+        PaddedImage image(pixels, width, height, width + CHUNK_SIZE);
+        image.computeIntegral();
+        return image;
+    }
+
+    ///////////////////////////////////
+
+    // Sum of absolute differences between lhs and a window of rhs of the same
+    // size. lhs rows are zero padded to whole chunks. Stops as soon as the
+    // sum reaches limit, in which case the returned value is at least limit.
+    size_t sadScalar(const unsigned char* lhs, size_t lhsStride, const unsigned char* rhs, size_t rhsStride, size_t width, size_t height, size_t limit)
+    {
+        size_t sad = 0;
+        for(size_t y = 0; y < height; y++, lhs += lhsStride, rhs += rhsStride)
+        {
+            for(size_t x = 0; x < width; x++)
+            {
+                int d = (int)lhs[x] - (int)rhs[x];
+                sad += d < 0 ? -d : d;
+            }
+
+            if(sad >= limit)
+                return sad;
+        }
+
+        return sad;
+    }
+
+#if defined(SB_UTILITY_X86_SIMD)
+    // 16 set bytes followed by 16 zero bytes. Loading at 16 - n gives a mask
+    // for the first n bytes of a chunk.
+    const unsigned char CHUNK_MASKS[2 * CHUNK_SIZE] =
+    {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    };
+
+    __attribute__((target("sse2")))
+    inline __m128i sadRowSse2(const unsigned char* lhs, const unsigned char* rhs, size_t numChunks, __m128i lastMask)
+    {
+        __m128i sad = _mm_setzero_si128();
+        for(size_t c = 0; c + 1 < numChunks; c++)
+        {
+            __m128i l = _mm_loadu_si128((const __m128i*)(lhs + c * CHUNK_SIZE));
+            __m128i r = _mm_loadu_si128((const __m128i*)(rhs + c * CHUNK_SIZE));
+            sad = _mm_add_epi64(sad, _mm_sad_epu8(l, r));
+        }
+
+        const size_t c = numChunks - 1;
+        __m128i l = _mm_loadu_si128((const __m128i*)(lhs + c * CHUNK_SIZE));
+        __m128i r = _mm_and_si128(_mm_loadu_si128((const __m128i*)(rhs + c * CHUNK_SIZE)), lastMask);
+        return _mm_add_epi64(sad, _mm_sad_epu8(l, r));
+    }
+
+    __attribute__((target("sse2")))
+    inline size_t horizontalSumSse2(__m128i sad)
+    {
+        return (unsigned int)_mm_cvtsi128_si32(_mm_add_epi64(sad, _mm_srli_si128(sad, 8)));
+    }
+
+    __attribute__((target("sse2")))
+    size_t sadSse2(const unsigned char* lhs, size_t lhsStride, const unsigned char* rhs, size_t rhsStride, size_t width, size_t height, size_t limit)
+    {
+        const size_t numChunks = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        const __m128i lastMask = _mm_loadu_si128((const __m128i*)(CHUNK_MASKS + numChunks * CHUNK_SIZE - width));
+        size_t sad = 0;
+        for(size_t y = 0; y < height; y++, lhs += lhsStride, rhs += rhsStride)
+        {
+            sad += horizontalSumSse2(sadRowSse2(lhs, rhs, numChunks, lastMask));
+            if(sad >= limit)
+                return sad;
+        }
+
+        return sad;
+    }
+
+    // Two rows per instruction, one in each lane.
+    __attribute__((target("avx2")))
+    size_t sadAvx2(const unsigned char* lhs, size_t lhsStride, const unsigned char* rhs, size_t rhsStride, size_t width, size_t height, size_t limit)
+    {
+        const size_t numChunks = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        const __m128i lastMask = _mm_loadu_si128((const __m128i*)(CHUNK_MASKS + numChunks * CHUNK_SIZE - width));
+        const __m256i lastMask2 = _mm256_broadcastsi128_si256(lastMask);
+        size_t sad = 0;
+        size_t y = 0;
+        for(; y + 1 < height; y += 2, lhs += 2 * lhsStride, rhs += 2 * rhsStride)
+        {
+            __m256i rowSad = _mm256_setzero_si256();
+            for(size_t c = 0; c < numChunks; c++)
+            {
+                const size_t offset = c * CHUNK_SIZE;
+                __m256i l = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(lhs + offset))), _mm_loadu_si128((const __m128i*)(lhs + lhsStride + offset)), 1);
+                __m256i r = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(rhs + offset))), _mm_loadu_si128((const __m128i*)(rhs + rhsStride + offset)), 1);
+                if(c + 1 == numChunks)
+                    r = _mm256_and_si256(r, lastMask2);
+
+                rowSad = _mm256_add_epi64(rowSad, _mm256_sad_epu8(l, r));
+            }
+
+            sad += horizontalSumSse2(_mm_add_epi64(_mm256_castsi256_si128(rowSad), _mm256_extracti128_si256(rowSad, 1)));
+            if(sad >= limit)
+                return sad;
+        }
+
+        if(y < height)
+            sad += horizontalSumSse2(sadRowSse2(lhs, rhs, numChunks, lastMask));
+
+        return sad;
+    }
+#endif // defined(SB_UTILITY_X86_SIMD)
+
+    typedef size_t (*SadKernel)(const unsigned char*, size_t, const unsigned char*, size_t, size_t, size_t, size_t);
+
+    SadKernel getSadKernel()
+    {
+        switch(getSimdLevel())
+        {
+        #if defined(SB_UTILITY_X86_SIMD)
+            case SimdLevel::AVX2:
+                return sadAvx2;
+
+            case SimdLevel::SSE2:
+                return sadSse2;
+        #endif
+
+            default:
+                return sadScalar;
+        }
+    }
+
+    ///////////////////////////////////
+
+    // The diff of a window is the SAD inside it plus the sum of rhs outside
+    // of it. The outside part is known up front from the integral image, so
+    // a window is abandoned as soon as the two together reach the best diff
+    // so far. Returns the smallest diff if it is lower than bound, otherwise
+    // some value at least as large as bound.
+    size_t minDiff(SadKernel sad, const PaddedImage& lhs, const PaddedImage& rhs, size_t rhsSum, size_t bound)
+    {
+        if(lhs.getWidth() == 0 || lhs.getHeight() == 0)
+            return rhsSum;
+
+        const size_t NUM_ITERATIONS_X = rhs.getWidth() - lhs.getWidth() + 1;
+        const size_t NUM_ITERATIONS_Y = rhs.getHeight() - lhs.getHeight() + 1;
+        size_t best = bound;
+        for(size_t x = 0; x < NUM_ITERATIONS_X; x++)
+            for(size_t y = 0; y < NUM_ITERATIONS_Y; y++)
+            {
+                const unsigned char* window = rhs.getPixels() + y * rhs.getStride() + x;
+                const size_t windowSum = rhs.getSum(x, y, lhs.getWidth(), lhs.getHeight());
+
+                size_t diff;
+                if(rhsSum >= windowSum)
+                {
+                    const size_t outside = rhsSum - windowSum;
+                    if(outside >= best)
+                        continue;
+
+                    const size_t limit = best - outside;
+                    const size_t windowSad = sad(lhs.getPixels(), lhs.getStride(), window, rhs.getStride(), lhs.getWidth(), lhs.getHeight(), limit);
+                    if(windowSad >= limit)
+                        continue;
+
+                    diff = windowSad + outside;
+                }
+                else
+                {
+                    // Only happens if the given rhsSum is too small. Keep the
+                    // wrapping arithmetic of the original implementation.
+                    diff = sad(lhs.getPixels(), lhs.getStride(), window, rhs.getStride(), lhs.getWidth(), lhs.getHeight(), NO_LIMIT) + rhsSum - windowSum;
+                    if(diff >= best)
+                        continue;
+                }
+
+                best = diff;
+                if(best == 0)
+                    return 0;
+            }
+
+        return best;
+    }
+}
+
+///////////////////////////////////
+
+size_t movingWindowMinDiff
+(
+    const unsigned char* lhs,
+    size_t lhsWidth, size_t lhsHeight,
+    const unsigned char* rhs,
+    size_t rhsWidth, size_t rhsHeight,
+    size_t rhsSum
+)
+{
+    if(lhsWidth > rhsWidth || lhsHeight > rhsHeight)
+        SB_THROW("LHS size cannot be higher than RHS size.");
+
+    PaddedImage lhsImage = createLhs(lhs, lhsWidth, lhsHeight);
+    PaddedImage rhsImage = createRhs(rhs, rhsWidth, rhsHeight);
+    if(rhsSum == size_t(-1))
+        rhsSum = rhsImage.getSum(0, 0, rhsWidth, rhsHeight);
+
+    return minDiff(getSadKernel(), lhsImage, rhsImage, rhsSum, NO_LIMIT);
+}
+
+///////////////////////////////////
+
+void movingWindowMinDiffs
+(
+    const unsigned char* image,
+    size_t width, size_t height,
+    size_t sum,
+    const WindowDiffTemplate* templates,
+    size_t numTemplates,
+    size_t* diffs,
+    bool isBestOnly
+)
+{
+    const SadKernel sad = getSadKernel();
+
+    // The image is padded once, for each of its two roles.
+    std::unique_ptr<PaddedImage> imageAsLhs;
+    std::unique_ptr<PaddedImage> imageAsRhs;
+    if(sum == size_t(-1))
+    {
+        sum = 0;
+        for(size_t i = 0; i < width * height; i++)
+            sum += image[i];
+    }
+
+    size_t best = NO_LIMIT;
+    for(size_t i = 0; i < numTemplates; i++)
+    {
+        const WindowDiffTemplate& t = templates[i];
+        if(isBestOnly && best == 0)
+        {
+            diffs[i] = best;
+            continue;
+        }
+
+        const size_t bound = (isBestOnly ? best : NO_LIMIT);
+        if(t.width <= width && t.height <= height)
+        {
+            if(!imageAsRhs)
+                imageAsRhs.reset(new PaddedImage(createRhs(image, width, height)));
+
+            diffs[i] = minDiff(sad, createLhs(t.pixels, t.width, t.height), *imageAsRhs, sum, bound);
+        }
+        else if(width <= t.width && height <= t.height)
+        {
+            if(!imageAsLhs)
+                imageAsLhs.reset(new PaddedImage(createLhs(image, width, height)));
+
+            diffs[i] = minDiff(sad, *imageAsLhs, createRhs(t.pixels, t.width, t.height), t.sum, bound);
+        }
+        else
+        {
+            diffs[i] = -1;
+        }
+
+        if(diffs[i] < best)
+            best = diffs[i];
+    }
+}
+
+///////////////////////////////////
+
+size_t centerDiff
+(
+    const unsigned char* lhs,
+    size_t lhsWidth, size_t lhsHeight,
+    size_t lhsCenter,
+    const unsigned char* rhs,
+    size_t rhsWidth, size_t rhsHeight,
+    size_t rhsCenter,
+    size_t rhsSum
+)
+{
+    if(lhsWidth > rhsWidth || lhsHeight > rhsHeight)
+        SB_THROW("LHS size cannot be higher than RHS size.");
+
+    const size_t RHS_SIZE = rhsHeight * rhsWidth;
+    if(rhsSum == size_t(-1))
+    {
+        rhsSum = 0;
+        for(size_t i = 0; i < RHS_SIZE; i++)
+            rhsSum += rhs[i];
+    }
+
+    if(lhsWidth == 0 || lhsHeight == 0)
+        return rhsSum;
+
+    // The window is addressed linearly in rhs, like the original
+    // implementation did, so rows may wrap around the right edge. Rows
+    // starting past the end of rhs are left out.
+    const size_t start = rhsCenter - (lhsCenter / lhsWidth) * rhsWidth - lhsCenter % lhsWidth;
+    size_t numRows = 0;
+    while(numRows < lhsHeight && start + numRows * rhsWidth < RHS_SIZE)
+        numRows++;
+
+    if(numRows == 0)
+        return rhsSum;
+
+    // Linear copy of rhs with room for the last row to run over its end.
+    const size_t lhsStride = getChunkedStride(lhsWidth);
+    std::vector<unsigned char> paddedRhs(RHS_SIZE + lhsStride + CHUNK_SIZE, 0);
+    memcpy(paddedRhs.data(), rhs, RHS_SIZE);
+
+    PaddedImage lhsImage = createLhs(lhs, lhsWidth, lhsHeight);
+    const std::vector<unsigned char> zeros(lhsStride * numRows, 0);
+    const unsigned char* window = paddedRhs.data() + start;
+    const SadKernel sad = getSadKernel();
+
+    const size_t diff = sad(lhsImage.getPixels(), lhsStride, window, rhsWidth, lhsWidth, numRows, NO_LIMIT);
+    const size_t windowSum = sad(zeros.data(), lhsStride, window, rhsWidth, lhsWidth, numRows, NO_LIMIT);
+    return diff + rhsSum - windowSum;
+}
+
+///////////////////////////////////
+
+}
+}
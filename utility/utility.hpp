@@ -37,12 +37,14 @@
 #include <istream>
 #include <vector>
 #include <array>
+#include <cstdint>
 ///////////////////////////////////
 
 ///////////////////////////////////
 // Internal ShankBot headers
 #include "utility/config.hpp"
 #include "utility/Buffer.hpp"
+#include "utility/BufferView.hpp"
 namespace sb
 {
 namespace utility
@@ -86,7 +88,20 @@ namespace utility
     SHANK_BOT_UTILITY_DECLSPEC std::vector<size_t> rgbaToColorTreeSprite(const unsigned char* rgba, size_t width, size_t height, bool* isBlank = nullptr);
     SHANK_BOT_UTILITY_DECLSPEC std::vector<size_t> rgbaToTransparencyTreeSprite(const unsigned char* rgba, size_t width, size_t height, bool* isBlank = nullptr);
 
+    // Same as above, but the sprite is written into a caller provided buffer
+    // whose storage is reused. Vectorized where the CPU supports it.
+    SHANK_BOT_UTILITY_DECLSPEC void bgraToColorTreeSprite(const unsigned char* bgra, size_t width, size_t height, std::vector<size_t>& sprite, bool* isBlank = nullptr);
+    SHANK_BOT_UTILITY_DECLSPEC void rgbaToColorTreeSprite(const unsigned char* rgba, size_t width, size_t height, std::vector<size_t>& sprite, bool* isBlank = nullptr);
+    SHANK_BOT_UTILITY_DECLSPEC void rgbaToTransparencyTreeSprite(const unsigned char* rgba, size_t width, size_t height, std::vector<size_t>& sprite, bool* isBlank = nullptr);
+
+    // Same as above for pixels whose rows are stride bytes apart, such as a
+    // sprite inside a sprite sheet.
+    SHANK_BOT_UTILITY_DECLSPEC void bgraToColorTreeSprite(const unsigned char* bgra, size_t width, size_t height, size_t stride, std::vector<size_t>& sprite, bool* isBlank = nullptr);
+    SHANK_BOT_UTILITY_DECLSPEC void rgbaToColorTreeSprite(const unsigned char* rgba, size_t width, size_t height, size_t stride, std::vector<size_t>& sprite, bool* isBlank = nullptr);
+    SHANK_BOT_UTILITY_DECLSPEC void rgbaToTransparencyTreeSprite(const unsigned char* rgba, size_t width, size_t height, size_t stride, std::vector<size_t>& sprite, bool* isBlank = nullptr);
+
     SHANK_BOT_UTILITY_DECLSPEC std::string randStr(size_t length);
+    SHANK_BOT_UTILITY_DECLSPEC uint64_t hash64(const void* data, size_t size, uint64_t seed = 0); // XXH64
 
     template<typename T>
     void stringifyHelper(std::ostream& stream, const T& t)
@@ -180,6 +195,16 @@ namespace utility
         b.curr += size;
     }
 
+    template<typename T>
+    void readStream(T& t, BufferView& b, size_t n = 1)
+    {
+        const size_t size = sizeof(T) * n;
+        if(size > b.size - b.curr)
+            b.throwReadPastEnd(size);
+        memcpy((char*)&t, b.data + b.curr, size);
+        b.curr += size;
+    }
+
     template<typename T>
     void readStream(T& t, const char*& stream, size_t n = 1)
     {
@@ -230,6 +255,7 @@ namespace utility
 
     SHANK_BOT_UTILITY_DECLSPEC size_t readTibiaSizeIndicator(std::istream& stream);
     SHANK_BOT_UTILITY_DECLSPEC size_t readTibiaSizeIndicator(Buffer& stream);
+    SHANK_BOT_UTILITY_DECLSPEC size_t readTibiaSizeIndicator(BufferView& stream);
 
     SHANK_BOT_UTILITY_DECLSPEC std::string getDateTime();
 
@@ -281,6 +307,31 @@ namespace utility
         size_t rhsWidth, size_t rhsHeight,
         size_t rhsSum = -1
     );
+
+    struct WindowDiffTemplate
+    {
+        const unsigned char* pixels;
+        size_t width;
+        size_t height;
+        size_t sum;
+    };
+
+    // Compares image against every template with movingWindowMinDiff, using
+    // whichever of the two fits inside the other as the window. Templates
+    // fitting neither way get a diff of -1. If isBestOnly is set, only the
+    // smallest diff is guaranteed to be exact; the others are only known to
+    // be at least as large as it. The template sums must be set, image sum
+    // may be -1.
+    SHANK_BOT_UTILITY_DECLSPEC void movingWindowMinDiffs
+    (
+        const unsigned char* image,
+        size_t width, size_t height,
+        size_t sum,
+        const WindowDiffTemplate* templates,
+        size_t numTemplates,
+        size_t* diffs,
+        bool isBestOnly = false
+    );
     SHANK_BOT_UTILITY_DECLSPEC size_t centerDiff
     (
         const unsigned char* lhs,